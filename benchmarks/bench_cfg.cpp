@@ -0,0 +1,351 @@
+#include "cfg.h"
+#include "automaton.h"
+#include "grammars.h"
+#include "string_utils.h"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <fstream>
+
+using namespace std;
+
+static ContextFreeGrammar parseGrammar(const string& s) {
+    ContextFreeGrammar grammar;
+    if (!grammar.parse(s)) {
+        throw runtime_error(grammar.errorMessage());
+    }
+    return grammar;
+}
+
+static size_t countTokens(const string& s) {
+    size_t count = 0;
+    bool inToken = false;
+    for (const auto ch : s) {
+        if (ch == ' ') {
+            inToken = false;
+        } else if (!inToken) {
+            inToken = true;
+            ++count;
+        }
+    }
+    return count;
+}
+
+static void BM_SegmentGraphemes(benchmark::State& state) {
+    const auto text = randomGrammar(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(segmentGraphemes(text));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_SegmentGraphemes)->RangeMultiplier(4)->Range(16, 1024);
+
+static void BM_SegmentGraphemeViews(benchmark::State& state) {
+    const auto text = randomGrammar(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(segmentGraphemeViews(text));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_SegmentGraphemeViews)->RangeMultiplier(4)->Range(16, 1024);
+
+static void BM_TokenizeGrammar(benchmark::State& state) {
+    const auto text = randomGrammar(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ContextFreeGrammar::tokenize(text));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_TokenizeGrammar)->RangeMultiplier(4)->Range(16, 1024);
+
+static void BM_TokenizeGrammarViews(benchmark::State& state) {
+    const auto text = randomGrammar(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ContextFreeGrammar::tokenizeViews(text));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_TokenizeGrammarViews)->RangeMultiplier(4)->Range(16, 1024);
+
+static void BM_ParseGrammar(benchmark::State& state) {
+    const auto text = randomGrammar(state.range(0));
+    for (auto _ : state) {
+        ContextFreeGrammar grammar;
+        benchmark::DoNotOptimize(grammar.parse(text));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_ParseGrammar)->RangeMultiplier(4)->Range(16, 1024);
+
+static void BM_ParseGrammarFile(benchmark::State& state) {
+    const auto path = filesystem::temp_directory_path() / "parsing_toys_bench_grammar.txt";
+    const auto text = randomGrammar(state.range(0));
+    ofstream(path, ios::binary) << text;
+    for (auto _ : state) {
+        ContextFreeGrammar grammar;
+        benchmark::DoNotOptimize(grammar.parseFile(path.string()));
+    }
+    filesystem::remove(path);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_ParseGrammarFile)->RangeMultiplier(4)->Range(16, 1024);
+
+/**
+ * Type a symbol into the middle of the grammar and delete it, which are two edits per iteration.
+ */
+static void BM_IncrementalGrammarEdit(benchmark::State& state) {
+    IncrementalGrammar incremental;
+    incremental.parse(randomGrammar(state.range(0)));
+    const auto offset = incremental.text().find('\n', incremental.text().size() / 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(incremental.edit(offset, 0, " x"));
+        benchmark::DoNotOptimize(incremental.edit(offset, 2, ""));
+    }
+}
+BENCHMARK(BM_IncrementalGrammarEdit)->RangeMultiplier(4)->Range(16, 16384);
+
+static void BM_LeftFactoring(benchmark::State& state) {
+    const auto grammar = parseGrammar(randomGrammar(state.range(0)));
+    for (auto _ : state) {
+        auto copy = grammar;
+        copy.leftFactoring(state.range(1) != 0);
+        benchmark::DoNotOptimize(copy);
+    }
+}
+// Expanding the expressions grows quickly, so the expanded version only runs on small grammars.
+BENCHMARK(BM_LeftFactoring)->ArgsProduct({{16, 64, 256}, {0}})->ArgsProduct({{8, 16}, {1}});
+
+static void BM_LeftRecursionElimination(benchmark::State& state) {
+    const auto grammar = parseGrammar(expressionGrammar(state.range(0)));
+    for (auto _ : state) {
+        auto copy = grammar;
+        benchmark::DoNotOptimize(copy.leftRecursionElimination());
+    }
+}
+BENCHMARK(BM_LeftRecursionElimination)->RangeMultiplier(2)->Range(2, 64);
+
+static void BM_FirstAndFollowRandom(benchmark::State& state) {
+    const auto grammar = parseGrammar(randomGrammar(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(grammar.computeFirstAndFollowSet());
+    }
+}
+BENCHMARK(BM_FirstAndFollowRandom)->RangeMultiplier(4)->Range(16, 1024);
+
+static void BM_FirstAndFollowCLike(benchmark::State& state) {
+    const auto grammar = parseGrammar(cLikeGrammar());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(grammar.computeFirstAndFollowSet());
+    }
+}
+BENCHMARK(BM_FirstAndFollowCLike);
+
+/**
+ * Build an automaton and its ACTION/GOTO table for the expression grammar with range(0) levels.
+ * range(1) is 0 for the automaton only, and 1 for both.
+ */
+template<auto ComputeAutomaton, auto ComputeTable>
+static void BM_LRExpression(benchmark::State& state) {
+    const auto grammar = parseGrammar(expressionGrammar(state.range(0)));
+    size_t numStates = 0;
+    for (auto _ : state) {
+        auto copy = grammar;
+        const auto automaton = (copy.*ComputeAutomaton)();
+        numStates = automaton->size();
+        if (state.range(1) != 0) {
+            benchmark::DoNotOptimize((copy.*ComputeTable)(automaton));
+        }
+    }
+    state.counters["states"] = static_cast<double>(numStates);
+}
+BENCHMARK(BM_LRExpression<&ContextFreeGrammar::computeLR0Automaton, &ContextFreeGrammar::computeLR0ActionGotoTable>)
+    ->Name("BM_LR0Expression")->ArgsProduct({{2, 4, 8, 16}, {0, 1}});
+BENCHMARK(BM_LRExpression<&ContextFreeGrammar::computeSLR1Automaton, &ContextFreeGrammar::computeSLR1ActionGotoTable>)
+    ->Name("BM_SLR1Expression")->ArgsProduct({{2, 4, 8, 16}, {0, 1}});
+BENCHMARK(BM_LRExpression<&ContextFreeGrammar::computeLR1Automaton, &ContextFreeGrammar::computeLR1ActionGotoTable>)
+    ->Name("BM_LR1Expression")->ArgsProduct({{2, 4, 8}, {0, 1}});
+BENCHMARK(BM_LRExpression<&ContextFreeGrammar::computeLALR1Automaton, &ContextFreeGrammar::computeLALR1ActionGotoTable>)
+    ->Name("BM_LALR1Expression")->ArgsProduct({{2, 4, 8}, {0, 1}});
+
+template<auto ComputeAutomaton>
+static void BM_LRCLike(benchmark::State& state) {
+    const auto grammar = parseGrammar(cLikeGrammar());
+    size_t numStates = 0;
+    for (auto _ : state) {
+        auto copy = grammar;
+        numStates = (copy.*ComputeAutomaton)()->size();
+    }
+    state.counters["states"] = static_cast<double>(numStates);
+}
+BENCHMARK(BM_LRCLike<&ContextFreeGrammar::computeLR0Automaton>)->Name("BM_LR0CLike");
+BENCHMARK(BM_LRCLike<&ContextFreeGrammar::computeLR1Automaton>)->Name("BM_LR1CLike");
+BENCHMARK(BM_LRCLike<&ContextFreeGrammar::computeLALR1Automaton>)->Name("BM_LALR1CLike");
+
+/**
+ * Build the LR(1) automaton of the C-like grammar with range(0) threads.
+ */
+static void BM_LR1CLikeParallel(benchmark::State& state) {
+    const auto grammar = parseGrammar(cLikeGrammar());
+    size_t numStates = 0;
+    for (auto _ : state) {
+        auto copy = grammar;
+        numStates = copy.computeLRAutomaton(LRAlgorithm::LR1, state.range(0))->size();
+    }
+    state.counters["states"] = static_cast<double>(numStates);
+}
+BENCHMARK(BM_LR1CLikeParallel)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+
+/**
+ * Fill the LR(1) ACTION/GOTO table of the C-like grammar with range(0) threads.
+ */
+static void BM_LR1TableCLikeParallel(benchmark::State& state) {
+    auto grammar = parseGrammar(cLikeGrammar());
+    const auto automaton = grammar.computeLR1Automaton();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(grammar.computeActionGotoTable(LRAlgorithm::LR1, automaton, state.range(0)));
+    }
+    state.counters["states"] = static_cast<double>(automaton->size());
+}
+BENCHMARK(BM_LR1TableCLikeParallel)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+
+/**
+ * Add a type to the C-like grammar and remove it, which are two updates of the automaton and the table per iteration.
+ */
+template<IncrementalLRAutomaton::Type Type>
+static void BM_IncrementalLRCLike(benchmark::State& state) {
+    const auto grammar = parseGrammar(cLikeGrammar());
+    auto text = cLikeGrammar();
+    text.replace(text.find("| char"), 6, "| char | double");
+    const auto edited = parseGrammar(text);
+    IncrementalLRAutomaton incremental(Type);
+    incremental.update(grammar);
+    for (auto _ : state) {
+        incremental.update(edited);
+        incremental.update(grammar);
+    }
+    state.counters["states"] = static_cast<double>(incremental.automaton()->size());
+    state.counters["reused"] = static_cast<double>(incremental.numReusedStates());
+}
+BENCHMARK(BM_IncrementalLRCLike<IncrementalLRAutomaton::Type::LR0>)->Name("BM_IncrementalLR0CLike");
+BENCHMARK(BM_IncrementalLRCLike<IncrementalLRAutomaton::Type::LR1>)->Name("BM_IncrementalLR1CLike");
+BENCHMARK(BM_IncrementalLRCLike<IncrementalLRAutomaton::Type::LALR1>)->Name("BM_IncrementalLALR1CLike");
+
+/**
+ * Load the LALR(1) table of the C-like grammar from a warm cache directory.
+ */
+static void BM_ArtifactCacheCLike(benchmark::State& state) {
+    const auto directory = filesystem::temp_directory_path() / "parsing_toys_bench_artifact_cache";
+    const auto grammar = parseGrammar(cLikeGrammar());
+    GrammarArtifactCache cache(directory.string());
+    benchmark::DoNotOptimize(cache.actionGotoTable(grammar, LRAlgorithm::LALR1));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.actionGotoTable(grammar, LRAlgorithm::LALR1));
+    }
+    filesystem::remove_all(directory);
+}
+BENCHMARK(BM_ArtifactCacheCLike);
+
+static void BM_LRParse(benchmark::State& state) {
+    auto grammar = parseGrammar(expressionGrammar(4));
+    const auto automaton = grammar.computeLALR1Automaton();
+    auto table = grammar.computeLALR1ActionGotoTable(automaton);
+    const auto input = expressionInput(4, state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(table.parse(input));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * countTokens(input)));
+}
+BENCHMARK(BM_LRParse)->RangeMultiplier(4)->Range(16, 4096);
+
+static void BM_LL1Table(benchmark::State& state) {
+    auto grammar = parseGrammar(expressionGrammar(state.range(0)));
+    grammar.leftRecursionElimination();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(grammar.computeLL1Table());
+    }
+}
+BENCHMARK(BM_LL1Table)->RangeMultiplier(2)->Range(2, 32);
+
+static void BM_LL1Parse(benchmark::State& state) {
+    auto grammar = parseGrammar(expressionGrammar(4));
+    grammar.leftRecursionElimination();
+    auto table = grammar.computeLL1Table();
+    const auto input = expressionInput(4, state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(table.parse(input));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * countTokens(input)));
+}
+BENCHMARK(BM_LL1Parse)->RangeMultiplier(4)->Range(16, 4096);
+
+static void BM_ChomskyNormalForm(benchmark::State& state) {
+    const auto grammar = parseGrammar(expressionGrammar(state.range(0)));
+    for (auto _ : state) {
+        auto copy = grammar;
+        copy.toChomskyNormalForm();
+        benchmark::DoNotOptimize(copy);
+    }
+}
+BENCHMARK(BM_ChomskyNormalForm)->RangeMultiplier(2)->Range(2, 32);
+
+static void BM_ChomskyNormalFormCLike(benchmark::State& state) {
+    const auto grammar = parseGrammar(cLikeGrammar());
+    for (auto _ : state) {
+        auto copy = grammar;
+        copy.toChomskyNormalForm();
+        benchmark::DoNotOptimize(copy);
+    }
+}
+BENCHMARK(BM_ChomskyNormalFormCLike);
+
+static void BM_CYKExpression(benchmark::State& state) {
+    auto grammar = parseGrammar(expressionGrammar(4));
+    grammar.toChomskyNormalForm();
+    const auto input = expressionInput(4, state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(grammar.cykParse(input));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * countTokens(input)));
+}
+BENCHMARK(BM_CYKExpression)->RangeMultiplier(2)->Range(8, 128);
+
+static void BM_CYKCLike(benchmark::State& state) {
+    auto grammar = parseGrammar(cLikeGrammar());
+    grammar.toChomskyNormalForm();
+    const auto input = cLikeInput(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(grammar.cykParse(input));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * countTokens(input)));
+}
+BENCHMARK(BM_CYKCLike)->RangeMultiplier(2)->Range(1, 8);
+
+static void BM_WeightedCYKExpression(benchmark::State& state) {
+    auto grammar = parseGrammar(expressionGrammar(4));
+    grammar.toChomskyNormalForm();
+    const auto input = expressionInput(4, state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(grammar.weightedCYKParse(input));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * countTokens(input)));
+}
+BENCHMARK(BM_WeightedCYKExpression)->RangeMultiplier(2)->Range(8, 128);
+
+static void BM_EarleyExpression(benchmark::State& state) {
+    const auto grammar = parseGrammar(expressionGrammar(4));
+    const auto input = expressionInput(4, state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(grammar.earleyParse(input));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * countTokens(input)));
+}
+BENCHMARK(BM_EarleyExpression)->RangeMultiplier(4)->Range(16, 4096);
+
+static void BM_EarleyCLike(benchmark::State& state) {
+    const auto grammar = parseGrammar(cLikeGrammar());
+    const auto input = cLikeInput(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(grammar.earleyParse(input));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * countTokens(input)));
+}
+BENCHMARK(BM_EarleyCLike)->RangeMultiplier(4)->Range(4, 1024);
@@ -0,0 +1,322 @@
+#include "re.h"
+#include "re_matcher.h"
+#include "lexer.h"
+#include "grammars.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+static void BM_RegexParse(benchmark::State& state) {
+    const auto pattern = keywordsRegex(state.range(0));
+    for (auto _ : state) {
+        RegularExpression regex;
+        benchmark::DoNotOptimize(regex.parse(pattern));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * pattern.size()));
+}
+BENCHMARK(BM_RegexParse)->RangeMultiplier(4)->Range(4, 1024);
+
+static void BM_RegexParseNested(benchmark::State& state) {
+    string pattern;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        pattern += "a|(";
+    }
+    pattern += "b" + string(state.range(0), ')');
+    for (auto _ : state) {
+        RegularExpression regex;
+        benchmark::DoNotOptimize(regex.parse(pattern));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * pattern.size()));
+}
+BENCHMARK(BM_RegexParseNested)->RangeMultiplier(4)->Range(16, 4096);
+
+static void BM_RegexToNFA(benchmark::State& state) {
+    const RegularExpression regex(keywordsRegex(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(regex.toNFA());
+    }
+}
+BENCHMARK(BM_RegexToNFA)->RangeMultiplier(4)->Range(4, 1024);
+
+static void BM_RegexToFlatNFA(benchmark::State& state) {
+    const RegularExpression regex(keywordsRegex(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(regex.toFlatNFA());
+    }
+}
+BENCHMARK(BM_RegexToFlatNFA)->RangeMultiplier(4)->Range(4, 1024);
+
+/**
+ * range(0) is the size of the pattern, range(1) is 0 for the keywords and 1 for the exponential blowup.
+ */
+static string benchmarkPattern(const benchmark::State& state) {
+    return state.range(1) == 0 ? keywordsRegex(state.range(0)) : exponentialRegex(state.range(0));
+}
+
+static void BM_NFAToDFA(benchmark::State& state) {
+    const RegularExpression regex(benchmarkPattern(state));
+    const auto nfa = regex.toNFA();
+    size_t numStates = 0;
+    for (auto _ : state) {
+        const auto dfa = RegularExpression::toDFA(nfa);
+        numStates = RegularExpression::toDFAGraph(dfa).size();
+    }
+    state.counters["states"] = static_cast<double>(numStates);
+}
+BENCHMARK(BM_NFAToDFA)->ArgsProduct({{4, 16, 64, 256}, {0}})->ArgsProduct({{4, 6, 8, 10}, {1}});
+
+static void BM_FlatNFAToFlatDFA(benchmark::State& state) {
+    const RegularExpression regex(benchmarkPattern(state));
+    const auto nfa = regex.toFlatNFA();
+    size_t numStates = 0;
+    for (auto _ : state) {
+        numStates = RegularExpression::toFlatDFA(nfa).size();
+    }
+    state.counters["states"] = static_cast<double>(numStates);
+}
+BENCHMARK(BM_FlatNFAToFlatDFA)->ArgsProduct({{4, 16, 64, 256, 1024}, {0}})->ArgsProduct({{4, 6, 8, 10, 12}, {1}});
+
+static void BM_RegexToByteDFA(benchmark::State& state) {
+    const RegularExpression regex(benchmarkPattern(state));
+    size_t numStates = 0;
+    for (auto _ : state) {
+        numStates = RegularExpression::toFlatDFA(regex.toByteNFA()).size();
+    }
+    state.counters["states"] = static_cast<double>(numStates);
+}
+BENCHMARK(BM_RegexToByteDFA)->ArgsProduct({{4, 16, 64, 256, 1024}, {0}})->ArgsProduct({{4, 6, 8, 10, 12}, {1}});
+
+static void BM_RegexToFollowPosDFA(benchmark::State& state) {
+    const RegularExpression regex(benchmarkPattern(state));
+    size_t numStates = 0;
+    for (auto _ : state) {
+        numStates = RegularExpression::toFlatDFA(regex.toGlushkovNFA()).size();
+    }
+    state.counters["states"] = static_cast<double>(numStates);
+}
+BENCHMARK(BM_RegexToFollowPosDFA)->ArgsProduct({{4, 16, 64, 256, 1024}, {0}})->ArgsProduct({{4, 6, 8, 10, 12}, {1}});
+
+static void BM_DFAToMinDFA(benchmark::State& state) {
+    const RegularExpression regex(benchmarkPattern(state));
+    const auto dfa = RegularExpression::toDFA(regex.toNFA());
+    size_t numStates = 0;
+    for (auto _ : state) {
+        const auto minDfa = RegularExpression::toMinDFA(dfa);
+        numStates = RegularExpression::toDFAGraph(minDfa).size();
+    }
+    state.counters["states"] = static_cast<double>(numStates);
+}
+BENCHMARK(BM_DFAToMinDFA)->ArgsProduct({{4, 16, 64, 256}, {0}})->ArgsProduct({{4, 6, 8, 10}, {1}});
+
+static void BM_FlatDFAToMinFlatDFA(benchmark::State& state) {
+    const RegularExpression regex(benchmarkPattern(state));
+    const auto dfa = RegularExpression::toFlatDFA(regex.toFlatNFA());
+    size_t numStates = 0;
+    for (auto _ : state) {
+        numStates = RegularExpression::toMinFlatDFA(dfa).size();
+    }
+    state.counters["states"] = static_cast<double>(numStates);
+}
+BENCHMARK(BM_FlatDFAToMinFlatDFA)->ArgsProduct({{4, 16, 64, 256, 1024}, {0}})->ArgsProduct({{4, 6, 8, 10, 12, 14}, {1}});
+
+static void BM_FlatDFAEquivalence(benchmark::State& state) {
+    const RegularExpression regex(benchmarkPattern(state));
+    const auto dfa = RegularExpression::toFlatDFA(regex.toGlushkovNFA());
+    const auto minDFA = RegularExpression::toMinFlatDFA(dfa);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(RegularExpression::isEquivalentFlatDFA(dfa, minDFA));
+    }
+    state.counters["states"] = static_cast<double>(dfa.size());
+}
+BENCHMARK(BM_FlatDFAEquivalence)->ArgsProduct({{4, 16, 64, 256, 1024}, {0}})->ArgsProduct({{4, 8, 12}, {1}});
+
+static void BM_RegexPipeline(benchmark::State& state) {
+    const auto pattern = benchmarkPattern(state);
+    for (auto _ : state) {
+        const RegularExpression regex(pattern);
+        benchmark::DoNotOptimize(RegularExpression::toMinDFA(RegularExpression::toDFA(regex.toNFA())));
+    }
+}
+BENCHMARK(BM_RegexPipeline)->ArgsProduct({{4, 16, 64}, {0}})->ArgsProduct({{4, 8}, {1}});
+
+static vector<string_view> splitLines(const string& text) {
+    vector<string_view> lines;
+    size_t last = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\n') {
+            lines.emplace_back(text.data() + last, i - last);
+            last = i + 1;
+        }
+    }
+    return lines;
+}
+
+static void BM_DFAMatcherBuild(benchmark::State& state) {
+    const RegularExpression regex(keywordsRegex(state.range(0)));
+    size_t numStates = 0;
+    for (auto _ : state) {
+        numStates = DFAMatcher(regex).numStates();
+    }
+    state.counters["states"] = static_cast<double>(numStates);
+}
+BENCHMARK(BM_DFAMatcherBuild)->RangeMultiplier(4)->Range(4, 256);
+
+static void BM_RegexCacheGet(benchmark::State& state) {
+    vector<string> patterns;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        patterns.push_back(keywordsRegex(4) + "|x" + to_string(i));
+    }
+    RegexCache cache(static_cast<size_t>(state.range(0)));
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.get(patterns[i++ % patterns.size()]));
+    }
+    state.counters["misses"] = static_cast<double>(cache.numMisses());
+}
+BENCHMARK(BM_RegexCacheGet)->Arg(16)->Arg(256);
+
+/**
+ * Search each line of the log for the first match, range(0) is the size of the log in KB.
+ */
+static void BM_DFAMatcherFindLines(benchmark::State& state) {
+    const auto text = logText(state.range(0) * 1024);
+    const auto lines = splitLines(text);
+    const DFAMatcher matcher("error (a|b|c|d|e)+");
+    size_t numMatches = 0;
+    for (auto _ : state) {
+        numMatches = 0;
+        for (const auto line : lines) {
+            numMatches += matcher.find(line).has_value();
+        }
+    }
+    state.counters["matches"] = static_cast<double>(numMatches);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_DFAMatcherFindLines)->Arg(64)->Arg(1024);
+
+static void BM_DFAMatcherLongestPrefix(benchmark::State& state) {
+    const auto text = logText(state.range(0) * 1024);
+    const DFAMatcher matcher("((0|1|2|3|4|5|6|7|8|9|-| |\n)*(a|b|c|d|e|f|g|h|i|j|k|l|m|n|o|p|q|r|s|t|u|v|w|x|y|z)*)*");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(matcher.longestPrefix(text));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_DFAMatcherLongestPrefix)->Arg(64)->Arg(1024);
+
+static void BM_LazyDFAMatcherFindLines(benchmark::State& state) {
+    const auto text = logText(state.range(0) * 1024);
+    const auto lines = splitLines(text);
+    LazyDFAMatcher matcher("error (a|b|c|d|e)+");
+    size_t numMatches = 0;
+    for (auto _ : state) {
+        numMatches = 0;
+        for (const auto line : lines) {
+            numMatches += matcher.find(line).has_value();
+        }
+    }
+    state.counters["matches"] = static_cast<double>(numMatches);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_LazyDFAMatcherFindLines)->Arg(64)->Arg(1024);
+
+static void BM_FindLiteral(benchmark::State& state) {
+    const auto text = logText(state.range(0) * 1024);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(findLiteral(text, "error fatal"));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_FindLiteral)->Arg(64)->Arg(1024);
+
+static void BM_StringViewFind(benchmark::State& state) {
+    const auto text = logText(state.range(0) * 1024);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(string_view(text).find("error fatal"));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_StringViewFind)->Arg(64)->Arg(1024);
+
+/**
+ * The full DFA of (a|b)*a(a|b)^(n-1) has 2^n states, range(0) is n.
+ */
+static void BM_LazyDFAMatcherExponential(benchmark::State& state) {
+    string pattern = "(a|b)*a";
+    for (int64_t i = 1; i < state.range(0); ++i) {
+        pattern += "(a|b)";
+    }
+    mt19937 rng(42);
+    string text(64 * 1024, 'a');
+    for (auto& ch : text) {
+        ch = rng() % 2 ? 'a' : 'b';
+    }
+    LazyDFAMatcher matcher(pattern);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(matcher.match(text));
+    }
+    state.counters["flushes"] = static_cast<double>(matcher.numFlushes());
+    state.counters["fallbacks"] = static_cast<double>(matcher.numFallbacks());
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_LazyDFAMatcherExponential)->Arg(8)->Arg(16)->Arg(24);
+
+static void BM_BitParallelMatcherFindLines(benchmark::State& state) {
+    const auto text = logText(state.range(0) * 1024);
+    const auto lines = splitLines(text);
+    const BitParallelMatcher matcher("error (a|b|c|d|e)+");
+    size_t numMatches = 0;
+    for (auto _ : state) {
+        numMatches = 0;
+        for (const auto line : lines) {
+            numMatches += matcher.find(line).has_value();
+        }
+    }
+    state.counters["matches"] = static_cast<double>(numMatches);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_BitParallelMatcherFindLines)->Arg(64)->Arg(1024);
+
+/**
+ * Match the longest prefix of a random text with a pattern of range(0) positions, which needs range(0) / 64 words.
+ */
+static void BM_BitParallelMatcherLongestPrefix(benchmark::State& state) {
+    string pattern = "(a|b)*";
+    for (int64_t i = 2; i < state.range(0); i += 2) {
+        pattern += "(a|b)";
+    }
+    mt19937 rng(42);
+    string text(64 * 1024, 'a');
+    for (auto& ch : text) {
+        ch = rng() % 2 ? 'a' : 'b';
+    }
+    const BitParallelMatcher matcher(pattern);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(matcher.longestPrefix(text));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_BitParallelMatcherLongestPrefix)->Arg(16)->Arg(64)->Arg(128)->Arg(256);
+
+static void BM_LexerTokenize(benchmark::State& state) {
+    const auto text = logText(state.range(0) * 1024);
+    const string letter = "(a|b|c|d|e|f|g|h|i|j|k|l|m|n|o|p|q|r|s|t|u|v|w|x|y|z)";
+    const string digit = "(0|1|2|3|4|5|6|7|8|9)";
+    const Lexer lexer({
+        {"error", "error"},
+        {"word", letter + "+"},
+        {"date", digit + digit + digit + digit + "-" + digit + digit + "-" + digit + digit},
+        {"number", digit + "+"},
+        {"ws", "( |\n)+", true},
+    });
+    size_t numTokens = 0;
+    for (auto _ : state) {
+        numTokens = lexer.tokenize(text).tokens.size();
+    }
+    state.counters["tokens"] = static_cast<double>(numTokens);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_LexerTokenize)->Arg(64)->Arg(1024);
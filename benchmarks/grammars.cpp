@@ -0,0 +1,183 @@
+#include "grammars.h"
+#include <random>
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+static string expressionOperator(const size_t level) {
+    static const vector<string> OPERATORS = {"or", "and", "==", "<", "+", "*", "^", "."};
+    if (level < OPERATORS.size()) {
+        return OPERATORS[level];
+    }
+    return "op" + to_string(level);
+}
+
+string expressionGrammar(const size_t levels) {
+    string grammar;
+    for (size_t i = 0; i < levels; ++i) {
+        const auto head = "E" + to_string(i);
+        const auto next = "E" + to_string(i + 1);
+        grammar += head + " -> " + head + " " + expressionOperator(i) + " " + next + " | " + next + "\n";
+    }
+    grammar += "E" + to_string(levels) + " -> ( E0 ) | id\n";
+    return grammar;
+}
+
+string expressionInput(const size_t levels, const size_t n, const unsigned seed) {
+    mt19937 rng(seed);
+    uniform_int_distribution<size_t> level(0, levels - 1);
+    uniform_int_distribution<int> percent(0, 99);
+    string input = "id";
+    size_t count = 1;
+    while (count < n) {
+        input += " " + expressionOperator(level(rng));
+        if (percent(rng) < 20) {
+            input += " ( id " + expressionOperator(level(rng)) + " id )";
+            count += 6;
+        } else {
+            input += " id";
+            count += 2;
+        }
+    }
+    return input;
+}
+
+string randomGrammar(const size_t n, const unsigned seed) {
+    mt19937 rng(seed);
+    const size_t numTerminals = n / 2 + 2;
+    uniform_int_distribution<size_t> nonTerminal(0, n - 1);
+    uniform_int_distribution<size_t> terminal(0, numTerminals - 1);
+    uniform_int_distribution<size_t> count(1, 4);
+    uniform_int_distribution<int> percent(0, 99);
+    auto randomTerminal = [&] { return "t" + to_string(terminal(rng)); };
+    auto randomNonTerminal = [&] { return "N" + to_string(nonTerminal(rng)); };
+
+    string grammar;
+    for (size_t i = 0; i < n; ++i) {
+        grammar += "N" + to_string(i) + " -> " + randomTerminal();
+        if (percent(rng) < 50) {
+            grammar += " " + randomTerminal();
+        }
+        const auto numProductions = count(rng) - 1;
+        for (size_t j = 0; j < numProductions; ++j) {
+            grammar += " |";
+            const auto length = count(rng);
+            for (size_t k = 0; k < length; ++k) {
+                grammar += " " + (percent(rng) < 60 ? randomNonTerminal() : randomTerminal());
+            }
+        }
+        grammar += "\n";
+    }
+    return grammar;
+}
+
+string cLikeGrammar() {
+    return R"(
+Program -> StmtList
+StmtList -> StmtList Stmt | Stmt
+Stmt -> Type id ; | Type id = Expr ; | id = Expr ; | Call ;
+      | if ( Expr ) Stmt | if ( Expr ) Stmt else Stmt
+      | while ( Expr ) Stmt | return Expr ; | { StmtList } | { }
+Type -> int | float | char
+Expr -> Expr or And | And
+And -> And and Eq | Eq
+Eq -> Eq == Rel | Eq != Rel | Rel
+Rel -> Rel < Add | Rel > Add | Add
+Add -> Add + Mul | Add - Mul | Mul
+Mul -> Mul * Unary | Mul / Unary | Unary
+Unary -> ! Unary | - Unary | Primary
+Primary -> id | num | ( Expr ) | Call
+Call -> id ( Args ) | id ( )
+Args -> Args , Expr | Expr
+)";
+}
+
+string cLikeInput(const size_t n, const unsigned seed) {
+    mt19937 rng(seed);
+    uniform_int_distribution<int> percent(0, 99);
+    auto expression = [&] {
+        static const vector<string> EXPRESSIONS = {
+            "id", "num", "id + num", "id * ( id - num )", "! id and id < num", "id ( id , num + id )", "- id / num == id",
+        };
+        return EXPRESSIONS[percent(rng) % EXPRESSIONS.size()];
+    };
+    function<string(size_t)> statement = [&](const size_t depth) -> string {
+        const auto choice = depth >= 3 ? percent(rng) % 50 : percent(rng);
+        if (choice < 15) {
+            return "int id = " + expression() + " ;";
+        }
+        if (choice < 35) {
+            return "id = " + expression() + " ;";
+        }
+        if (choice < 45) {
+            return "id ( " + expression() + " ) ;";
+        }
+        if (choice < 50) {
+            return "return " + expression() + " ;";
+        }
+        if (choice < 65) {
+            return "if ( " + expression() + " ) " + statement(depth + 1);
+        }
+        if (choice < 75) {
+            return "if ( " + expression() + " ) " + statement(depth + 1) + " else " + statement(depth + 1);
+        }
+        if (choice < 85) {
+            return "while ( " + expression() + " ) " + statement(depth + 1);
+        }
+        return "{ " + statement(depth + 1) + " " + statement(depth + 1) + " }";
+    };
+    string input;
+    for (size_t i = 0; i < n; ++i) {
+        input += statement(0) + " ";
+    }
+    return input;
+}
+
+string keywordsRegex(const size_t n) {
+    string regex = "(";
+    for (size_t i = 0; i < n; ++i) {
+        if (i > 0) {
+            regex += "|";
+        }
+        // Distinct words sharing prefixes, e.g. "ba", "bb", ..., "bab".
+        auto value = i + 26;
+        string word;
+        while (value > 0) {
+            word += static_cast<char>('a' + value % 26);
+            value /= 26;
+        }
+        regex += word;
+    }
+    return regex + ")";
+}
+
+string exponentialRegex(const size_t n) {
+    string regex = "(a|b)*a";
+    for (size_t i = 1; i < n; ++i) {
+        regex += "(a|b)";
+    }
+    return regex;
+}
+
+string logText(const size_t n, const size_t every, const unsigned seed) {
+    mt19937 rng(seed);
+    string text;
+    text.reserve(n + 128);
+    for (size_t line = 0; text.size() < n; ++line) {
+        text += "2024-01-" + to_string(10 + rng() % 20) + " " + to_string(rng() % 100000);
+        for (size_t i = 0; i < 8; ++i) {
+            text += ' ';
+            if (i == 4 && line % every == every - 1) {
+                text += "error";
+                continue;
+            }
+            const auto length = 3 + rng() % 6;
+            for (size_t j = 0; j < length; ++j) {
+                text += static_cast<char>('a' + rng() % 26);
+            }
+        }
+        text += '\n';
+    }
+    return text;
+}
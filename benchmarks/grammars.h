@@ -0,0 +1,50 @@
+#ifndef PARSING_TOYS_BENCHMARK_GRAMMARS_H
+#define PARSING_TOYS_BENCHMARK_GRAMMARS_H
+
+#include <string>
+#include <cstddef>
+
+/**
+ * An expression grammar with the given levels of precedence, E0 has the lowest precedence:
+ * Ei -> Ei opi Ei+1 | Ei+1, and the last level is the parenthesized expression or an identifier.
+ */
+std::string expressionGrammar(std::size_t levels);
+
+/**
+ * A random expression of the expression grammar with about n tokens.
+ */
+std::string expressionInput(std::size_t levels, std::size_t n, unsigned seed = 42);
+
+/**
+ * A random grammar with n non-terminals, each with up to 4 productions of up to 4 symbols.
+ * The first alternative of each non-terminal always terminates, so every non-terminal is productive.
+ */
+std::string randomGrammar(std::size_t n, unsigned seed = 42);
+
+/**
+ * A small C-like language with declarations, assignments, control flows and expressions.
+ */
+std::string cLikeGrammar();
+
+/**
+ * A C-like program with n statements.
+ */
+std::string cLikeInput(std::size_t n, unsigned seed = 42);
+
+/**
+ * A regular expression with n alternatives of words sharing prefixes, e.g. (ba|bb|...|bab).
+ */
+std::string keywordsRegex(std::size_t n);
+
+/**
+ * The classic (a|b)*a(a|b)...(a|b) with n - 1 trailing (a|b), whose DFA has 2^n states.
+ */
+std::string exponentialRegex(std::size_t n);
+
+/**
+ * Log-like lines of random lowercase words and numbers with about n bytes in total,
+ * where one line in every `every` lines contains the word "error".
+ */
+std::string logText(std::size_t n, std::size_t every = 100, unsigned seed = 42);
+
+#endif //PARSING_TOYS_BENCHMARK_GRAMMARS_H
@@ -32,6 +32,10 @@ public:
     FiniteAutomatonNode& nodeAt(std::size_t i);
     [[nodiscard]] std::string newNodeLabel(const std::string& prefix = "I") const;
     std::size_t addNode(const FiniteAutomatonNode& node);
+    /**
+     * Add a node whose key is already known, which should be the sorted kernel and non-kernel items.
+     */
+    std::size_t addNode(FiniteAutomatonNode node, const std::string& key);
     std::size_t addEdge(const FiniteAutomatonEdge& edge);
     std::size_t addEdge(std::size_t u, std::size_t v, const std::string& label);
 
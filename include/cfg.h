@@ -2,18 +2,37 @@
 #define PARSING_TOYS_CFG_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iostream>
 #include <unordered_map>
 #include <unordered_set>
 #include <memory>
+#include <functional>
+#include <cstdint>
 
 using Symbol = std::string;
 using Production = std::vector<std::string>;
 using Productions = std::vector<Production>;
 
 class FiniteAutomaton;
+struct FiniteAutomatonNode;
 class ContextFreeGrammar;
+struct LRStateExpansion;
+struct LRStateCache;
+struct ChomskyNormalForm;
+struct EarleyGrammar;
+class ParseForest;
+
+/**
+ * The algorithms that build LR automata and ACTION/GOTO tables.
+ */
+enum class LRAlgorithm {
+    LR0,
+    SLR1,
+    LR1,
+    LALR1,
+};
 
 /**
  * Tokenized results.
@@ -31,6 +50,26 @@ struct ContextFreeGrammarToken {
     bool operator==(const ContextFreeGrammarToken& other) const;
 };
 
+/**
+ * A token whose symbol points into the tokenized string, which should outlive it.
+ */
+struct ContextFreeGrammarTokenView {
+    ContextFreeGrammarToken::Type type;
+    std::string_view symbol;
+    std::size_t line, column;
+};
+
+/**
+ * The productions from a head to the next head in a grammar text.
+ */
+struct ContextFreeGrammarRule {
+    Symbol head;
+    std::size_t line;  // The line of the head
+    bool startsLine;  // Whether the head is the first token of its line
+    Productions productions;
+    std::vector<std::pair<std::size_t, double>> weights;  // The indices of the weighted productions and their weights
+};
+
 struct FirstAndFollowSet {
     std::vector<Symbol> ordering;
     std::unordered_map<Symbol, std::unordered_set<Symbol>> first;
@@ -86,6 +125,10 @@ struct ActionGotoTable {
     [[nodiscard]] std::string toString(size_t index, const Symbol& symbol, const std::string& separator = " / ") const;
 
     [[nodiscard]] LRParsingSteps parse(const std::string& s);
+    /**
+     * Parse the terminals directly, e.g. the terminals of the tokens from a Lexer.
+     */
+    [[nodiscard]] LRParsingSteps parse(const std::vector<Symbol>& tokens);
 
     /** For unit tests only. */
     [[nodiscard]] std::string toString(const ContextFreeGrammar& grammar, const std::string& separator = " / ") const;
@@ -118,6 +161,10 @@ struct MTable {
     [[nodiscard]] Symbol getTerminal(std::size_t index) const;
 
     [[nodiscard]] LLParsingSteps parse(const std::string& s);
+    /**
+     * Parse the terminals directly, e.g. the terminals of the tokens from a Lexer.
+     */
+    [[nodiscard]] LLParsingSteps parse(const std::vector<Symbol>& tokens);
     [[nodiscard]] std::string toString(const std::string& separator = " / ") const;
 };
 
@@ -125,6 +172,7 @@ struct CYKTable {
     std::size_t n = 0;
     std::vector<std::vector<std::vector<Symbol>>> table;
     std::shared_ptr<ParseTreeNode> parseTree = nullptr;
+    std::shared_ptr<ParseForest> forest = nullptr;
     bool accepted = false;
 
     explicit CYKTable(std::size_t size);
@@ -133,6 +181,60 @@ struct CYKTable {
     [[nodiscard]] std::string getCellString(std::size_t r, std::size_t c, const std::string& separator = ", ") const;
 };
 
+/**
+ * The chart of the probabilistic CYK algorithm.
+ * Each cell stores a dense vector of log probabilities indexed by the non-terminals,
+ * the cell [r][c] covers the tokens from r to c.
+ */
+struct WeightedCYKTable {
+    std::size_t n = 0;
+    std::vector<Symbol> nonTerminals;
+    std::unordered_map<Symbol, std::size_t> nonTerminalIndex;
+    std::vector<double> viterbi;  // The best log probability of each (cell, non-terminal)
+    std::vector<double> inside;   // The total log probability of each (cell, non-terminal)
+    std::shared_ptr<ParseTreeNode> parseTree = nullptr;  // The Viterbi parse
+    double logProbability;        // The log probability of the Viterbi parse
+    double insideLogProbability;  // The log probability of the input summed over all parses
+    bool accepted = false;
+
+    WeightedCYKTable(std::size_t size, std::vector<Symbol> symbols);
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] double getViterbi(std::size_t r, std::size_t c, const Symbol& symbol) const;
+    [[nodiscard]] double getInside(std::size_t r, std::size_t c, const Symbol& symbol) const;
+};
+
+/**
+ * An Earley item. The fields after the origin record how the item is derived,
+ * which is enough to rebuild the parse tree without searching the chart.
+ */
+struct EarleyItem {
+    enum class Link : std::uint8_t {
+        PREDICT,
+        SCAN,      // prefix: the item in the previous set
+        COMPLETE,  // prefix: the item in the origin set of child; child: the completed item in the same set
+        NULLABLE,  // prefix: the item in the same set; child: the nullable non-terminal (Aycock-Horspool)
+        LEO,       // child: the completed item that triggers the deterministic reduction path
+    };
+    std::uint32_t rule;    // The dotted rule index
+    std::uint32_t origin;  // The index of the set where the rule is predicted
+    std::uint32_t prefix = 0;
+    std::uint32_t child = 0;
+    Link link = Link::PREDICT;
+};
+
+struct EarleyChart {
+    std::size_t n = 0;
+    std::vector<std::vector<EarleyItem>> sets;
+    std::shared_ptr<const EarleyGrammar> grammar = nullptr;
+    std::shared_ptr<ParseTreeNode> parseTree = nullptr;
+    std::shared_ptr<ParseForest> forest = nullptr;
+    bool accepted = false;
+
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::size_t numItems() const;
+    [[nodiscard]] std::vector<std::string> getSet(std::size_t index) const;
+};
+
 class ContextFreeGrammar {
 public:
     ContextFreeGrammar() = default;
@@ -149,13 +251,30 @@ public:
      * @return Tokens
      */
     static std::vector<ContextFreeGrammarToken> tokenize(const std::string& s);
+    /**
+     * Tokenize without copying the symbols, in a single pass over the grapheme clusters.
+     * The symbols of ε point to EMPTY_SYMBOL.
+     */
+    static std::vector<ContextFreeGrammarTokenView> tokenizeViews(std::string_view s);
 
     /**
      * Tokenize and parse a context-free grammar.
+     *
+     * Each rule is a head, "->" and alternatives separated by "|", e.g. "S -> A B | ε".
+     * The last symbol of an alternative with other symbols is its weight if it is a decimal number in square brackets,
+     * e.g. "S -> A B [0.8] | a [0.2]". A weight should be a non-negative finite number, so "[-1]" and "[1e400]" are errors,
+     * while the symbols like "[x]" and "[nan]" that are not numbers are terminals.
+     *
      * @param s A string representing a context-free grammar.
      * @return
      */
     bool parse(const std::string& s);
+    /**
+     * Parse a grammar file, which is mapped into memory and tokenized in place where mmap is available.
+     * @param path The path of the file.
+     * @return
+     */
+    bool parseFile(const std::string& path);
 
     /**
      * TPossible error messages during parsing.
@@ -174,6 +293,12 @@ public:
      * @return Formatted string.
      */
     [[nodiscard]] std::string toSortedString() const;
+    /**
+     * A hash of the heads and their productions in order, the terminals and the weights,
+     * which does not depend on the iteration orders of the hash maps, so it is the same in every run.
+     * @return FNV-1a hash of the serialized grammar.
+     */
+    [[nodiscard]] std::uint64_t fingerprint() const;
 
     /**
      * Find all terminals in the existing productions.
@@ -227,6 +352,17 @@ public:
 
     ContextFreeGrammar operator|(const ContextFreeGrammar& other) const;
 
+    /**
+     * Production weights are written as a trailing "[w]" of an alternative, e.g. "S -> A B [0.8] | a [0.2]".
+     * @return Whether any production has an explicit weight.
+     */
+    [[nodiscard]] bool hasWeights() const;
+    /**
+     * @return The weight of the production, 1 if it is not specified.
+     */
+    [[nodiscard]] double weightOf(const Symbol& head, const Production& production) const;
+    void setWeight(const Symbol& head, const Production& production, double weight);
+
     /**
      * Find and group the longest common prefixes.
      *
@@ -253,6 +389,20 @@ public:
      * @return First and follow sets.
      */
     [[nodiscard]] FirstAndFollowSet computeFirstAndFollowSet() const;
+    /**
+     * Update the FIRST and FOLLOW sets of a previous version of the grammar.
+     * Only the FIRST sets of the heads that use the changed heads are computed again,
+     * and only the FOLLOW sets that may receive different symbols.
+     *
+     * @param previousGrammar The previous version of the grammar.
+     * @param previous The FIRST and FOLLOW sets of the previous version.
+     * @return The same sets as computeFirstAndFollowSet().
+     */
+    [[nodiscard]] FirstAndFollowSet updateFirstAndFollowSet(const ContextFreeGrammar& previousGrammar, const FirstAndFollowSet& previous) const;
+    /**
+     * @return The heads whose productions are different in the two grammars, including the heads in only one of them.
+     */
+    [[nodiscard]] std::unordered_set<Symbol> changedHeads(const ContextFreeGrammar& other) const;
 
     /**
      * Compute the closure of an item set. The closure adds all items for non-terminals that can be expanded next.
@@ -329,6 +479,23 @@ public:
      */
     [[nodiscard]] ActionGotoTable computeLALR1ActionGotoTable(const std::unique_ptr<FiniteAutomaton>& automaton) const;
 
+    /**
+     * Compute the automaton of an LR algorithm with a pool of threads. The threads expand the states concurrently,
+     * and the states are numbered in the BFS order at the end, so the automaton is the same as the sequential one.
+     *
+     * @param numThreads The number of threads, or 0 to use all the hardware threads.
+     * @return A deterministic finite automaton.
+     */
+    std::unique_ptr<FiniteAutomaton> computeLRAutomaton(LRAlgorithm algorithm, std::size_t numThreads);
+    /**
+     * Compute the ACTION/GOTO table of an LR algorithm with a pool of threads, where each thread fills chunks of rows.
+     * The table is the same as the sequential one.
+     *
+     * @param automaton The automaton of the same algorithm.
+     * @param numThreads The number of threads, or 0 to use all the hardware threads.
+     */
+    [[nodiscard]] ActionGotoTable computeActionGotoTable(LRAlgorithm algorithm, const std::unique_ptr<FiniteAutomaton>& automaton, std::size_t numThreads) const;
+
     /**
      * Compute the LL(1) predictive parsing table.
      * For each production A -> α, add M[A, a] = α for all a in FIRST(α).
@@ -341,14 +508,307 @@ public:
     [[nodiscard]] bool isChomskyNormalForm() const;
     void toChomskyNormalForm();
 
-    [[nodiscard]] CYKTable cykParse(const std::string& s) const;
+    /**
+     * Convert a copy of the grammar to Chomsky normal form,
+     * and record how the new productions are derived from the original ones,
+     * so that the trees of the converted grammar can be mapped back without converting again.
+     *
+     * @return The converted grammar and the inverse mapping.
+     */
+    [[nodiscard]] ChomskyNormalForm compileChomskyNormalForm() const;
+
+    /**
+     * Parse with the CYK algorithm. The grammar should be in Chomsky normal form.
+     *
+     * @param s Input string (space-separated tokens).
+     * @param buildForest Whether to keep all the derivations in a shared packed parse forest.
+     * @return The CYK table.
+     */
+    [[nodiscard]] CYKTable cykParse(const std::string& s, bool buildForest = false) const;
+
+    /**
+     * Parse with the probabilistic CYK algorithm. The grammar should be in Chomsky normal form,
+     * and the weights of the productions are treated as probabilities.
+     *
+     * @param s Input string (space-separated tokens).
+     * @return The Viterbi and inside log probabilities of all the cells, and the most probable parse tree.
+     */
+    [[nodiscard]] WeightedCYKTable weightedCYKParse(const std::string& s) const;
+
+    /**
+     * Parse with the Earley algorithm, which works for any context-free grammar without conversion.
+     * Nullable non-terminals are handled with the Aycock-Horspool prediction,
+     * and right recursions are collapsed with Leo's deterministic reduction paths.
+     *
+     * @param s Input string (space-separated tokens).
+     * @param buildForest Whether to keep all the derivations in a shared packed parse forest.
+     *                    The deterministic reduction paths are not used in this mode.
+     * @return The item sets and the parse tree in terms of the original productions.
+     */
+    [[nodiscard]] EarleyChart earleyParse(const std::string& s, bool buildForest = false) const;
 
 private:
+    friend class IncrementalGrammar;
+    friend class IncrementalLRAutomaton;
+    friend class GrammarArtifactCache;
+
+    enum class ReduceLookahead {
+        ALL_TERMINALS,  // LR(0)
+        FOLLOW_SET,  // SLR(1)
+        ITEM,  // LR(1) and LALR(1), the lookaheads in the items
+    };
+
     std::string _errorMessage;
     std::vector<Symbol> _ordering;  // The output ordering
     std::unordered_map<Symbol, Productions> _productions;  // All the productions
     std::unordered_map<Symbol, std::unordered_set<std::string>> _productionKeys;  // Helper member for checking the existence of a production
     std::unordered_set<Symbol> _terminals;  // Helper member for checking the existence of terminals
+    std::unordered_map<std::string, double> _weights;  // Explicit production weights, indexed by the production keys with heads
+
+    /**
+     * Group the tokens into rules in the order of the text, without changing the grammar.
+     */
+    static bool parseRules(const std::vector<ContextFreeGrammarTokenView>& tokens, std::vector<ContextFreeGrammarRule>& rules, std::string& errorMessage);
+    /**
+     * Build the productions from the tokens, where the symbols are copied.
+     */
+    bool parseTokens(const std::vector<ContextFreeGrammarTokenView>& tokens);
+    void addRule(ContextFreeGrammarRule rule);
+    void pruneWeights();
+    /**
+     * The summed weight of a rewritten production, which is explicit if any of its sources is weighted.
+     */
+    struct WeightSum {
+        double weight = 0.0;
+        bool isExplicit = false;
+    };
+    /**
+     * Set the weight of a production, or remove it if it is implicitly 1.
+     * @param key The production key with the head.
+     */
+    void setSummedWeight(const std::string& key, const WeightSum& weightSum);
+    /**
+     * Append all the members except the error message, with the sets and the maps in lexical order.
+     */
+    void serialize(std::string& out) const;
+    /**
+     * Whether the two grammars have the same heads and productions in the same orders.
+     */
+    [[nodiscard]] bool hasSameOrder(const ContextFreeGrammar& other) const;
+    /**
+     * Read a grammar written by serialize() from the beginning of the input, and remove it from the input.
+     */
+    bool deserialize(std::string_view& in);
+
+    /**
+     * Build the canonical collection from the initial kernel with BFS. The closure and the transitions of a kernel
+     * are computed by the expansion function once, and are taken from the cache for the same kernel.
+     */
+    static std::unique_ptr<FiniteAutomaton> buildLRAutomaton(const ContextFreeGrammar& initialKernel, const std::function<void(const ContextFreeGrammar&, LRStateExpansion&)>& expand, LRStateCache& cache, std::size_t numThreads = 1);
+    /**
+     * The same as buildLRAutomaton(), where the expansion function is called from several threads at once.
+     */
+    static std::unique_ptr<FiniteAutomaton> buildLRAutomatonInParallel(const ContextFreeGrammar& initialKernel, const std::function<void(const ContextFreeGrammar&, LRStateExpansion&)>& expand, LRStateCache& cache, std::size_t numThreads);
+    std::unique_ptr<FiniteAutomaton> buildLR0Automaton(LRStateCache& cache, std::size_t numThreads = 1);
+    std::unique_ptr<FiniteAutomaton> buildLR1Automaton(const FirstAndFollowSet& firstFollow, LRStateCache& cache, std::size_t numThreads = 1);
+    std::unique_ptr<FiniteAutomaton> mergeLALR1Automaton(FiniteAutomaton& lr1Automaton) const;
+    /**
+     * Add the accept action or the reduce actions of a state to its row.
+     */
+    void addReduceActions(ActionGotoTable& table, std::size_t u, const FiniteAutomatonNode& node, ReduceLookahead lookahead, const FirstAndFollowSet* firstFollowSet = nullptr) const;
+    void convertToChomskyNormalForm(ChomskyNormalForm* mapping);
+};
+
+/**
+ * An original production that is shortened by removing nullable symbols during the conversion.
+ */
+struct ChomskyNormalFormDerivation {
+    Production production;
+    std::vector<bool> removed;  // Whether each symbol of the production is removed and derives ε
+};
+
+struct ChomskyNormalForm {
+    ContextFreeGrammar grammar;
+    Symbol originalStart;
+    Symbol newStart;  // Empty if the start symbol is not replaced
+    std::unordered_map<Symbol, Symbol> terminalWrappers;  // The new non-terminal -> the terminal it wraps
+    std::unordered_set<Symbol> binarizedSymbols;  // The new non-terminals that split the long productions
+    std::unordered_map<Symbol, Productions> binarizedProductions;  // The productions before eliminating ε and unit productions
+    std::unordered_map<Symbol, std::vector<std::vector<Symbol>>> unitChains;  // All the unit chains from each non-terminal in BFS order
+    std::unordered_map<std::string, ChomskyNormalFormDerivation> derivations;  // Indexed by the keys of the binarized productions with nullable symbols removed
+    std::unordered_map<Symbol, std::shared_ptr<ParseTreeNode>> emptyDerivations;  // The shallowest tree deriving ε for each nullable non-terminal
+
+    /**
+     * Parse with the converted grammar and restore the parse tree in terms of the original grammar.
+     * The cells of the table contain the symbols of the converted grammar.
+     */
+    [[nodiscard]] CYKTable cykParse(const std::string& s) const;
+
+    /**
+     * Expand the unit productions and the nullable symbols eliminated during the conversion,
+     * then remove the terminal wrappers and the binarized symbols.
+     */
+    [[nodiscard]] std::shared_ptr<ParseTreeNode> restoreParseTree(const std::shared_ptr<ParseTreeNode>& tree) const;
+};
+
+/**
+ * The closure and the transitions of an LR state, which are determined by its kernel.
+ */
+struct LRStateExpansion {
+    ContextFreeGrammar kernel;  // The orders of the closure and the transitions follow the item order of this kernel
+    ContextFreeGrammar nonKernel;
+    bool accept = false;
+    std::vector<std::pair<Symbol, ContextFreeGrammar>> transitions;  // The symbols after the dots and the kernels of the GOTO states
+    std::unordered_set<Symbol> dependencies;  // The symbols whose productions or FIRST sets are used in the closure
+    std::string nonKernelKey;  // The sorted string of the non-kernel items
+    std::vector<std::string> transitionKeys;  // The sorted strings of the kernels of the GOTO states
+    bool used = false;  // Whether it is used in the current build
+    std::size_t index = 0;  // The index of the node in the current build
+};
+
+struct LRStateCache {
+    std::unordered_map<std::string, LRStateExpansion> states;  // Indexed by the sorted strings of the kernels
+    std::vector<std::string> nodeKeys;  // The keys of the nodes in the current build
+    std::size_t numReused = 0;  // The number of states that are expanded in the previous builds
+};
+
+/**
+ * The LR automaton and the ACTION/GOTO table of a grammar that is changed repeatedly.
+ * The expansions of the states are kept by their kernels, and an update only expands the states again
+ * if their closures use a changed head or a changed FIRST set. The rows of the table are reused
+ * if the states, their edges and the lookaheads of their reductions are unchanged.
+ * The results are the same as computing them from scratch.
+ */
+class IncrementalLRAutomaton {
+public:
+    using Type = LRAlgorithm;
+
+    explicit IncrementalLRAutomaton(Type type);
+    ~IncrementalLRAutomaton();
+
+    /**
+     * Update the FIRST and FOLLOW sets, the automaton and the ACTION/GOTO table for a new version of the grammar.
+     */
+    void update(const ContextFreeGrammar& grammar);
+
+    [[nodiscard]] const FirstAndFollowSet& firstAndFollowSet() const;
+    [[nodiscard]] const std::unique_ptr<FiniteAutomaton>& automaton() const;
+    [[nodiscard]] const ActionGotoTable& actionGotoTable() const;
+    /** The number of states whose expansions are reused in the last update. */
+    [[nodiscard]] std::size_t numReusedStates() const;
+    /** The number of rows of the table that are reused in the last update. */
+    [[nodiscard]] std::size_t numReusedRows() const;
+
+private:
+    Type _type;
+    ContextFreeGrammar _grammar;
+    Symbol _primedSymbol;
+    FirstAndFollowSet _firstAndFollowSet;
+    LRStateCache _cache;
+    std::unique_ptr<FiniteAutomaton> _automaton;
+    std::vector<std::string> _nodeKeys;
+    ActionGotoTable _actionGotoTable;
+    std::size_t _numReusedRows = 0;
+
+    void updateActionGotoTable(const std::unique_ptr<FiniteAutomaton>& previousAutomaton, const std::unordered_set<Symbol>& changedFollowSets, const std::unordered_set<Symbol>& changedTerminals, bool terminalsChanged);
+};
+
+/**
+ * A directory of the FIRST/FOLLOW sets, the LR automata and the ACTION/GOTO tables computed before,
+ * e.g. shared by the jobs that run the same grammar. An artifact is keyed by the fingerprint of the grammar,
+ * the algorithm and the format version, and the serialized grammar is stored with it to rule out hash collisions.
+ * A missing or unreadable artifact is computed and written again. The files are written to temporary paths and
+ * renamed, so the processes that share the directory never read partial files.
+ */
+class GrammarArtifactCache {
+public:
+    /** Bumped whenever the serialized artifacts or the results of the algorithms that produce them change. */
+    static constexpr int FORMAT_VERSION = 1;
+
+    explicit GrammarArtifactCache(std::string directory);
+
+    [[nodiscard]] FirstAndFollowSet firstAndFollowSet(const ContextFreeGrammar& grammar);
+    [[nodiscard]] std::unique_ptr<FiniteAutomaton> automaton(const ContextFreeGrammar& grammar, LRAlgorithm algorithm);
+    /**
+     * The automaton is also taken from the cache if the table is missing.
+     */
+    [[nodiscard]] ActionGotoTable actionGotoTable(const ContextFreeGrammar& grammar, LRAlgorithm algorithm);
+
+    /**
+     * @param kind The name of the artifact, e.g. "lalr1-table".
+     * @return The path of the artifact of the grammar.
+     */
+    [[nodiscard]] std::string pathOf(const ContextFreeGrammar& grammar, const std::string& kind) const;
+    [[nodiscard]] const std::string& directory() const;
+    [[nodiscard]] std::size_t numHits() const;
+    [[nodiscard]] std::size_t numMisses() const;
+
+private:
+    std::string _directory;
+    std::size_t _numHits = 0;
+    std::size_t _numMisses = 0;
+
+    /**
+     * Read the content after the header, if the artifact exists and is written for the same grammar and version.
+     */
+    bool load(const ContextFreeGrammar& grammar, const std::string& kind, std::string& content);
+    void store(const ContextFreeGrammar& grammar, const std::string& kind, const std::string& content) const;
+    static std::string header(const ContextFreeGrammar& grammar, const std::string& kind);
+    static void writeAutomaton(std::string& out, FiniteAutomaton& automaton);
+    static bool readAutomaton(std::string_view& in, FiniteAutomaton& automaton);
+};
+
+/**
+ * A grammar text that is edited in place, e.g. in an editor that re-parses on every keystroke.
+ * The text is split into blocks of lines, where each block starts with a line whose first token is a head.
+ * An edit only re-tokenizes the blocks around it, then updates the productions of the heads in these blocks.
+ */
+class IncrementalGrammar {
+public:
+    IncrementalGrammar() = default;
+
+    /**
+     * Parse the whole text.
+     * @return False if the text has errors, and the grammar of the last successful parse is kept.
+     */
+    bool parse(std::string s);
+    bool parseFile(const std::string& path);
+
+    /**
+     * Replace a range of the text and re-parse the affected blocks.
+     * The whole text is parsed again if the last parse failed or the edit has errors,
+     * so the error messages are the same as parsing the whole text.
+     *
+     * @param offset The byte offset of the range.
+     * @param length The number of bytes in the range.
+     * @param replacement The new text of the range.
+     * @return False if the new text has errors or the range is out of the text.
+     */
+    bool edit(std::size_t offset, std::size_t length, std::string_view replacement);
+
+    [[nodiscard]] const std::string& text() const;
+    [[nodiscard]] const ContextFreeGrammar& grammar() const;
+    [[nodiscard]] const std::string& errorMessage() const;
+    [[nodiscard]] std::size_t numBlocks() const;
+
+private:
+    struct Block {
+        std::size_t begin;  // The byte offset of the first line
+        std::size_t line;  // The number of the first line
+        std::vector<ContextFreeGrammarRule> rules;
+    };
+
+    std::string _text;
+    std::string _errorMessage;
+    std::vector<Block> _blocks;
+    ContextFreeGrammar _grammar;
+    std::unordered_map<Symbol, std::size_t> _numRules;  // The number of rules of each head in all the blocks
+    std::unordered_map<Symbol, std::size_t> _symbolCounts;  // The number of occurrences in the productions for finding terminals
+    bool _parsed = false;  // Whether the blocks match the text
+
+    bool parseText();
+    bool parseBlocks(std::size_t begin, std::size_t end, std::size_t line, std::vector<Block>& blocks, std::size_t& numLineBreaks);
+    void updateHeads(const std::unordered_set<Symbol>& heads, std::size_t begin, std::size_t end, bool orderingChanged);
 };
 
 void PrintTo(const ContextFreeGrammarToken& token, std::ostream* os);
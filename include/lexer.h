@@ -0,0 +1,58 @@
+#ifndef PARSING_TOYS_LEXER_H
+#define PARSING_TOYS_LEXER_H
+
+#include "re_matcher.h"
+
+struct LexerRule {
+    std::string name;
+    std::string pattern;
+    bool skip = false;  // Whether the matched tokens are dropped, e.g. for whitespaces
+};
+
+struct LexerToken {
+    std::uint32_t rule = 0;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+
+    bool operator==(const LexerToken&) const = default;
+};
+
+struct LexerResult {
+    std::vector<LexerToken> tokens;
+    bool accepted = false;
+    std::size_t errorPosition = 0;  // The position where no rule matches if not accepted
+};
+
+/**
+ * Split byte strings into tokens with a list of named regular expressions.
+ *
+ * All the patterns are combined into one DFA, whose accepting states are labelled with the first rule they accept,
+ * and the DFA is minimized without merging the states of different rules.
+ * Each token is the longest match at its position, and the earlier rule wins if several rules match the same length.
+ */
+class Lexer {
+public:
+    Lexer() = default;
+    explicit Lexer(const std::vector<LexerRule>& rules);
+
+    /**
+     * @return The error of the rules, or an empty string if the lexer is built.
+     */
+    [[nodiscard]] const std::string& errorMessage() const;
+    [[nodiscard]] std::size_t numRules() const;
+    [[nodiscard]] const std::string& ruleName(std::size_t rule) const;
+    [[nodiscard]] std::size_t numStates() const;
+
+    [[nodiscard]] LexerResult tokenize(std::string_view text) const;
+    /**
+     * @return The names of the rules of the tokens, which are the terminals to parse.
+     */
+    [[nodiscard]] std::vector<std::string> terminals(const std::vector<LexerToken>& tokens) const;
+
+private:
+    std::string _errorMessage;
+    std::vector<LexerRule> _rules;
+    DenseDFA _dfa;
+};
+
+#endif //PARSING_TOYS_LEXER_H
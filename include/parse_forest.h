@@ -0,0 +1,124 @@
+#ifndef PARSING_TOYS_PARSE_FOREST_H
+#define PARSING_TOYS_PARSE_FOREST_H
+
+#include "cfg.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <limits>
+#include <unordered_map>
+
+struct ParseForestNode {
+    enum class Type {
+        TERMINAL,
+        SYMBOL,
+        INTERMEDIATE,  // A partially recognized production, inlined into its parent when extracting trees
+    };
+    Type type;
+    Symbol label;
+    std::size_t begin, end;
+    std::vector<std::size_t> packed;  // Each packed node is an alternative derivation of the span
+};
+
+struct ParseForestPackedNode {
+    std::vector<std::size_t> children;
+    double weight = 0.0;  // The score of this alternative, used for extracting the best trees
+};
+
+class ParseForestTreeStream;
+
+/**
+ * Shared packed parse forest (SPPF).
+ *
+ * Nodes with the same (type, label, begin, end) are shared,
+ * and alternative derivations of the same node are stored as packed nodes,
+ * so that all the parse trees of an ambiguous input are kept in polynomial space.
+ */
+class ParseForest {
+public:
+    static constexpr std::size_t NONE = std::numeric_limits<std::size_t>::max();
+
+    ParseForest() = default;
+    ~ParseForest() = default;
+
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::size_t numPackedNodes() const;
+    [[nodiscard]] const ParseForestNode& nodeAt(std::size_t i) const;
+    [[nodiscard]] const ParseForestPackedNode& packedNodeAt(std::size_t i) const;
+
+    /**
+     * Find or create a node.
+     * @return The index of the node.
+     */
+    std::size_t addNode(ParseForestNode::Type type, const Symbol& label, std::size_t begin, std::size_t end);
+    [[nodiscard]] std::size_t findNode(ParseForestNode::Type type, const Symbol& label, std::size_t begin, std::size_t end) const;
+
+    /**
+     * Add an alternative derivation to a node. Duplicated alternatives are ignored.
+     * @return The index of the packed node.
+     */
+    std::size_t addPackedNode(std::size_t parent, const std::vector<std::size_t>& children, double weight = 0.0);
+
+    void setRoot(std::size_t root);
+    [[nodiscard]] std::size_t root() const;
+
+    [[nodiscard]] bool isAmbiguous() const;
+
+    /**
+     * Count the number of parse trees under the root.
+     * @return The count, saturated at NONE if it overflows or the forest has cycles.
+     */
+    [[nodiscard]] std::size_t countDerivations() const;
+
+    /**
+     * Extract the first k trees in the enumeration order of the stream.
+     */
+    [[nodiscard]] std::vector<std::shared_ptr<ParseTreeNode>> firstTrees(std::size_t k) const;
+
+    /**
+     * Extract the k trees with the highest total weights of packed nodes.
+     * Derivations containing cycles are ignored.
+     */
+    [[nodiscard]] std::vector<std::shared_ptr<ParseTreeNode>> bestTrees(std::size_t k) const;
+
+    /**
+     * Enumerate the trees lazily. Derivations containing cycles are skipped.
+     * The stream refers to the forest, which must outlive it.
+     */
+    [[nodiscard]] ParseForestTreeStream trees() const;
+
+    /** For unit tests only. */
+    [[nodiscard]] std::string toString() const;
+
+private:
+    std::vector<ParseForestNode> _nodes;
+    std::vector<ParseForestPackedNode> _packedNodes;
+    std::unordered_map<std::string, std::size_t> _keyToNodeIndex;
+    std::size_t _root = NONE;
+};
+
+class ParseForestTreeStream {
+public:
+    explicit ParseForestTreeStream(const ParseForest& forest);
+
+    /**
+     * @return The next tree, or nullptr if all the trees have been enumerated.
+     */
+    std::shared_ptr<ParseTreeNode> next();
+
+private:
+    const ParseForest& _forest;
+    std::vector<std::size_t> _choices;      // The packed node chosen at each choice point in preorder
+    std::vector<std::size_t> _choiceNodes;  // The forest node of each choice point
+    std::vector<bool> _onPath;
+    std::size_t _position = 0;
+    std::size_t _failure = 0;
+    bool _started = false;
+    bool _finished = false;
+
+    bool advance();
+    bool expandChildren(std::size_t index, std::vector<std::shared_ptr<ParseTreeNode>>& children);
+    std::shared_ptr<ParseTreeNode> expand(std::size_t index);
+};
+
+#endif //PARSING_TOYS_PARSE_FOREST_H
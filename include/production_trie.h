@@ -12,6 +12,7 @@ struct ProductionTrieNode {
     ProductionTrieNode *parent = nullptr;
     std::unordered_set<int> originalIndices;  // Keep track of the indices in the original productions
     std::unordered_set<int> expansionIndices;
+    double weight = 0.0;  // The summed weight of the productions ending at the node
     std::unordered_map<std::string, std::shared_ptr<ProductionTrieNode>> children;
 };
 
@@ -27,8 +28,9 @@ public:
      * @param production
      * @param originalIndex The index before expansion.
      * @param expansionIndex The index after expansion.
+     * @param weight The weight of the production.
      */
-    void insert(const std::vector<std::string>& production, int originalIndex, int expansionIndex = NO_EXPANSION) const;
+    void insert(const std::vector<std::string>& production, int originalIndex, int expansionIndex = NO_EXPANSION, double weight = 1.0) const;
 
     /**
      * Find the longest common prefix in the current trie.
@@ -43,9 +45,10 @@ public:
      * Find all child productions under the current node and sort them in lexicographical order.
      * @param node A trie node.
      * @param parents The parent relation of expansion indices.
+     * @param weights If not null, the weights of the productions in the same order are stored in it.
      * @return
      */
-    static std::vector<std::vector<std::string>> computeProductionsUnderPrefix(const std::shared_ptr<ProductionTrieNode>& node, const std::unordered_map<int ,int>* parents = nullptr);
+    static std::vector<std::vector<std::string>> computeProductionsUnderPrefix(const std::shared_ptr<ProductionTrieNode>& node, const std::unordered_map<int ,int>* parents = nullptr, std::vector<double>* weights = nullptr);
 
     /**
      * Remove a node from the trie.
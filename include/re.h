@@ -7,6 +7,37 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <tuple>
+#include <bitset>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+/**
+ * A set of Unicode code points as intervals, which are sorted, disjoint and not adjacent after normalize().
+ */
+struct CharClass {
+    static constexpr std::uint32_t MAX_CODE_POINT = 0x10FFFF;
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> intervals;
+
+    void add(std::uint32_t lo, std::uint32_t hi);
+    void add(const CharClass& other);
+    void normalize();
+    [[nodiscard]] bool contains(std::uint32_t codePoint) const;
+    [[nodiscard]] CharClass negated() const;
+
+    [[nodiscard]] static std::string toUTF8(std::uint32_t codePoint);
+    /**
+     * @return The code point of a string with exactly one code point in UTF-8, or nullopt.
+     */
+    [[nodiscard]] static std::optional<std::uint32_t> fromUTF8(const std::string& s);
+
+    /**
+     * Split the UTF-8 encodings of the code points into sequences of byte ranges, so that the class is matched by
+     * the alternatives of the sequences, e.g. [a-zé] is [a-z] | \xc3 \xa9. The surrogates are excluded.
+     */
+    [[nodiscard]] std::vector<std::vector<std::pair<std::uint8_t, std::uint8_t>>> utf8Sequences() const;
+};
 
 struct RegexNode {
     enum class Type {
@@ -15,14 +46,26 @@ struct RegexNode {
         CAT,
         OR,
         STAR,
+        CLASS,
     };
 
     Type type;
     std::size_t begin = 0;
     std::size_t end = 0;
-    std::string text;
+    std::string text;  // The literal of TEXT, or the pattern of CLASS used as its label
     std::shared_ptr<RegexNode> sub;
     std::vector<std::shared_ptr<RegexNode>> parts;
+    CharClass charClass;
+};
+
+/**
+ * Literals found in every string matched by a pattern, in bytes.
+ */
+struct RegexLiterals {
+    bool exact = false;  // Whether the pattern matches only the prefix, which is then the whole string
+    std::string prefix;  // Every match starts with it
+    std::string suffix;  // Every match ends with it
+    std::string required;  // The longest literal found, every match contains it
 };
 
 struct NFAState {
@@ -32,6 +75,108 @@ struct NFAState {
     std::vector<std::pair<std::string, std::shared_ptr<NFAState>>> edges;
 };
 
+/**
+ * Thompson NFA stored in flat arrays.
+ *
+ * The symbol edges of state i are [edgeBegin[i], edgeBegin[i + 1]) in edgeSymbols and edgeTargets,
+ * where each symbol is the index of its label in the sorted symbol table.
+ * The ε-edges are stored separately in the same form, so that the ε-closure never scans symbol edges.
+ *
+ * For NFAs over bytes, the symbols are byte classes: sets of bytes that are never distinguished by any edge,
+ * and byteClasses maps each of the 256 bytes to its symbol.
+ */
+struct FlatNFA {
+    static constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+
+    std::vector<std::string> symbols;
+    std::vector<std::uint32_t> edgeBegin;
+    std::vector<std::uint32_t> edgeSymbols;
+    std::vector<std::uint32_t> edgeTargets;
+    std::vector<std::uint32_t> epsilonBegin;
+    std::vector<std::uint32_t> epsilonTargets;
+    std::vector<std::uint32_t> byteClasses;
+    std::uint32_t start = NONE;
+    std::uint32_t accept = NONE;
+
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::size_t numSymbols() const;
+    [[nodiscard]] std::size_t numEdges() const;
+    [[nodiscard]] std::size_t numEpsilonEdges() const;
+
+    /**
+     * @return The id of the symbol, or NONE if the label does not appear in the NFA.
+     *         For NFAs over bytes, the label should be a single byte and the class of the byte is returned.
+     */
+    [[nodiscard]] std::uint32_t symbolId(const std::string& label) const;
+
+    /**
+     * Reverse all the edges and swap the start and accept states.
+     */
+    [[nodiscard]] FlatNFA reversed() const;
+
+    /**
+     * Add a new start state that loops on all the symbols, so that any text ending with an accepted string is accepted.
+     */
+    [[nodiscard]] FlatNFA unanchored() const;
+
+    /**
+     * @param bytes The sorted bytes of a byte class.
+     * @return The label of the class with ranges of consecutive bytes, e.g. "[0-9a-f]".
+     */
+    [[nodiscard]] static std::string byteClassLabel(const std::vector<std::uint32_t>& bytes);
+
+    /**
+     * Flatten a pointer-based NFA.
+     * The states keep their ids if the ids are 0 to n-1, otherwise they are numbered in the order of discovery.
+     * @param states If not null, the original state of each flat state is stored in it.
+     */
+    [[nodiscard]] static FlatNFA fromNFA(const std::shared_ptr<NFAState>& nfa, std::vector<std::shared_ptr<NFAState>>* states = nullptr);
+};
+
+/**
+ * DFA with integer states and a dense transition table indexed by state * numSymbols() + symbol.
+ * The symbols are the same as the ones of the NFA it is built from.
+ */
+struct FlatDFA {
+    static constexpr std::uint32_t DEAD = std::numeric_limits<std::uint32_t>::max();
+
+    std::vector<std::string> symbols;
+    std::vector<std::uint32_t> byteClasses;
+    std::vector<std::uint32_t> transitions;
+    std::vector<bool> accepting;
+    std::uint32_t start = DEAD;
+
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::size_t numSymbols() const;
+    [[nodiscard]] std::uint32_t next(std::uint32_t state, std::uint32_t symbol) const;
+};
+
+/**
+ * Glushkov (position) automaton over bytes, which has no ε-edges and one state per position.
+ *
+ * Every byte of the texts in the pattern is a position, numbered from left to right.
+ * Entering position i consumes a byte in positionBytes[i], so the automaton is described by the positions
+ * that can start and end a match, and the positions that can follow each position in followTargets
+ * [followBegin[i], followBegin[i + 1]).
+ */
+struct GlushkovNFA {
+    std::vector<std::bitset<256>> positionBytes;
+    std::vector<std::uint32_t> first;
+    std::vector<std::uint32_t> last;
+    std::vector<std::uint32_t> followBegin;
+    std::vector<std::uint32_t> followTargets;
+    bool nullable = false;
+
+    [[nodiscard]] std::size_t size() const;
+};
+
+/**
+ * Hash of a sorted set of NFA states, which identifies a DFA state in subset constructions.
+ */
+struct NFAStateSetHash {
+    std::size_t operator()(const std::vector<std::uint32_t>& states) const;
+};
+
 struct DFAState {
     std::string id;
     std::string key;
@@ -73,17 +218,100 @@ struct DFAGraph {
 class RegularExpression {
 public:
     static const std::string EPSILON;
+    static constexpr std::size_t MAX_REPETITION = 1000;
+    static constexpr std::size_t MAX_EXPANDED_SIZE = 1000000;  // The maximum number of the nodes after the repetitions are expanded
+    static constexpr std::size_t MAX_DEPTH = 5000;  // The maximum depth of the syntax tree after the repetitions are expanded
 
     RegularExpression() = default;
     explicit RegularExpression(const std::string& pattern);
 
+    /**
+     * Besides the texts, (), |, *, +, ? and ε, the syntax has:
+     * - classes like [a-z_], [^0-9] and ., which matches any character except \n;
+     * - escapes \d, \w, \s and their negations \D, \W, \S, \n, \t, \r, \f, \v, \xHH,
+     *   and a backslash before any other character for the character itself;
+     * - counted repetitions {m}, {m,} and {m,n} with counts up to MAX_REPETITION,
+     *   where the pattern after the nested repetitions are expanded has at most MAX_EXPANDED_SIZE nodes
+     *   and a depth of at most MAX_DEPTH.
+     * The grapheme NFAs and DFAs use the pattern of a class as the label of a single edge,
+     * and the byte automata match the UTF-8 encodings of its code points.
+     */
     bool parse(const std::string& pattern);
     [[nodiscard]] const std::string& errorMessage() const;
     [[nodiscard]] std::shared_ptr<RegexNode> ast() const;
 
     [[nodiscard]] std::shared_ptr<NFAState> toNFA() const;
+    /**
+     * Build the same NFA as toNFA() in flat arrays, with the same state ids.
+     */
+    [[nodiscard]] FlatNFA toFlatNFA() const;
+    /**
+     * Build the NFA over the UTF-8 bytes of the graphemes, for matching byte strings.
+     */
+    [[nodiscard]] FlatNFA toByteNFA() const;
+    /**
+     * Build the NFA over bytes of the union of the patterns, keeping one accept state for each pattern.
+     * The accept field of the result is NONE.
+     * @param accepts The accept state of each pattern is stored in it.
+     */
+    [[nodiscard]] static FlatNFA toByteNFA(const std::vector<RegularExpression>& regexes, std::vector<std::uint32_t>& accepts);
+    /**
+     * Build the position automaton over the UTF-8 bytes of the graphemes.
+     * @param reversed Whether to build the automaton of the reversed pattern.
+     */
+    [[nodiscard]] GlushkovNFA toGlushkovNFA(bool reversed = false) const;
+    /**
+     * Find the literals required by the pattern, which are empty if nothing is required or the pattern is invalid.
+     */
+    [[nodiscard]] RegexLiterals literals() const;
     [[nodiscard]] static std::shared_ptr<DFAState> toDFA(const std::shared_ptr<NFAState>& nfa);
+    /**
+     * Subset construction, the states are numbered in the same order as toDFA().
+     */
+    [[nodiscard]] static FlatDFA toFlatDFA(const FlatNFA& nfa);
+    /**
+     * @param items The sorted NFA states of each DFA state are stored in it.
+     */
+    [[nodiscard]] static FlatDFA toFlatDFA(const FlatNFA& nfa, std::vector<std::vector<std::uint32_t>>& items);
+    /**
+     * Build the DFA over bytes directly from the positions of the pattern with the followpos construction,
+     * which has no ε-closures. A DFA state is the set of positions that can be entered next.
+     * @param unanchored Whether any text ending with an accepted string is accepted, as FlatNFA::unanchored().
+     */
+    [[nodiscard]] static FlatDFA toFlatDFA(const GlushkovNFA& nfa, bool unanchored = false);
     [[nodiscard]] static std::shared_ptr<DFAState> toMinDFA(const std::shared_ptr<DFAState>& dfa);
+    /**
+     * Hopcroft's minimization on integer states in O(kn log n).
+     * The states that can not reach an accepting state are removed, and the states are numbered in BFS order.
+     */
+    [[nodiscard]] static FlatDFA toMinFlatDFA(const FlatDFA& dfa);
+    /**
+     * Minimize a DFA whose accepting states are partitioned by labels, the states with different labels are never merged.
+     * @param labels The label of each state, 0 for the rejecting states, which is replaced by the labels of the new states.
+     */
+    [[nodiscard]] static FlatDFA toMinFlatDFA(const FlatDFA& dfa, std::vector<std::uint32_t>& labels);
+    /**
+     * The product constructions take two DFAs over bytes, whose byte classes are refined to the pairs of their classes,
+     * or two DFAs with the same symbols. The states are the reachable pairs of states, and the results are not minimized.
+     */
+    [[nodiscard]] static FlatDFA intersectFlatDFA(const FlatDFA& a, const FlatDFA& b);
+    [[nodiscard]] static FlatDFA unionFlatDFA(const FlatDFA& a, const FlatDFA& b);
+    [[nodiscard]] static FlatDFA differenceFlatDFA(const FlatDFA& a, const FlatDFA& b);
+    /**
+     * The complement over all the strings of the symbols, e.g. it accepts the invalid UTF-8 for a DFA over bytes.
+     */
+    [[nodiscard]] static FlatDFA complementFlatDFA(const FlatDFA& dfa);
+    /**
+     * Hopcroft-Karp: the pairs of states reached by the same strings are merged with union-find in BFS order,
+     * which is near-linear in the sizes of the DFAs.
+     * @param counterexample If not null, a string accepted by only one of the DFAs is stored in it.
+     */
+    [[nodiscard]] static bool isEquivalentFlatDFA(const FlatDFA& a, const FlatDFA& b, std::string* counterexample = nullptr);
+    /**
+     * Whether every string accepted by a is accepted by b, by searching the product for a pair accepted only by a.
+     * @param counterexample If not null, the shortest string accepted by a but not by b is stored in it.
+     */
+    [[nodiscard]] static bool isSubsetFlatDFA(const FlatDFA& a, const FlatDFA& b, std::string* counterexample = nullptr);
 
     [[nodiscard]] static NFAGraph toNFAGraph(const std::shared_ptr<NFAState>& nfa);
     [[nodiscard]] static DFAGraph toDFAGraph(const std::shared_ptr<DFAState>& dfa);
@@ -92,7 +320,10 @@ private:
     std::string _errorMessage;
     std::shared_ptr<RegexNode> _ast;
 
-    std::shared_ptr<RegexNode> parseSub(const std::vector<std::string>& graphemes, std::size_t begin, std::size_t end, bool first);
+    std::shared_ptr<RegexNode> parseGraphemes(const std::vector<std::string>& graphemes);
+    std::shared_ptr<RegexNode> parseClass(const std::vector<std::string>& graphemes, std::size_t& i, std::size_t end);
+    std::optional<CharClass> parseEscape(const std::vector<std::string>& graphemes, std::size_t& i, std::size_t end);
+    bool parseRepetition(const std::vector<std::string>& graphemes, std::size_t& i, std::size_t end, std::size_t& low, std::size_t& high);
 };
 
 #endif //PARSING_TOYS_RE_H
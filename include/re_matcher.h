@@ -0,0 +1,336 @@
+#ifndef PARSING_TOYS_RE_MATCHER_H
+#define PARSING_TOYS_RE_MATCHER_H
+
+#include "re.h"
+#include <array>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <optional>
+#include <unordered_map>
+
+struct RegexMatch {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+
+    bool operator==(const RegexMatch&) const = default;
+};
+
+/**
+ * Find the first occurrence of a literal from a position, comparing blocks of bytes with SSE2 or AVX2 on x86-64.
+ * @return The position of the occurrence, or std::string_view::npos if not found.
+ */
+[[nodiscard]] std::size_t findLiteral(std::string_view text, std::string_view literal, std::size_t from = 0);
+
+/**
+ * Skip to the candidates of matches with the literals required by a pattern, before running a matcher.
+ *
+ * There is no match if the required literal does not occur. If every match starts with a literal prefix,
+ * the leftmost match starts at one of its occurrences, which are tried in order with an anchored match.
+ * After MAX_CANDIDATES failed candidates, the rest of the text is searched by the matcher, so the time stays linear.
+ */
+class LiteralPrefilter {
+public:
+    static constexpr std::size_t MAX_CANDIDATES = 8;
+
+    LiteralPrefilter() = default;
+    explicit LiteralPrefilter(RegexLiterals literals) : _literals(std::move(literals)) {}
+
+    [[nodiscard]] const RegexLiterals& literals() const {
+        return _literals;
+    }
+
+    /**
+     * @param find The leftmost-longest match of a matcher.
+     * @param longestPrefix The longest prefix accepted by a matcher, or std::string_view::npos.
+     */
+    template<typename Find, typename LongestPrefix>
+    std::optional<RegexMatch> find(const std::string_view text, Find&& find, LongestPrefix&& longestPrefix) const {
+        if (_literals.required.empty()) {
+            return find(text);
+        }
+        auto candidate = findLiteral(text, _literals.required);
+        if (candidate == std::string_view::npos) {
+            return std::nullopt;
+        }
+        if (_literals.prefix.empty()) {
+            return find(text);
+        }
+        if (_literals.prefix != _literals.required) {
+            candidate = findLiteral(text, _literals.prefix);
+        }
+        for (std::size_t i = 0; candidate != std::string_view::npos; ++i) {
+            if (i == MAX_CANDIDATES) {
+                auto match = find(text.substr(candidate));
+                if (match) {
+                    match->begin += candidate;
+                    match->end += candidate;
+                }
+                return match;
+            }
+            if (const auto length = longestPrefix(text.substr(candidate)); length != std::string_view::npos) {
+                return RegexMatch{candidate, candidate + length};
+            }
+            candidate = findLiteral(text, _literals.prefix, candidate + 1);
+        }
+        return std::nullopt;
+    }
+
+private:
+    RegexLiterals _literals;
+};
+
+/**
+ * A DFA over bytes compiled for scanning.
+ *
+ * The bytes are mapped to byte classes, and the transitions are stored in a dense table with
+ * the state indices premultiplied by the number of classes, using 16-bit entries when the table is small enough.
+ * State 0 is the dead state, and the accepting states are numbered last, so both checks are single comparisons.
+ */
+struct DenseDFA {
+    std::array<std::uint8_t, 256> classes{};
+    std::size_t numClasses = 1;
+    std::vector<std::uint16_t> table16;
+    std::vector<std::uint32_t> table32;
+    std::uint32_t start = 0;
+    std::uint32_t acceptBegin = 1;
+    std::vector<std::uint32_t> acceptLabels;
+
+    DenseDFA();
+    /**
+     * @param dfa A DFA built from an NFA over bytes.
+     * @param labels If not null, the labels of the accepting states are kept in acceptLabels,
+     *               indexed by (state - acceptBegin) / numClasses.
+     */
+    explicit DenseDFA(const FlatDFA& dfa, const std::vector<std::uint32_t>* labels = nullptr);
+
+    /**
+     * @return The number of states including the dead state.
+     */
+    [[nodiscard]] std::size_t size() const;
+
+    /**
+     * @return Whether the whole text is accepted.
+     */
+    [[nodiscard]] bool match(std::string_view text) const;
+
+    /**
+     * @return The length of the longest accepted prefix, or std::string_view::npos if no prefix is accepted.
+     */
+    [[nodiscard]] std::size_t longestPrefix(std::string_view text) const;
+
+    /**
+     * @return The length of the longest accepted prefix and the label of the accepting state it ends in,
+     *         or (std::string_view::npos, 0) if no prefix is accepted. The DFA should be built with labels.
+     */
+    [[nodiscard]] std::pair<std::size_t, std::uint32_t> longestLabelledPrefix(std::string_view text) const;
+
+    /**
+     * Scan the text backward from the end.
+     * @return The smallest position where the DFA is in an accepting state, or std::string_view::npos.
+     */
+    [[nodiscard]] std::size_t leftmostAcceptReversed(std::string_view text) const;
+};
+
+/**
+ * Match byte strings with the DFA of a regular expression.
+ *
+ * find() returns the leftmost-longest match: the leftmost start is found by scanning the text backward
+ * with the DFA of the reversed pattern prefixed by any bytes, then the longest match is found from the start.
+ * The literals required by the pattern are searched first to skip the texts and positions that can not match.
+ */
+class DFAMatcher {
+public:
+    DFAMatcher() = default;
+    explicit DFAMatcher(const RegularExpression& regex);
+    explicit DFAMatcher(const std::string& pattern);
+
+    [[nodiscard]] std::size_t numStates() const;
+    [[nodiscard]] std::size_t numClasses() const;
+
+    [[nodiscard]] bool match(std::string_view text) const;
+    [[nodiscard]] std::size_t longestPrefix(std::string_view text) const;
+    [[nodiscard]] std::optional<RegexMatch> find(std::string_view text) const;
+
+private:
+    LiteralPrefilter _prefilter;
+    DenseDFA _forward;
+    DenseDFA _reverse;
+};
+
+/**
+ * A thread-safe cache of the compiled DFA matchers of the most recently used patterns.
+ *
+ * The matchers are shared and immutable, so they can be used by several threads at once, and stay valid after eviction.
+ * A pattern is compiled outside the lock, so a slow compilation does not block the lookups of the other patterns.
+ */
+class RegexCache {
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 256;
+
+    explicit RegexCache(std::size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @return The matcher of the pattern, which never matches if the pattern is invalid.
+     */
+    [[nodiscard]] std::shared_ptr<const DFAMatcher> get(const std::string& pattern);
+
+    [[nodiscard]] std::size_t capacity() const;
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::size_t numHits() const;
+    [[nodiscard]] std::size_t numMisses() const;
+    void clear();
+
+private:
+    using Entry = std::pair<std::string, std::shared_ptr<const DFAMatcher>>;
+
+    mutable std::mutex _mutex;
+    std::size_t _capacity;
+    std::list<Entry> _entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> _index;
+    std::size_t _numHits = 0;
+    std::size_t _numMisses = 0;
+};
+
+/**
+ * A DFA over bytes that is determinized from an NFA on demand while scanning.
+ *
+ * The states are cached up to a fixed number, and the cache is flushed when it is full.
+ * If the cache keeps thrashing, i.e. too few bytes are scanned per state built, the scan falls back to
+ * simulating the NFA directly, so matching is linear in the text with bounded memory for any pattern.
+ * The cache is modified while matching, so an instance must not be shared between threads.
+ */
+class LazyDFA {
+public:
+    static constexpr std::size_t DEFAULT_MAX_STATES = 2048;
+
+    LazyDFA() = default;
+    /**
+     * @param nfa An NFA over bytes.
+     */
+    explicit LazyDFA(FlatNFA nfa, std::size_t maxStates = DEFAULT_MAX_STATES);
+
+    /**
+     * Scan the text, backward if required, until the DFA dies.
+     * @return The largest number of bytes scanned that ends in an accepting state, or std::string_view::npos.
+     */
+    std::size_t longestAccepted(std::string_view text, bool backward = false);
+
+    [[nodiscard]] std::size_t numCachedStates() const;
+    [[nodiscard]] std::size_t numFlushes() const;
+    [[nodiscard]] std::size_t numFallbacks() const;
+
+private:
+    static constexpr std::uint32_t UNKNOWN = FlatNFA::NONE - 1;
+
+    FlatNFA _nfa;
+    std::size_t _maxStates = DEFAULT_MAX_STATES;
+    std::vector<std::uint32_t> _startSet;
+    std::uint32_t _start = FlatNFA::NONE;
+    std::unordered_map<std::vector<std::uint32_t>, std::uint32_t, NFAStateSetHash> _stateIds;
+    std::vector<std::vector<std::uint32_t>> _states;
+    std::vector<bool> _accepting;
+    std::vector<std::uint32_t> _transitions;
+    std::size_t _numFlushes = 0;
+    std::size_t _numFallbacks = 0;
+
+    std::vector<std::uint32_t> _stamp;
+    std::uint32_t _generation = 0;
+    std::vector<std::uint32_t> _stack;
+    std::vector<std::uint32_t> _next;
+
+    void closure(std::vector<std::uint32_t>& states);
+    void move(const std::vector<std::uint32_t>& states, std::uint32_t symbol, std::vector<std::uint32_t>& result);
+    [[nodiscard]] bool isAccepting(const std::vector<std::uint32_t>& states) const;
+    std::uint32_t addState(std::vector<std::uint32_t> states);
+    void flush();
+};
+
+/**
+ * The same matching interface as DFAMatcher with lazy DFAs, which never builds the full DFA.
+ */
+class LazyDFAMatcher {
+public:
+    LazyDFAMatcher() = default;
+    explicit LazyDFAMatcher(const RegularExpression& regex, std::size_t maxStates = LazyDFA::DEFAULT_MAX_STATES);
+    explicit LazyDFAMatcher(const std::string& pattern, std::size_t maxStates = LazyDFA::DEFAULT_MAX_STATES);
+
+    [[nodiscard]] bool match(std::string_view text);
+    [[nodiscard]] std::size_t longestPrefix(std::string_view text);
+    [[nodiscard]] std::optional<RegexMatch> find(std::string_view text);
+
+    [[nodiscard]] std::size_t numCachedStates() const;
+    [[nodiscard]] std::size_t numFlushes() const;
+    [[nodiscard]] std::size_t numFallbacks() const;
+
+private:
+    LiteralPrefilter _prefilter;
+    LazyDFA _forward;
+    LazyDFA _reverse;
+};
+
+/**
+ * Bit-parallel simulation of a Glushkov automaton with at most MAX_POSITIONS positions.
+ *
+ * The active positions are the bits of 1, 2 or 4 64-bit words. A step moves to the positions following the active ones,
+ * then keeps those accepting the byte with the mask of the byte. The follow edges from i to i + d for up to MAX_SHIFTS
+ * of the most common distances d are shifts by d with a mask of the targets, e.g. d = 1 for the texts, which is the classic Shift-And.
+ * The other edges are looked up in tables indexed by 8 bits of the state, only for the bytes with such edges.
+ * There is no determinization, so building is linear in the number of follow edges.
+ */
+struct BitParallelNFA {
+    static constexpr std::size_t MAX_POSITIONS = 256;
+    static constexpr std::size_t MAX_SHIFTS = 8;
+
+    std::size_t words = 1;
+    std::vector<std::uint64_t> byteMasks;
+    std::vector<std::uint64_t> first;
+    std::vector<std::uint64_t> last;
+    std::vector<std::int32_t> shifts;
+    std::vector<std::uint64_t> shiftMasks;
+    std::vector<std::uint32_t> chunks;
+    std::vector<std::uint64_t> chunkTables;
+    bool nullable = false;
+
+    BitParallelNFA();
+    explicit BitParallelNFA(const GlushkovNFA& nfa);
+
+    [[nodiscard]] bool match(std::string_view text) const;
+    [[nodiscard]] std::size_t longestPrefix(std::string_view text) const;
+    /**
+     * Scan the text backward from the end, with the first positions active before every byte.
+     * @return The smallest position where a last position is active, or std::string_view::npos.
+     */
+    [[nodiscard]] std::size_t leftmostAcceptReversed(std::string_view text) const;
+};
+
+/**
+ * The same matching interface as DFAMatcher with bit-parallel NFAs, for patterns with at most 256 byte positions,
+ * i.e. the bytes of the texts and of the UTF-8 byte ranges of the classes.
+ */
+class BitParallelMatcher {
+public:
+    BitParallelMatcher() = default;
+    explicit BitParallelMatcher(const RegularExpression& regex);
+    explicit BitParallelMatcher(const std::string& pattern);
+
+    /**
+     * @return The error of the pattern, or an empty string if the pattern is supported.
+     */
+    [[nodiscard]] const std::string& errorMessage() const;
+    [[nodiscard]] std::size_t numPositions() const;
+
+    [[nodiscard]] bool match(std::string_view text) const;
+    [[nodiscard]] std::size_t longestPrefix(std::string_view text) const;
+    [[nodiscard]] std::optional<RegexMatch> find(std::string_view text) const;
+
+private:
+    std::string _errorMessage;
+    std::size_t _numPositions = 0;
+    LiteralPrefilter _prefilter;
+    BitParallelNFA _forward;
+    BitParallelNFA _reverse;
+};
+
+#endif //PARSING_TOYS_RE_MATCHER_H
@@ -3,8 +3,19 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 
 std::vector<std::string> segmentGraphemes(const std::string& s);
+/**
+ * Segment a string into grapheme clusters that point into the string, without copying them.
+ * The runs of ASCII are split into single bytes directly, and only the bytes around the other characters
+ * are segmented with the Unicode rules.
+ */
+std::vector<std::string_view> segmentGraphemeViews(std::string_view s);
+/**
+ * @param clusters The clusters are appended to it, so that a buffer can be reused.
+ */
+void segmentGraphemeViews(std::string_view s, std::vector<std::string_view>& clusters);
 std::vector<std::string> stringSplit(const std::string& str, char delimiter, bool removeEmpty = false);
 std::string stringJoin(const std::vector<std::string>& strings, const std::string& separator);
 std::string stringReplace(const std::string& str, char from, const std::string& to);
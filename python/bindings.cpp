@@ -3,8 +3,11 @@
 #include <string>
 #include <memory>
 #include "cfg.h"
+#include "parse_forest.h"
 #include "automaton.h"
 #include "re.h"
+#include "re_matcher.h"
+#include "lexer.h"
 using namespace std;
 
 namespace py = pybind11;
@@ -59,7 +62,8 @@ PYBIND11_MODULE(_core, m, py::mod_gil_not_used()) {
         .def("get_cell", [](const ActionGotoTable& self, size_t index, const string& symbol, const string& separator) {
             return self.toString(index, symbol, separator);
         }, py::arg("index"), py::arg("symbol"), py::arg("separator") = " / ")
-        .def("parse", &ActionGotoTable::parse, py::arg("s"))
+        .def("parse", py::overload_cast<const string&>(&ActionGotoTable::parse), py::arg("s"))
+        .def("parse", py::overload_cast<const vector<Symbol>&>(&ActionGotoTable::parse), py::arg("tokens"))
         .def_property_readonly("parse_tree", [](const ActionGotoTable& self) { return self.parseTree; })
     ;
 
@@ -81,7 +85,8 @@ PYBIND11_MODULE(_core, m, py::mod_gil_not_used()) {
         .def("has_conflict", py::overload_cast<>(&MTable::hasConflict, py::const_))
         .def("has_conflict_at", py::overload_cast<const Symbol&, const Symbol&>(&MTable::hasConflict, py::const_), py::arg("non_terminal"), py::arg("terminal"))
         .def("get_cell", &MTable::getCell, py::arg("non_terminal"), py::arg("terminal"), py::arg("separator") = " / ")
-        .def("parse", &MTable::parse, py::arg("s"))
+        .def("parse", py::overload_cast<const string&>(&MTable::parse), py::arg("s"))
+        .def("parse", py::overload_cast<const vector<Symbol>&>(&MTable::parse), py::arg("tokens"))
         .def_property_readonly("parse_tree", [](const MTable& self) { return self.parseTree; })
         .def("__str__", [](const MTable& self) { return self.toString(); })
     ;
@@ -93,6 +98,36 @@ PYBIND11_MODULE(_core, m, py::mod_gil_not_used()) {
         .def("get_cell_string", &CYKTable::getCellString, py::arg("r"), py::arg("c"), py::arg("separator") = ", ")
         .def_property_readonly("accepted", [](const CYKTable& self) { return self.accepted; })
         .def_property_readonly("parse_tree", [](const CYKTable& self) { return self.parseTree; })
+        .def_property_readonly("forest", [](const CYKTable& self) { return self.forest; })
+    ;
+
+    py::class_<WeightedCYKTable>(m, "WeightedCYKTable")
+        .def("size", &WeightedCYKTable::size)
+        .def("get_viterbi", &WeightedCYKTable::getViterbi, py::arg("r"), py::arg("c"), py::arg("symbol"))
+        .def("get_inside", &WeightedCYKTable::getInside, py::arg("r"), py::arg("c"), py::arg("symbol"))
+        .def_property_readonly("accepted", [](const WeightedCYKTable& self) { return self.accepted; })
+        .def_property_readonly("parse_tree", [](const WeightedCYKTable& self) { return self.parseTree; })
+        .def_property_readonly("log_probability", [](const WeightedCYKTable& self) { return self.logProbability; })
+        .def_property_readonly("inside_log_probability", [](const WeightedCYKTable& self) { return self.insideLogProbability; })
+    ;
+
+    py::class_<EarleyChart>(m, "EarleyChart")
+        .def("size", &EarleyChart::size)
+        .def("num_items", &EarleyChart::numItems)
+        .def("get_set", &EarleyChart::getSet, py::arg("index"))
+        .def_property_readonly("accepted", [](const EarleyChart& self) { return self.accepted; })
+        .def_property_readonly("parse_tree", [](const EarleyChart& self) { return self.parseTree; })
+        .def_property_readonly("forest", [](const EarleyChart& self) { return self.forest; })
+    ;
+
+    py::class_<ParseForest, shared_ptr<ParseForest>>(m, "ParseForest")
+        .def("size", &ParseForest::size)
+        .def("num_packed_nodes", &ParseForest::numPackedNodes)
+        .def("is_ambiguous", &ParseForest::isAmbiguous)
+        .def("count_derivations", &ParseForest::countDerivations)
+        .def("first_trees", &ParseForest::firstTrees, py::arg("k"))
+        .def("best_trees", &ParseForest::bestTrees, py::arg("k"))
+        .def("__str__", [](const ParseForest& self) { return self.toString(); })
     ;
 
     py::class_<AutomatonWrapper>(m, "FiniteAutomaton")
@@ -100,18 +135,29 @@ PYBIND11_MODULE(_core, m, py::mod_gil_not_used()) {
         .def("to_svg", &AutomatonWrapper::to_svg, py::arg("dark_mode") = false)
     ;
 
+    py::enum_<LRAlgorithm>(m, "LRAlgorithm")
+        .value("LR0", LRAlgorithm::LR0)
+        .value("SLR1", LRAlgorithm::SLR1)
+        .value("LR1", LRAlgorithm::LR1)
+        .value("LALR1", LRAlgorithm::LALR1)
+    ;
+
     py::class_<ContextFreeGrammar>(m, "ContextFreeGrammar")
         .def(py::init<>())
         .def_property_readonly_static("EMPTY_SYMBOL", [](py::object) { return ContextFreeGrammar::EMPTY_SYMBOL; })
         .def_property_readonly_static("DOT_SYMBOL", [](py::object) { return ContextFreeGrammar::DOT_SYMBOL; })
         .def_property_readonly_static("EOF_SYMBOL", [](py::object) { return ContextFreeGrammar::EOF_SYMBOL; })
         .def("parse", &ContextFreeGrammar::parse, py::arg("s"))
+        .def("parse_file", &ContextFreeGrammar::parseFile, py::arg("path"))
         .def("error_message", &ContextFreeGrammar::errorMessage)
         .def("terminals", &ContextFreeGrammar::terminals)
         .def("non_terminals", &ContextFreeGrammar::nonTerminals)
         .def("ordered_non_terminals", &ContextFreeGrammar::orderedNonTerminals)
         .def("is_terminal", &ContextFreeGrammar::isTerminal, py::arg("symbol"))
         .def("is_non_terminal", &ContextFreeGrammar::isNonTerminal, py::arg("symbol"))
+        .def("fingerprint", &ContextFreeGrammar::fingerprint)
+        .def("has_weights", &ContextFreeGrammar::hasWeights)
+        .def("weight_of", &ContextFreeGrammar::weightOf, py::arg("head"), py::arg("production"))
         .def("left_factoring", &ContextFreeGrammar::leftFactoring, py::arg("expand") = false)
         .def("left_recursion_elimination", &ContextFreeGrammar::leftRecursionElimination)
         .def("compute_first_and_follow_set", &ContextFreeGrammar::computeFirstAndFollowSet)
@@ -139,13 +185,68 @@ PYBIND11_MODULE(_core, m, py::mod_gil_not_used()) {
         .def("compute_lalr1_action_goto_table", [](const ContextFreeGrammar& self, AutomatonWrapper& wrapper) {
             return self.computeLALR1ActionGotoTable(wrapper.automaton);
         }, py::arg("automaton"))
+        .def("compute_lr_automaton", [](ContextFreeGrammar& self, const LRAlgorithm algorithm, const size_t numThreads) {
+            return AutomatonWrapper(self.computeLRAutomaton(algorithm, numThreads));
+        }, py::arg("algorithm"), py::arg("num_threads") = 0)
+        .def("compute_action_goto_table", [](const ContextFreeGrammar& self, const LRAlgorithm algorithm, AutomatonWrapper& wrapper, const size_t numThreads) {
+            return self.computeActionGotoTable(algorithm, wrapper.automaton, numThreads);
+        }, py::arg("algorithm"), py::arg("automaton"), py::arg("num_threads") = 0)
         .def("compute_ll1_table", &ContextFreeGrammar::computeLL1Table)
         .def("is_chomsky_normal_form", &ContextFreeGrammar::isChomskyNormalForm)
         .def("to_chomsky_normal_form", &ContextFreeGrammar::toChomskyNormalForm)
-        .def("cyk_parse", &ContextFreeGrammar::cykParse, py::arg("s"))
+        .def("compile_chomsky_normal_form", &ContextFreeGrammar::compileChomskyNormalForm)
+        .def("cyk_parse", &ContextFreeGrammar::cykParse, py::arg("s"), py::arg("build_forest") = false)
+        .def("weighted_cyk_parse", &ContextFreeGrammar::weightedCYKParse, py::arg("s"))
+        .def("earley_parse", &ContextFreeGrammar::earleyParse, py::arg("s"), py::arg("build_forest") = false)
         .def("__str__", &ContextFreeGrammar::toString)
     ;
 
+    py::class_<IncrementalGrammar>(m, "IncrementalGrammar")
+        .def(py::init<>())
+        .def("parse", &IncrementalGrammar::parse, py::arg("s"))
+        .def("parse_file", &IncrementalGrammar::parseFile, py::arg("path"))
+        .def("edit", &IncrementalGrammar::edit, py::arg("offset"), py::arg("length"), py::arg("replacement"))
+        .def("text", &IncrementalGrammar::text)
+        .def_property_readonly("grammar", [](const IncrementalGrammar& self) { return self.grammar(); })
+        .def("error_message", &IncrementalGrammar::errorMessage)
+        .def("num_blocks", &IncrementalGrammar::numBlocks)
+    ;
+
+    py::class_<IncrementalLRAutomaton> incrementalLRAutomaton(m, "IncrementalLRAutomaton");
+    incrementalLRAutomaton.attr("Type") = m.attr("LRAlgorithm");
+    incrementalLRAutomaton
+        .def(py::init<IncrementalLRAutomaton::Type>(), py::arg("type"))
+        .def("update", &IncrementalLRAutomaton::update, py::arg("grammar"))
+        .def("first_and_follow_set", &IncrementalLRAutomaton::firstAndFollowSet)
+        .def("size", [](const IncrementalLRAutomaton& self) { return self.automaton()->size(); })
+        .def("to_svg", [](const IncrementalLRAutomaton& self, const bool darkMode) {
+            return self.automaton()->toSVG(darkMode);
+        }, py::arg("dark_mode") = false)
+        .def("action_goto_table", &IncrementalLRAutomaton::actionGotoTable)
+        .def("num_reused_states", &IncrementalLRAutomaton::numReusedStates)
+        .def("num_reused_rows", &IncrementalLRAutomaton::numReusedRows)
+    ;
+
+    py::class_<GrammarArtifactCache>(m, "GrammarArtifactCache")
+        .def(py::init<string>(), py::arg("directory"))
+        .def_property_readonly_static("FORMAT_VERSION", [](py::object) { return GrammarArtifactCache::FORMAT_VERSION; })
+        .def("first_and_follow_set", &GrammarArtifactCache::firstAndFollowSet, py::arg("grammar"))
+        .def("automaton", [](GrammarArtifactCache& self, const ContextFreeGrammar& grammar, const LRAlgorithm algorithm) {
+            return AutomatonWrapper(self.automaton(grammar, algorithm));
+        }, py::arg("grammar"), py::arg("algorithm"))
+        .def("action_goto_table", &GrammarArtifactCache::actionGotoTable, py::arg("grammar"), py::arg("algorithm"))
+        .def("path_of", &GrammarArtifactCache::pathOf, py::arg("grammar"), py::arg("kind"))
+        .def("directory", &GrammarArtifactCache::directory)
+        .def("num_hits", &GrammarArtifactCache::numHits)
+        .def("num_misses", &GrammarArtifactCache::numMisses)
+    ;
+
+    py::class_<ChomskyNormalForm>(m, "ChomskyNormalForm")
+        .def_property_readonly("grammar", [](const ChomskyNormalForm& self) { return self.grammar; })
+        .def("cyk_parse", &ChomskyNormalForm::cykParse, py::arg("s"))
+        .def("restore_parse_tree", &ChomskyNormalForm::restoreParseTree, py::arg("tree"))
+    ;
+
     py::class_<NFAState, shared_ptr<NFAState>>(m, "NFAState")
         .def(py::init<>())
         .def_readonly("id", &NFAState::id)
@@ -183,16 +284,115 @@ PYBIND11_MODULE(_core, m, py::mod_gil_not_used()) {
         .def("edge_label", &DFAGraph::edgeLabel, py::arg("index"))
     ;
 
+    py::class_<RegexLiterals>(m, "RegexLiterals")
+        .def_readonly("exact", &RegexLiterals::exact)
+        .def_readonly("prefix", &RegexLiterals::prefix)
+        .def_readonly("suffix", &RegexLiterals::suffix)
+        .def_readonly("required", &RegexLiterals::required)
+    ;
+
     py::class_<RegularExpression>(m, "RegularExpression")
         .def(py::init<>())
         .def(py::init<const string&>(), py::arg("pattern"))
         .def_property_readonly_static("EPSILON", [](py::object) { return RegularExpression::EPSILON; })
         .def("parse", &RegularExpression::parse, py::arg("pattern"))
         .def("error_message", &RegularExpression::errorMessage)
+        .def("literals", &RegularExpression::literals)
         .def("to_nfa", &RegularExpression::toNFA)
         .def_static("to_dfa", &RegularExpression::toDFA, py::arg("nfa"))
         .def_static("to_min_dfa", &RegularExpression::toMinDFA, py::arg("dfa"))
         .def_static("to_nfa_graph", &RegularExpression::toNFAGraph, py::arg("nfa"))
         .def_static("to_dfa_graph", &RegularExpression::toDFAGraph, py::arg("dfa"))
     ;
+
+    py::class_<RegexMatch>(m, "RegexMatch")
+        .def_readonly("begin", &RegexMatch::begin)
+        .def_readonly("end", &RegexMatch::end)
+    ;
+
+    py::class_<DFAMatcher, shared_ptr<DFAMatcher>>(m, "DFAMatcher")
+        .def(py::init<const string&>(), py::arg("pattern"))
+        .def("num_states", &DFAMatcher::numStates)
+        .def("num_classes", &DFAMatcher::numClasses)
+        .def("match", &DFAMatcher::match, py::arg("text"))
+        .def("longest_prefix", [](const DFAMatcher& self, const string_view text) -> optional<size_t> {
+            if (const auto length = self.longestPrefix(text); length != string_view::npos) {
+                return length;
+            }
+            return nullopt;
+        }, py::arg("text"))
+        .def("find", &DFAMatcher::find, py::arg("text"))
+    ;
+
+    py::class_<RegexCache>(m, "RegexCache")
+        .def(py::init<size_t>(), py::arg("capacity") = RegexCache::DEFAULT_CAPACITY)
+        .def("get", [](RegexCache& self, const string& pattern) {
+            return const_pointer_cast<DFAMatcher>(self.get(pattern));
+        }, py::arg("pattern"))
+        .def("capacity", &RegexCache::capacity)
+        .def("size", &RegexCache::size)
+        .def("num_hits", &RegexCache::numHits)
+        .def("num_misses", &RegexCache::numMisses)
+        .def("clear", &RegexCache::clear)
+    ;
+
+    py::class_<LazyDFAMatcher>(m, "LazyDFAMatcher")
+        .def(py::init<const string&, size_t>(), py::arg("pattern"), py::arg("max_states") = LazyDFA::DEFAULT_MAX_STATES)
+        .def("num_cached_states", &LazyDFAMatcher::numCachedStates)
+        .def("num_flushes", &LazyDFAMatcher::numFlushes)
+        .def("num_fallbacks", &LazyDFAMatcher::numFallbacks)
+        .def("match", &LazyDFAMatcher::match, py::arg("text"))
+        .def("longest_prefix", [](LazyDFAMatcher& self, const string_view text) -> optional<size_t> {
+            if (const auto length = self.longestPrefix(text); length != string_view::npos) {
+                return length;
+            }
+            return nullopt;
+        }, py::arg("text"))
+        .def("find", &LazyDFAMatcher::find, py::arg("text"))
+    ;
+
+    py::class_<BitParallelMatcher>(m, "BitParallelMatcher")
+        .def(py::init<const string&>(), py::arg("pattern"))
+        .def("error_message", &BitParallelMatcher::errorMessage)
+        .def("num_positions", &BitParallelMatcher::numPositions)
+        .def("match", &BitParallelMatcher::match, py::arg("text"))
+        .def("longest_prefix", [](const BitParallelMatcher& self, const string_view text) -> optional<size_t> {
+            if (const auto length = self.longestPrefix(text); length != string_view::npos) {
+                return length;
+            }
+            return nullopt;
+        }, py::arg("text"))
+        .def("find", &BitParallelMatcher::find, py::arg("text"))
+    ;
+
+    py::class_<LexerRule>(m, "LexerRule")
+        .def(py::init([](const string& name, const string& pattern, const bool skip) {
+            return LexerRule{name, pattern, skip};
+        }), py::arg("name"), py::arg("pattern"), py::arg("skip") = false)
+        .def_readonly("name", &LexerRule::name)
+        .def_readonly("pattern", &LexerRule::pattern)
+        .def_readonly("skip", &LexerRule::skip)
+    ;
+
+    py::class_<LexerToken>(m, "LexerToken")
+        .def_readonly("rule", &LexerToken::rule)
+        .def_readonly("begin", &LexerToken::begin)
+        .def_readonly("end", &LexerToken::end)
+    ;
+
+    py::class_<LexerResult>(m, "LexerResult")
+        .def_readonly("tokens", &LexerResult::tokens)
+        .def_readonly("accepted", &LexerResult::accepted)
+        .def_readonly("error_position", &LexerResult::errorPosition)
+    ;
+
+    py::class_<Lexer>(m, "Lexer")
+        .def(py::init<const vector<LexerRule>&>(), py::arg("rules"))
+        .def("error_message", &Lexer::errorMessage)
+        .def("num_rules", &Lexer::numRules)
+        .def("rule_name", &Lexer::ruleName, py::arg("rule"))
+        .def("num_states", &Lexer::numStates)
+        .def("tokenize", &Lexer::tokenize, py::arg("text"))
+        .def("terminals", &Lexer::terminals, py::arg("tokens"))
+    ;
 }
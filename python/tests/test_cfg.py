@@ -1,4 +1,7 @@
-from parsing_toys import ContextFreeGrammar
+import os
+import tempfile
+
+from parsing_toys import ContextFreeGrammar, GrammarArtifactCache, IncrementalGrammar, IncrementalLRAutomaton, LRAlgorithm
 
 
 class TestContextFreeGrammar:
@@ -121,3 +124,46 @@ class TestLeftRecursionElimination:
         )
         result = cfg.left_recursion_elimination()
         assert result is False
+
+    def test_incremental_grammar(self):
+        incremental = IncrementalGrammar()
+        assert incremental.parse("S -> A b\nA -> a\n") is True
+        assert incremental.edit(incremental.text().index("a"), 1, "c | S") is True
+        assert str(incremental.grammar) == "S -> A b\nA -> c\n   | S\n"
+        assert incremental.edit(0, 4, "") is False
+        assert incremental.error_message() != ""
+
+    def test_incremental_lr_automaton(self):
+        grammar = ContextFreeGrammar()
+        assert grammar.parse("E -> E + T | T\nT -> id\n") is True
+        incremental = IncrementalLRAutomaton(IncrementalLRAutomaton.Type.LALR1)
+        incremental.update(grammar)
+        assert incremental.size() == grammar.compute_lalr1_automaton().size()
+        assert grammar.parse("E -> E + T | T\nT -> id | ( E )\n") is True
+        incremental.update(grammar)
+        assert incremental.size() == grammar.compute_lalr1_automaton().size()
+        assert incremental.num_reused_states() > 0
+        assert incremental.first_and_follow_set().get_first_set("T") == ["(", "id"]
+        assert not incremental.action_goto_table().has_conflict()
+
+    def test_grammar_artifact_cache(self):
+        grammar = ContextFreeGrammar()
+        assert grammar.parse("E -> E + T | T\nT -> id\n") is True
+        spaced = ContextFreeGrammar()
+        assert spaced.parse("E->E + T|T\n\nT -> id\n") is True
+        assert grammar.fingerprint() == spaced.fingerprint()
+        with tempfile.TemporaryDirectory() as directory:
+            cache = GrammarArtifactCache(directory)
+            table = cache.action_goto_table(grammar, LRAlgorithm.LALR1)
+            assert os.path.exists(cache.path_of(grammar, "lalr1-table"))
+            assert cache.path_of(grammar, "lalr1-table").endswith(f"-v{GrammarArtifactCache.FORMAT_VERSION}")
+            assert cache.num_misses() == 2
+            cache = GrammarArtifactCache(directory)
+            cached = cache.action_goto_table(spaced, LRAlgorithm.LALR1)
+            assert cached.size() == table.size()
+            assert cached.get_cell(0, "id") == table.get_cell(0, "id")
+            assert cached.parse("id + id").size() == table.parse("id + id").size()
+            assert cache.automaton(grammar, LRAlgorithm.LALR1).size() == grammar.compute_lalr1_automaton().size()
+            assert cache.first_and_follow_set(grammar).get_first_set("E") == ["id"]
+            assert cache.num_hits() == 2
+            assert cache.num_misses() == 1
@@ -1,3 +1,5 @@
+import math
+
 from parsing_toys import ContextFreeGrammar
 
 
@@ -152,3 +154,33 @@ class TestCYKParsing:
         cfg.to_chomsky_normal_form()
         result = cfg.cyk_parse("b a a b a")
         assert isinstance(result.accepted, bool)
+
+    def test_weighted_cyk_parse(self):
+        cfg = ContextFreeGrammar()
+        cfg.parse(
+            """
+            S -> A A [0.4] | A B [0.6]
+            A -> a
+            B -> a [0.5] | b [0.5]
+        """
+        )
+        assert cfg.has_weights() is True
+        assert cfg.weight_of("S", ["A", "B"]) == 0.6
+        result = cfg.weighted_cyk_parse("a a")
+        assert result.accepted is True
+        assert abs(result.log_probability - math.log(0.4)) < 1e-9
+        assert abs(result.inside_log_probability - math.log(0.7)) < 1e-9
+        assert [child.label for child in result.parse_tree.children] == ["A", "A"]
+
+    def test_compiled_chomsky_normal_form(self):
+        cfg = ContextFreeGrammar()
+        cfg.parse(
+            """
+            S -> a S b | ε
+        """
+        )
+        compiled = cfg.compile_chomsky_normal_form()
+        assert compiled.grammar.is_chomsky_normal_form() is True
+        result = compiled.cyk_parse("a b")
+        assert result.accepted is True
+        assert [child.label for child in result.parse_tree.children] == ["a", "S", "b"]
@@ -0,0 +1,57 @@
+from parsing_toys import ContextFreeGrammar
+
+
+class TestEarleyParsing:
+    def test_earley_parse_simple(self):
+        cfg = ContextFreeGrammar()
+        cfg.parse(
+            """
+            S -> A B
+            A -> a
+            B -> b
+        """
+        )
+        result = cfg.earley_parse("a b")
+        assert result.accepted is True
+        assert result.size() == 2
+        assert result.get_set(0) == ["S' -> · S, 0", "S -> · A B, 0", "A -> · a, 0"]
+
+    def test_earley_parse_rejected(self):
+        cfg = ContextFreeGrammar()
+        cfg.parse(
+            """
+            E -> E + T | T
+            T -> T * F | F
+            F -> ( E ) | id
+        """
+        )
+        result = cfg.earley_parse("id + + id")
+        assert result.accepted is False
+        assert result.parse_tree is None
+
+    def test_earley_parse_tree(self):
+        cfg = ContextFreeGrammar()
+        cfg.parse(
+            """
+            S -> a S | ε
+        """
+        )
+        result = cfg.earley_parse("a a")
+        assert result.accepted is True
+        tree = result.parse_tree
+        assert tree.label == "S"
+        assert [child.label for child in tree.children] == ["a", "S"]
+        assert tree.size() == 6
+
+    def test_earley_parse_forest(self):
+        cfg = ContextFreeGrammar()
+        cfg.parse(
+            """
+            E -> E + E | id
+        """
+        )
+        assert cfg.earley_parse("id + id").forest is None
+        forest = cfg.earley_parse("id + id + id", build_forest=True).forest
+        assert forest.is_ambiguous() is True
+        assert forest.count_derivations() == 2
+        assert len(forest.first_trees(5)) == 2
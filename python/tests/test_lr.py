@@ -1,4 +1,4 @@
-from parsing_toys import ContextFreeGrammar
+from parsing_toys import ContextFreeGrammar, LRAlgorithm
 
 
 class TestLR0Parsing:
@@ -248,3 +248,39 @@ class TestActionGotoTable:
             for terminal in cfg.terminals():
                 result = table.has_conflict_at(i, terminal)
                 assert isinstance(result, bool)
+
+
+class TestParallelLRAutomaton:
+    def test_compute_lr_automaton(self):
+        cfg = ContextFreeGrammar()
+        cfg.parse(
+            """
+            E -> E + T | T
+            T -> T * F | F
+            F -> ( E ) | id
+        """
+        )
+        automaton = cfg.compute_lr_automaton(LRAlgorithm.LR1, num_threads=4)
+        expected = cfg.compute_lr1_automaton()
+        assert automaton.size() == expected.size()
+        assert automaton.to_svg() == expected.to_svg()
+        table = cfg.compute_lr1_action_goto_table(automaton)
+        assert not table.has_conflict()
+
+    def test_compute_action_goto_table(self):
+        cfg = ContextFreeGrammar()
+        cfg.parse(
+            """
+            E -> E + T | T
+            T -> T * F | F
+            F -> ( E ) | id
+        """
+        )
+        automaton = cfg.compute_lr0_automaton()
+        expected = cfg.compute_lr0_action_goto_table(automaton)
+        table = cfg.compute_action_goto_table(LRAlgorithm.LR0, automaton, num_threads=4)
+        assert table.size() == expected.size()
+        assert table.has_conflict() == expected.has_conflict()
+        for i in range(table.size()):
+            for terminal in cfg.terminals():
+                assert table.get_cell(i, terminal) == expected.get_cell(i, terminal)
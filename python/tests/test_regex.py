@@ -1,4 +1,4 @@
-from parsing_toys import RegularExpression
+from parsing_toys import BitParallelMatcher, ContextFreeGrammar, DFAMatcher, LazyDFAMatcher, Lexer, LexerRule, RegexCache, RegularExpression
 
 
 class TestRegularExpression:
@@ -21,6 +21,13 @@ class TestRegularExpression:
     def test_epsilon_constant(self):
         assert RegularExpression.EPSILON == "ε"
 
+    def test_literals(self):
+        literals = RegularExpression("ab(c|d)*efg").literals()
+        assert literals.exact is False
+        assert literals.prefix == "ab"
+        assert literals.suffix == "efg"
+        assert literals.required == "efg"
+
 
 class TestNFA:
     def test_to_nfa(self):
@@ -190,3 +197,135 @@ class TestDFAState:
         assert hasattr(dfa, "id")
         assert hasattr(dfa, "key")
         assert hasattr(dfa, "type")
+
+
+class TestDFAMatcher:
+    def test_match(self):
+        matcher = DFAMatcher("(a|b)*abb")
+        assert matcher.match("babb")
+        assert not matcher.match("bab")
+        assert matcher.num_states() > 1
+
+    def test_longest_prefix(self):
+        matcher = DFAMatcher("a(bc)*")
+        assert matcher.longest_prefix("abcbcb") == 5
+        assert matcher.longest_prefix("bc") is None
+
+    def test_find(self):
+        matcher = DFAMatcher("abcd|c")
+        found = matcher.find("xabcd")
+        assert (found.begin, found.end) == (1, 5)
+        assert matcher.find("xyz") is None
+
+    def test_classes_and_repetition(self):
+        matcher = DFAMatcher(r"[A-Za-z_]\w*|\d{2,3}")
+        assert matcher.match("_foo42")
+        assert matcher.match("123")
+        assert not matcher.match("1234")
+        found = matcher.find("1 + bar")
+        assert (found.begin, found.end) == (4, 7)
+
+
+class TestRegexCache:
+    def test_get(self):
+        cache = RegexCache(capacity=2)
+        assert cache.get("(a|b)*abb").match("babb")
+        assert cache.get("(a|b)*abb").match("abb")
+        cache.get("c")
+        cache.get("d")
+        assert cache.size() == 2
+        assert (cache.num_hits(), cache.num_misses()) == (1, 3)
+        cache.clear()
+        assert cache.size() == 0
+
+
+class TestLazyDFAMatcher:
+    def test_match(self):
+        matcher = LazyDFAMatcher("(a|b)*abb")
+        assert matcher.match("babb")
+        assert not matcher.match("bab")
+        assert matcher.num_cached_states() > 1
+
+    def test_longest_prefix(self):
+        matcher = LazyDFAMatcher("a(bc)*")
+        assert matcher.longest_prefix("abcbcb") == 5
+        assert matcher.longest_prefix("bc") is None
+
+    def test_find(self):
+        matcher = LazyDFAMatcher("abcd|c")
+        found = matcher.find("xabcd")
+        assert (found.begin, found.end) == (1, 5)
+        assert matcher.find("xyz") is None
+
+    def test_small_cache(self):
+        matcher = LazyDFAMatcher("(a|b)*a(a|b)(a|b)(a|b)(a|b)(a|b)", max_states=4)
+        assert matcher.match("ab" * 100 + "abbbb")
+        assert not matcher.match("ab" * 100 + "bbbbb")
+        assert matcher.num_flushes() + matcher.num_fallbacks() > 0
+
+
+class TestBitParallelMatcher:
+    def test_match(self):
+        matcher = BitParallelMatcher("(a|b)*abb")
+        assert matcher.error_message() == ""
+        assert matcher.num_positions() == 5
+        assert matcher.match("babb")
+        assert not matcher.match("bab")
+
+    def test_longest_prefix(self):
+        matcher = BitParallelMatcher("a(bc)*")
+        assert matcher.longest_prefix("abcbcb") == 5
+        assert matcher.longest_prefix("bc") is None
+
+    def test_find(self):
+        matcher = BitParallelMatcher("abcd|c")
+        found = matcher.find("xabcd")
+        assert (found.begin, found.end) == (1, 5)
+        assert matcher.find("xyz") is None
+
+    def test_too_many_positions(self):
+        matcher = BitParallelMatcher("a" * 300)
+        assert matcher.error_message() != ""
+        assert not matcher.match("a" * 300)
+
+
+class TestLexer:
+    @staticmethod
+    def lexer():
+        letter = "(" + "|".join("abcdefghijklmnopqrstuvwxyz") + ")"
+        return Lexer(
+            [
+                LexerRule("if", "if"),
+                LexerRule("id", letter + "+"),
+                LexerRule(",", ","),
+                LexerRule("ws", " +", skip=True),
+            ]
+        )
+
+    def test_tokenize(self):
+        lexer = self.lexer()
+        assert lexer.error_message() == ""
+        assert lexer.num_rules() == 4
+        result = lexer.tokenize("if iff")
+        assert result.accepted
+        assert [(token.rule, token.begin, token.end) for token in result.tokens] == [(0, 0, 2), (1, 3, 6)]
+        assert lexer.terminals(result.tokens) == ["if", "id"]
+
+    def test_error(self):
+        result = self.lexer().tokenize("ab 1")
+        assert not result.accepted
+        assert result.error_position == 3
+        assert Lexer([LexerRule("a", "a*")]).error_message() != ""
+
+    def test_parse(self):
+        lexer = self.lexer()
+        cfg = ContextFreeGrammar()
+        cfg.parse(
+            """
+            L -> id R
+            R -> , id R | ε
+        """
+        )
+        table = cfg.compute_slr1_action_goto_table(cfg.compute_slr1_automaton())
+        steps = table.parse(lexer.terminals(lexer.tokenize("a, b ,c").tokens))
+        assert steps.get_action(steps.size() - 1) == "accept"
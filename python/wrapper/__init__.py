@@ -1,33 +1,69 @@
 from ._core import (
     ActionGotoTable,
+    BitParallelMatcher,
+    ChomskyNormalForm,
     ContextFreeGrammar,
     CYKTable,
     DFAGraph,
+    DFAMatcher,
     DFAState,
+    EarleyChart,
     FiniteAutomaton,
     FirstAndFollowSet,
+    GrammarArtifactCache,
+    IncrementalGrammar,
+    IncrementalLRAutomaton,
+    Lexer,
+    LexerResult,
+    LexerRule,
+    LexerToken,
+    LazyDFAMatcher,
     LLParsingSteps,
+    LRAlgorithm,
     LRParsingSteps,
     MTable,
     NFAGraph,
     NFAState,
+    ParseForest,
     ParseTreeNode,
+    RegexCache,
+    RegexLiterals,
+    RegexMatch,
     RegularExpression,
+    WeightedCYKTable,
 )
 
 __all__ = [
     "ActionGotoTable",
+    "BitParallelMatcher",
+    "ChomskyNormalForm",
     "ContextFreeGrammar",
     "CYKTable",
     "DFAGraph",
+    "DFAMatcher",
     "DFAState",
+    "EarleyChart",
     "FiniteAutomaton",
     "FirstAndFollowSet",
+    "GrammarArtifactCache",
+    "IncrementalGrammar",
+    "IncrementalLRAutomaton",
+    "Lexer",
+    "LexerResult",
+    "LexerRule",
+    "LexerToken",
+    "LazyDFAMatcher",
     "LLParsingSteps",
+    "LRAlgorithm",
     "LRParsingSteps",
     "MTable",
     "NFAGraph",
     "NFAState",
+    "ParseForest",
     "ParseTreeNode",
+    "RegexCache",
+    "RegexLiterals",
+    "RegexMatch",
     "RegularExpression",
+    "WeightedCYKTable",
 ]
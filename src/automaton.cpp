@@ -29,13 +29,16 @@ string FiniteAutomaton::newNodeLabel(const string& prefix) const {
 }
 
 size_t FiniteAutomaton::addNode(const FiniteAutomatonNode& node) {
-    const auto key = node.kernel.toSortedString() + "---\n" + node.nonKernel.toSortedString();
+    return addNode(node, node.kernel.toSortedString() + "---\n" + node.nonKernel.toSortedString());
+}
+
+size_t FiniteAutomaton::addNode(FiniteAutomatonNode node, const string& key) {
     if (const auto it = _keyToNodeIndex.find(key); it != _keyToNodeIndex.end()) {
         return it->second;
     }
     const size_t index = _nodes.size();
     _keyToNodeIndex[key] = index;
-    _nodes.emplace_back(node);
+    _nodes.emplace_back(std::move(node));
     return index;
 }
 
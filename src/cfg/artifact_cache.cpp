@@ -0,0 +1,472 @@
+#include "cfg.h"
+#include "automaton.h"
+#include <charconv>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <random>
+#include <ranges>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * The artifacts are written as lines of decimal numbers and length-prefixed strings,
+ * so the symbols can contain any bytes.
+ */
+static void writeNumber(string& out, const size_t n) {
+    out += to_string(n);
+    out += '\n';
+}
+
+static void writeString(string& out, const string_view s) {
+    writeNumber(out, s.size());
+    out += s;
+    out += '\n';
+}
+
+static void writeStrings(string& out, const vector<string>& strings) {
+    writeNumber(out, strings.size());
+    for (const auto& s : strings) {
+        writeString(out, s);
+    }
+}
+
+static bool readNumber(string_view& in, size_t& n) {
+    const auto end = in.find('\n');
+    if (end == string_view::npos) {
+        return false;
+    }
+    if (const auto [ptr, error] = from_chars(in.data(), in.data() + end, n); error != errc() || ptr != in.data() + end) {
+        return false;
+    }
+    in.remove_prefix(end + 1);
+    return true;
+}
+
+/**
+ * Every element takes at least two bytes, which bounds the counts read from a corrupted file.
+ */
+static bool readCount(string_view& in, size_t& n) {
+    return readNumber(in, n) && n <= in.size() / 2;
+}
+
+static bool readString(string_view& in, string& s) {
+    size_t n;
+    if (!readNumber(in, n) || n >= in.size() || in[n] != '\n') {
+        return false;
+    }
+    s.assign(in.substr(0, n));
+    in.remove_prefix(n + 1);
+    return true;
+}
+
+static bool readStrings(string_view& in, vector<string>& strings) {
+    size_t n;
+    if (!readCount(in, n)) {
+        return false;
+    }
+    strings.resize(n);
+    return ranges::all_of(strings, [&](string& s) { return readString(in, s); });
+}
+
+template<typename Map>
+static vector<string> sortedKeys(const Map& map) {
+    vector<string> keys;
+    keys.reserve(map.size());
+    for (const auto& key : map | views::keys) {
+        keys.push_back(key);
+    }
+    ranges::sort(keys);
+    return keys;
+}
+
+static vector<string> sortedSet(const unordered_set<string>& set) {
+    vector<string> values(set.begin(), set.end());
+    ranges::sort(values);
+    return values;
+}
+
+/**
+ * The heads are written in the output ordering, then all the heads with productions in lexical order,
+ * which also covers the heads that are not in the ordering.
+ */
+void ContextFreeGrammar::serialize(string& out) const {
+    writeStrings(out, _ordering);
+    writeNumber(out, _productions.size());
+    for (const auto& head : sortedKeys(_productions)) {
+        const auto& productions = _productions.at(head);
+        writeString(out, head);
+        writeNumber(out, productions.size());
+        for (const auto& production : productions) {
+            writeStrings(out, production);
+        }
+    }
+    writeStrings(out, sortedSet(_terminals));
+    writeNumber(out, _weights.size());
+    for (const auto& key : sortedKeys(_weights)) {
+        writeString(out, key);
+        writeString(out, format("{}", _weights.at(key)));
+    }
+    writeNumber(out, _productionKeys.size());
+    for (const auto& head : sortedKeys(_productionKeys)) {
+        writeString(out, head);
+        writeStrings(out, sortedSet(_productionKeys.at(head)));
+    }
+}
+
+bool ContextFreeGrammar::deserialize(string_view& in) {
+    *this = ContextFreeGrammar();
+    size_t numHeads, numProductions, numWeights, numKeys;
+    if (!readStrings(in, _ordering) || !readCount(in, numHeads)) {
+        return false;
+    }
+    for (size_t i = 0; i < numHeads; ++i) {
+        Symbol head;
+        if (!readString(in, head) || !readCount(in, numProductions)) {
+            return false;
+        }
+        auto& productions = _productions[head];
+        productions.resize(numProductions);
+        if (!ranges::all_of(productions, [&](Production& production) { return readStrings(in, production); })) {
+            return false;
+        }
+    }
+    vector<Symbol> terminals;
+    if (!readStrings(in, terminals) || !readCount(in, numWeights)) {
+        return false;
+    }
+    _terminals.insert(terminals.begin(), terminals.end());
+    for (size_t i = 0; i < numWeights; ++i) {
+        string key, text;
+        double weight;
+        if (!readString(in, key) || !readString(in, text)) {
+            return false;
+        }
+        if (const auto [ptr, error] = from_chars(text.data(), text.data() + text.size(), weight); error != errc() || ptr != text.data() + text.size()) {
+            return false;
+        }
+        _weights[key] = weight;
+    }
+    if (!readCount(in, numKeys)) {
+        return false;
+    }
+    for (size_t i = 0; i < numKeys; ++i) {
+        Symbol head;
+        vector<string> keys;
+        if (!readString(in, head) || !readStrings(in, keys)) {
+            return false;
+        }
+        _productionKeys[head].insert(keys.begin(), keys.end());
+    }
+    return true;
+}
+
+/**
+ * FNV-1a over the serialized grammar.
+ */
+uint64_t ContextFreeGrammar::fingerprint() const {
+    string serialized;
+    serialize(serialized);
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char ch : serialized) {
+        hash ^= static_cast<uint8_t>(ch);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void writeSets(string& out, const unordered_map<Symbol, unordered_set<Symbol>>& sets) {
+    writeNumber(out, sets.size());
+    for (const auto& symbol : sortedKeys(sets)) {
+        writeString(out, symbol);
+        writeStrings(out, sortedSet(sets.at(symbol)));
+    }
+}
+
+static bool readSets(string_view& in, unordered_map<Symbol, unordered_set<Symbol>>& sets) {
+    size_t n;
+    if (!readCount(in, n)) {
+        return false;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        Symbol symbol;
+        vector<Symbol> values;
+        if (!readString(in, symbol) || !readStrings(in, values)) {
+            return false;
+        }
+        sets[symbol].insert(values.begin(), values.end());
+    }
+    return true;
+}
+
+static void writeFirstAndFollowSet(string& out, const FirstAndFollowSet& firstAndFollowSet) {
+    writeStrings(out, firstAndFollowSet.ordering);
+    writeSets(out, firstAndFollowSet.first);
+    writeSets(out, firstAndFollowSet.follow);
+}
+
+static bool readFirstAndFollowSet(string_view& in, FirstAndFollowSet& firstAndFollowSet) {
+    return readStrings(in, firstAndFollowSet.ordering) && readSets(in, firstAndFollowSet.first) && readSets(in, firstAndFollowSet.follow);
+}
+
+void GrammarArtifactCache::writeAutomaton(string& out, FiniteAutomaton& automaton) {
+    writeNumber(out, automaton.size());
+    for (size_t i = 0; i < automaton.size(); ++i) {
+        const auto& node = automaton.nodeAt(i);
+        writeNumber(out, node.accept ? 1 : 0);
+        writeString(out, node.label);
+        node.kernel.serialize(out);
+        node.nonKernel.serialize(out);
+    }
+    writeNumber(out, automaton.edges().size());
+    for (const auto& [u, v, label] : automaton.edges()) {
+        writeNumber(out, u);
+        writeNumber(out, v);
+        writeString(out, label);
+    }
+}
+
+bool GrammarArtifactCache::readAutomaton(string_view& in, FiniteAutomaton& automaton) {
+    size_t numNodes, numEdges, accept;
+    if (!readCount(in, numNodes)) {
+        return false;
+    }
+    for (size_t i = 0; i < numNodes; ++i) {
+        FiniteAutomatonNode node;
+        if (!readNumber(in, accept) || !readString(in, node.label) || !node.kernel.deserialize(in) || !node.nonKernel.deserialize(in)) {
+            return false;
+        }
+        node.accept = accept != 0;
+        if (automaton.addNode(node) != i) {
+            return false;
+        }
+    }
+    if (!readCount(in, numEdges)) {
+        return false;
+    }
+    for (size_t i = 0; i < numEdges; ++i) {
+        size_t u, v;
+        string label;
+        if (!readNumber(in, u) || !readNumber(in, v) || !readString(in, label) || u >= numNodes || v >= numNodes) {
+            return false;
+        }
+        automaton.addEdge(u, v, label);
+    }
+    return true;
+}
+
+static void writeActionGotoTable(string& out, const ActionGotoTable& table) {
+    writeNumber(out, table.actions.size());
+    for (size_t i = 0; i < table.actions.size(); ++i) {
+        writeNumber(out, table.actions[i].size());
+        for (const auto& symbol : sortedKeys(table.actions[i])) {
+            writeString(out, symbol);
+            writeStrings(out, table.actions[i].at(symbol));
+        }
+        writeNumber(out, table.nextStates[i].size());
+        for (const auto& symbol : sortedKeys(table.nextStates[i])) {
+            writeString(out, symbol);
+            writeNumber(out, table.nextStates[i].at(symbol));
+        }
+        writeNumber(out, table.reduceHeads[i].size());
+        for (const auto& symbol : sortedKeys(table.reduceHeads[i])) {
+            writeString(out, symbol);
+            writeString(out, table.reduceHeads[i].at(symbol));
+            writeStrings(out, table.reduceProductions[i].at(symbol));
+        }
+    }
+}
+
+static bool readActionGotoTable(string_view& in, ActionGotoTable& table) {
+    size_t numRows;
+    if (!readCount(in, numRows)) {
+        return false;
+    }
+    table = ActionGotoTable(numRows);
+    for (size_t i = 0; i < numRows; ++i) {
+        size_t n;
+        Symbol symbol;
+        if (!readCount(in, n)) {
+            return false;
+        }
+        for (size_t j = 0; j < n; ++j) {
+            if (!readString(in, symbol) || !readStrings(in, table.actions[i][symbol])) {
+                return false;
+            }
+        }
+        if (!readCount(in, n)) {
+            return false;
+        }
+        for (size_t j = 0; j < n; ++j) {
+            if (!readString(in, symbol) || !readNumber(in, table.nextStates[i][symbol])) {
+                return false;
+            }
+        }
+        if (!readCount(in, n)) {
+            return false;
+        }
+        for (size_t j = 0; j < n; ++j) {
+            if (!readString(in, symbol) || !readString(in, table.reduceHeads[i][symbol]) || !readStrings(in, table.reduceProductions[i][symbol])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static string nameOf(const LRAlgorithm algorithm) {
+    switch (algorithm) {
+        case LRAlgorithm::LR0:
+            return "lr0";
+        case LRAlgorithm::SLR1:
+            return "slr1";
+        case LRAlgorithm::LR1:
+            return "lr1";
+        case LRAlgorithm::LALR1:
+            return "lalr1";
+    }
+    throw runtime_error("Unknown LR algorithm");
+}
+
+GrammarArtifactCache::GrammarArtifactCache(string directory) : _directory(std::move(directory)) {}
+
+FirstAndFollowSet GrammarArtifactCache::firstAndFollowSet(const ContextFreeGrammar& grammar) {
+    const string kind = "first-follow";
+    FirstAndFollowSet result;
+    if (string content; load(grammar, kind, content)) {
+        if (string_view in = content; readFirstAndFollowSet(in, result) && in.empty()) {
+            ++_numHits;
+            return result;
+        }
+    }
+    ++_numMisses;
+    result = grammar.computeFirstAndFollowSet();
+    string content;
+    writeFirstAndFollowSet(content, result);
+    store(grammar, kind, content);
+    return result;
+}
+
+unique_ptr<FiniteAutomaton> GrammarArtifactCache::automaton(const ContextFreeGrammar& grammar, const LRAlgorithm algorithm) {
+    const string kind = nameOf(algorithm) + "-automaton";
+    auto result = make_unique<FiniteAutomaton>();
+    if (string content; load(grammar, kind, content)) {
+        if (string_view in = content; readAutomaton(in, *result) && in.empty()) {
+            ++_numHits;
+            return result;
+        }
+    }
+    ++_numMisses;
+    auto copy = grammar;
+    switch (algorithm) {
+        case LRAlgorithm::LR0:
+            result = copy.computeLR0Automaton();
+            break;
+        case LRAlgorithm::SLR1:
+            result = copy.computeSLR1Automaton();
+            break;
+        case LRAlgorithm::LR1:
+            result = copy.computeLR1Automaton();
+            break;
+        case LRAlgorithm::LALR1:
+            result = copy.computeLALR1Automaton();
+            break;
+    }
+    string content;
+    writeAutomaton(content, *result);
+    store(grammar, kind, content);
+    return result;
+}
+
+ActionGotoTable GrammarArtifactCache::actionGotoTable(const ContextFreeGrammar& grammar, const LRAlgorithm algorithm) {
+    const string kind = nameOf(algorithm) + "-table";
+    ActionGotoTable result;
+    if (string content; load(grammar, kind, content)) {
+        if (string_view in = content; readActionGotoTable(in, result) && in.empty()) {
+            ++_numHits;
+            return result;
+        }
+    }
+    ++_numMisses;
+    const auto lrAutomaton = automaton(grammar, algorithm);
+    switch (algorithm) {
+        case LRAlgorithm::LR0:
+            result = grammar.computeLR0ActionGotoTable(lrAutomaton);
+            break;
+        case LRAlgorithm::SLR1:
+            result = grammar.computeSLR1ActionGotoTable(lrAutomaton);
+            break;
+        case LRAlgorithm::LR1:
+            result = grammar.computeLR1ActionGotoTable(lrAutomaton);
+            break;
+        case LRAlgorithm::LALR1:
+            result = grammar.computeLALR1ActionGotoTable(lrAutomaton);
+            break;
+    }
+    string content;
+    writeActionGotoTable(content, result);
+    store(grammar, kind, content);
+    return result;
+}
+
+string GrammarArtifactCache::pathOf(const ContextFreeGrammar& grammar, const string& kind) const {
+    return (filesystem::path(_directory) / format("{:016x}-{}-v{}", grammar.fingerprint(), kind, FORMAT_VERSION)).string();
+}
+
+const string& GrammarArtifactCache::directory() const {
+    return _directory;
+}
+
+size_t GrammarArtifactCache::numHits() const {
+    return _numHits;
+}
+
+size_t GrammarArtifactCache::numMisses() const {
+    return _numMisses;
+}
+
+bool GrammarArtifactCache::load(const ContextFreeGrammar& grammar, const string& kind, string& content) {
+    ifstream file(pathOf(grammar, kind), ios::binary);
+    if (!file) {
+        return false;
+    }
+    content.assign(istreambuf_iterator(file), istreambuf_iterator<char>());
+    const auto expected = header(grammar, kind);
+    if (!content.starts_with(expected)) {
+        return false;
+    }
+    content.erase(0, expected.size());
+    return true;
+}
+
+/**
+ * The cache is best-effort, an artifact that can not be written is computed again in the next run.
+ */
+void GrammarArtifactCache::store(const ContextFreeGrammar& grammar, const string& kind, const string& content) const {
+    error_code error;
+    filesystem::create_directories(_directory, error);
+    const auto path = pathOf(grammar, kind);
+    const auto temporaryPath = format("{}.{}.tmp", path, random_device()());
+    {
+        ofstream file(temporaryPath, ios::binary);
+        file << header(grammar, kind) << content;
+        if (!file) {
+            file.close();
+            filesystem::remove(temporaryPath, error);
+            return;
+        }
+    }
+    filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        filesystem::remove(temporaryPath, error);
+    }
+}
+
+string GrammarArtifactCache::header(const ContextFreeGrammar& grammar, const string& kind) {
+    string header = "parsing-toys artifact\n";
+    writeNumber(header, FORMAT_VERSION);
+    writeString(header, kind);
+    grammar.serialize(header);
+    return header;
+}
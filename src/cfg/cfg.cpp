@@ -4,6 +4,16 @@
 #include <ranges>
 #include <limits>
 #include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PARSING_TOYS_MMAP
+#endif
 
 using namespace std;
 
@@ -18,104 +28,200 @@ bool ContextFreeGrammarToken::operator==(const ContextFreeGrammarToken& other) c
 }
 
 vector<ContextFreeGrammarToken> ContextFreeGrammar::tokenize(const string& s) {
-    const auto graphemes = segmentGraphemes(s);
-    const auto n = graphemes.size();
     vector<ContextFreeGrammarToken> tokens;
+    for (const auto& [type, symbol, line, column] : tokenizeViews(s)) {
+        tokens.emplace_back(ContextFreeGrammarToken{type, string(symbol), line, column});
+    }
+    return tokens;
+}
+
+/**
+ * The text is segmented line by line into a reused buffer, as the line breaks are always boundaries of clusters and tokens.
+ * A symbol is the span from its first cluster to the cluster before the next separator,
+ * so the clusters are only compared, never concatenated.
+ */
+vector<ContextFreeGrammarTokenView> ContextFreeGrammar::tokenizeViews(const string_view s) {
+    vector<ContextFreeGrammarTokenView> tokens;
+    vector<string_view> graphemes;
+    size_t n = 0;
     size_t line = 1, column = 1;
 
-    auto isWhitespace = [](const string& g) {
-        return g.size() == 1 && isspace(static_cast<unsigned char>(g[0]));
+    auto isArrow = [&](const size_t i) {
+        return i + 1 < n && graphemes[i] == "-" && graphemes[i + 1] == ">";
+    };
+    // Whether a symbol ends before the cluster, most clusters are single bytes which are checked without comparing strings.
+    auto isSeparator = [&](const size_t i) {
+        if (const auto g = graphemes[i]; g.size() == 1) {
+            return isspace(static_cast<unsigned char>(g[0])) || g[0] == '|' || isArrow(i);
+        }
+        return graphemes[i] == "\r\n" || graphemes[i] == "｜" || graphemes[i] == "→";
     };
 
-    for (size_t i = 0; i < n;) {
-        const auto& g = graphemes[i];
-        if (g == "\r\n" || g == "\n" || g == "\r") {
-            ++line;
-            column = 1;
-            ++i;
-        } else if (isWhitespace(g)) {
-            ++column;
-            ++i;
-        } else if (i + 1 < n && graphemes[i] == "-" && graphemes[i + 1] == ">") {
-            tokens.emplace_back(ContextFreeGrammarToken{ContextFreeGrammarToken::Type::PRODUCTION, "->", line, column});
-            i += 2;
-            column += 2;
-        } else if (g == "→") {
-            tokens.emplace_back(ContextFreeGrammarToken{ContextFreeGrammarToken::Type::PRODUCTION, "→", line, column});
-            ++i;
-            ++column;
-        } else if (g == "|") {
-            tokens.emplace_back(ContextFreeGrammarToken{ContextFreeGrammarToken::Type::ALTERNATION, "|", line, column});
-            ++i;
-            ++column;
-        } else if (g == "｜") {
-            tokens.emplace_back(ContextFreeGrammarToken{ContextFreeGrammarToken::Type::ALTERNATION, "｜", line, column});
-            ++i;
-            ++column;
-        } else {
-            string symbol;
-            size_t numChars = 0;
-            for (size_t j = i; j < n; ++j) {
-                const auto& gj = graphemes[j];
-                if (isWhitespace(gj)
-                    || gj == "\r\n" || gj == "\n" || gj == "\r"
-                    || gj == "|" || gj == "｜" || gj == "→"
-                    || (j + 1 < n && gj == "-" && graphemes[j + 1] == ">")) {
-                    break;
-                }
-                symbol += gj;
-                ++numChars;
-            }
-            if (symbol == "ε" || symbol == "ϵ") {
-                tokens.emplace_back(ContextFreeGrammarToken{ContextFreeGrammarToken::Type::SYMBOL, EMPTY_SYMBOL, line, column});
+    for (size_t lineBegin = 0; lineBegin < s.size();) {
+        const auto lineEnd = min(s.find('\n', lineBegin), s.size() - 1) + 1;
+        graphemes.clear();
+        segmentGraphemeViews(s.substr(lineBegin, lineEnd - lineBegin), graphemes);
+        lineBegin = lineEnd;
+        n = graphemes.size();
+        for (size_t i = 0; i < n;) {
+            const auto g = graphemes[i];
+            if (g == "\r\n" || g == "\n" || g == "\r") {
+                ++line;
+                column = 1;
+                ++i;
+            } else if (g.size() == 1 && isspace(static_cast<unsigned char>(g[0]))) {
+                ++column;
+                ++i;
+            } else if (isArrow(i)) {
+                tokens.emplace_back(ContextFreeGrammarTokenView{ContextFreeGrammarToken::Type::PRODUCTION, {g.data(), 2}, line, column});
+                i += 2;
+                column += 2;
+            } else if (g == "→") {
+                tokens.emplace_back(ContextFreeGrammarTokenView{ContextFreeGrammarToken::Type::PRODUCTION, g, line, column});
+                ++i;
+                ++column;
+            } else if (g == "|" || g == "｜") {
+                tokens.emplace_back(ContextFreeGrammarTokenView{ContextFreeGrammarToken::Type::ALTERNATION, g, line, column});
+                ++i;
+                ++column;
             } else {
-                tokens.emplace_back(ContextFreeGrammarToken{ContextFreeGrammarToken::Type::SYMBOL, symbol, line, column});
+                size_t j = i + 1;
+                while (j < n && !isSeparator(j)) {
+                    ++j;
+                }
+                string_view symbol(g.data(), static_cast<size_t>(graphemes[j - 1].data() + graphemes[j - 1].size() - g.data()));
+                if (symbol == "ε" || symbol == "ϵ") {
+                    symbol = EMPTY_SYMBOL;
+                }
+                tokens.emplace_back(ContextFreeGrammarTokenView{ContextFreeGrammarToken::Type::SYMBOL, symbol, line, column});
+                column += j - i;
+                i = j;
             }
-            i += numChars;
-            column += numChars;
         }
     }
     return tokens;
 }
 
+/**
+ * A weight is a decimal number enclosed in square brackets, e.g. "[0.5]" or "[2e-3]".
+ * The weight may be out of range, which should be checked by the caller.
+ * @return Whether the symbol is written in the form of a weight.
+ */
+static bool parseWeight(const string_view symbol, double& weight) {
+    if (symbol.size() < 3 || symbol.front() != '[' || symbol.back() != ']') {
+        return false;
+    }
+    const string number(symbol.substr(1, symbol.size() - 2));
+    if (!isdigit(static_cast<unsigned char>(number[0])) && number[0] != '-' && number[0] != '+' && number[0] != '.') {
+        return false;
+    }
+    char* end = nullptr;
+    weight = strtod(number.c_str(), &end);
+    return end == number.c_str() + number.size();
+}
+
+static string weightToString(const double weight) {
+    return format(" [{}]", weight);
+}
+
 bool ContextFreeGrammar::parse(const string& s) {
-    const auto tokens = tokenize(s);
+    return parseTokens(tokenizeViews(s));
+}
+
+#ifdef PARSING_TOYS_MMAP
+/**
+ * A read-only mapping of a file, which is unmapped and closed on destruction.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const string& path) : _fd(open(path.c_str(), O_RDONLY)) {
+        if (struct stat info{}; _fd >= 0 && fstat(_fd, &info) == 0) {
+            _size = static_cast<size_t>(info.st_size);
+            if (_size > 0) {
+                _data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+                if (_data != MAP_FAILED) {
+                    madvise(_data, _size, MADV_SEQUENTIAL);
+                }
+            }
+        }
+    }
+    ~MappedFile() {
+        if (_data != MAP_FAILED) {
+            munmap(_data, _size);
+        }
+        if (_fd >= 0) {
+            close(_fd);
+        }
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] bool isOpen() const {
+        return _fd >= 0 && (_size == 0 || _data != MAP_FAILED);
+    }
+    [[nodiscard]] string_view view() const {
+        return _size == 0 ? string_view() : string_view(static_cast<const char*>(_data), _size);
+    }
+
+private:
+    int _fd;
+    size_t _size = 0;
+    void* _data = MAP_FAILED;
+};
+#endif
+
+bool ContextFreeGrammar::parseFile(const string& path) {
+#ifdef PARSING_TOYS_MMAP
+    const MappedFile file(path);
+    if (!file.isOpen()) {
+        _errorMessage = format("Can not open the file '{}'.", path);
+        return false;
+    }
+    return parseTokens(tokenizeViews(file.view()));
+#else
+    ifstream file(path, ios::binary);
+    if (!file) {
+        _errorMessage = format("Can not open the file '{}'.", path);
+        return false;
+    }
+    const string s((istreambuf_iterator(file)), istreambuf_iterator<char>());
+    return parseTokens(tokenizeViews(s));
+#endif
+}
+
+bool ContextFreeGrammar::parseRules(const vector<ContextFreeGrammarTokenView>& tokens, vector<ContextFreeGrammarRule>& rules, string& errorMessage) {
     const auto n = tokens.size();
     if (n == 0) {
         return true;
     }
-    string head;
     auto hasEmptyProduction = [&](const size_t line, const size_t column) -> bool {
-        if (head.empty()) {
+        if (rules.empty()) {
             return false;
         }
-        const bool hasEmpty = _productions[head].back().empty();
+        const bool hasEmpty = rules.back().productions.back().empty();
         if (hasEmpty) {
-           _errorMessage = "Line " + to_string(line) + " Column " + to_string(column) + ": Found empty production for '" + head + "'.";
+           errorMessage = "Line " + to_string(line) + " Column " + to_string(column) + ": Found empty production for '" + rules.back().head + "'.";
         }
         return hasEmpty;
     };
     auto noHeadFound = [&](const size_t line, const size_t column) -> bool {
-        if (head.empty()) {
-            _errorMessage = "Line " + to_string(line) + " Column " + to_string(column) + ": Can not find the head of the production.";
+        if (rules.empty()) {
+            errorMessage = "Line " + to_string(line) + " Column " + to_string(column) + ": Can not find the head of the production.";
             return true;
         }
         return false;
     };
     for (size_t i = 0; i < n; ++i) {
         if (tokens[i].type == ContextFreeGrammarToken::Type::PRODUCTION) {
-            _errorMessage = format("Line {} Column {}: Can not find the head of the production.", tokens[i].line, tokens[i].column);
+            errorMessage = format("Line {} Column {}: Can not find the head of the production.", tokens[i].line, tokens[i].column);
             return false;
         }
         if (i + 1 < n && tokens[i].type == ContextFreeGrammarToken::Type::SYMBOL && tokens[i + 1].type == ContextFreeGrammarToken::Type::PRODUCTION) {
             if (hasEmptyProduction(tokens[i].line, tokens[i].column)) {
                 return false;
             }
-            head = tokens[i].symbol;
-            if (!_productions.contains(head)) {
-                _ordering.emplace_back(head);
-            }
-            _productions[head].emplace_back();
+            const bool startsLine = i == 0 || tokens[i - 1].line != tokens[i].line;
+            rules.emplace_back(ContextFreeGrammarRule{Symbol(tokens[i].symbol), tokens[i].line, startsLine, Productions(1), {}});
             ++i;
         } else if (tokens[i].type == ContextFreeGrammarToken::Type::ALTERNATION) {
             if (noHeadFound(tokens[i].line, tokens[i].column)) {
@@ -124,24 +230,66 @@ bool ContextFreeGrammar::parse(const string& s) {
             if (hasEmptyProduction(tokens[i].line, tokens[i].column)) {
                 return false;
             }
-            _productions[head].emplace_back();
+            rules.back().productions.emplace_back();
         } else {
             if (noHeadFound(tokens[i].line, tokens[i].column)) {
                 return false;
             }
-            _productions[head].back().emplace_back(tokens[i].symbol);
+            auto& rule = rules.back();
+            // The weight should be the last symbol of an alternative.
+            const bool isLast = i + 1 == n
+                || tokens[i + 1].type == ContextFreeGrammarToken::Type::ALTERNATION
+                || (i + 2 < n && tokens[i + 2].type == ContextFreeGrammarToken::Type::PRODUCTION);
+            if (double weight; isLast && !rule.productions.back().empty() && parseWeight(tokens[i].symbol, weight)) {
+                if (weight < 0.0) {
+                    errorMessage = format("Line {} Column {}: The weight of a production should be non-negative.", tokens[i].line, tokens[i].column);
+                    return false;
+                }
+                if (!isfinite(weight)) {
+                    errorMessage = format("Line {} Column {}: The weight of a production is out of range.", tokens[i].line, tokens[i].column);
+                    return false;
+                }
+                rule.weights.emplace_back(rule.productions.size() - 1, weight);
+                continue;
+            }
+            rule.productions.back().emplace_back(tokens[i].symbol);
         }
     }
     const auto lastLine = tokens.back().line;
-    const auto lastColumn = tokens.back().column + utf8Length(tokens.back().symbol);
-    if (hasEmptyProduction(lastLine, lastColumn)) {
+    const auto lastColumn = tokens.back().column + segmentGraphemeViews(tokens.back().symbol).size();
+    return !hasEmptyProduction(lastLine, lastColumn);
+}
+
+bool ContextFreeGrammar::parseTokens(const vector<ContextFreeGrammarTokenView>& tokens) {
+    vector<ContextFreeGrammarRule> rules;
+    if (!parseRules(tokens, rules, _errorMessage)) {
         return false;
     }
+    if (rules.empty()) {
+        return true;
+    }
+    for (auto& rule : rules) {
+        addRule(std::move(rule));
+    }
     initTerminals();
     deduplicate();
     return true;
 }
 
+/**
+ * The productions are appended without deduplication, and the first weight of a production is kept.
+ */
+void ContextFreeGrammar::addRule(ContextFreeGrammarRule rule) {
+    const auto [it, inserted] = _productions.try_emplace(rule.head);
+    if (inserted) {
+        _ordering.emplace_back(rule.head);
+    }
+    for (const auto& [index, weight] : rule.weights) {
+        _weights.try_emplace(computeProductionKey(rule.head, rule.productions[index]), weight);
+    }
+    it->second.insert(it->second.end(), make_move_iterator(rule.productions.begin()), make_move_iterator(rule.productions.end()));
+}
+
 const string& ContextFreeGrammar::errorMessage() const {
     return _errorMessage;
 }
@@ -165,6 +313,9 @@ string ContextFreeGrammar::toString() const {
             for (const auto& symbol: productions[i]) {
                 grammar += " " + symbol;
             }
+            if (const auto it = _weights.find(computeProductionKey(head, productions[i])); it != _weights.end()) {
+                grammar += weightToString(it->second);
+            }
             grammar += "\n";
         }
     }
@@ -205,6 +356,9 @@ std::string ContextFreeGrammar::toSortedString() const {
             for (const auto& symbol: productions[i]) {
                 grammar += " " + symbol;
             }
+            if (const auto it = _weights.find(computeProductionKey(head, productions[i])); it != _weights.end()) {
+                grammar += weightToString(it->second);
+            }
             grammar += "\n";
         }
     }
@@ -390,9 +544,55 @@ ContextFreeGrammar ContextFreeGrammar::operator|(const ContextFreeGrammar& other
     for (const auto& symbol : other._ordering) {
         result.addProductions(symbol, other._productions.at(symbol));
     }
+    result._weights = _weights;
+    for (const auto& [key, weight] : other._weights) {
+        result._weights.try_emplace(key, weight);
+    }
     return result;
 }
 
+bool ContextFreeGrammar::hasWeights() const {
+    return !_weights.empty();
+}
+
+double ContextFreeGrammar::weightOf(const Symbol& head, const Production& production) const {
+    if (const auto it = _weights.find(computeProductionKey(head, production)); it != _weights.end()) {
+        return it->second;
+    }
+    return 1.0;
+}
+
+void ContextFreeGrammar::setWeight(const Symbol& head, const Production& production, const double weight) {
+    _weights[computeProductionKey(head, production)] = weight;
+}
+
+/**
+ * Remove the weights of the productions that no longer exist after transformations.
+ */
+void ContextFreeGrammar::pruneWeights() {
+    if (_weights.empty()) {
+        return;
+    }
+    unordered_map<string, double> weights;
+    for (const auto& [head, productions] : _productions) {
+        for (const auto& production : productions) {
+            const auto key = computeProductionKey(head, production);
+            if (const auto it = _weights.find(key); it != _weights.end()) {
+                weights[key] = it->second;
+            }
+        }
+    }
+    _weights = std::move(weights);
+}
+
+void ContextFreeGrammar::setSummedWeight(const string& key, const WeightSum& weightSum) {
+    if (weightSum.isExplicit || weightSum.weight != 1.0) {
+        _weights[key] = weightSum.weight;
+    } else {
+        _weights.erase(key);
+    }
+}
+
 void PrintTo(const ContextFreeGrammarToken& token, ostream* os) {
     *os << "{" << static_cast<int>(token.type) << "," << token.symbol << "," << token.line << "," << token.column << "}";
 }
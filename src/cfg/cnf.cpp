@@ -2,9 +2,37 @@
 #include <queue>
 #include <ranges>
 #include <algorithm>
+#include <functional>
+#include <cmath>
 
 using namespace std;
 
+/**
+ * Solve the weights of the symbols, where each weight is a sum over the weights of the other symbols.
+ * The weights are iterated from zero, so the least solution is found even if the symbols derive themselves.
+ */
+static unordered_map<Symbol, double> solveWeightSums(const vector<Symbol>& symbols, const function<double(const Symbol&, const unordered_map<Symbol, double>&)>& sumOf) {
+    constexpr int MAX_ROUNDS = 1000;
+    constexpr double TOLERANCE = 1e-12;
+    unordered_map<Symbol, double> weights;
+    for (const auto& symbol : symbols) {
+        weights[symbol] = 0.0;
+    }
+    for (int round = 0; round < MAX_ROUNDS; ++round) {
+        unordered_map<Symbol, double> next;
+        double maxChange = 0.0;
+        for (const auto& symbol : symbols) {
+            next[symbol] = sumOf(symbol, weights);
+            maxChange = max(maxChange, abs(next[symbol] - weights[symbol]));
+        }
+        weights = std::move(next);
+        if (maxChange <= TOLERANCE) {
+            break;
+        }
+    }
+    return weights;
+}
+
 bool ContextFreeGrammar::isChomskyNormalForm() const {
     if (_ordering.empty()) {
         return true;
@@ -47,6 +75,10 @@ bool ContextFreeGrammar::isChomskyNormalForm() const {
 }
 
 void ContextFreeGrammar::toChomskyNormalForm() {
+    convertToChomskyNormalForm(nullptr);
+}
+
+void ContextFreeGrammar::convertToChomskyNormalForm(ChomskyNormalForm* mapping) {
     if (_ordering.empty()) {
         return;
     }
@@ -67,6 +99,9 @@ void ContextFreeGrammar::toChomskyNormalForm() {
         const auto newStart = generatePrimedSymbol(originalStart, false);
         _productions[newStart] = {{originalStart}};
         _ordering.insert(_ordering.begin(), newStart);
+        if (mapping != nullptr) {
+            mapping->newStart = newStart;
+        }
     }
 
     unordered_map<Symbol, Symbol> terminalToNonTerminal;
@@ -83,17 +118,32 @@ void ContextFreeGrammar::toChomskyNormalForm() {
         }
         terminalToNonTerminal[terminal] = newSymbol;
         _productions[newSymbol] = {{terminal}};
+        if (mapping != nullptr) {
+            mapping->terminalWrappers[newSymbol] = terminal;
+        }
         _ordering.push_back(newSymbol);
     }
 
-    for (auto &productions: _productions | views::values) {
+    // The weights follow the productions when they are rewritten. The weights of the productions that are
+    // derived by removing nullable symbols or unit productions are treated as probabilities,
+    // which are the products along the derivations and summed over the derivations of the same production.
+    const bool weighted = hasWeights();
+    auto inheritWeight = [&](const Symbol& head, const Production& production, const Symbol& sourceHead, const Production& source) {
+        if (const auto it = _weights.find(computeProductionKey(sourceHead, source)); it != _weights.end()) {
+            _weights.try_emplace(computeProductionKey(head, production), it->second);
+        }
+    };
+
+    for (auto& [head, productions] : _productions) {
         for (auto& production : productions) {
             if (production.size() >= 2) {
+                const auto original = production;
                 for (auto& symbol : production) {
                     if (isTerminal(symbol) && symbol != EMPTY_SYMBOL) {
                         symbol = terminalToNonTerminal[symbol];
                     }
                 }
+                inheritWeight(head, production, head, original);
             }
         }
     }
@@ -108,7 +158,15 @@ void ContextFreeGrammar::toChomskyNormalForm() {
                 auto current = head;
                 for (size_t i = 0; i + 2 < production.size(); ++i) {
                     const auto newSymbol = generatePrimedSymbol(current);
-                    newProductions.push_back({production[i], newSymbol});
+                    if (mapping != nullptr) {
+                        mapping->binarizedSymbols.insert(newSymbol);
+                    }
+                    if (i == 0) {
+                        newProductions.push_back({production[i], newSymbol});
+                        inheritWeight(head, newProductions.back(), head, production);
+                    } else {
+                        _productions[current].push_back({production[i], newSymbol});
+                    }
                     _productions[newSymbol] = {};
                     current = newSymbol;
                 }
@@ -118,6 +176,10 @@ void ContextFreeGrammar::toChomskyNormalForm() {
         _productions[head] = newProductions;
     }
 
+    if (mapping != nullptr) {
+        mapping->binarizedProductions = _productions;
+    }
+
     unordered_set<Symbol> nullable;
     bool changed = true;
     while (changed) {
@@ -142,13 +204,44 @@ void ContextFreeGrammar::toChomskyNormalForm() {
         }
     }
 
+    // The probability that a nullable symbol derives ε.
+    unordered_map<Symbol, double> emptyProbabilities;
+    if (weighted) {
+        vector<Symbol> nullableSymbols;
+        for (const auto& head : _ordering) {
+            if (nullable.contains(head)) {
+                nullableSymbols.push_back(head);
+            }
+        }
+        emptyProbabilities = solveWeightSums(nullableSymbols, [&](const Symbol& head, const unordered_map<Symbol, double>& probabilities) {
+            double sum = 0.0;
+            for (const auto& production : _productions.at(head)) {
+                double probability = weightOf(head, production);
+                for (const auto& symbol : production) {
+                    if (symbol != EMPTY_SYMBOL) {
+                        probability *= nullable.contains(symbol) ? probabilities.at(symbol) : 0.0;
+                    }
+                }
+                sum += probability;
+            }
+            return sum;
+        });
+    }
+
     const auto& startSymbol = _ordering[0];
     for (auto& [head, productions] : _productions) {
         Productions newProductions;
+        unordered_map<string, WeightSum> newWeights;
         for (const auto& production : productions) {
+            const auto sourceKey = computeProductionKey(head, production);
+            const bool isExplicit = _weights.contains(sourceKey);
+            const double weight = weightOf(head, production);
             if (production.size() == 1 && production[0] == EMPTY_SYMBOL) {
                 if (head == startSymbol) {
                     newProductions.push_back(production);
+                    auto& [sum, sumIsExplicit] = newWeights[sourceKey];
+                    sum += weight;
+                    sumIsExplicit |= isExplicit;
                 }
                 continue;
             }
@@ -164,9 +257,13 @@ void ContextFreeGrammar::toChomskyNormalForm() {
             for (size_t mask = 0; mask < subsets; ++mask) {
                 Production newProduction;
                 unordered_set<size_t> skipIndices;
+                double probability = weight;
                 for (size_t i = 0; i < nullableIndices.size(); ++i) {
                     if (mask & (1u << i)) {
                         skipIndices.insert(nullableIndices[i]);
+                        if (weighted) {
+                            probability *= emptyProbabilities.at(production[nullableIndices[i]]);
+                        }
                     }
                 }
                 for (size_t i = 0; i < production.size(); ++i) {
@@ -178,10 +275,21 @@ void ContextFreeGrammar::toChomskyNormalForm() {
                     newProductions.push_back(newProduction);
                 } else if (head == startSymbol) {
                     newProductions.push_back({EMPTY_SYMBOL});
+                } else {
+                    continue;
                 }
+                auto& [sum, sumIsExplicit] = newWeights[computeProductionKey(head, newProductions.back())];
+                sum += probability;
+                sumIsExplicit |= isExplicit;
             }
         }
         _productions[head] = newProductions;
+        if (weighted) {
+            // The weights are written after all the productions of the head are read.
+            for (const auto& [key, weightSum] : newWeights) {
+                setSummedWeight(key, weightSum);
+            }
+        }
     }
 
     unordered_map<Symbol, unordered_set<Symbol>> unitGraph;
@@ -193,6 +301,10 @@ void ContextFreeGrammar::toChomskyNormalForm() {
         }
     }
 
+    // The probabilities of the unit derivations between the symbols, summed over the paths.
+    unordered_map<Symbol, unordered_map<Symbol, double>> unitProbabilities;
+    const auto sourceProductions = _productions;
+    const auto sourceWeights = _weights;
     unordered_map<Symbol, unordered_set<Symbol>> reachable;
     for (const auto& head : _ordering) {
         queue<Symbol> q;
@@ -208,6 +320,23 @@ void ContextFreeGrammar::toChomskyNormalForm() {
                 }
             }
         }
+        if (weighted) {
+            vector<Symbol> reachableSymbols;
+            for (const auto& symbol : _ordering) {
+                if (reachable[head].contains(symbol)) {
+                    reachableSymbols.push_back(symbol);
+                }
+            }
+            unitProbabilities[head] = solveWeightSums(reachableSymbols, [&](const Symbol& symbol, const unordered_map<Symbol, double>& probabilities) {
+                double sum = symbol == head ? 1.0 : 0.0;
+                for (const auto& from : reachableSymbols) {
+                    if (unitGraph[from].contains(symbol)) {
+                        sum += probabilities.at(from) * weightOf(from, {symbol});
+                    }
+                }
+                return sum;
+            });
+        }
     }
 
     for (auto& [head, productions] : _productions) {
@@ -236,6 +365,28 @@ void ContextFreeGrammar::toChomskyNormalForm() {
         }
         _productions[head] = newProductions;
     }
+    if (weighted) {
+        // The productions of the reachable symbols may already include their own unit derivations,
+        // so the weights are computed from the productions before the elimination.
+        for (const auto& [head, probabilities] : unitProbabilities) {
+            unordered_map<string, WeightSum> newWeights;
+            for (const auto& [symbol, probability] : probabilities) {
+                for (const auto& production : sourceProductions.at(symbol)) {
+                    if (production.size() == 1 && isNonTerminal(production[0])) {
+                        continue;
+                    }
+                    const auto sourceKey = computeProductionKey(symbol, production);
+                    const auto it = sourceWeights.find(sourceKey);
+                    auto& [sum, sumIsExplicit] = newWeights[computeProductionKey(head, production)];
+                    sum += probability * (it == sourceWeights.end() ? 1.0 : it->second);
+                    sumIsExplicit |= it != sourceWeights.end();
+                }
+            }
+            for (const auto& [key, weightSum] : newWeights) {
+                setSummedWeight(key, weightSum);
+            }
+        }
+    }
 
     unordered_set<Symbol> reachableFromStart;
     queue<Symbol> reachQueue;
@@ -266,4 +417,203 @@ void ContextFreeGrammar::toChomskyNormalForm() {
 
     deduplicate();
     initTerminals();
+    pruneWeights();
+}
+
+static shared_ptr<ParseTreeNode> copyParseTree(const shared_ptr<ParseTreeNode>& tree) {
+    auto node = make_shared<ParseTreeNode>();
+    node->terminal = tree->terminal;
+    node->label = tree->label;
+    for (const auto& child : tree->children) {
+        node->children.push_back(copyParseTree(child));
+    }
+    return node;
+}
+
+ChomskyNormalForm ContextFreeGrammar::compileChomskyNormalForm() const {
+    ChomskyNormalForm result;
+    result.grammar = *this;
+    result.grammar.convertToChomskyNormalForm(&result);
+    if (_ordering.empty()) {
+        return result;
+    }
+    result.originalStart = _ordering[0];
+    const auto& productions = result.binarizedProductions;
+
+    // Each round only uses the trees found in the previous rounds, so the trees are the shallowest.
+    while (true) {
+        unordered_map<Symbol, shared_ptr<ParseTreeNode>> found;
+        for (const auto& [head, headProductions] : productions) {
+            if (result.emptyDerivations.contains(head)) {
+                continue;
+            }
+            for (const auto& production : headProductions) {
+                if (ranges::all_of(production, [&](const Symbol& symbol) { return symbol == EMPTY_SYMBOL || result.emptyDerivations.contains(symbol); })) {
+                    auto node = make_shared<ParseTreeNode>();
+                    node->terminal = false;
+                    node->label = head;
+                    for (const auto& symbol : production) {
+                        if (symbol == EMPTY_SYMBOL) {
+                            auto leaf = make_shared<ParseTreeNode>();
+                            leaf->terminal = true;
+                            leaf->label = EMPTY_SYMBOL;
+                            node->children.push_back(leaf);
+                        } else {
+                            node->children.push_back(result.emptyDerivations.at(symbol));
+                        }
+                    }
+                    found[head] = node;
+                    break;
+                }
+            }
+        }
+        if (found.empty()) {
+            break;
+        }
+        result.emptyDerivations.merge(found);
+    }
+
+    // A production becomes a unit production if all but one of its symbols are removed.
+    unordered_map<Symbol, vector<Symbol>> units;
+    for (const auto& [head, headProductions] : productions) {
+        for (const auto& production : headProductions) {
+            if (production.size() == 1 && production[0] == EMPTY_SYMBOL) {
+                continue;
+            }
+            vector<size_t> nullableIndices;
+            for (size_t i = 0; i < production.size(); ++i) {
+                if (result.emptyDerivations.contains(production[i])) {
+                    nullableIndices.push_back(i);
+                }
+            }
+            const size_t subsets = 1u << nullableIndices.size();
+            for (size_t mask = 0; mask < subsets; ++mask) {
+                vector removed(production.size(), false);
+                for (size_t i = 0; i < nullableIndices.size(); ++i) {
+                    if (mask & (1u << i)) {
+                        removed[nullableIndices[i]] = true;
+                    }
+                }
+                Production shortened;
+                for (size_t i = 0; i < production.size(); ++i) {
+                    if (!removed[i]) {
+                        shortened.push_back(production[i]);
+                    }
+                }
+                if (shortened.empty()) {
+                    continue;
+                }
+                const auto key = computeProductionKey(head, shortened);
+                if (result.derivations.try_emplace(key, ChomskyNormalFormDerivation{production, removed}).second
+                    && shortened.size() == 1 && productions.contains(shortened[0])) {
+                    units[head].push_back(shortened[0]);
+                }
+            }
+        }
+    }
+
+    for (const auto& head : productions | views::keys) {
+        auto& chains = result.unitChains[head];
+        unordered_set<Symbol> visited = {head};
+        chains.push_back({head});
+        for (size_t i = 0; i < chains.size(); ++i) {
+            for (const auto& next : units[chains[i].back()]) {
+                if (!visited.contains(next)) {
+                    visited.insert(next);
+                    auto chain = chains[i];
+                    chain.push_back(next);
+                    chains.push_back(chain);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+CYKTable ChomskyNormalForm::cykParse(const string& s) const {
+    auto result = grammar.cykParse(s);
+    result.parseTree = restoreParseTree(result.parseTree);
+    return result;
+}
+
+shared_ptr<ParseTreeNode> ChomskyNormalForm::restoreParseTree(const shared_ptr<ParseTreeNode>& tree) const {
+    if (tree == nullptr) {
+        return nullptr;
+    }
+    // Restore the eliminated unit productions and nullable symbols.
+    function<shared_ptr<ParseTreeNode>(const shared_ptr<ParseTreeNode>&)> rebuild = [&](const shared_ptr<ParseTreeNode>& node) {
+        if (node->terminal) {
+            return copyParseTree(node);
+        }
+        const auto& head = node->label;
+        if (node->children.size() == 1 && node->children[0]->terminal && node->children[0]->label == ContextFreeGrammar::EMPTY_SYMBOL) {
+            if (const auto it = emptyDerivations.find(head); it != emptyDerivations.end()) {
+                return copyParseTree(it->second);
+            }
+        }
+        vector<shared_ptr<ParseTreeNode>> children;
+        Production shortened;
+        for (const auto& child : node->children) {
+            children.push_back(rebuild(child));
+            shortened.push_back(child->label);
+        }
+        if (const auto chains = unitChains.find(head); chains != unitChains.end()) {
+            for (const auto& chain : chains->second) {
+                const auto it = derivations.find(ContextFreeGrammar::computeProductionKey(chain.back(), shortened));
+                if (it == derivations.end()) {
+                    continue;
+                }
+                const auto& [production, removed] = it->second;
+                auto current = make_shared<ParseTreeNode>();
+                current->terminal = false;
+                current->label = chain.back();
+                for (size_t i = 0, j = 0; i < production.size(); ++i) {
+                    current->children.push_back(removed[i] ? copyParseTree(emptyDerivations.at(production[i])) : children[j++]);
+                }
+                for (size_t i = chain.size() - 1; i > 0; --i) {
+                    const auto& [unitProduction, unitRemoved] = derivations.at(ContextFreeGrammar::computeProductionKey(chain[i - 1], {chain[i]}));
+                    auto parent = make_shared<ParseTreeNode>();
+                    parent->terminal = false;
+                    parent->label = chain[i - 1];
+                    for (size_t k = 0; k < unitProduction.size(); ++k) {
+                        parent->children.push_back(unitRemoved[k] ? copyParseTree(emptyDerivations.at(unitProduction[k])) : current);
+                    }
+                    current = parent;
+                }
+                return current;
+            }
+        }
+        auto restored = make_shared<ParseTreeNode>();
+        restored->terminal = false;
+        restored->label = head;
+        restored->children = children;
+        return restored;
+    };
+    // Remove the terminal wrappers and the binarized symbols.
+    function<void(const shared_ptr<ParseTreeNode>&, vector<shared_ptr<ParseTreeNode>>&)> flatten = [&](const shared_ptr<ParseTreeNode>& node, vector<shared_ptr<ParseTreeNode>>& siblings) {
+        if (const auto it = terminalWrappers.find(node->label); !node->terminal && it != terminalWrappers.end()) {
+            node->terminal = true;
+            node->label = it->second;
+            node->children.clear();
+            siblings.push_back(node);
+            return;
+        }
+        vector<shared_ptr<ParseTreeNode>> children;
+        for (const auto& child : node->children) {
+            flatten(child, children);
+        }
+        if (!node->terminal && binarizedSymbols.contains(node->label)) {
+            siblings.insert(siblings.end(), children.begin(), children.end());
+        } else {
+            node->children = std::move(children);
+            siblings.push_back(node);
+        }
+    };
+    vector<shared_ptr<ParseTreeNode>> roots;
+    flatten(rebuild(tree), roots);
+    auto restored = roots[0];
+    if (!newStart.empty() && restored->label == newStart && restored->children.size() == 1) {
+        return restored->children[0];
+    }
+    return restored;
 }
@@ -1,4 +1,5 @@
 #include "cfg.h"
+#include "parse_forest.h"
 #include <sstream>
 #include <algorithm>
 #include <ranges>
@@ -31,7 +32,7 @@ string CYKTable::getCellString(const size_t r, const size_t c, const string& sep
     return result;
 }
 
-CYKTable ContextFreeGrammar::cykParse(const string& s) const {
+CYKTable ContextFreeGrammar::cykParse(const string& s, const bool buildForest) const {
     vector<Symbol> tokens;
     istringstream iss(s);
     string token;
@@ -41,6 +42,9 @@ CYKTable ContextFreeGrammar::cykParse(const string& s) const {
 
     size_t n = tokens.size();
     CYKTable result(n);
+    if (buildForest) {
+        result.forest = make_shared<ParseForest>();
+    }
 
     if (n == 0) {
         if (!_ordering.empty()) {
@@ -49,6 +53,11 @@ CYKTable ContextFreeGrammar::cykParse(const string& s) const {
                 for (const auto& production : productions) {
                     if (production.size() == 1 && production[0] == EMPTY_SYMBOL && head == startSymbol) {
                         result.accepted = true;
+                        if (buildForest) {
+                            const auto root = result.forest->addNode(ParseForestNode::Type::SYMBOL, startSymbol, 0, 0);
+                            result.forest->addPackedNode(root, {});
+                            result.forest->setRoot(root);
+                        }
                         result.parseTree = make_shared<ParseTreeNode>();
                         result.parseTree->terminal = false;
                         result.parseTree->label = startSymbol;
@@ -86,6 +95,10 @@ CYKTable ContextFreeGrammar::cykParse(const string& s) const {
         bool isTerminal{};
     };
     vector backPointers(n, vector<unordered_map<Symbol, BackPointer>>(n));
+    // Forest nodes use half-open spans, the cell [r][c] covers tokens [r, c + 1).
+    auto addForestNode = [&](const Symbol& symbol, const size_t r, const size_t c) {
+        return result.forest->addNode(ParseForestNode::Type::SYMBOL, symbol, r, c + 1);
+    };
 
     for (size_t i = 0; i < n; ++i) {
         const auto& terminal = tokens[i];
@@ -93,6 +106,10 @@ CYKTable ContextFreeGrammar::cykParse(const string& s) const {
             for (const auto& nt : terminalToNonTerminal[terminal]) {
                 result.table[i][i].push_back(nt);
                 backPointers[i][i][nt] = {terminal, 0, "", "", true};
+                if (buildForest) {
+                    const auto leaf = result.forest->addNode(ParseForestNode::Type::TERMINAL, terminal, i, i + 1);
+                    result.forest->addPackedNode(addForestNode(nt, i, i), {leaf});
+                }
             }
         }
     }
@@ -111,6 +128,9 @@ CYKTable ContextFreeGrammar::cykParse(const string& s) const {
                                     result.table[i][j].push_back(A);
                                     backPointers[i][j][A] = {A, k, B, C, false};
                                 }
+                                if (buildForest) {
+                                    result.forest->addPackedNode(addForestNode(A, i, j), {addForestNode(B, i, k), addForestNode(C, k + 1, j)});
+                                }
                             }
                         }
                     }
@@ -153,6 +173,9 @@ CYKTable ContextFreeGrammar::cykParse(const string& s) const {
         };
 
         result.parseTree = buildTree(0, n - 1, _ordering[0]);
+        if (buildForest) {
+            result.forest->setRoot(addForestNode(_ordering[0], 0, n - 1));
+        }
     }
 
     return result;
@@ -0,0 +1,476 @@
+#include "cfg.h"
+#include "parse_forest.h"
+#include <sstream>
+#include <algorithm>
+#include <limits>
+#include <functional>
+
+using namespace std;
+
+/**
+ * The grammar compiled into integer arrays.
+ *
+ * Symbols: non-terminals in [0, numNonTerminals), the augmented start symbol is the last non-terminal,
+ * terminals follow the non-terminals.
+ * Each production A -> X₁...Xₖ occupies k + 1 consecutive dotted rules, the i-th one has the dot before Xᵢ₊₁.
+ */
+struct EarleyGrammar {
+    static constexpr uint32_t END = numeric_limits<uint32_t>::max();
+
+    uint32_t numNonTerminals = 0;
+    uint32_t start = 0;
+    vector<Symbol> names;
+    unordered_map<Symbol, uint32_t> symbolIds;
+    vector<uint32_t> productionBegin;       // The first dotted rule of each production
+    vector<uint32_t> productionHead;
+    vector<uint32_t> ruleProduction;        // The production of each dotted rule
+    vector<uint32_t> ruleSymbol;            // The symbol after the dot, END if the rule is completed
+    vector<uint32_t> nonTerminalBegin;      // Productions of non-terminal A are in [nonTerminalBegin[A], nonTerminalBegin[A + 1])
+    vector<uint32_t> nullableProduction;    // The production with the lowest ε-derivation, END if not nullable
+
+    [[nodiscard]] uint32_t head(const uint32_t rule) const {
+        return productionHead[ruleProduction[rule]];
+    }
+
+    [[nodiscard]] bool isNullable(const uint32_t symbol) const {
+        return symbol < numNonTerminals && nullableProduction[symbol] != END;
+    }
+
+    [[nodiscard]] string ruleToString(const uint32_t rule) const {
+        const auto production = ruleProduction[rule];
+        string result = names[productionHead[production]] + " ->";
+        for (auto i = productionBegin[production]; ; ++i) {
+            if (i == rule) {
+                result += " " + ContextFreeGrammar::DOT_SYMBOL;
+            }
+            if (ruleSymbol[i] == END) {
+                break;
+            }
+            result += " " + names[ruleSymbol[i]];
+        }
+        return result;
+    }
+};
+
+size_t EarleyChart::size() const {
+    return n;
+}
+
+size_t EarleyChart::numItems() const {
+    size_t result = 0;
+    for (const auto& set : sets) {
+        result += set.size();
+    }
+    return result;
+}
+
+vector<string> EarleyChart::getSet(const size_t index) const {
+    vector<string> result;
+    if (index >= sets.size()) {
+        return result;
+    }
+    for (const auto& item : sets[index]) {
+        result.emplace_back(grammar->ruleToString(item.rule) + ", " + to_string(item.origin));
+    }
+    return result;
+}
+
+static shared_ptr<EarleyGrammar> compileEarleyGrammar(
+    const vector<Symbol>& ordering,
+    const unordered_map<Symbol, Productions>& productions,
+    const unordered_set<Symbol>& terminals) {
+    constexpr auto END = EarleyGrammar::END;
+    auto grammar = make_shared<EarleyGrammar>();
+    auto& g = *grammar;
+
+    // The augmented start symbol is only used for display.
+    auto startName = ordering[0] + "'";
+    while (productions.contains(startName) || terminals.contains(startName)) {
+        startName += "'";
+    }
+    for (const auto& head : ordering) {
+        g.symbolIds[head] = static_cast<uint32_t>(g.names.size());
+        g.names.emplace_back(head);
+    }
+    g.start = static_cast<uint32_t>(g.names.size());
+    g.names.emplace_back(startName);
+    g.numNonTerminals = static_cast<uint32_t>(g.names.size());
+    vector sortedTerminals(terminals.begin(), terminals.end());
+    ranges::sort(sortedTerminals);
+    for (const auto& terminal : sortedTerminals) {
+        g.symbolIds[terminal] = static_cast<uint32_t>(g.names.size());
+        g.names.emplace_back(terminal);
+    }
+
+    auto addProduction = [&](const uint32_t head, const Production& production) {
+        const auto index = static_cast<uint32_t>(g.productionHead.size());
+        g.productionHead.emplace_back(head);
+        g.productionBegin.emplace_back(static_cast<uint32_t>(g.ruleSymbol.size()));
+        for (const auto& symbol : production) {
+            if (symbol != ContextFreeGrammar::EMPTY_SYMBOL) {
+                g.ruleProduction.emplace_back(index);
+                g.ruleSymbol.emplace_back(g.symbolIds.at(symbol));
+            }
+        }
+        g.ruleProduction.emplace_back(index);
+        g.ruleSymbol.emplace_back(END);
+    };
+    for (uint32_t head = 0; head < g.start; ++head) {
+        g.nonTerminalBegin.emplace_back(static_cast<uint32_t>(g.productionHead.size()));
+        for (const auto& production : productions.at(g.names[head])) {
+            addProduction(head, production);
+        }
+    }
+    g.nonTerminalBegin.emplace_back(static_cast<uint32_t>(g.productionHead.size()));
+    addProduction(g.start, {ordering[0]});
+    g.nonTerminalBegin.emplace_back(static_cast<uint32_t>(g.productionHead.size()));
+
+    // Assign nullable productions round by round, so that the chosen ε-derivations never form cycles.
+    g.nullableProduction.assign(g.numNonTerminals, END);
+    bool hasUpdate = true;
+    while (hasUpdate) {
+        hasUpdate = false;
+        vector<pair<uint32_t, uint32_t>> assigned;
+        for (uint32_t head = 0; head < g.numNonTerminals; ++head) {
+            if (g.nullableProduction[head] != END) {
+                continue;
+            }
+            for (auto p = g.nonTerminalBegin[head]; p < g.nonTerminalBegin[head + 1]; ++p) {
+                bool nullable = true;
+                for (auto rule = g.productionBegin[p]; g.ruleSymbol[rule] != END; ++rule) {
+                    if (!g.isNullable(g.ruleSymbol[rule])) {
+                        nullable = false;
+                        break;
+                    }
+                }
+                if (nullable) {
+                    assigned.emplace_back(head, p);
+                    break;
+                }
+            }
+        }
+        for (const auto& [head, p] : assigned) {
+            g.nullableProduction[head] = p;
+            hasUpdate = true;
+        }
+    }
+    return grammar;
+}
+
+/**
+ * Earley parsing.
+ *
+ * For each position j, the set Sⱼ contains items [A -> α · β, i] meaning α derives the tokens in [i, j).
+ * - Predict: [A -> α · B β, i] adds [B -> · γ, j]; if B is nullable, also adds [A -> α B · β, i] (Aycock-Horspool).
+ * - Scan: [A -> α · a β, i] adds [A -> α a · β, i] to Sⱼ₊₁ if the j-th token is a.
+ * - Complete: [B -> γ ·, k] advances the items in Sₖ that wait for B.
+ *   If Sₖ has exactly one item waiting for B and B is its last symbol, the completions form a deterministic path,
+ *   and only the topmost completed item is added (Leo). This makes right recursions linear.
+ */
+EarleyChart ContextFreeGrammar::earleyParse(const string& s, const bool buildForest) const {
+    constexpr auto END = EarleyGrammar::END;
+    using Link = EarleyItem::Link;
+
+    vector<Symbol> tokens;
+    istringstream iss(s);
+    string token;
+    while (iss >> token) {
+        if (token != EMPTY_SYMBOL) {
+            tokens.push_back(token);
+        }
+    }
+
+    EarleyChart result;
+    result.n = tokens.size();
+    if (buildForest) {
+        result.forest = make_shared<ParseForest>();
+    }
+    if (_ordering.empty()) {
+        return result;
+    }
+    const auto grammar = compileEarleyGrammar(_ordering, _productions, _terminals);
+    const auto& g = *grammar;
+    result.grammar = grammar;
+    const auto n = tokens.size();
+    auto& sets = result.sets;
+    sets.resize(n + 1);
+
+    vector<uint32_t> tokenIds(n, END);
+    for (size_t i = 0; i < n; ++i) {
+        if (const auto it = g.symbolIds.find(tokens[i]); it != g.symbolIds.end() && it->second >= g.numNonTerminals) {
+            tokenIds[i] = it->second;
+        }
+    }
+
+    // The items waiting for each non-terminal, packed as (symbol << 32 | index) and sorted once a set is finished.
+    vector<vector<uint64_t>> waiting(n + 1);
+    auto findWaiting = [&](const size_t k, const uint32_t symbol) {
+        const auto& packed = waiting[k];
+        const auto first = ranges::lower_bound(packed, static_cast<uint64_t>(symbol) << 32);
+        const auto last = ranges::lower_bound(packed, static_cast<uint64_t>(symbol + 1) << 32);
+        return make_pair(first - packed.begin(), last - packed.begin());
+    };
+
+    struct LeoEntry {
+        bool exists = false;
+        bool next = false;            // Whether the path continues in the origin set of the penultimate item
+        uint32_t penultimate = 0;     // The unique waiting item in the set
+        uint32_t topRule = 0;
+        uint32_t topOrigin = 0;
+    };
+    unordered_map<uint64_t, LeoEntry> leoEntries;
+    function<LeoEntry(size_t, uint32_t)> leoAt = [&](const size_t k, const uint32_t symbol) -> LeoEntry {
+        const auto key = static_cast<uint64_t>(k) << 32 | symbol;
+        if (const auto it = leoEntries.find(key); it != leoEntries.end()) {
+            return it->second;
+        }
+        LeoEntry entry;
+        if (const auto [first, last] = findWaiting(k, symbol); last - first == 1) {
+            const auto index = static_cast<uint32_t>(waiting[k][first] & 0xffffffffu);
+            if (const auto& item = sets[k][index]; g.ruleSymbol[item.rule + 1] == END) {
+                entry.exists = true;
+                entry.penultimate = index;
+                entry.topRule = item.rule + 1;
+                entry.topOrigin = item.origin;
+                if (item.origin < k) {
+                    if (const auto up = leoAt(item.origin, g.head(item.rule)); up.exists) {
+                        entry.next = true;
+                        entry.topRule = up.topRule;
+                        entry.topOrigin = up.topOrigin;
+                    }
+                }
+            }
+        }
+        leoEntries[key] = entry;
+        return entry;
+    };
+
+    unordered_map<uint64_t, uint32_t> seen;
+    // In forest mode, the links of the items that are derived more than once.
+    unordered_map<uint64_t, vector<EarleyItem>> extraLinks;
+    vector<uint32_t> predicted(g.numNonTerminals, END);
+    size_t processed = 0;
+    for (size_t j = 0; j <= n; ++j) {
+        processed = j;
+        auto& set = sets[j];
+        seen.clear();
+        auto add = [&](const EarleyItem& item) {
+            const auto [it, inserted] = seen.emplace(static_cast<uint64_t>(item.rule) << 32 | item.origin, static_cast<uint32_t>(set.size()));
+            if (inserted) {
+                if (const auto symbol = g.ruleSymbol[item.rule]; symbol < g.numNonTerminals) {
+                    waiting[j].emplace_back(static_cast<uint64_t>(symbol) << 32 | set.size());
+                }
+                set.emplace_back(item);
+            } else if (buildForest && item.link != Link::PREDICT) {
+                extraLinks[static_cast<uint64_t>(j) << 32 | it->second].emplace_back(item);
+            }
+        };
+        // The scanned items are distinct by construction.
+        for (uint32_t t = 0; t < set.size(); ++t) {
+            seen.emplace(static_cast<uint64_t>(set[t].rule) << 32 | set[t].origin, t);
+            if (const auto symbol = g.ruleSymbol[set[t].rule]; symbol < g.numNonTerminals) {
+                waiting[j].emplace_back(static_cast<uint64_t>(symbol) << 32 | t);
+            }
+        }
+        if (j == 0) {
+            add({g.productionBegin[g.nonTerminalBegin[g.start]], 0});
+        }
+        for (uint32_t t = 0; t < set.size(); ++t) {
+            const auto item = set[t];
+            const auto symbol = g.ruleSymbol[item.rule];
+            if (symbol == END) {
+                const auto head = g.head(item.rule);
+                const auto k = item.origin;
+                if (k == j) {
+                    // The waiting items added later are advanced by the nullable prediction.
+                    for (size_t w = 0; w < waiting[j].size(); ++w) {
+                        if (waiting[j][w] >> 32 == head) {
+                            const auto index = static_cast<uint32_t>(waiting[j][w] & 0xffffffffu);
+                            add({set[index].rule + 1, set[index].origin, index, t, Link::COMPLETE});
+                        }
+                    }
+                } else if (const auto leo = buildForest ? LeoEntry{} : leoAt(k, head); leo.exists) {
+                    add({leo.topRule, leo.topOrigin, 0, t, Link::LEO});
+                } else {
+                    const auto [first, last] = findWaiting(k, head);
+                    for (auto w = first; w < last; ++w) {
+                        const auto index = static_cast<uint32_t>(waiting[k][w] & 0xffffffffu);
+                        const auto& waitingItem = sets[k][index];
+                        add({waitingItem.rule + 1, waitingItem.origin, index, t, Link::COMPLETE});
+                    }
+                }
+            } else if (symbol < g.numNonTerminals) {
+                if (predicted[symbol] != j) {
+                    predicted[symbol] = static_cast<uint32_t>(j);
+                    for (auto p = g.nonTerminalBegin[symbol]; p < g.nonTerminalBegin[symbol + 1]; ++p) {
+                        add({g.productionBegin[p], static_cast<uint32_t>(j)});
+                    }
+                }
+                if (g.isNullable(symbol)) {
+                    add({item.rule + 1, item.origin, t, symbol, Link::NULLABLE});
+                }
+            } else if (j < n && tokenIds[j] == symbol) {
+                sets[j + 1].push_back({item.rule + 1, item.origin, t, 0, Link::SCAN});
+            }
+        }
+        ranges::sort(waiting[j]);
+        if (j < n && sets[j + 1].empty()) {
+            break;
+        }
+    }
+    if (processed < n) {
+        return result;
+    }
+
+    const auto acceptRule = g.productionBegin[g.nonTerminalBegin[g.start]] + 1;
+    uint32_t acceptIndex = END;
+    for (uint32_t t = 0; t < sets[n].size(); ++t) {
+        if (sets[n][t].rule == acceptRule && sets[n][t].origin == 0) {
+            acceptIndex = t;
+            break;
+        }
+    }
+    if (acceptIndex == END) {
+        return result;
+    }
+    result.accepted = true;
+
+    auto newNode = [](const Symbol& label, const bool terminal) {
+        auto node = make_shared<ParseTreeNode>();
+        node->terminal = terminal;
+        node->label = label;
+        return node;
+    };
+    function<shared_ptr<ParseTreeNode>(uint32_t)> buildNullable = [&](const uint32_t symbol) {
+        auto node = newNode(g.names[symbol], false);
+        const auto production = g.nullableProduction[symbol];
+        for (auto rule = g.productionBegin[production]; g.ruleSymbol[rule] != END; ++rule) {
+            node->children.emplace_back(buildNullable(g.ruleSymbol[rule]));
+        }
+        if (node->children.empty()) {
+            node->children.emplace_back(newNode(EMPTY_SYMBOL, true));
+        }
+        return node;
+    };
+    function<shared_ptr<ParseTreeNode>(size_t, uint32_t)> buildCompleted;
+    // Collect the children before the dot in reversed order by following the links back to the prediction.
+    auto collectChildren = [&](size_t j, uint32_t t, vector<shared_ptr<ParseTreeNode>>& children) {
+        while (true) {
+            const auto& item = sets[j][t];
+            switch (item.link) {
+                case Link::PREDICT:
+                case Link::LEO:
+                    return;
+                case Link::SCAN:
+                    children.emplace_back(newNode(tokens[j - 1], true));
+                    t = item.prefix;
+                    --j;
+                    break;
+                case Link::COMPLETE: {
+                    children.emplace_back(buildCompleted(j, item.child));
+                    const auto origin = sets[j][item.child].origin;
+                    t = item.prefix;
+                    j = origin;
+                    break;
+                }
+                case Link::NULLABLE:
+                    children.emplace_back(buildNullable(item.child));
+                    t = item.prefix;
+                    break;
+            }
+        }
+    };
+    auto finishNode = [&](const uint32_t head, vector<shared_ptr<ParseTreeNode>>& children) {
+        auto node = newNode(g.names[head], false);
+        if (children.empty()) {
+            node->children.emplace_back(newNode(EMPTY_SYMBOL, true));
+        } else {
+            node->children.assign(children.rbegin(), children.rend());
+        }
+        return node;
+    };
+    buildCompleted = [&](const size_t j, const uint32_t t) -> shared_ptr<ParseTreeNode> {
+        const auto& item = sets[j][t];
+        if (item.link != Link::LEO) {
+            vector<shared_ptr<ParseTreeNode>> children;
+            collectChildren(j, t, children);
+            return finishNode(g.head(item.rule), children);
+        }
+        // Expand the deterministic reduction path skipped by the Leo item from the bottom.
+        auto node = buildCompleted(j, item.child);
+        size_t k = sets[j][item.child].origin;
+        auto symbol = g.head(sets[j][item.child].rule);
+        while (true) {
+            const auto& entry = leoEntries.at(static_cast<uint64_t>(k) << 32 | symbol);
+            const auto& penultimate = sets[k][entry.penultimate];
+            vector children = {node};
+            collectChildren(k, entry.penultimate, children);
+            node = finishNode(g.head(penultimate.rule), children);
+            if (!entry.next) {
+                break;
+            }
+            symbol = g.head(penultimate.rule);
+            k = penultimate.origin;
+        }
+        return node;
+    };
+    result.parseTree = buildCompleted(n, acceptIndex)->children[0];
+
+    if (buildForest) {
+        // Each item with a non-empty prefix is a node: completed items are symbol nodes shared by (head, origin, j),
+        // and the others are intermediate nodes. Each link of the item is a packed node of (prefix, child).
+        auto& forest = *result.forest;
+        auto itemNode = [&](const size_t j, const uint32_t t) -> size_t {
+            const auto& item = sets[j][t];
+            if (g.ruleSymbol[item.rule] == END) {
+                return forest.addNode(ParseForestNode::Type::SYMBOL, g.names[g.head(item.rule)], item.origin, j);
+            }
+            if (item.rule == g.productionBegin[g.ruleProduction[item.rule]]) {
+                return ParseForest::NONE;
+            }
+            return forest.addNode(ParseForestNode::Type::INTERMEDIATE, g.ruleToString(item.rule), item.origin, j);
+        };
+        auto addLink = [&](const size_t j, const uint32_t t, const EarleyItem& link) {
+            const auto parent = itemNode(j, t);
+            if (parent == ParseForest::NONE) {
+                return;
+            }
+            vector<size_t> children;
+            auto addChild = [&](const size_t child) {
+                if (child != ParseForest::NONE) {
+                    children.emplace_back(child);
+                }
+            };
+            switch (link.link) {
+                case Link::PREDICT:
+                case Link::LEO:
+                    break;
+                case Link::SCAN:
+                    addChild(itemNode(j - 1, link.prefix));
+                    addChild(forest.addNode(ParseForestNode::Type::TERMINAL, tokens[j - 1], j - 1, j));
+                    break;
+                case Link::COMPLETE:
+                    addChild(itemNode(sets[j][link.child].origin, link.prefix));
+                    addChild(itemNode(j, link.child));
+                    break;
+                case Link::NULLABLE:
+                    addChild(itemNode(j, link.prefix));
+                    addChild(forest.addNode(ParseForestNode::Type::SYMBOL, g.names[link.child], j, j));
+                    break;
+            }
+            forest.addPackedNode(parent, children);
+        };
+        for (size_t j = 0; j <= n; ++j) {
+            for (uint32_t t = 0; t < sets[j].size(); ++t) {
+                addLink(j, t, sets[j][t]);
+                if (const auto it = extraLinks.find(static_cast<uint64_t>(j) << 32 | t); it != extraLinks.end()) {
+                    for (const auto& link : it->second) {
+                        addLink(j, t, link);
+                    }
+                }
+            }
+        }
+        forest.setRoot(forest.findNode(ParseForestNode::Type::SYMBOL, g.names[0], 0, n));
+    }
+    return result;
+}
@@ -30,6 +30,93 @@ vector<string> FirstAndFollowSet::getFollowSet(const string& symbol) const {
     return result;
 }
 
+using ProductionList = vector<pair<Symbol, const Production*>>;
+
+/**
+ * Iterate the FIRST rules over the productions until no symbol is added.
+ */
+static void computeFirstSets(const ContextFreeGrammar& grammar, const ProductionList& productions, FirstAndFollowSet& result) {
+    bool hasUpdate = true;
+    while (hasUpdate) {
+        hasUpdate = false;
+        auto addToFirst = [&](const Symbol& head, const Symbol& symbol) {
+            if (auto& firstSet = result.first[head]; !firstSet.contains(symbol)) {
+                hasUpdate = true;
+                firstSet.insert(symbol);
+            }
+        };
+        for (const auto& [head, production] : productions) {
+            bool nullable = true;
+            for (const auto& symbol : *production) {
+                if (grammar.isNonTerminal(symbol)) {
+                    // Add FIRST(symbol) - {ε} to FIRST(head)
+                    for (const auto& firstSymbol : result.first[symbol]) {
+                        if (firstSymbol != ContextFreeGrammar::EMPTY_SYMBOL) {
+                            addToFirst(head, firstSymbol);
+                        }
+                    }
+                } else if (symbol != ContextFreeGrammar::EMPTY_SYMBOL) {
+                    addToFirst(head, symbol);
+                }
+                if (!result.getNullable(symbol)) {
+                    nullable = false;
+                    break;  // Stop if this symbol is not nullable
+                }
+            }
+            if (nullable) {
+                addToFirst(head, ContextFreeGrammar::EMPTY_SYMBOL);
+            }
+        }
+    }
+}
+
+/**
+ * Iterate the FOLLOW rules over the productions until no symbol is added.
+ * @param targets The symbols whose FOLLOW sets are computed, all the non-terminals if it is null.
+ */
+static void computeFollowSets(const ContextFreeGrammar& grammar, const ProductionList& productions, const unordered_set<Symbol>* targets, FirstAndFollowSet& result) {
+    bool hasUpdate = true;
+    while (hasUpdate) {
+        hasUpdate = false;
+        auto addToFollow = [&](const Symbol& head, const Symbol& symbol) {
+            if (auto& followSet = result.follow[head]; !followSet.contains(symbol)) {
+                hasUpdate = true;
+                followSet.insert(symbol);
+            }
+        };
+        for (const auto& [head, production] : productions) {
+            // Scan right-to-left to track if suffix is nullable
+            bool nullable = true;
+            for (int i = static_cast<int>(production->size()) - 1; i >= 0; --i) {
+                const auto& symbol = (*production)[i];
+                if (grammar.isNonTerminal(symbol) && (targets == nullptr || targets->contains(symbol))) {
+                    // Rule 3: If everything after production[i] is nullable,
+                    // add FOLLOW(head) to FOLLOW(production[i])
+                    if (nullable) {
+                        for (const auto& followSymbol : result.follow[head]) {
+                            addToFollow(symbol, followSymbol);
+                        }
+                    }
+                    // Rule 2: Add FIRST(β) - {ε} where β is production[i+1...]
+                    for (int j = i + 1; j < static_cast<int>(production->size()); ++j) {
+                        for (const auto& firstSymbol : result.first.at((*production)[j])) {
+                            if (firstSymbol != ContextFreeGrammar::EMPTY_SYMBOL) {
+                                addToFollow(symbol, firstSymbol);
+                            }
+                        }
+                        if (!result.getNullable((*production)[j])) {
+                            break;
+                        }
+                    }
+                }
+                if (!result.getNullable(symbol)) {
+                    nullable = false;
+                }
+            }
+        }
+    }
+}
+
 /**
  * Compute FIRST and FOLLOW sets for all non-terminals.
  *
@@ -52,9 +139,14 @@ FirstAndFollowSet ContextFreeGrammar::computeFirstAndFollowSet() const {
         return result;
     }
     result.ordering = _ordering;
+    ProductionList productions;
+    for (const auto& head : _ordering) {
+        for (const auto& production : _productions.at(head)) {
+            productions.emplace_back(head, &production);
+        }
+    }
 
     // FIRST set computation
-    bool hasUpdate = true;
     result.first[EMPTY_SYMBOL].insert(EMPTY_SYMBOL);
     for (const auto& symbol : _terminals) {
         result.first[symbol].insert(symbol);
@@ -62,86 +154,165 @@ FirstAndFollowSet ContextFreeGrammar::computeFirstAndFollowSet() const {
     for (const auto& symbol : _ordering) {
         result.first[symbol];
     }
-    while (hasUpdate) {
-        hasUpdate = false;
-        auto addToFirst = [&](const Symbol& head, const Symbol& symbol) {
-            if (auto& firstSet = result.first[head]; !firstSet.contains(symbol)) {
-                hasUpdate = true;
-                firstSet.insert(symbol);
-            }
-        };
-        for (const auto& head : _ordering) {
-            for (const auto& production : _productions.at(head)) {
-                bool nullable = true;
-                for (const auto& symbol : production) {
-                    if (isNonTerminal(symbol)) {
-                        // Add FIRST(symbol) - {ε} to FIRST(head)
-                        for (const auto& firstSymbol : result.first[symbol]) {
-                            if (firstSymbol != EMPTY_SYMBOL) {
-                                addToFirst(head, firstSymbol);
-                            }
-                        }
-                    } else if (symbol != EMPTY_SYMBOL) {
-                        addToFirst(head, symbol);
-                    }
-                    if (!result.getNullable(symbol)) {
-                        nullable = false;
-                        break;  // Stop if this symbol is not nullable
-                    }
-                }
-                if (nullable) {
-                    addToFirst(head, EMPTY_SYMBOL);
-                }
-            }
-        }
-    }
+    computeFirstSets(*this, productions, result);
 
     // FOLLOW set computation
-    hasUpdate = true;
     for (const auto& symbol : _ordering) {
         result.follow[symbol];
     }
     result.follow[_ordering[0]].insert(EOF_SYMBOL);  // Rule 1
-    while (hasUpdate) {
-        hasUpdate = false;
-        auto addToFollow = [&](const Symbol& head, const Symbol& symbol) {
-            if (auto& followSet = result.follow[head]; !followSet.contains(symbol)) {
-                hasUpdate = true;
-                followSet.insert(symbol);
+    computeFollowSets(*this, productions, nullptr, result);
+    return result;
+}
+
+unordered_set<Symbol> ContextFreeGrammar::changedHeads(const ContextFreeGrammar& other) const {
+    unordered_set<Symbol> heads;
+    for (const auto& [head, productions] : _productions) {
+        if (const auto it = other._productions.find(head); it == other._productions.end() || it->second != productions) {
+            heads.insert(head);
+        }
+    }
+    for (const auto& head : other._productions | views::keys) {
+        if (!_productions.contains(head)) {
+            heads.insert(head);
+        }
+    }
+    return heads;
+}
+
+/**
+ * The sets of the other symbols do not depend on the recomputed ones, so they are kept as the fixed points:
+ *
+ * - The FIRST set of a head can only change if it derives a changed head, which are found by the reversed occurrences.
+ * - The FOLLOW set of a symbol can only change if it is in a changed production, or a changed FIRST set is after it,
+ *   or it is the old or the new start symbol, or it receives the FOLLOW set of such a symbol by rule 3.
+ */
+FirstAndFollowSet ContextFreeGrammar::updateFirstAndFollowSet(const ContextFreeGrammar& previousGrammar, const FirstAndFollowSet& previous) const {
+    if (_ordering.empty() || previous.ordering.empty()) {
+        return computeFirstAndFollowSet();
+    }
+    const auto heads = changedHeads(previousGrammar);
+    FirstAndFollowSet result = previous;
+    result.ordering = _ordering;
+    for (const auto& head : heads) {
+        result.first.erase(head);
+        result.follow.erase(head);
+    }
+    erase_if(result.first, [&](const auto& item) {
+        return item.first != EMPTY_SYMBOL && !isTerminal(item.first) && !isNonTerminal(item.first);
+    });
+    for (const auto& symbol : _terminals) {
+        result.first.try_emplace(symbol, unordered_set{symbol});
+    }
+
+    // FIRST sets of the heads that derive the changed heads
+    unordered_map<Symbol, vector<Symbol>> users;
+    for (const auto& head : _ordering) {
+        for (const auto& production : _productions.at(head)) {
+            for (const auto& symbol : production) {
+                users[symbol].push_back(head);
             }
-        };
-        for (const auto& head : _ordering) {
-            for (const auto& production : _productions.at(head)) {
-                // Scan right-to-left to track if suffix is nullable
-                bool nullable = true;
-                for (int i = static_cast<int>(production.size()) - 1; i >= 0; --i) {
-                    if (isNonTerminal(production[i])) {
-                        // Rule 3: If everything after production[i] is nullable,
-                        // add FOLLOW(head) to FOLLOW(production[i])
-                        if (nullable) {
-                            for (const auto& followSymbol : result.follow[head]) {
-                                addToFollow(production[i], followSymbol);
-                            }
-                        }
-                        // Rule 2: Add FIRST(β) - {ε} where β is production[i+1...]
-                        for (int j = i + 1; j < static_cast<int>(production.size()); ++j) {
-                            for (const auto& firstSymbol : result.first.at(production[j])) {
-                                if (firstSymbol != EMPTY_SYMBOL) {
-                                    addToFollow(production[i], firstSymbol);
-                                }
-                            }
-                            if (!result.getNullable(production[j])) {
-                                break;
-                            }
-                        }
+        }
+    }
+    // The removed heads are terminals now, the heads that use them are also affected.
+    vector<Symbol> affected;
+    unordered_set<Symbol> affectedSet;
+    auto addUsers = [&](const Symbol& symbol) {
+        if (const auto it = users.find(symbol); it != users.end()) {
+            for (const auto& user : it->second) {
+                if (affectedSet.insert(user).second) {
+                    affected.push_back(user);
+                }
+            }
+        }
+    };
+    for (const auto& head : heads) {
+        if (isNonTerminal(head) && affectedSet.insert(head).second) {
+            affected.push_back(head);
+        } else if (!isNonTerminal(head)) {
+            addUsers(head);
+        }
+    }
+    for (size_t i = 0; i < affected.size(); ++i) {
+        addUsers(affected[i]);
+    }
+    ProductionList productions;
+    for (const auto& head : affected) {
+        result.first[head].clear();
+        for (const auto& production : _productions.at(head)) {
+            productions.emplace_back(head, &production);
+        }
+    }
+    computeFirstSets(*this, productions, result);
+    unordered_set<Symbol> changedFirst(heads);
+    for (const auto& head : affected) {
+        if (const auto it = previous.first.find(head); it == previous.first.end() || it->second != result.first.at(head)) {
+            changedFirst.insert(head);
+        }
+    }
+
+    // FOLLOW sets that may receive different symbols
+    vector<Symbol> targets;
+    unordered_set<Symbol> targetSet;
+    auto addTarget = [&](const Symbol& symbol) {
+        if (isNonTerminal(symbol) && targetSet.insert(symbol).second) {
+            targets.push_back(symbol);
+        }
+    };
+    for (const auto& head : heads) {
+        addTarget(head);
+        for (const auto* grammar : {this, &previousGrammar}) {
+            if (const auto it = grammar->_productions.find(head); it != grammar->_productions.end()) {
+                for (const auto& production : it->second) {
+                    for (const auto& symbol : production) {
+                        addTarget(symbol);
+                    }
+                }
+            }
+        }
+    }
+    addTarget(_ordering[0]);
+    addTarget(previous.ordering[0]);
+    unordered_map<Symbol, vector<Symbol>> flows;  // Rule 3: FOLLOW(head) flows to the symbols with nullable suffixes
+    for (const auto& head : _ordering) {
+        for (const auto& production : _productions.at(head)) {
+            bool nullable = true, firstChanged = false;
+            for (size_t i = production.size(); i > 0; --i) {
+                const auto& symbol = production[i - 1];
+                if (isNonTerminal(symbol)) {
+                    if (firstChanged) {
+                        addTarget(symbol);
                     }
-                    if (!result.getNullable(production[i])) {
-                        nullable = false;
+                    if (nullable) {
+                        flows[head].push_back(symbol);
                     }
                 }
+                firstChanged = firstChanged || changedFirst.contains(symbol);
+                nullable = nullable && result.getNullable(symbol);
             }
         }
     }
-
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (const auto it = flows.find(targets[i]); it != flows.end()) {
+            for (const auto& symbol : it->second) {
+                addTarget(symbol);
+            }
+        }
+    }
+    for (const auto& symbol : targets) {
+        result.follow[symbol].clear();
+    }
+    if (targetSet.contains(_ordering[0])) {
+        result.follow[_ordering[0]].insert(EOF_SYMBOL);  // Rule 1
+    }
+    productions.clear();
+    for (const auto& head : _ordering) {
+        for (const auto& production : _productions.at(head)) {
+            if (ranges::any_of(production, [&](const Symbol& symbol) { return targetSet.contains(symbol); })) {
+                productions.emplace_back(head, &production);
+            }
+        }
+    }
+    computeFollowSets(*this, productions, &targetSet, result);
     return result;
 }
@@ -0,0 +1,258 @@
+#include "cfg.h"
+#include <format>
+#include <fstream>
+#include <ranges>
+#include <algorithm>
+
+using namespace std;
+
+bool IncrementalGrammar::parse(string s) {
+    _text = std::move(s);
+    return parseText();
+}
+
+bool IncrementalGrammar::parseFile(const string& path) {
+    ifstream file(path, ios::binary);
+    if (!file) {
+        _errorMessage = format("Can not open the file '{}'.", path);
+        return false;
+    }
+    _text.assign(istreambuf_iterator(file), istreambuf_iterator<char>());
+    return parseText();
+}
+
+/**
+ * The grammar is rebuilt from the blocks in the same way as parsing the whole text.
+ */
+bool IncrementalGrammar::parseText() {
+    vector<Block> blocks;
+    if (size_t numLineBreaks; !parseBlocks(0, _text.size(), 1, blocks, numLineBreaks)) {
+        _parsed = false;
+        return false;
+    }
+    _blocks = std::move(blocks);
+    _grammar = ContextFreeGrammar();
+    for (const auto& block : _blocks) {
+        for (const auto& rule : block.rules) {
+            _grammar.addRule(rule);
+        }
+    }
+    _grammar.initTerminals();
+    _grammar.deduplicate();
+    _numRules.clear();
+    for (const auto& block : _blocks) {
+        for (const auto& rule : block.rules) {
+            ++_numRules[rule.head];
+        }
+    }
+    _symbolCounts.clear();
+    for (const auto& productions : _grammar._productions | views::values) {
+        for (const auto& production : productions) {
+            for (const auto& symbol : production) {
+                ++_symbolCounts[symbol];
+            }
+        }
+    }
+    _parsed = true;
+    _errorMessage.clear();
+    return true;
+}
+
+/**
+ * The range should start at the beginning of a line and end at the end of a line. The first block starts at the range
+ * even if the first head is in a later line, so that the blocks always cover the whole text.
+ */
+bool IncrementalGrammar::parseBlocks(const size_t begin, const size_t end, const size_t line, vector<Block>& blocks, size_t& numLineBreaks) {
+    auto tokens = ContextFreeGrammar::tokenizeViews(string_view(_text).substr(begin, end - begin));
+    for (auto& token : tokens) {
+        token.line += line - 1;
+    }
+    vector<ContextFreeGrammarRule> rules;
+    if (!ContextFreeGrammar::parseRules(tokens, rules, _errorMessage)) {
+        return false;
+    }
+    // The line breaks are the same as the tokenizer, where a CR is a line break if it is not followed by an LF.
+    vector<size_t> lineBegins = {begin};
+    for (size_t i = begin; i < end; ++i) {
+        if (_text[i] == '\n' || (_text[i] == '\r' && (i + 1 == _text.size() || _text[i + 1] != '\n'))) {
+            lineBegins.push_back(i + 1);
+        }
+    }
+    numLineBreaks = lineBegins.size() - 1;
+    blocks.push_back(Block{begin, line, {}});
+    for (auto& rule : rules) {
+        if (rule.startsLine && !blocks.back().rules.empty()) {
+            blocks.push_back(Block{lineBegins[rule.line - line], rule.line, {}});
+        }
+        blocks.back().rules.push_back(std::move(rule));
+    }
+    return true;
+}
+
+/**
+ * The block before the edit is also parsed, as the first line of the edited block may no longer start with a head,
+ * then its rules belong to the previous block. The blocks after the edit start with heads in unchanged lines,
+ * so they are only shifted.
+ */
+bool IncrementalGrammar::edit(const size_t offset, const size_t length, const string_view replacement) {
+    if (offset > _text.size() || length > _text.size() - offset) {
+        _errorMessage = format("The range [{}, {}) is out of the text with {} bytes.", offset, offset + length, _text.size());
+        return false;
+    }
+    if (!_parsed) {
+        _text.replace(offset, length, replacement);
+        return parseText();
+    }
+    auto blockAt = [&](const size_t position) {
+        const auto it = ranges::upper_bound(_blocks, position, {}, &Block::begin);
+        return static_cast<size_t>(it - _blocks.begin()) - 1;
+    };
+    const size_t first = max(blockAt(offset), static_cast<size_t>(1)) - 1;
+    const size_t last = blockAt(offset + length);
+    const size_t begin = _blocks[first].begin;
+    const size_t oldEnd = last + 1 < _blocks.size() ? _blocks[last + 1].begin : _text.size();
+    const size_t end = oldEnd - length + replacement.size();
+    _text.replace(offset, length, replacement);
+
+    vector<Block> blocks;
+    size_t numLineBreaks;
+    if (!parseBlocks(begin, end, _blocks[first].line, blocks, numLineBreaks)) {
+        return parseText();
+    }
+
+    unordered_set<Symbol> heads;
+    vector<Symbol> oldHeads, newHeads;
+    for (size_t i = first; i <= last; ++i) {
+        for (const auto& rule : _blocks[i].rules) {
+            heads.insert(rule.head);
+            oldHeads.push_back(rule.head);
+            if (--_numRules[rule.head] == 0) {
+                _numRules.erase(rule.head);
+            }
+        }
+    }
+    unordered_map<Symbol, size_t> numNewRules;
+    for (const auto& block : blocks) {
+        for (const auto& rule : block.rules) {
+            heads.insert(rule.head);
+            newHeads.push_back(rule.head);
+            ++numNewRules[rule.head];
+        }
+    }
+    // The productions are only collected from the new blocks if all the rules of the heads are in them.
+    const bool isLocal = ranges::none_of(heads, [&](const Symbol& head) { return _numRules.contains(head); });
+    for (const auto& [head, count] : numNewRules) {
+        _numRules[head] += count;
+    }
+    // The offsets are added in modular arithmetic, which also works if they are negative.
+    if (last + 1 < _blocks.size()) {
+        const size_t lineOffset = _blocks[first].line + numLineBreaks - _blocks[last + 1].line;
+        const size_t byteOffset = replacement.size() - length;
+        for (size_t i = last + 1; i < _blocks.size(); ++i) {
+            _blocks[i].begin += byteOffset;
+            _blocks[i].line += lineOffset;
+        }
+    }
+    // The blocks are replaced in place, and the following blocks are only moved if the number of blocks is changed.
+    const size_t numOldBlocks = last + 1 - first, numCommon = min(numOldBlocks, blocks.size());
+    ranges::move(blocks.begin(), blocks.begin() + static_cast<ptrdiff_t>(numCommon), _blocks.begin() + static_cast<ptrdiff_t>(first));
+    const auto position = _blocks.begin() + static_cast<ptrdiff_t>(first + numCommon);
+    if (numOldBlocks > numCommon) {
+        _blocks.erase(position, position + static_cast<ptrdiff_t>(numOldBlocks - numCommon));
+    } else {
+        _blocks.insert(position, make_move_iterator(blocks.begin() + static_cast<ptrdiff_t>(numCommon)), make_move_iterator(blocks.end()));
+    }
+    if (isLocal) {
+        updateHeads(heads, first, first + blocks.size(), oldHeads != newHeads);
+    } else {
+        updateHeads(heads, 0, _blocks.size(), oldHeads != newHeads);
+    }
+    _errorMessage.clear();
+    return true;
+}
+
+/**
+ * The productions of the heads are collected again from the blocks in order, which gives the same productions
+ * and weights as parsing the whole text. The terminals are only changed for the symbols whose counts are changed.
+ * @param begin The first block that contains the rules of the heads.
+ * @param end The end of the blocks that contain the rules of the heads.
+ * @param orderingChanged Whether the first occurrences of the heads may be changed.
+ */
+void IncrementalGrammar::updateHeads(const unordered_set<Symbol>& heads, const size_t begin, const size_t end, const bool orderingChanged) {
+    auto& productions = _grammar._productions;
+    unordered_set<Symbol> changedSymbols(heads);
+    for (const auto& head : heads) {
+        const auto it = productions.find(head);
+        if (it == productions.end()) {
+            continue;
+        }
+        for (const auto& production : it->second) {
+            _grammar._weights.erase(ContextFreeGrammar::computeProductionKey(head, production));
+            for (const auto& symbol : production) {
+                --_symbolCounts[symbol];
+                changedSymbols.insert(symbol);
+            }
+        }
+        productions.erase(it);
+        _grammar._productionKeys.erase(head);
+    }
+    for (size_t i = begin; i < end; ++i) {
+        for (const auto& rule : _blocks[i].rules) {
+            if (!heads.contains(rule.head)) {
+                continue;
+            }
+            auto& headProductions = productions[rule.head];
+            auto& keys = _grammar._productionKeys[rule.head];
+            for (const auto& [index, weight] : rule.weights) {
+                _grammar._weights.try_emplace(ContextFreeGrammar::computeProductionKey(rule.head, rule.productions[index]), weight);
+            }
+            for (const auto& production : rule.productions) {
+                if (keys.insert(ContextFreeGrammar::computeProductionKey(production)).second) {
+                    headProductions.push_back(production);
+                    for (const auto& symbol : production) {
+                        ++_symbolCounts[symbol];
+                        changedSymbols.insert(symbol);
+                    }
+                }
+            }
+        }
+    }
+    if (orderingChanged) {
+        _grammar._ordering.clear();
+        unordered_set<Symbol> visited;
+        for (const auto& block : _blocks) {
+            for (const auto& rule : block.rules) {
+                if (visited.insert(rule.head).second) {
+                    _grammar._ordering.push_back(rule.head);
+                }
+            }
+        }
+    }
+    for (const auto& symbol : changedSymbols) {
+        const auto it = _symbolCounts.find(symbol);
+        if (it != _symbolCounts.end() && it->second == 0) {
+            _symbolCounts.erase(it);
+        }
+        if (_symbolCounts.contains(symbol) && !productions.contains(symbol) && symbol != ContextFreeGrammar::EMPTY_SYMBOL) {
+            _grammar._terminals.insert(symbol);
+        } else {
+            _grammar._terminals.erase(symbol);
+        }
+    }
+}
+
+const string& IncrementalGrammar::text() const {
+    return _text;
+}
+
+const ContextFreeGrammar& IncrementalGrammar::grammar() const {
+    return _grammar;
+}
+
+const string& IncrementalGrammar::errorMessage() const {
+    return _errorMessage;
+}
+
+size_t IncrementalGrammar::numBlocks() const {
+    return _blocks.size();
+}
@@ -0,0 +1,164 @@
+#include "cfg.h"
+#include "automaton.h"
+#include <ranges>
+#include <algorithm>
+
+using namespace std;
+
+IncrementalLRAutomaton::IncrementalLRAutomaton(const Type type) : _type(type) {}
+
+IncrementalLRAutomaton::~IncrementalLRAutomaton() = default;
+
+/**
+ * The expansion of a kernel only reads the productions of the symbols after the dots, and for LR(1) the FIRST sets
+ * of the symbols after them, so the expansions without changed dependencies are still valid. The accept flags
+ * depend on the primed start symbol, which invalidates all the expansions if it is changed.
+ */
+void IncrementalLRAutomaton::update(const ContextFreeGrammar& grammar) {
+    if (grammar._ordering.empty()) {
+        throw runtime_error("Can not find a start symbol");
+    }
+    const bool hasPrevious = _automaton != nullptr;
+    auto firstAndFollowSet = hasPrevious ? grammar.updateFirstAndFollowSet(_grammar, _firstAndFollowSet) : grammar.computeFirstAndFollowSet();
+    unordered_set<Symbol> changed, changedFollowSets, changedTerminals;
+    if (hasPrevious) {
+        changed = grammar.changedHeads(_grammar);
+        for (const auto& symbol : changed) {
+            if (grammar.isTerminal(symbol) != _grammar.isTerminal(symbol)) {
+                changedTerminals.insert(symbol);
+            }
+        }
+        for (const auto& [symbol, followSet] : firstAndFollowSet.follow) {
+            if (const auto it = _firstAndFollowSet.follow.find(symbol); it == _firstAndFollowSet.follow.end() || it->second != followSet) {
+                changedFollowSets.insert(symbol);
+            }
+        }
+        if (_type == Type::LR1 || _type == Type::LALR1) {
+            for (const auto& symbol : grammar._ordering) {
+                if (const auto it = _firstAndFollowSet.first.find(symbol); it == _firstAndFollowSet.first.end() || it->second != firstAndFollowSet.first.at(symbol)) {
+                    changed.insert(symbol);
+                }
+            }
+        }
+    }
+    const bool terminalsChanged = grammar._terminals != _grammar._terminals;
+    _grammar = grammar;
+    _firstAndFollowSet = std::move(firstAndFollowSet);
+
+    if (auto primedSymbol = _grammar.generatePrimedSymbol(_grammar._ordering[0], false); primedSymbol != _primedSymbol) {
+        _primedSymbol = std::move(primedSymbol);
+        _cache.states.clear();
+    } else {
+        erase_if(_cache.states, [&](const auto& item) {
+            return ranges::any_of(item.second.dependencies, [&](const Symbol& symbol) { return changed.contains(symbol); });
+        });
+    }
+    auto automaton = _type == Type::LR0 || _type == Type::SLR1 ? _grammar.buildLR0Automaton(_cache) : _grammar.buildLR1Automaton(_firstAndFollowSet, _cache);
+    if (_type == Type::LALR1) {
+        automaton = _grammar.mergeLALR1Automaton(*automaton);
+    }
+    swap(_automaton, automaton);
+    updateActionGotoTable(automaton, changedFollowSets, changedTerminals, terminalsChanged);
+}
+
+/**
+ * A row is copied from the previous table if its state has the same items in the same order and the same outgoing edges,
+ * the labels of the edges are still shifts or gotos, and the lookaheads of its reductions are unchanged,
+ * which are the terminals for LR(0) and the FOLLOW sets for SLR(1).
+ * @param changedTerminals The symbols that are changed between terminals and non-terminals.
+ */
+void IncrementalLRAutomaton::updateActionGotoTable(const unique_ptr<FiniteAutomaton>& previousAutomaton, const unordered_set<Symbol>& changedFollowSets, const unordered_set<Symbol>& changedTerminals, const bool terminalsChanged) {
+    auto outEdges = [](FiniteAutomaton& automaton) {
+        vector<vector<pair<string, size_t>>> edges(automaton.size());
+        for (const auto& [u, v, label] : automaton.edges()) {
+            edges[u].emplace_back(label, v);
+        }
+        return edges;
+    };
+    const auto edges = outEdges(*_automaton);
+    const auto previousEdges = previousAutomaton ? outEdges(*previousAutomaton) : vector<vector<pair<string, size_t>>>();
+    // The reductions in a cell follow the item order, so the items should also be in the same order.
+    auto isReused = [&](const size_t u, const string& nodeKey) {
+        if (u >= _nodeKeys.size() || nodeKey != _nodeKeys[u] || edges[u] != previousEdges[u]
+            || ranges::any_of(edges[u], [&](const auto& edge) { return changedTerminals.contains(edge.first); })) {
+            return false;
+        }
+        const auto& node = _automaton->nodeAt(u);
+        const auto& previousNode = previousAutomaton->nodeAt(u);
+        return node.kernel.hasSameOrder(previousNode.kernel) && node.nonKernel.hasSameOrder(previousNode.nonKernel);
+    };
+    auto reducesChanged = [&](const FiniteAutomatonNode& node) {
+        if (_type == Type::LR1 || _type == Type::LALR1) {
+            return false;
+        }
+        if (_type == Type::LR0 ? !terminalsChanged : changedFollowSets.empty()) {
+            return false;
+        }
+        for (const auto* grammar : {&node.kernel, &node.nonKernel}) {
+            for (const auto& [head, productions] : grammar->_productions) {
+                for (const auto& production : productions) {
+                    if (production.back() == ContextFreeGrammar::DOT_SYMBOL && (_type == Type::LR0 || changedFollowSets.contains(head))) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    };
+
+    const auto lookahead = _type == Type::LR0 ? ContextFreeGrammar::ReduceLookahead::ALL_TERMINALS
+                         : _type == Type::SLR1 ? ContextFreeGrammar::ReduceLookahead::FOLLOW_SET
+                                               : ContextFreeGrammar::ReduceLookahead::ITEM;
+    // The keys of the LR(0) and LR(1) states are kept by the build, and the merged LALR(1) states are sorted again.
+    auto nodeKeys = _cache.nodeKeys;
+    if (_type == Type::LALR1) {
+        nodeKeys.resize(_automaton->size());
+        for (size_t u = 0; u < _automaton->size(); ++u) {
+            const auto& node = _automaton->nodeAt(u);
+            nodeKeys[u] = node.kernel.toSortedString() + "---\n" + node.nonKernel.toSortedString();
+        }
+    }
+    ActionGotoTable table(_automaton->size());
+    _numReusedRows = 0;
+    for (size_t u = 0; u < _automaton->size(); ++u) {
+        const auto& node = _automaton->nodeAt(u);
+        if (isReused(u, nodeKeys[u]) && !reducesChanged(node)) {
+            table.actions[u] = std::move(_actionGotoTable.actions[u]);
+            table.nextStates[u] = std::move(_actionGotoTable.nextStates[u]);
+            table.reduceHeads[u] = std::move(_actionGotoTable.reduceHeads[u]);
+            table.reduceProductions[u] = std::move(_actionGotoTable.reduceProductions[u]);
+            ++_numReusedRows;
+            continue;
+        }
+        for (const auto& [label, v] : edges[u]) {
+            if (_grammar.isTerminal(label)) {
+                table.addShift(u, label, v);
+            } else {
+                table.addGoto(u, label, v);
+            }
+        }
+        _grammar.addReduceActions(table, u, node, lookahead, &_firstAndFollowSet);
+    }
+    _nodeKeys = std::move(nodeKeys);
+    _actionGotoTable = std::move(table);
+}
+
+const FirstAndFollowSet& IncrementalLRAutomaton::firstAndFollowSet() const {
+    return _firstAndFollowSet;
+}
+
+const unique_ptr<FiniteAutomaton>& IncrementalLRAutomaton::automaton() const {
+    return _automaton;
+}
+
+const ActionGotoTable& IncrementalLRAutomaton::actionGotoTable() const {
+    return _actionGotoTable;
+}
+
+size_t IncrementalLRAutomaton::numReusedStates() const {
+    return _cache.numReused;
+}
+
+size_t IncrementalLRAutomaton::numReusedRows() const {
+    return _numReusedRows;
+}
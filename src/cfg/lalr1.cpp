@@ -86,7 +86,10 @@ static string computeItemCoreKey(const Symbol& head, const Production& productio
 unique_ptr<FiniteAutomaton> ContextFreeGrammar::computeLALR1Automaton() {
     // First, build the full LR(1) automaton
     const auto lr1Automaton = computeLR1Automaton();
+    return mergeLALR1Automaton(*lr1Automaton);
+}
 
+unique_ptr<FiniteAutomaton> ContextFreeGrammar::mergeLALR1Automaton(FiniteAutomaton& lr1Automaton) const {
     auto removeLookaheads = [&](const ContextFreeGrammar& grammar) {
         ContextFreeGrammar newGrammar;
         for (const auto& [head, productions] : grammar._productions) {
@@ -141,13 +144,13 @@ unique_ptr<FiniteAutomaton> ContextFreeGrammar::computeLALR1Automaton() {
     };
 
     unordered_map<string, size_t> coreKeyToMergedIndex;
-    vector<size_t> lr1ToMerged(lr1Automaton->size());
+    vector<size_t> lr1ToMerged(lr1Automaton.size());
 
     auto lalrAutomaton = make_unique<FiniteAutomaton>();
 
     // First pass: identify unique cores and create merged states
-    for (size_t i = 0; i < lr1Automaton->size(); ++i) {
-        const auto& node = lr1Automaton->nodeAt(i);
+    for (size_t i = 0; i < lr1Automaton.size(); ++i) {
+        const auto& node = lr1Automaton.nodeAt(i);
         const string coreKey = computeCoreKey(node.kernel, node.nonKernel);
         if (coreKeyToMergedIndex.contains(coreKey)) {
             lr1ToMerged[i] = coreKeyToMergedIndex[coreKey];
@@ -172,7 +175,7 @@ unique_ptr<FiniteAutomaton> ContextFreeGrammar::computeLALR1Automaton() {
 
     // Second pass: add edges with remapped state indices
     unordered_set<string> addedEdges;
-    for (const auto& [u, v, label] : lr1Automaton->edges()) {
+    for (const auto& [u, v, label] : lr1Automaton.edges()) {
         const size_t mergedU = lr1ToMerged[u];
         const size_t mergedV = lr1ToMerged[v];
 
@@ -4,7 +4,12 @@
 
 using namespace std;
 
+/**
+ * The weights are carried through as the probabilities of the factored productions. A -> α A' has the total weight
+ * of the productions with the common prefix α, and each A' -> β has its share of the total.
+ */
 void ContextFreeGrammar::leftFactoring(const bool expand) {
+    const bool weighted = hasWeights();
     unordered_set<Symbol> primedSymbols;
     const vector<Symbol> originalNonTerminals = _ordering;
     for (int step = 0; step <= static_cast<int>(expand); ++step) {
@@ -18,14 +23,14 @@ void ContextFreeGrammar::leftFactoring(const bool expand) {
                 auto& productions = _productions[head];
                 unordered_set expanded = {head};
                 unordered_map<int, int> parents;
-                const function<int(const Production&, size_t, int)> expandProduction = [&](const Production& production, size_t index, const int originalProductionIndex) -> int {
+                const function<int(const Production&, size_t, int, double)> expandProduction = [&](const Production& production, size_t index, const int originalProductionIndex, const double weight) -> int {
                     const int currentExpansionIndex = expansionIndex++;
                     while (index < production.size() &&
                         (primedSymbols.contains(production[index]) || !_productions.contains(production[index]) || expanded.contains(production[index]))) {
                         ++index;
                     }
                     if (index < production.size()) {
-                        auto childIndex = expandProduction(production, index + 1, originalProductionIndex);
+                        auto childIndex = expandProduction(production, index + 1, originalProductionIndex, weight);
                         parents[childIndex] = currentExpansionIndex;
                         expanded.insert(production[index]);
                         for (const auto& expandedProduction : _productions[production[index]]) {
@@ -33,24 +38,25 @@ void ContextFreeGrammar::leftFactoring(const bool expand) {
                             newProduction.insert(newProduction.begin(), production.begin(), production.begin() + static_cast<int>(index));
                             newProduction.insert(newProduction.end(), expandedProduction.begin(), expandedProduction.end());
                             newProduction.insert(newProduction.end(), production.begin() + static_cast<int>(index) + 1, production.end());
-                            childIndex = expandProduction(newProduction, index, originalProductionIndex);
+                            childIndex = expandProduction(newProduction, index, originalProductionIndex, weight * weightOf(production[index], expandedProduction));
                             parents[childIndex] = currentExpansionIndex;
                         }
                         expanded.erase(production[index]);
                     } else {
-                        trie.insert(production, originalProductionIndex, currentExpansionIndex);
+                        trie.insert(production, originalProductionIndex, currentExpansionIndex, weight);
                     }
                     return currentExpansionIndex;
                 };
                 for (size_t i = 0; i < productions.size(); ++i) {
                     if (expandProductions) {
-                        expandProduction(productions[i], 0, static_cast<int>(i));
+                        expandProduction(productions[i], 0, static_cast<int>(i), weightOf(head, productions[i]));
                     } else {
-                        trie.insert(productions[i], static_cast<int>(i));
+                        trie.insert(productions[i], static_cast<int>(i), ProductionTrie::NO_EXPANSION, weightOf(head, productions[i]));
                     }
                 }
                 unordered_set<int> toBeRemoved;
                 Productions newProductions;
+                vector<WeightSum> newWeights;
                 auto [prefix, node] = trie.findLongestCommonPrefix();
                 if (prefix.empty()) {
                     continue;
@@ -59,7 +65,16 @@ void ContextFreeGrammar::leftFactoring(const bool expand) {
                     for (const auto& index : node->originalIndices) {
                         toBeRemoved.insert(index);
                     }
-                    const auto suffices = ProductionTrie::computeProductionsUnderPrefix(node, &parents);
+                    vector<double> weights;
+                    const auto suffices = ProductionTrie::computeProductionsUnderPrefix(node, &parents, &weights);
+                    WeightSum total;
+                    for (const auto weight : weights) {
+                        total.weight += weight;
+                        total.isExplicit |= weight != 1.0;
+                    }
+                    for (const auto& index : node->originalIndices) {
+                        total.isExplicit |= _weights.contains(computeProductionKey(head, productions[index]));
+                    }
                     if (suffices.size() == 1) {
                         if (!(suffices[0].size() == 1 && suffices[0][0] == EMPTY_SYMBOL)) {
                             prefix.insert(prefix.end(), suffices[0].begin(), suffices[0].end());
@@ -71,6 +86,15 @@ void ContextFreeGrammar::leftFactoring(const bool expand) {
                         primedSymbols.insert(primedSymbol);
                         prefix.emplace_back(primedSymbol);
                         newProductions.emplace_back(prefix);
+                        if (weighted && total.isExplicit && total.weight > 0.0) {
+                            for (size_t i = 0; i < suffices.size(); ++i) {
+                                setWeight(primedSymbol, suffices[i], weights[i] / total.weight);
+                            }
+                        }
+                    }
+                    if (weighted) {
+                        // The productions without weights stay without weights.
+                        newWeights.emplace_back(total.isExplicit ? total : WeightSum{1.0, false});
                     }
                     hasUpdate = true;
                 }
@@ -84,10 +108,16 @@ void ContextFreeGrammar::leftFactoring(const bool expand) {
                     }
                 }
                 productions.resize(m);
-                for (const auto& production : newProductions) {
-                    productions.emplace_back(production);
+                for (size_t i = 0; i < newProductions.size(); ++i) {
+                    productions.emplace_back(newProductions[i]);
+                    if (weighted) {
+                        setSummedWeight(computeProductionKey(head, newProductions[i]), newWeights[i]);
+                    }
                 }
             }
         }
     }
+    if (weighted) {
+        pruneWeights();
+    }
 }
\ No newline at end of file
@@ -14,67 +14,92 @@ using namespace std;
  *   Process non-terminals in order, substituting earlier non-terminals
  *   to convert indirect recursion to direct, then eliminate.
  *
+ * The weights are carried through the substitutions as products. A -> β A' keeps the weight of A -> β,
+ * A' -> α A' keeps the weight of A -> A α, and A' -> ε is 1, so each derivation keeps its weight.
+ *
  * @return false if elimination is impossible (all productions are left-recursive).
  */
 bool ContextFreeGrammar::leftRecursionElimination() {
     bool eliminable = true;
+    const bool weighted = hasWeights();
     unordered_set<Symbol> eliminated;  // Non-terminals already processed
 
-    for (auto head : _ordering) {
+    // The primed symbols are inserted into the ordering right after their heads during the loop,
+    // so it is iterated by index to reach the heads after them.
+    for (size_t index = 0; index < _ordering.size(); ++index) {
+        const auto head = _ordering[index];
         const auto& productions = _productions[head];
         Productions recursiveProductions, nonRecursiveProductions;
         unordered_set<string> productionKeys;  // For deduplication
+        unordered_map<string, WeightSum> weightSums;  // The weights of the duplicated productions are summed
 
-        const auto addToRecursiveSet = [&](const Production& production) {
-            if (const auto key = computeProductionKey(production); !productionKeys.contains(key)) {
+        const auto addWeight = [&](const string& key, const WeightSum& weight) {
+            auto& [sum, isExplicit] = weightSums[key];
+            sum += weight.weight;
+            isExplicit |= weight.isExplicit;
+        };
+        const auto addToRecursiveSet = [&](const Production& production, const WeightSum& weight) {
+            const auto key = computeProductionKey(production);
+            if (!productionKeys.contains(key)) {
                 productionKeys.insert(key);
                 recursiveProductions.emplace_back(production);
             }
+            addWeight(key, weight);
         };
-        const auto addToNonRecursiveSet = [&](const Production& production) {
-            if (auto key = computeProductionKey(production); !productionKeys.contains(key)) {
+        const auto addToNonRecursiveSet = [&](const Production& production, const WeightSum& weight) {
+            const auto key = computeProductionKey(production);
+            if (!productionKeys.contains(key)) {
                 productionKeys.insert(key);
                 nonRecursiveProductions.emplace_back(production);
             }
+            addWeight(key, weight);
         };
 
         // Recursively expand productions starting with already-eliminated non-terminals.
         // This converts indirect left recursion to direct.
-        const function<void(const Production&)> expand = [&](const Production& production) -> void {
+        const function<void(const Production&, const WeightSum&)> expand = [&](const Production& production, const WeightSum& weight) -> void {
             if (!production.empty()) {
                 if (eliminated.contains(production[0])) {
                     // First symbol is an eliminated non-terminal: substitute its productions.
                     for (auto newProduction : _productions[production[0]]) {
+                        WeightSum newWeight = weight;
+                        if (weighted) {
+                            const auto it = _weights.find(computeProductionKey(production[0], newProduction));
+                            newWeight.weight *= it == _weights.end() ? 1.0 : it->second;
+                            newWeight.isExplicit |= it != _weights.end();
+                        }
                         if (newProduction.size() == 1 && newProduction[0] == EMPTY_SYMBOL) {
                             newProduction.resize(0);  // ε becomes empty
                         }
                         // Append the rest: B γ where B -> δ becomes δ γ
                         newProduction.insert(newProduction.end(), production.begin() + 1, production.end());
                         if (!newProduction.empty() && newProduction[0] == head) {
-                            addToRecursiveSet(newProduction);
+                            addToRecursiveSet(newProduction, newWeight);
                         } else {
-                            expand(newProduction);
+                            expand(newProduction, newWeight);
                         }
                     }
                 } else if (production[0] == head) {
                     // Direct left recursion: A -> A α
-                    if (const auto key = computeProductionKey(production); !productionKeys.contains(key)) {
-                        productionKeys.insert(key);
-                        recursiveProductions.emplace_back(production);
-                    }
+                    addToRecursiveSet(production, weight);
                 } else {
                     // Non-recursive production
                     if (production.size() == 1 && production[0] == EMPTY_SYMBOL) {
-                        addToNonRecursiveSet(Production());
+                        addToNonRecursiveSet(Production(), weight);
                     } else {
-                       addToNonRecursiveSet(production);
+                       addToNonRecursiveSet(production, weight);
                     }
                 }
             }
         };
 
         for (const auto& production : productions) {
-            expand(production);
+            WeightSum weight = {1.0, false};
+            if (weighted) {
+                const auto it = _weights.find(computeProductionKey(head, production));
+                weight = {it == _weights.end() ? 1.0 : it->second, it != _weights.end()};
+            }
+            expand(production, weight);
         }
         eliminated.insert(head);
 
@@ -94,6 +119,15 @@ bool ContextFreeGrammar::leftRecursionElimination() {
             && recursiveProductions[0].size() == 1
             && recursiveProductions[0][0] == head;
 
+        // The weights of the productions before they are transformed.
+        vector<WeightSum> nonRecursiveWeights, recursiveWeights;
+        for (const auto& production : nonRecursiveProductions) {
+            nonRecursiveWeights.emplace_back(weightSums.at(computeProductionKey(production)));
+        }
+        for (const auto& production : recursiveProductions) {
+            recursiveWeights.emplace_back(weightSums.at(computeProductionKey(production)));
+        }
+
         if (!onlySelfLoop) {
             // Standard transformation:
             // A -> A α₁ | A α₂ | β₁ | β₂
@@ -117,8 +151,21 @@ bool ContextFreeGrammar::leftRecursionElimination() {
             }
             _productions[primedSymbol].emplace_back(vector{EMPTY_SYMBOL});
             _terminals.insert(EMPTY_SYMBOL);
+            if (weighted) {
+                for (size_t i = 0; i < recursiveProductions.size(); ++i) {
+                    setSummedWeight(computeProductionKey(primedSymbol, recursiveProductions[i]), recursiveWeights[i]);
+                }
+            }
         }
         _productions[head] = nonRecursiveProductions;
+        if (weighted) {
+            for (size_t i = 0; i < nonRecursiveProductions.size(); ++i) {
+                setSummedWeight(computeProductionKey(head, nonRecursiveProductions[i]), nonRecursiveWeights[i]);
+            }
+        }
+    }
+    if (weighted) {
+        pruneWeights();
     }
     return eliminable;
 }
@@ -103,12 +103,16 @@ Symbol MTable::getTerminal(const size_t index) const {
 }
 
 LLParsingSteps MTable::parse(const string& s) {
+    return parse(stringSplit(s, ' ', true));
+}
+
+LLParsingSteps MTable::parse(const vector<Symbol>& tokens) {
     LLParsingSteps steps;
     vector stack = {ContextFreeGrammar::EOF_SYMBOL};
     if (!nonTerminals.empty()) {
         stack.push_back(nonTerminals[0]);
     }
-    vector<Symbol> remaining = stringSplit(s, ' ', true);
+    vector<Symbol> remaining = tokens;
     remaining.emplace_back(ContextFreeGrammar::EOF_SYMBOL);
 
     size_t n = 0;
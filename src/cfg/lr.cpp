@@ -146,10 +146,14 @@ string ActionGotoTable::toString(const size_t index, const Symbol& symbol, const
  * @return Parsing steps.
  */
 LRParsingSteps ActionGotoTable::parse(const string& s) {
+    return parse(stringSplit(s, ' ', true));
+}
+
+LRParsingSteps ActionGotoTable::parse(const vector<Symbol>& tokens) {
     LRParsingSteps steps;
     vector<size_t> stack = {0};   // State stack, initialized with state 0
     vector<string> symbols;       // Symbol stack (terminals and non-terminals)
-    vector<string> remaining = stringSplit(s, ' ', true);
+    vector<string> remaining = tokens;
     remaining.emplace_back(ContextFreeGrammar::EOF_SYMBOL);
     vector<shared_ptr<ParseTreeNode>> treeNodes = {nullptr};
 
@@ -1,9 +1,80 @@
 #include "cfg.h"
 #include "automaton.h"
 #include <unordered_set>
+#include <ranges>
+#include <algorithm>
 
 using namespace std;
 
+bool ContextFreeGrammar::hasSameOrder(const ContextFreeGrammar& other) const {
+    return _ordering == other._ordering && ranges::all_of(_ordering, [&](const Symbol& head) {
+        return _productions.at(head) == other._productions.at(head);
+    });
+}
+
+/**
+ * The BFS is shared by all the LR automata. A kernel reached again is only expanded once,
+ * and its expansion is kept in the cache for later builds of the same grammar.
+ * The sorted strings of the items are also kept, so that a reused state does not sort its items again.
+ * A later build may reach the same kernel with its items in another order, which gives other orders of the closure
+ * and the transitions, so the expansion is only reused if the item orders are the same.
+ * The expansions that are not used in this build are removed from the cache.
+ */
+unique_ptr<FiniteAutomaton> ContextFreeGrammar::buildLRAutomaton(const ContextFreeGrammar& initialKernel, const function<void(const ContextFreeGrammar&, LRStateExpansion&)>& expand, LRStateCache& cache, const size_t numThreads) {
+    if (numThreads != 1) {
+        return buildLRAutomatonInParallel(initialKernel, expand, cache, numThreads);
+    }
+    for (auto& expansion : cache.states | views::values) {
+        expansion.used = false;
+    }
+    cache.nodeKeys.clear();
+    cache.numReused = 0;
+
+    auto automaton = make_unique<FiniteAutomaton>();
+    vector<const LRStateExpansion*> expansions;
+    auto addNode = [&](const ContextFreeGrammar& kernel, const string& kernelKey) {
+        const auto [it, inserted] = cache.states.try_emplace(kernelKey);
+        auto& expansion = it->second;
+        if (expansion.used) {
+            return expansion.index;
+        }
+        if (inserted || !expansion.kernel.hasSameOrder(kernel)) {
+            expansion = LRStateExpansion();
+            expansion.kernel = kernel;
+            expand(kernel, expansion);
+            expansion.nonKernelKey = expansion.nonKernel.toSortedString();
+            for (const auto& newKernel : expansion.transitions | views::values) {
+                expansion.transitionKeys.emplace_back(newKernel.toSortedString());
+            }
+        } else {
+            ++cache.numReused;
+        }
+        FiniteAutomatonNode node;
+        node.label = automaton->newNodeLabel();
+        node.accept = expansion.accept;
+        node.kernel = kernel;
+        node.nonKernel = expansion.nonKernel;
+        auto key = kernelKey + "---\n" + expansion.nonKernelKey;
+        expansion.used = true;
+        expansion.index = automaton->addNode(std::move(node), key);
+        expansions.push_back(&expansion);
+        cache.nodeKeys.emplace_back(std::move(key));
+        return expansion.index;
+    };
+    addNode(initialKernel, initialKernel.toSortedString());
+
+    // Note: automaton->size() grows as new states are added.
+    for (size_t u = 0; u < automaton->size(); ++u) {
+        const auto& transitions = expansions[u]->transitions;
+        for (size_t i = 0; i < transitions.size(); ++i) {
+            const size_t v = addNode(transitions[i].second, expansions[u]->transitionKeys[i]);
+            automaton->addEdge(u, v, transitions[i].first);
+        }
+    }
+    erase_if(cache.states, [](const auto& item) { return !item.second.used; });
+    return automaton;
+}
+
 /**
  * Build LR(0) automaton (canonical collection of LR(0) item sets).
  *
@@ -18,6 +89,11 @@ using namespace std;
  * 4. Deduplicate states by their item sets
  */
 unique_ptr<FiniteAutomaton> ContextFreeGrammar::computeLR0Automaton() {
+    LRStateCache cache;
+    return buildLR0Automaton(cache);
+}
+
+unique_ptr<FiniteAutomaton> ContextFreeGrammar::buildLR0Automaton(LRStateCache& cache, const size_t numThreads) {
     if (_ordering.empty()) {
         throw runtime_error("Can not find a start symbol");
     }
@@ -26,24 +102,16 @@ unique_ptr<FiniteAutomaton> ContextFreeGrammar::computeLR0Automaton() {
     const auto& startSymbol = _ordering[0];
     const auto newStartSymbol = generatePrimedSymbol(startSymbol, false);
 
-    auto automaton = make_unique<FiniteAutomaton>();
-
     // Initial state: I₀ with kernel {S' -> · S}
-    FiniteAutomatonNode initialNode;
-    initialNode.label = automaton->newNodeLabel();
-    initialNode.kernel.addProduction(newStartSymbol, {DOT_SYMBOL, startSymbol});
-    initialNode.nonKernel = computeClosure(initialNode.kernel);
-    automaton->addNode(initialNode);
+    ContextFreeGrammar initialKernel;
+    initialKernel.addProduction(newStartSymbol, {DOT_SYMBOL, startSymbol});
 
-    // BFS: process each state to find transitions.
-    // Note: automaton->size() grows as new states are added.
-    for (size_t u = 0; u < automaton->size(); ++u) {
-        auto& node = automaton->nodeAt(u);
-        auto grammar = node.kernel | node.nonKernel;
+    return buildLRAutomaton(initialKernel, [&](const ContextFreeGrammar& kernel, LRStateExpansion& expansion) {
+        expansion.nonKernel = computeClosure(kernel);
+        const auto grammar = kernel | expansion.nonKernel;
 
         // Collect all symbols that appear immediately after the dot.
-        // These are the possible transitions from this state.
-        unordered_set<Symbol> transitionSymbolSet;
+        // These are the possible transitions from this state, and the closure only depends on their productions.
         vector<Symbol> transitionSymbols;
         for (const auto& head : grammar._ordering) {
             const auto& productions = grammar._productions.at(head);
@@ -54,13 +122,13 @@ unique_ptr<FiniteAutomaton> ContextFreeGrammar::computeLR0Automaton() {
                             // Dot at end: A -> α · (reduce item)
                             // Mark accept state if this is S' -> S ·
                             if (head == newStartSymbol) {
-                                node.accept = true;
+                                expansion.accept = true;
                             }
                         } else {
                             // Dot before symbol: A -> α · X β
                             const auto& symbol = production[i + 1];
-                            if (!transitionSymbolSet.contains(symbol)) {
-                                transitionSymbolSet.insert(symbol);
+                            if (!expansion.dependencies.contains(symbol)) {
+                                expansion.dependencies.insert(symbol);
                                 transitionSymbols.emplace_back(symbol);
                             }
                         }
@@ -72,8 +140,7 @@ unique_ptr<FiniteAutomaton> ContextFreeGrammar::computeLR0Automaton() {
 
         // GOTO(I, X): advance dot over X for all items A -> α · X β
         for (const auto& transitionSymbol : transitionSymbols) {
-            FiniteAutomatonNode newNode;
-            newNode.label = automaton->newNodeLabel();
+            ContextFreeGrammar newKernel;
             for (const auto& head : grammar._ordering) {
                 const auto& productions = grammar._productions.at(head);
                 for (const auto& production : productions) {
@@ -86,19 +153,16 @@ unique_ptr<FiniteAutomaton> ContextFreeGrammar::computeLR0Automaton() {
                                 // A -> α · X β becomes A -> α X · β
                                 auto newProduction = production;
                                 swap(newProduction[i], newProduction[i + 1]);
-                                newNode.kernel.addProduction(head, newProduction);
+                                newKernel.addProduction(head, newProduction);
                             }
                             break;
                         }
                     }
                 }
             }
-            newNode.nonKernel = computeClosure(newNode.kernel);
-            const size_t v = automaton->addNode(newNode);
-            automaton->addEdge(u, v, transitionSymbol);
+            expansion.transitions.emplace_back(transitionSymbol, std::move(newKernel));
         }
-    }
-    return automaton;
+    }, cache, numThreads);
 }
 
 /**
@@ -126,29 +190,9 @@ ActionGotoTable ContextFreeGrammar::computeLR0ActionGotoTable(const unique_ptr<F
     }
 
     // Fill reduce actions and accept from automaton states.
+    // LR(0) has no lookahead: reduce on ALL terminals and EOF.
     for (size_t u = 0; u < automaton->size(); ++u) {
-        if (const auto& node = automaton->nodeAt(u); node.accept) {
-            actionGotoTable.actions[u][EOF_SYMBOL].emplace_back("accept");
-        } else {
-            // Find completed items (A -> α ·) and add reduce actions.
-            // LR(0) has no lookahead: reduce on ALL terminals and EOF.
-            const auto findReduce = [&](const ContextFreeGrammar& grammar) {
-                for (const auto& head : grammar._ordering) {
-                    const auto& productions = grammar._productions.at(head);
-                    for (const auto& production : productions) {
-                        if (production.back() == DOT_SYMBOL) {
-                            // Add reduce to all terminals (LR(0) has no lookahead)
-                            for (const auto& terminal : _terminals) {
-                                actionGotoTable.addReduce(u, terminal, head, production);
-                            }
-                            actionGotoTable.addReduce(u, EOF_SYMBOL, head, production);
-                        }
-                    }
-                }
-            };
-            findReduce(node.kernel);
-            findReduce(node.nonKernel);
-        }
+        addReduceActions(actionGotoTable, u, automaton->nodeAt(u), ReduceLookahead::ALL_TERMINALS);
     }
     return actionGotoTable;
 }
@@ -139,16 +139,20 @@ unique_ptr<FiniteAutomaton> ContextFreeGrammar::computeLR1Automaton() {
     if (_ordering.empty()) {
         throw runtime_error("Can not find a start symbol");
     }
+    // Precompute FIRST/FOLLOW sets for closure computation
+    LRStateCache cache;
+    return buildLR1Automaton(computeFirstAndFollowSet(), cache);
+}
+
+unique_ptr<FiniteAutomaton> ContextFreeGrammar::buildLR1Automaton(const FirstAndFollowSet& firstFollow, LRStateCache& cache, const size_t numThreads) {
+    if (_ordering.empty()) {
+        throw runtime_error("Can not find a start symbol");
+    }
 
     // Augment grammar: add S' -> S
     const auto& startSymbol = _ordering[0];
     const auto newStartSymbol = generatePrimedSymbol(startSymbol, false);
 
-    // Precompute FIRST/FOLLOW sets for closure computation
-    const auto firstFollow = computeFirstAndFollowSet();
-
-    auto automaton = make_unique<FiniteAutomaton>();
-
     // Merge productions with the same core by combining their lookaheads
     auto mergeLookaheads = [](const ContextFreeGrammar& grammar) -> ContextFreeGrammar {
         unordered_map<string, unordered_set<Symbol>> coreLookaheads;
@@ -179,9 +183,8 @@ unique_ptr<FiniteAutomaton> ContextFreeGrammar::computeLR1Automaton() {
     };
 
     // Initial state: I₀ with kernel {[S' -> · S, ¥]}
-    FiniteAutomatonNode initialNode;
-    initialNode.label = automaton->newNodeLabel();
-    initialNode.kernel.addProduction(newStartSymbol, createLR1Production({DOT_SYMBOL, startSymbol}, EOF_SYMBOL));
+    ContextFreeGrammar initialKernel;
+    initialKernel.addProduction(newStartSymbol, createLR1Production({DOT_SYMBOL, startSymbol}, EOF_SYMBOL));
 
     auto computeLR1Closure = [&](const ContextFreeGrammar& kernel) -> ContextFreeGrammar {
         ContextFreeGrammar closure;
@@ -248,15 +251,12 @@ unique_ptr<FiniteAutomaton> ContextFreeGrammar::computeLR1Automaton() {
         return mergeLookaheads(closure);
     };
 
-    initialNode.nonKernel = computeLR1Closure(initialNode.kernel);
-    automaton->addNode(initialNode);
+    return buildLRAutomaton(initialKernel, [&](const ContextFreeGrammar& kernel, LRStateExpansion& expansion) {
+        expansion.nonKernel = computeLR1Closure(kernel);
+        const auto grammar = kernel | expansion.nonKernel;
 
-    // BFS: process each state to find transitions
-    for (size_t u = 0; u < automaton->size(); ++u) {
-        auto& node = automaton->nodeAt(u);
-        auto grammar = node.kernel | node.nonKernel;
-
-        // Collect all symbols that appear immediately after the dot
+        // Collect all symbols that appear immediately after the dot.
+        // The closure depends on the productions of these symbols, and the FIRST sets of the symbols after them.
         unordered_set<Symbol> transitionSymbolSet;
         vector<Symbol> transitionSymbols;
         for (const auto& head : grammar._ordering) {
@@ -270,10 +270,13 @@ unique_ptr<FiniteAutomaton> ContextFreeGrammar::computeLR1Automaton() {
                                 transitionSymbolSet.insert(symbol);
                                 transitionSymbols.emplace_back(symbol);
                             }
+                            for (size_t j = i + 1; j < production.size() && production[j] != LOOKAHEAD_SEPARATOR; ++j) {
+                                expansion.dependencies.insert(production[j]);
+                            }
                         } else if (i + 1 == production.size() || production[i + 1] == LOOKAHEAD_SEPARATOR) {
                             // Dot at end (before lookahead): reduce item
                             if (head == newStartSymbol) {
-                                node.accept = true;
+                                expansion.accept = true;
                             }
                         }
                         break;
@@ -284,8 +287,7 @@ unique_ptr<FiniteAutomaton> ContextFreeGrammar::computeLR1Automaton() {
 
         // GOTO(I, X): advance dot over X
         for (const auto& transitionSymbol : transitionSymbols) {
-            FiniteAutomatonNode newNode;
-            newNode.label = automaton->newNodeLabel();
+            ContextFreeGrammar newKernel;
             for (const auto& head : grammar._ordering) {
                 const auto& productions = grammar._productions.at(head);
                 for (const auto& production : productions) {
@@ -294,21 +296,16 @@ unique_ptr<FiniteAutomaton> ContextFreeGrammar::computeLR1Automaton() {
                             if (i + 1 < production.size() && production[i + 1] == transitionSymbol) {
                                 auto newProduction = production;
                                 swap(newProduction[i], newProduction[i + 1]);
-                                newNode.kernel.addProduction(head, newProduction);
+                                newKernel.addProduction(head, newProduction);
                             }
                             break;
                         }
                     }
                 }
             }
-            newNode.kernel = mergeLookaheads(newNode.kernel);
-            newNode.nonKernel = computeLR1Closure(newNode.kernel);
-            const size_t v = automaton->addNode(newNode);
-            automaton->addEdge(u, v, transitionSymbol);
+            expansion.transitions.emplace_back(transitionSymbol, mergeLookaheads(newKernel));
         }
-    }
-
-    return automaton;
+    }, cache, numThreads);
 }
 
 /**
@@ -337,29 +334,47 @@ ActionGotoTable ContextFreeGrammar::computeLR1ActionGotoTable(const unique_ptr<F
 
     // Fill reduce actions and accept from automaton states
     for (size_t u = 0; u < automaton->size(); ++u) {
-        if (const auto& node = automaton->nodeAt(u); node.accept) {
-            actionGotoTable.actions[u][EOF_SYMBOL].emplace_back("accept");
-        } else {
-            // Find completed items [A -> α ·, a] and add reduce actions
-            const auto findReduce = [&](const ContextFreeGrammar& grammar) {
-                for (const auto& head : grammar._ordering) {
-                    const auto& productions = grammar._productions.at(head);
-                    for (const auto& production : productions) {
-                        Production core = extractCore(production);
-                        if (!core.empty() && core.back() == DOT_SYMBOL) {
-                            // Extract lookaheads and add reduce action for each
-                            auto lookaheads = extractLookaheads(production);
-                            for (const auto& lookahead : lookaheads) {
-                                actionGotoTable.addReduce(u, lookahead, head, core);
-                            }
+        addReduceActions(actionGotoTable, u, automaton->nodeAt(u), ReduceLookahead::ITEM);
+    }
+
+    return actionGotoTable;
+}
+
+/**
+ * The reduce actions of the items without lookaheads are on all the terminals and EOF for LR(0),
+ * or the FOLLOW set of the head for SLR(1). The items of LR(1) are reduced on their own lookaheads.
+ */
+void ContextFreeGrammar::addReduceActions(ActionGotoTable& table, const size_t u, const FiniteAutomatonNode& node, const ReduceLookahead lookahead, const FirstAndFollowSet* firstFollowSet) const {
+    if (node.accept) {
+        table.actions[u][EOF_SYMBOL].emplace_back("accept");
+        return;
+    }
+    const auto findReduce = [&](const ContextFreeGrammar& grammar) {
+        for (const auto& head : grammar._ordering) {
+            const auto& productions = grammar._productions.at(head);
+            for (const auto& production : productions) {
+                if (lookahead == ReduceLookahead::ITEM) {
+                    // Find completed items [A -> α ·, a] and add reduce action for each lookahead
+                    if (Production core = extractCore(production); !core.empty() && core.back() == DOT_SYMBOL) {
+                        for (const auto& symbol : extractLookaheads(production)) {
+                            table.addReduce(u, symbol, head, core);
                         }
                     }
+                } else if (production.back() == DOT_SYMBOL) {
+                    if (lookahead == ReduceLookahead::FOLLOW_SET) {
+                        for (const auto& symbol : firstFollowSet->follow.at(head)) {
+                            table.addReduce(u, symbol, head, production);
+                        }
+                    } else {
+                        for (const auto& terminal : _terminals) {
+                            table.addReduce(u, terminal, head, production);
+                        }
+                        table.addReduce(u, EOF_SYMBOL, head, production);
+                    }
                 }
-            };
-            findReduce(node.kernel);
-            findReduce(node.nonKernel);
+            }
         }
-    }
-
-    return actionGotoTable;
+    };
+    findReduce(node.kernel);
+    findReduce(node.nonKernel);
 }
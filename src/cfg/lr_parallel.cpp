@@ -0,0 +1,245 @@
+#include "cfg.h"
+#include "automaton.h"
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <ranges>
+#include <algorithm>
+
+using namespace std;
+
+static size_t resolveNumThreads(const size_t numThreads) {
+    return numThreads == 0 ? max(thread::hardware_concurrency(), 1u) : numThreads;
+}
+
+/**
+ * Run the task on the indices in [begin, end), where the threads take chunks of indices in turn.
+ * The task is called in the current thread if there is only one chunk. The first exception is rethrown.
+ * @param task Called with the index of the thread and the index in the range.
+ */
+static void runInParallel(const size_t numThreads, const size_t begin, const size_t end, const size_t chunkSize, const function<void(size_t, size_t)>& task) {
+    const size_t numWorkers = min(numThreads, (end - begin + chunkSize - 1) / chunkSize);
+    if (numWorkers <= 1) {
+        for (size_t i = begin; i < end; ++i) {
+            task(0, i);
+        }
+        return;
+    }
+    atomic<size_t> next = begin;
+    vector<exception_ptr> errors(numWorkers);
+    {
+        vector<jthread> threads;
+        for (size_t t = 0; t < numWorkers; ++t) {
+            threads.emplace_back([&, t] {
+                try {
+                    for (size_t chunk = next.fetch_add(chunkSize); chunk < end; chunk = next.fetch_add(chunkSize)) {
+                        for (size_t i = chunk; i < min(chunk + chunkSize, end); ++i) {
+                            task(t, i);
+                        }
+                    }
+                } catch (...) {
+                    errors[t] = current_exception();
+                    next = end;
+                }
+            });
+        }
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            rethrow_exception(error);
+        }
+    }
+}
+
+/**
+ * A state found by the parallel build. The kernel belongs to the expansion of the state that reaches it first,
+ * which is the state with the smallest index and transition in the previous level.
+ */
+struct ParallelLRState {
+    const string* kernelKey = nullptr;
+    const ContextFreeGrammar* kernel = nullptr;
+    pair<size_t, size_t> rank = {numeric_limits<size_t>::max(), 0};  // The index of the state that reaches it first and the transition
+    const LRStateExpansion* expansion = nullptr;  // Either in the cache or the new expansion
+    unique_ptr<LRStateExpansion> newExpansion;
+    vector<ParallelLRState*> targets;  // The GOTO states in the order of the transitions
+    size_t index = numeric_limits<size_t>::max();
+};
+
+/**
+ * The states indexed by the sorted strings of their kernels. The keys are hashed into stripes with their own locks,
+ * so the threads rarely wait for each other. The values of the maps are never moved, so the pointers stay valid.
+ */
+class StripedLRStateTable {
+public:
+    explicit StripedLRStateTable(const size_t numStripes) : _stripes(numStripes) {}
+
+    /**
+     * Find or add the state of a kernel. The kernel of a state that is not numbered yet is replaced
+     * if it is reached by a smaller rank.
+     * @return The state of the kernel, and whether it is new.
+     */
+    pair<ParallelLRState*, bool> insert(const string& kernelKey, const ContextFreeGrammar& kernel, const pair<size_t, size_t>& rank) {
+        auto& stripe = _stripes[hash<string>()(kernelKey) % _stripes.size()];
+        lock_guard lock(stripe.guard);
+        const auto [it, inserted] = stripe.states.try_emplace(kernelKey);
+        auto& state = it->second;
+        if (inserted) {
+            state.kernelKey = &it->first;
+        }
+        if (state.index == numeric_limits<size_t>::max() && rank < state.rank) {
+            state.kernel = &kernel;
+            state.rank = rank;
+        }
+        return {&state, inserted};
+    }
+
+private:
+    struct Stripe {
+        mutex guard;
+        unordered_map<string, ParallelLRState> states;
+    };
+    vector<Stripe> _stripes;
+};
+
+/**
+ * The states are expanded level by level, where the threads take the states of the current level in turn.
+ * The GOTO states that are new in the table form the next level, which are numbered by the states and the transitions
+ * that reach them first. This is the same order as the sequential BFS, and the kernels are also taken from the same
+ * transitions, so the indices, the labels, the items and the edges are the same as the sequential build.
+ * The cache is only read by the threads, and is updated after all the levels are expanded. As in the sequential build,
+ * a cached expansion is only reused if its kernel has the same item order.
+ */
+unique_ptr<FiniteAutomaton> ContextFreeGrammar::buildLRAutomatonInParallel(const ContextFreeGrammar& initialKernel, const function<void(const ContextFreeGrammar&, LRStateExpansion&)>& expand, LRStateCache& cache, size_t numThreads) {
+    numThreads = resolveNumThreads(numThreads);
+    StripedLRStateTable table(numThreads * 16);
+    ParallelLRState* initialState = table.insert(initialKernel.toSortedString(), initialKernel, {0, 0}).first;
+    initialState->index = 0;
+
+    auto expandState = [&](ParallelLRState& state, vector<ParallelLRState*>& found) {
+        if (const auto it = cache.states.find(*state.kernelKey); it != cache.states.end() && it->second.kernel.hasSameOrder(*state.kernel)) {
+            state.expansion = &it->second;
+        } else {
+            state.newExpansion = make_unique<LRStateExpansion>();
+            auto& expansion = *state.newExpansion;
+            expansion.kernel = *state.kernel;
+            expand(*state.kernel, expansion);
+            expansion.nonKernelKey = expansion.nonKernel.toSortedString();
+            for (const auto& newKernel : expansion.transitions | views::values) {
+                expansion.transitionKeys.emplace_back(newKernel.toSortedString());
+            }
+            state.expansion = &expansion;
+        }
+        const auto& transitions = state.expansion->transitions;
+        for (size_t i = 0; i < transitions.size(); ++i) {
+            const auto [target, inserted] = table.insert(state.expansion->transitionKeys[i], transitions[i].second, {state.index, i});
+            state.targets.push_back(target);
+            if (inserted) {
+                found.push_back(target);
+            }
+        }
+    };
+
+    vector<ParallelLRState*> states = {initialState};
+    for (size_t levelBegin = 0; levelBegin < states.size();) {
+        const size_t levelEnd = states.size();
+        vector<vector<ParallelLRState*>> found(numThreads);
+        runInParallel(numThreads, levelBegin, levelEnd, 1, [&](const size_t t, const size_t u) {
+            expandState(*states[u], found[t]);
+        });
+        vector<ParallelLRState*> level;
+        for (const auto& threadFound : found) {
+            level.insert(level.end(), threadFound.begin(), threadFound.end());
+        }
+        ranges::sort(level, {}, &ParallelLRState::rank);
+        for (auto* state : level) {
+            state->index = states.size();
+            states.push_back(state);
+        }
+        levelBegin = levelEnd;
+    }
+
+    for (auto& expansion : cache.states | views::values) {
+        expansion.used = false;
+    }
+    cache.nodeKeys.clear();
+    cache.numReused = 0;
+    auto automaton = make_unique<FiniteAutomaton>();
+    for (const auto* state : states) {
+        FiniteAutomatonNode node;
+        node.label = automaton->newNodeLabel();
+        node.accept = state->expansion->accept;
+        node.kernel = *state->kernel;
+        node.nonKernel = state->expansion->nonKernel;
+        auto key = *state->kernelKey + "---\n" + state->expansion->nonKernelKey;
+        automaton->addNode(std::move(node), key);
+        cache.nodeKeys.emplace_back(std::move(key));
+    }
+    for (const auto* state : states) {
+        for (size_t i = 0; i < state->targets.size(); ++i) {
+            automaton->addEdge(state->index, state->targets[i]->index, state->expansion->transitions[i].first);
+        }
+    }
+    // The kernels of the nodes are copied, so the new expansions can be moved to the cache.
+    for (auto* state : states) {
+        LRStateExpansion* expansion;
+        if (state->newExpansion) {
+            expansion = &cache.states.insert_or_assign(*state->kernelKey, std::move(*state->newExpansion)).first->second;
+        } else {
+            expansion = &cache.states.at(*state->kernelKey);
+            ++cache.numReused;
+        }
+        expansion->used = true;
+        expansion->index = state->index;
+    }
+    erase_if(cache.states, [](const auto& item) { return !item.second.used; });
+    return automaton;
+}
+
+unique_ptr<FiniteAutomaton> ContextFreeGrammar::computeLRAutomaton(const LRAlgorithm algorithm, const size_t numThreads) {
+    LRStateCache cache;
+    switch (algorithm) {
+        case LRAlgorithm::LR0:
+        case LRAlgorithm::SLR1:
+            return buildLR0Automaton(cache, numThreads);
+        case LRAlgorithm::LR1:
+            return buildLR1Automaton(computeFirstAndFollowSet(), cache, numThreads);
+        case LRAlgorithm::LALR1: {
+            const auto lr1Automaton = buildLR1Automaton(computeFirstAndFollowSet(), cache, numThreads);
+            return mergeLALR1Automaton(*lr1Automaton);
+        }
+    }
+    throw runtime_error("Unknown LR algorithm");
+}
+
+/**
+ * The rows only depend on the edges and the items of their own states, so the chunks of rows are filled
+ * by the threads independently. The edges of a row are added in the same order as the sequential build,
+ * then the reductions, so the cells and their conflicts are the same.
+ */
+ActionGotoTable ContextFreeGrammar::computeActionGotoTable(const LRAlgorithm algorithm, const unique_ptr<FiniteAutomaton>& automaton, const size_t numThreads) const {
+    const auto lookahead = algorithm == LRAlgorithm::LR0 ? ReduceLookahead::ALL_TERMINALS
+                         : algorithm == LRAlgorithm::SLR1 ? ReduceLookahead::FOLLOW_SET
+                                                          : ReduceLookahead::ITEM;
+    FirstAndFollowSet firstFollowSet;
+    if (lookahead == ReduceLookahead::FOLLOW_SET) {
+        firstFollowSet = computeFirstAndFollowSet();
+    }
+    vector<vector<const FiniteAutomatonEdge*>> outEdges(automaton->size());
+    for (const auto& edge : automaton->edges()) {
+        outEdges[edge.u].push_back(&edge);
+    }
+    ActionGotoTable actionGotoTable(automaton->size());
+    runInParallel(resolveNumThreads(numThreads), 0, automaton->size(), 64, [&](size_t, const size_t u) {
+        for (const auto* edge : outEdges[u]) {
+            if (isTerminal(edge->label)) {
+                actionGotoTable.addShift(u, edge->label, edge->v);
+            } else {
+                actionGotoTable.addGoto(u, edge->label, edge->v);
+            }
+        }
+        addReduceActions(actionGotoTable, u, automaton->nodeAt(u), lookahead, &firstFollowSet);
+    });
+    return actionGotoTable;
+}
@@ -47,28 +47,9 @@ ActionGotoTable ContextFreeGrammar::computeSLR1ActionGotoTable(const unique_ptr<
     const auto firstFollowSet = computeFirstAndFollowSet();
 
     // Fill reduce actions and accept from automaton states.
+    // SLR(1) uses lookahead: reduce only on FOLLOW(A).
     for (size_t u = 0; u < automaton->size(); ++u) {
-        if (const auto& node = automaton->nodeAt(u); node.accept) {
-            actionGotoTable.actions[u][EOF_SYMBOL].emplace_back("accept");
-        } else {
-            // Find completed items (A -> α ·) and add reduce actions.
-            // SLR(1) uses lookahead: reduce only on FOLLOW(A).
-            const auto findReduce = [&](const ContextFreeGrammar& grammar) {
-                for (const auto& head : grammar._ordering) {
-                    const auto& productions = grammar._productions.at(head);
-                    for (const auto& production : productions) {
-                        if (production.back() == DOT_SYMBOL) {
-                            // Add reduce only to terminals in FOLLOW(head)
-                            for (const auto& symbol : firstFollowSet.follow.at(head)) {
-                                actionGotoTable.addReduce(u, symbol, head, production);
-                            }
-                        }
-                    }
-                }
-            };
-            findReduce(node.kernel);
-            findReduce(node.nonKernel);
-        }
+        addReduceActions(actionGotoTable, u, automaton->nodeAt(u), ReduceLookahead::FOLLOW_SET, &firstFollowSet);
     }
     return actionGotoTable;
 }
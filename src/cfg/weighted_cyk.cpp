@@ -0,0 +1,206 @@
+#include "cfg.h"
+#include <sstream>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+static constexpr double NEG_INF = -numeric_limits<double>::infinity();
+
+/**
+ * log(exp(a) + exp(b)) without overflow.
+ */
+static double logAdd(const double a, const double b) {
+    if (a == NEG_INF) {
+        return b;
+    }
+    if (b == NEG_INF) {
+        return a;
+    }
+    return a > b ? a + log1p(exp(b - a)) : b + log1p(exp(a - b));
+}
+
+WeightedCYKTable::WeightedCYKTable(const size_t size, vector<Symbol> symbols) :
+    n(size), nonTerminals(std::move(symbols)),
+    viterbi(size * size * nonTerminals.size(), NEG_INF), inside(size * size * nonTerminals.size(), NEG_INF),
+    logProbability(NEG_INF), insideLogProbability(NEG_INF) {
+    for (size_t i = 0; i < nonTerminals.size(); ++i) {
+        nonTerminalIndex[nonTerminals[i]] = i;
+    }
+}
+
+size_t WeightedCYKTable::size() const {
+    return n;
+}
+
+double WeightedCYKTable::getViterbi(const size_t r, const size_t c, const Symbol& symbol) const {
+    const auto it = nonTerminalIndex.find(symbol);
+    if (r >= n || c >= n || r > c || it == nonTerminalIndex.end()) {
+        return NEG_INF;
+    }
+    return viterbi[(r * n + c) * nonTerminals.size() + it->second];
+}
+
+double WeightedCYKTable::getInside(const size_t r, const size_t c, const Symbol& symbol) const {
+    const auto it = nonTerminalIndex.find(symbol);
+    if (r >= n || c >= n || r > c || it == nonTerminalIndex.end()) {
+        return NEG_INF;
+    }
+    return inside[(r * n + c) * nonTerminals.size() + it->second];
+}
+
+/**
+ * The binary productions are stored as parallel arrays grouped by the left child (CSR),
+ * so that the inner loop only touches the productions whose left child exists in the left cell,
+ * and reads the right child scores directly from the dense vector of the right cell.
+ */
+WeightedCYKTable ContextFreeGrammar::weightedCYKParse(const string& s) const {
+    vector<Symbol> tokens;
+    istringstream iss(s);
+    string token;
+    while (iss >> token) {
+        tokens.push_back(token);
+    }
+
+    const size_t n = tokens.size();
+    WeightedCYKTable result(n, _ordering);
+    const size_t m = _ordering.size();
+    if (m == 0) {
+        return result;
+    }
+    const auto& startSymbol = _ordering[0];
+
+    auto makeNode = [](const Symbol& label, const bool terminal) {
+        auto node = make_shared<ParseTreeNode>();
+        node->terminal = terminal;
+        node->label = label;
+        return node;
+    };
+
+    if (n == 0) {
+        for (const auto& production : _productions.at(startSymbol)) {
+            if (production.size() == 1 && production[0] == EMPTY_SYMBOL) {
+                if (const double weight = weightOf(startSymbol, production); weight > 0.0) {
+                    result.accepted = true;
+                    result.logProbability = result.insideLogProbability = log(weight);
+                    result.parseTree = makeNode(startSymbol, false);
+                    result.parseTree->children.push_back(makeNode(EMPTY_SYMBOL, true));
+                }
+            }
+        }
+        return result;
+    }
+
+    unordered_map<Symbol, vector<pair<uint32_t, double>>> terminalRules;
+    vector<uint32_t> ruleHead, ruleLeft, ruleRight;
+    vector<double> ruleWeight;
+    vector<uint32_t> leftBegin(m + 1, 0);
+    {
+        vector<tuple<uint32_t, uint32_t, uint32_t, double>> binaryRules;
+        for (uint32_t head = 0; head < m; ++head) {
+            for (const auto& production : _productions.at(_ordering[head])) {
+                const double weight = weightOf(_ordering[head], production);
+                if (weight <= 0.0) {
+                    continue;
+                }
+                if (production.size() == 1 && isTerminal(production[0])) {
+                    terminalRules[production[0]].emplace_back(head, log(weight));
+                } else if (production.size() == 2 && isNonTerminal(production[0]) && isNonTerminal(production[1])) {
+                    const auto left = static_cast<uint32_t>(result.nonTerminalIndex.at(production[0]));
+                    const auto right = static_cast<uint32_t>(result.nonTerminalIndex.at(production[1]));
+                    binaryRules.emplace_back(left, right, head, log(weight));
+                }
+            }
+        }
+        ranges::stable_sort(binaryRules, {}, [](const auto& rule) { return get<0>(rule); });
+        for (const auto& [left, right, head, weight] : binaryRules) {
+            ++leftBegin[left + 1];
+            ruleHead.push_back(head);
+            ruleLeft.push_back(left);
+            ruleRight.push_back(right);
+            ruleWeight.push_back(weight);
+        }
+        for (size_t i = 0; i < m; ++i) {
+            leftBegin[i + 1] += leftBegin[i];
+        }
+    }
+
+    // The split point and the production of the best derivation of each (cell, non-terminal).
+    // Terminal productions are marked with the largest rule index.
+    struct BackPointer {
+        uint32_t k;
+        uint32_t rule;
+    };
+    constexpr uint32_t TERMINAL_RULE = numeric_limits<uint32_t>::max();
+    vector<BackPointer> backPointers(n * n * m);
+    auto offset = [&](const size_t r, const size_t c) {
+        return (r * n + c) * m;
+    };
+
+    for (size_t i = 0; i < n; ++i) {
+        if (const auto it = terminalRules.find(tokens[i]); it != terminalRules.end()) {
+            const auto base = offset(i, i);
+            for (const auto& [head, weight] : it->second) {
+                result.inside[base + head] = logAdd(result.inside[base + head], weight);
+                if (weight > result.viterbi[base + head]) {
+                    result.viterbi[base + head] = weight;
+                    backPointers[base + head] = {static_cast<uint32_t>(i), TERMINAL_RULE};
+                }
+            }
+        }
+    }
+
+    for (size_t len = 2; len <= n; ++len) {
+        for (size_t i = 0; i + len <= n; ++i) {
+            const size_t j = i + len - 1;
+            double* const viterbi = result.viterbi.data() + offset(i, j);
+            double* const inside = result.inside.data() + offset(i, j);
+            BackPointer* const back = backPointers.data() + offset(i, j);
+            for (size_t k = i; k < j; ++k) {
+                const double* const leftViterbi = result.viterbi.data() + offset(i, k);
+                const double* const leftInside = result.inside.data() + offset(i, k);
+                const double* const rightViterbi = result.viterbi.data() + offset(k + 1, j);
+                const double* const rightInside = result.inside.data() + offset(k + 1, j);
+                for (size_t left = 0; left < m; ++left) {
+                    if (leftInside[left] == NEG_INF) {
+                        continue;
+                    }
+                    for (auto rule = leftBegin[left]; rule < leftBegin[left + 1]; ++rule) {
+                        const auto right = ruleRight[rule];
+                        if (rightInside[right] == NEG_INF) {
+                            continue;
+                        }
+                        const auto head = ruleHead[rule];
+                        inside[head] = logAdd(inside[head], leftInside[left] + rightInside[right] + ruleWeight[rule]);
+                        if (const double score = leftViterbi[left] + rightViterbi[right] + ruleWeight[rule]; score > viterbi[head]) {
+                            viterbi[head] = score;
+                            back[head] = {static_cast<uint32_t>(k), rule};
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    const auto start = offset(0, n - 1);
+    result.logProbability = result.viterbi[start];
+    result.insideLogProbability = result.inside[start];
+    result.accepted = result.logProbability != NEG_INF;
+
+    if (result.accepted) {
+        function<shared_ptr<ParseTreeNode>(size_t, size_t, size_t)> buildTree = [&](const size_t r, const size_t c, const size_t symbol) {
+            auto node = makeNode(_ordering[symbol], false);
+            if (const auto& [k, rule] = backPointers[offset(r, c) + symbol]; rule == TERMINAL_RULE) {
+                node->children.push_back(makeNode(tokens[r], true));
+            } else {
+                node->children.push_back(buildTree(r, k, ruleLeft[rule]));
+                node->children.push_back(buildTree(k + 1, c, ruleRight[rule]));
+            }
+            return node;
+        };
+        result.parseTree = buildTree(0, n - 1, 0);
+    }
+    return result;
+}
@@ -0,0 +1,373 @@
+#include "parse_forest.h"
+#include <queue>
+#include <set>
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+static string computeNodeKey(const ParseForestNode::Type type, const Symbol& label, const size_t begin, const size_t end) {
+    return to_string(static_cast<int>(type)) + " " + to_string(begin) + " " + to_string(end) + " " + label;
+}
+
+static shared_ptr<ParseTreeNode> newTreeNode(const Symbol& label, const bool terminal) {
+    auto node = make_shared<ParseTreeNode>();
+    node->terminal = terminal;
+    node->label = label;
+    return node;
+}
+
+size_t ParseForest::size() const {
+    return _nodes.size();
+}
+
+size_t ParseForest::numPackedNodes() const {
+    return _packedNodes.size();
+}
+
+const ParseForestNode& ParseForest::nodeAt(const size_t i) const {
+    return _nodes[i];
+}
+
+const ParseForestPackedNode& ParseForest::packedNodeAt(const size_t i) const {
+    return _packedNodes[i];
+}
+
+size_t ParseForest::addNode(const ParseForestNode::Type type, const Symbol& label, const size_t begin, const size_t end) {
+    const auto key = computeNodeKey(type, label, begin, end);
+    if (const auto it = _keyToNodeIndex.find(key); it != _keyToNodeIndex.end()) {
+        return it->second;
+    }
+    const size_t index = _nodes.size();
+    _keyToNodeIndex[key] = index;
+    _nodes.push_back({type, label, begin, end, {}});
+    return index;
+}
+
+size_t ParseForest::findNode(const ParseForestNode::Type type, const Symbol& label, const size_t begin, const size_t end) const {
+    if (const auto it = _keyToNodeIndex.find(computeNodeKey(type, label, begin, end)); it != _keyToNodeIndex.end()) {
+        return it->second;
+    }
+    return NONE;
+}
+
+size_t ParseForest::addPackedNode(const size_t parent, const vector<size_t>& children, const double weight) {
+    for (const auto index : _nodes[parent].packed) {
+        if (_packedNodes[index].children == children) {
+            return index;
+        }
+    }
+    const size_t index = _packedNodes.size();
+    _packedNodes.push_back({children, weight});
+    _nodes[parent].packed.emplace_back(index);
+    return index;
+}
+
+void ParseForest::setRoot(const size_t root) {
+    _root = root;
+}
+
+size_t ParseForest::root() const {
+    return _root;
+}
+
+bool ParseForest::isAmbiguous() const {
+    return countDerivations() > 1;
+}
+
+size_t ParseForest::countDerivations() const {
+    if (_root == NONE) {
+        return 0;
+    }
+    enum class State { UNVISITED, VISITING, VISITED };
+    vector states(_nodes.size(), State::UNVISITED);
+    vector<size_t> counts(_nodes.size(), 0);
+    bool cyclic = false;
+    auto saturatedAdd = [](const size_t a, const size_t b) {
+        return a > NONE - b ? NONE : a + b;
+    };
+    auto saturatedMultiply = [](const size_t a, const size_t b) {
+        return a != 0 && b > NONE / a ? NONE : a * b;
+    };
+    function<size_t(size_t)> count = [&](const size_t u) -> size_t {
+        if (states[u] == State::VISITED) {
+            return counts[u];
+        }
+        if (states[u] == State::VISITING) {
+            cyclic = true;
+            return 0;
+        }
+        if (_nodes[u].type == ParseForestNode::Type::TERMINAL) {
+            states[u] = State::VISITED;
+            return counts[u] = 1;
+        }
+        states[u] = State::VISITING;
+        size_t total = 0;
+        for (const auto packed : _nodes[u].packed) {
+            size_t product = 1;
+            for (const auto child : _packedNodes[packed].children) {
+                product = saturatedMultiply(product, count(child));
+            }
+            total = saturatedAdd(total, product);
+        }
+        states[u] = State::VISITED;
+        return counts[u] = total;
+    };
+    const auto total = count(_root);
+    return cyclic ? NONE : total;
+}
+
+vector<shared_ptr<ParseTreeNode>> ParseForest::firstTrees(const size_t k) const {
+    vector<shared_ptr<ParseTreeNode>> result;
+    auto stream = trees();
+    while (result.size() < k) {
+        auto tree = stream.next();
+        if (tree == nullptr) {
+            break;
+        }
+        result.emplace_back(tree);
+    }
+    return result;
+}
+
+/**
+ * Lazy k-best extraction.
+ *
+ * The derivations of a node are ranked by the weight of the packed node plus the scores of the children.
+ * For each node, the candidates start from the best derivation of each packed node,
+ * and each time a candidate is popped, the candidates with one child moved to its next derivation are pushed.
+ */
+vector<shared_ptr<ParseTreeNode>> ParseForest::bestTrees(const size_t k) const {
+    struct Derivation {
+        double score;
+        size_t packed;
+        vector<size_t> ranks;
+    };
+    vector<shared_ptr<ParseTreeNode>> result;
+    if (_root == NONE || k == 0) {
+        return result;
+    }
+    vector<vector<Derivation>> derivations(_nodes.size());
+    vector<bool> computed(_nodes.size(), false);
+    vector<bool> onPath(_nodes.size(), false);
+    function<const vector<Derivation>&(size_t)> computeBest = [&](const size_t u) -> const vector<Derivation>& {
+        if (computed[u] || onPath[u]) {
+            return derivations[u];
+        }
+        if (_nodes[u].type == ParseForestNode::Type::TERMINAL) {
+            computed[u] = true;
+            derivations[u].push_back({0.0, NONE, {}});
+            return derivations[u];
+        }
+        onPath[u] = true;
+        using Candidate = tuple<double, size_t, size_t, vector<size_t>>;  // Score, negated order, packed, ranks
+        priority_queue<Candidate> candidates;
+        set<pair<size_t, vector<size_t>>> visited;
+        size_t order = 0;
+        auto pushCandidate = [&](const size_t packed, const vector<size_t>& ranks) {
+            const auto& children = _packedNodes[packed].children;
+            double score = _packedNodes[packed].weight;
+            for (size_t i = 0; i < children.size(); ++i) {
+                const auto& childDerivations = derivations[children[i]];
+                if (ranks[i] >= childDerivations.size()) {
+                    return;
+                }
+                score += childDerivations[ranks[i]].score;
+            }
+            if (visited.emplace(packed, ranks).second) {
+                candidates.emplace(score, NONE - order++, packed, ranks);
+            }
+        };
+        for (const auto packed : _nodes[u].packed) {
+            bool valid = true;
+            for (const auto child : _packedNodes[packed].children) {
+                if (computeBest(child).empty()) {
+                    valid = false;
+                }
+            }
+            if (valid) {
+                pushCandidate(packed, vector<size_t>(_packedNodes[packed].children.size(), 0));
+            }
+        }
+        while (!candidates.empty() && derivations[u].size() < k) {
+            auto [score, _, packed, ranks] = candidates.top();
+            candidates.pop();
+            derivations[u].push_back({score, packed, ranks});
+            for (size_t i = 0; i < ranks.size(); ++i) {
+                ++ranks[i];
+                pushCandidate(packed, ranks);
+                --ranks[i];
+            }
+        }
+        onPath[u] = false;
+        computed[u] = true;
+        return derivations[u];
+    };
+    function<void(size_t, size_t, vector<shared_ptr<ParseTreeNode>>&)> buildChildren = [&](const size_t u, const size_t rank, vector<shared_ptr<ParseTreeNode>>& children) {
+        const auto& derivation = derivations[u][rank];
+        const auto& packedChildren = _packedNodes[derivation.packed].children;
+        for (size_t i = 0; i < packedChildren.size(); ++i) {
+            const auto& child = _nodes[packedChildren[i]];
+            if (child.type == ParseForestNode::Type::TERMINAL) {
+                children.emplace_back(newTreeNode(child.label, true));
+            } else if (child.type == ParseForestNode::Type::INTERMEDIATE) {
+                buildChildren(packedChildren[i], derivation.ranks[i], children);
+            } else {
+                auto node = newTreeNode(child.label, false);
+                buildChildren(packedChildren[i], derivation.ranks[i], node->children);
+                if (node->children.empty()) {
+                    node->children.emplace_back(newTreeNode(ContextFreeGrammar::EMPTY_SYMBOL, true));
+                }
+                children.emplace_back(node);
+            }
+        }
+    };
+    const auto& best = computeBest(_root);
+    for (size_t rank = 0; rank < best.size(); ++rank) {
+        auto tree = newTreeNode(_nodes[_root].label, false);
+        buildChildren(_root, rank, tree->children);
+        if (tree->children.empty()) {
+            tree->children.emplace_back(newTreeNode(ContextFreeGrammar::EMPTY_SYMBOL, true));
+        }
+        result.emplace_back(tree);
+    }
+    return result;
+}
+
+ParseForestTreeStream ParseForest::trees() const {
+    return ParseForestTreeStream(*this);
+}
+
+string ParseForest::toString() const {
+    string result;
+    if (_root == NONE) {
+        return result;
+    }
+    auto nodeToString = [&](const size_t u) {
+        const auto& node = _nodes[u];
+        return node.label + "[" + to_string(node.begin) + "," + to_string(node.end) + "]";
+    };
+    vector<bool> visited(_nodes.size(), false);
+    function<void(size_t)> visit = [&](const size_t u) {
+        if (visited[u] || _nodes[u].type == ParseForestNode::Type::TERMINAL) {
+            return;
+        }
+        visited[u] = true;
+        result += nodeToString(u) + "\n";
+        for (const auto packed : _nodes[u].packed) {
+            result += " ";
+            for (const auto child : _packedNodes[packed].children) {
+                result += " " + nodeToString(child);
+            }
+            if (_packedNodes[packed].children.empty()) {
+                result += " " + ContextFreeGrammar::EMPTY_SYMBOL;
+            }
+            result += "\n";
+        }
+        for (const auto packed : _nodes[u].packed) {
+            for (const auto child : _packedNodes[packed].children) {
+                visit(child);
+            }
+        }
+    };
+    visit(_root);
+    return result;
+}
+
+ParseForestTreeStream::ParseForestTreeStream(const ParseForest& forest) : _forest(forest), _onPath(forest.size(), false) {}
+
+/**
+ * The current tree is identified by the packed nodes chosen at the choice points in preorder,
+ * the next tree is found by moving the last choice point to its next alternative like an odometer.
+ */
+shared_ptr<ParseTreeNode> ParseForestTreeStream::next() {
+    if (_finished) {
+        return nullptr;
+    }
+    if (_forest.root() == ParseForest::NONE || (_started && !advance())) {
+        _finished = true;
+        return nullptr;
+    }
+    _started = true;
+    while (true) {
+        _position = 0;
+        _failure = ParseForest::NONE;
+        if (auto tree = expand(_forest.root())) {
+            return tree;
+        }
+        if (_failure == ParseForest::NONE) {
+            _finished = true;
+            return nullptr;
+        }
+        _choices.resize(_failure + 1);
+        _choiceNodes.resize(_failure + 1);
+        if (!advance()) {
+            _finished = true;
+            return nullptr;
+        }
+    }
+}
+
+bool ParseForestTreeStream::advance() {
+    while (!_choices.empty()) {
+        if (_choices.back() + 1 < _forest.nodeAt(_choiceNodes.back()).packed.size()) {
+            ++_choices.back();
+            return true;
+        }
+        _choices.pop_back();
+        _choiceNodes.pop_back();
+    }
+    return false;
+}
+
+bool ParseForestTreeStream::expandChildren(const size_t index, vector<shared_ptr<ParseTreeNode>>& children) {
+    const auto& node = _forest.nodeAt(index);
+    if (node.packed.empty()) {
+        _failure = _position == 0 ? ParseForest::NONE : _position - 1;
+        return false;
+    }
+    const auto position = _position++;
+    if (position == _choices.size()) {
+        _choices.emplace_back(0);
+        _choiceNodes.emplace_back(index);
+    }
+    const auto& packed = _forest.packedNodeAt(node.packed[_choices[position]]);
+    bool success = true;
+    _onPath[index] = true;
+    for (const auto child : packed.children) {
+        if (_onPath[child]) {
+            _failure = position;
+            success = false;
+            break;
+        }
+        const auto& childNode = _forest.nodeAt(child);
+        if (childNode.type == ParseForestNode::Type::TERMINAL) {
+            children.emplace_back(newTreeNode(childNode.label, true));
+        } else if (childNode.type == ParseForestNode::Type::INTERMEDIATE) {
+            if (!expandChildren(child, children)) {
+                success = false;
+                break;
+            }
+        } else {
+            auto tree = expand(child);
+            if (tree == nullptr) {
+                success = false;
+                break;
+            }
+            children.emplace_back(tree);
+        }
+    }
+    _onPath[index] = false;
+    return success;
+}
+
+shared_ptr<ParseTreeNode> ParseForestTreeStream::expand(const size_t index) {
+    auto node = newTreeNode(_forest.nodeAt(index).label, false);
+    if (!expandChildren(index, node->children)) {
+        return nullptr;
+    }
+    if (node->children.empty()) {
+        node->children.emplace_back(newTreeNode(ContextFreeGrammar::EMPTY_SYMBOL, true));
+    }
+    return node;
+}
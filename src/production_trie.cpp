@@ -11,7 +11,7 @@ ProductionTrie::ProductionTrie() {
     _head = make_shared<ProductionTrieNode>();
 }
 
-void ProductionTrie::insert(const vector<string>& production, const int originalIndex, const int expansionIndex) const {
+void ProductionTrie::insert(const vector<string>& production, const int originalIndex, const int expansionIndex, const double weight) const {
     auto current = _head;
     ++current->count;
     current->originalIndices.insert(originalIndex);
@@ -26,6 +26,7 @@ void ProductionTrie::insert(const vector<string>& production, const int original
         current->parent = parent;
     }
     current->expansionIndices.insert(expansionIndex);
+    current->weight += weight;
 }
 
 pair<vector<string>, shared_ptr<ProductionTrieNode>> ProductionTrie::findLongestCommonPrefix() const {
@@ -50,8 +51,9 @@ pair<vector<string>, shared_ptr<ProductionTrieNode>> ProductionTrie::findLongest
     return {longestPrefix, bestNode};
 }
 
-vector<vector<string>> ProductionTrie::computeProductionsUnderPrefix(const shared_ptr<ProductionTrieNode>& node, const unordered_map<int ,int>* parents) {
+vector<vector<string>> ProductionTrie::computeProductionsUnderPrefix(const shared_ptr<ProductionTrieNode>& node, const unordered_map<int ,int>* parents, vector<double>* weights) {
     vector<vector<string>> productions;
+    vector<double> productionWeights;
     unordered_set<int> allExpansionIndices;
     vector<unordered_set<int>> expansionIndices;
     vector<string> production;
@@ -62,6 +64,7 @@ vector<vector<string>> ProductionTrie::computeProductionsUnderPrefix(const share
             } else {
                 productions.emplace_back(production);
             }
+            productionWeights.emplace_back(_node->weight);
             if (parents != nullptr) {
                 expansionIndices.emplace_back(_node->expansionIndices);
                 for (const auto index : _node->expansionIndices) {
@@ -95,14 +98,27 @@ vector<vector<string>> ProductionTrie::computeProductionsUnderPrefix(const share
             if (valid) {
                 if (m != i) {
                     productions[m] = productions[i];
+                    productionWeights[m] = productionWeights[i];
                 }
                 ++m;
             }
         }
         productions.resize(m);
+        productionWeights.resize(m);
     }
-    ranges::sort(productions);
-    return productions;
+    vector<size_t> order(productions.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    ranges::stable_sort(order, [&](const size_t a, const size_t b) { return productions[a] < productions[b]; });
+    vector<vector<string>> sortedProductions;
+    for (const auto i : order) {
+        sortedProductions.emplace_back(std::move(productions[i]));
+        if (weights != nullptr) {
+            weights->emplace_back(productionWeights[i]);
+        }
+    }
+    return sortedProductions;
 }
 
 void ProductionTrie::removeNode(const shared_ptr<ProductionTrieNode>& node) {
@@ -0,0 +1,339 @@
+#include "re_matcher.h"
+#include <algorithm>
+#include <cstdlib>
+#include <array>
+#include <bit>
+#include <map>
+#include <ranges>
+#include <stdexcept>
+
+using namespace std;
+
+template<size_t W>
+using Bits = array<uint64_t, W>;
+
+BitParallelNFA::BitParallelNFA() : byteMasks(256, 0), first(1, 0), last(1, 0) {}
+
+/**
+ * A lookup in a chunk table is a load that depends on the state, which costs about as much as this number of shifts.
+ */
+static constexpr size_t TABLE_COST = 4;
+
+/**
+ * The distances are added as shifts in the order of their numbers of edges, and the number of shifts is chosen to
+ * minimize the cost of the shifts plus the chunk tables for the edges that are left, preferring shifts on ties.
+ */
+BitParallelNFA::BitParallelNFA(const GlushkovNFA& nfa) {
+    const size_t m = nfa.size();
+    if (m > MAX_POSITIONS) {
+        throw runtime_error("The automaton has more than " + to_string(MAX_POSITIONS) + " positions.");
+    }
+    words = m <= 64 ? 1 : m <= 128 ? 2 : 4;
+    auto set = [](vector<uint64_t>& bits, const size_t offset, const size_t position) {
+        bits[offset + position / 64] |= uint64_t{1} << position % 64;
+    };
+
+    byteMasks.assign(256 * words, 0);
+    for (size_t position = 0; position < m; ++position) {
+        for (size_t byte = 0; byte < 256; ++byte) {
+            if (nfa.positionBytes[position][byte]) {
+                set(byteMasks, byte * words, position);
+            }
+        }
+    }
+    first.assign(words, 0);
+    last.assign(words, 0);
+    for (const auto position : nfa.first) {
+        set(first, 0, position);
+    }
+    for (const auto position : nfa.last) {
+        set(last, 0, position);
+    }
+    nullable = nfa.nullable;
+
+    map<int32_t, size_t> numEdges;
+    for (size_t position = 0; position < m; ++position) {
+        for (auto i = nfa.followBegin[position]; i < nfa.followBegin[position + 1]; ++i) {
+            ++numEdges[static_cast<int32_t>(nfa.followTargets[i]) - static_cast<int32_t>(position)];
+        }
+    }
+    vector<int32_t> distances;
+    for (const auto& distance : numEdges | views::keys) {
+        distances.push_back(distance);
+    }
+    ranges::stable_sort(distances, greater{}, [&](const int32_t distance) { return numEdges[distance]; });
+    // The shifts never cross more than one word.
+    const auto far = ranges::stable_partition(distances, [](const int32_t distance) { return abs(distance) < 64; });
+    const size_t numNear = static_cast<size_t>(far.begin() - distances.begin());
+    map<int32_t, size_t> rank;
+    for (size_t i = 0; i < distances.size(); ++i) {
+        rank[distances[i]] = i;
+    }
+    // A chunk needs no table if all the distances of its edges are shifts, i.e. the shifts include its largest rank.
+    const size_t numChunks = (m + 7) / 8;
+    vector<size_t> chunkRank(numChunks, 0);
+    vector<bool> hasEdges(numChunks, false);
+    for (size_t position = 0; position < m; ++position) {
+        for (auto i = nfa.followBegin[position]; i < nfa.followBegin[position + 1]; ++i) {
+            const auto distance = static_cast<int32_t>(nfa.followTargets[i]) - static_cast<int32_t>(position);
+            chunkRank[position / 8] = max(chunkRank[position / 8], rank[distance]);
+            hasEdges[position / 8] = true;
+        }
+    }
+    vector<size_t> freed(distances.size() + 1, 0);
+    size_t numTables = 0;
+    for (size_t chunk = 0; chunk < numChunks; ++chunk) {
+        if (hasEdges[chunk]) {
+            ++numTables;
+            ++freed[chunkRank[chunk] + 1];
+        }
+    }
+    size_t numShifts = 0, bestCost = numTables * TABLE_COST;
+    for (size_t k = 1; k <= min(numNear, MAX_SHIFTS); ++k) {
+        numTables -= freed[k];
+        if (k + numTables * TABLE_COST <= bestCost) {
+            bestCost = k + numTables * TABLE_COST;
+            numShifts = k;
+        }
+    }
+
+    shifts.assign(distances.begin(), distances.begin() + static_cast<ptrdiff_t>(numShifts));
+    shiftMasks.assign(numShifts * words, 0);
+    vector<vector<uint32_t>> others(m);
+    for (size_t position = 0; position < m; ++position) {
+        for (auto i = nfa.followBegin[position]; i < nfa.followBegin[position + 1]; ++i) {
+            const auto target = nfa.followTargets[i];
+            if (const auto r = rank[static_cast<int32_t>(target) - static_cast<int32_t>(position)]; r < numShifts) {
+                set(shiftMasks, r * words, target);
+            } else {
+                others[position].push_back(target);
+            }
+        }
+    }
+    for (uint32_t chunk = 0; chunk < numChunks; ++chunk) {
+        bool irregular = false;
+        for (size_t position = chunk * 8; position < min<size_t>(m, chunk * 8 + 8); ++position) {
+            irregular = irregular || !others[position].empty();
+        }
+        if (!irregular) {
+            continue;
+        }
+        const size_t base = chunkTables.size();
+        chunks.push_back(chunk);
+        chunkTables.resize(base + 256 * words, 0);
+        for (size_t value = 1; value < 256; ++value) {
+            const size_t lowest = countr_zero(value);
+            for (size_t w = 0; w < words; ++w) {
+                chunkTables[base + value * words + w] = chunkTables[base + (value & (value - 1)) * words + w];
+            }
+            if (chunk * 8 + lowest < m) {
+                for (const auto target : others[chunk * 8 + lowest]) {
+                    set(chunkTables, base + value * words, target);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * The masks copied into fixed-size arrays, so that the steps are unrolled for the number of words.
+ * The shifts toward the higher and the lower positions are split, so that the amounts are never negated in the steps.
+ */
+template<size_t W>
+struct BitParallelScanner {
+    const BitParallelNFA& nfa;
+    Bits<W> first{}, last{};
+    size_t numUp = 0, numDown = 0;
+    array<uint32_t, BitParallelNFA::MAX_SHIFTS> upAmounts{}, downAmounts{};
+    array<Bits<W>, BitParallelNFA::MAX_SHIFTS> upMasks{}, downMasks{};
+
+    explicit BitParallelScanner(const BitParallelNFA& nfa) : nfa(nfa) {
+        for (size_t w = 0; w < W; ++w) {
+            first[w] = nfa.first[w];
+            last[w] = nfa.last[w];
+        }
+        for (size_t i = 0; i < nfa.shifts.size(); ++i) {
+            const auto distance = nfa.shifts[i];
+            auto& mask = distance >= 0 ? upMasks[numUp] : downMasks[numDown];
+            for (size_t w = 0; w < W; ++w) {
+                mask[w] = nfa.shiftMasks[i * W + w];
+            }
+            if (distance >= 0) {
+                upAmounts[numUp++] = static_cast<uint32_t>(distance);
+            } else {
+                downAmounts[numDown++] = static_cast<uint32_t>(-distance);
+            }
+        }
+    }
+
+    static bool any(const Bits<W>& bits) {
+        uint64_t result = 0;
+        for (size_t w = 0; w < W; ++w) {
+            result |= bits[w];
+        }
+        return result != 0;
+    }
+
+    [[nodiscard]] bool accepting(const Bits<W>& state) const {
+        uint64_t result = 0;
+        for (size_t w = 0; w < W; ++w) {
+            result |= state[w] & last[w];
+        }
+        return result != 0;
+    }
+
+    /**
+     * The amounts are less than 64, and the carried bits are shifted in two steps so that an amount of 0 is defined.
+     */
+    static void shiftUp(const Bits<W>& bits, const uint32_t amount, const Bits<W>& mask, Bits<W>& result) {
+        for (size_t w = 0; w < W; ++w) {
+            uint64_t moved = bits[w] << amount;
+            if (w > 0) {
+                moved |= bits[w - 1] >> 1 >> (63 - amount);
+            }
+            result[w] |= moved & mask[w];
+        }
+    }
+
+    static void shiftDown(const Bits<W>& bits, const uint32_t amount, const Bits<W>& mask, Bits<W>& result) {
+        for (size_t w = 0; w < W; ++w) {
+            uint64_t moved = bits[w] >> amount;
+            if (w + 1 < W) {
+                moved |= bits[w + 1] << 1 << (63 - amount);
+            }
+            result[w] |= moved & mask[w];
+        }
+    }
+
+    [[nodiscard]] Bits<W> step(const Bits<W>& state, const uint8_t byte, const bool inject) const {
+        Bits<W> next{};
+        for (size_t i = 0; i < numUp; ++i) {
+            shiftUp(state, upAmounts[i], upMasks[i], next);
+        }
+        for (size_t i = 0; i < numDown; ++i) {
+            shiftDown(state, downAmounts[i], downMasks[i], next);
+        }
+        for (size_t i = 0; i < nfa.chunks.size(); ++i) {
+            const auto chunk = nfa.chunks[i];
+            const auto value = state[chunk / 8] >> chunk % 8 * 8 & 0xff;
+            const uint64_t* table = nfa.chunkTables.data() + (i * 256 + value) * W;
+            for (size_t w = 0; w < W; ++w) {
+                next[w] |= table[w];
+            }
+        }
+        const uint64_t* mask = nfa.byteMasks.data() + byte * W;
+        for (size_t w = 0; w < W; ++w) {
+            next[w] = (inject ? next[w] | first[w] : next[w]) & mask[w];
+        }
+        return next;
+    }
+};
+
+template<typename Function>
+static auto withScanner(const BitParallelNFA& nfa, Function&& function) {
+    switch (nfa.words) {
+        case 1:
+            return function(BitParallelScanner<1>(nfa));
+        case 2:
+            return function(BitParallelScanner<2>(nfa));
+        default:
+            return function(BitParallelScanner<4>(nfa));
+    }
+}
+
+bool BitParallelNFA::match(const string_view text) const {
+    return withScanner(*this, [&](const auto& scanner) {
+        if (text.empty()) {
+            return nullable;
+        }
+        auto state = scanner.step({}, static_cast<uint8_t>(text[0]), true);
+        for (size_t i = 1; i < text.size() && scanner.any(state); ++i) {
+            state = scanner.step(state, static_cast<uint8_t>(text[i]), false);
+        }
+        return scanner.accepting(state);
+    });
+}
+
+size_t BitParallelNFA::longestPrefix(const string_view text) const {
+    return withScanner(*this, [&](const auto& scanner) {
+        size_t last = nullable ? 0 : string_view::npos;
+        if (text.empty()) {
+            return last;
+        }
+        auto state = scanner.step({}, static_cast<uint8_t>(text[0]), true);
+        for (size_t i = 1; scanner.any(state); ++i) {
+            if (scanner.accepting(state)) {
+                last = i;
+            }
+            if (i == text.size()) {
+                break;
+            }
+            state = scanner.step(state, static_cast<uint8_t>(text[i]), false);
+        }
+        return last;
+    });
+}
+
+size_t BitParallelNFA::leftmostAcceptReversed(const string_view text) const {
+    if (nullable) {
+        return 0;
+    }
+    return withScanner(*this, [&](const auto& scanner) {
+        size_t last = string_view::npos;
+        decltype(scanner.first) state{};
+        for (size_t i = text.size(); i-- > 0;) {
+            state = scanner.step(state, static_cast<uint8_t>(text[i]), true);
+            if (scanner.accepting(state)) {
+                last = i;
+            }
+        }
+        return last;
+    });
+}
+
+BitParallelMatcher::BitParallelMatcher(const RegularExpression& regex) {
+    if (!regex.ast()) {
+        _errorMessage = regex.errorMessage();
+        return;
+    }
+    auto forward = regex.toGlushkovNFA();
+    _numPositions = forward.size();
+    if (_numPositions > BitParallelNFA::MAX_POSITIONS) {
+        _errorMessage = "Error: the pattern has " + to_string(_numPositions) + " byte positions, more than "
+                        + to_string(BitParallelNFA::MAX_POSITIONS) + ".";
+        return;
+    }
+    _prefilter = LiteralPrefilter(regex.literals());
+    _forward = BitParallelNFA(forward);
+    _reverse = BitParallelNFA(regex.toGlushkovNFA(true));
+}
+
+BitParallelMatcher::BitParallelMatcher(const string& pattern) : BitParallelMatcher(RegularExpression(pattern)) {}
+
+const string& BitParallelMatcher::errorMessage() const {
+    return _errorMessage;
+}
+
+size_t BitParallelMatcher::numPositions() const {
+    return _numPositions;
+}
+
+bool BitParallelMatcher::match(const string_view text) const {
+    return _forward.match(text);
+}
+
+size_t BitParallelMatcher::longestPrefix(const string_view text) const {
+    return _forward.longestPrefix(text);
+}
+
+optional<RegexMatch> BitParallelMatcher::find(const string_view text) const {
+    return _prefilter.find(text, [&](const string_view rest) -> optional<RegexMatch> {
+        const auto begin = _reverse.leftmostAcceptReversed(rest);
+        if (begin == string_view::npos) {
+            return nullopt;
+        }
+        return RegexMatch{begin, begin + _forward.longestPrefix(rest.substr(begin))};
+    }, [&](const string_view rest) {
+        return _forward.longestPrefix(rest);
+    });
+}
@@ -0,0 +1,146 @@
+#include "re.h"
+#include <algorithm>
+
+using namespace std;
+
+using ByteRanges = vector<pair<uint8_t, uint8_t>>;
+
+static constexpr uint32_t SURROGATE_BEGIN = 0xD800;
+static constexpr uint32_t SURROGATE_END = 0xDFFF;
+
+void CharClass::add(const uint32_t lo, const uint32_t hi) {
+    intervals.emplace_back(lo, hi);
+}
+
+void CharClass::add(const CharClass& other) {
+    intervals.insert(intervals.end(), other.intervals.begin(), other.intervals.end());
+}
+
+void CharClass::normalize() {
+    ranges::sort(intervals);
+    size_t size = 0;
+    for (const auto& [lo, hi] : intervals) {
+        if (size > 0 && lo <= intervals[size - 1].second + 1) {
+            intervals[size - 1].second = max(intervals[size - 1].second, hi);
+        } else {
+            intervals[size++] = {lo, hi};
+        }
+    }
+    intervals.resize(size);
+}
+
+bool CharClass::contains(const uint32_t codePoint) const {
+    const auto it = ranges::upper_bound(intervals, codePoint, {}, [](const auto& interval) { return interval.first; });
+    return it != intervals.begin() && prev(it)->second >= codePoint;
+}
+
+CharClass CharClass::negated() const {
+    CharClass result;
+    uint32_t next = 0;
+    for (const auto& [lo, hi] : intervals) {
+        if (lo > next) {
+            result.add(next, lo - 1);
+        }
+        next = hi + 1;
+    }
+    if (next <= MAX_CODE_POINT) {
+        result.add(next, MAX_CODE_POINT);
+    }
+    return result;
+}
+
+static size_t encodeUTF8(const uint32_t codePoint, uint8_t* bytes) {
+    if (codePoint < 0x80) {
+        bytes[0] = static_cast<uint8_t>(codePoint);
+        return 1;
+    }
+    if (codePoint < 0x800) {
+        bytes[0] = static_cast<uint8_t>(0xC0 | codePoint >> 6);
+        bytes[1] = static_cast<uint8_t>(0x80 | (codePoint & 0x3F));
+        return 2;
+    }
+    if (codePoint < 0x10000) {
+        bytes[0] = static_cast<uint8_t>(0xE0 | codePoint >> 12);
+        bytes[1] = static_cast<uint8_t>(0x80 | (codePoint >> 6 & 0x3F));
+        bytes[2] = static_cast<uint8_t>(0x80 | (codePoint & 0x3F));
+        return 3;
+    }
+    bytes[0] = static_cast<uint8_t>(0xF0 | codePoint >> 18);
+    bytes[1] = static_cast<uint8_t>(0x80 | (codePoint >> 12 & 0x3F));
+    bytes[2] = static_cast<uint8_t>(0x80 | (codePoint >> 6 & 0x3F));
+    bytes[3] = static_cast<uint8_t>(0x80 | (codePoint & 0x3F));
+    return 4;
+}
+
+string CharClass::toUTF8(const uint32_t codePoint) {
+    uint8_t bytes[4];
+    const auto length = encodeUTF8(codePoint, bytes);
+    return {reinterpret_cast<const char*>(bytes), length};
+}
+
+optional<uint32_t> CharClass::fromUTF8(const string& s) {
+    if (s.empty()) {
+        return nullopt;
+    }
+    const auto lead = static_cast<uint8_t>(s[0]);
+    const size_t length = lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+    if (s.size() != length) {
+        return nullopt;
+    }
+    uint32_t codePoint = length == 1 ? lead : lead & (0x7F >> length);
+    for (size_t i = 1; i < length; ++i) {
+        codePoint = codePoint << 6 | (static_cast<uint8_t>(s[i]) & 0x3F);
+    }
+    return codePoint;
+}
+
+/**
+ * The range is split until its ends have the same length of encoding and differ only in bytes
+ * whose ranges are independent, i.e. the lower end has all the trailing bits 0 and the upper end has all of them 1.
+ * Then the byte ranges between the encodings of the ends match exactly the code points in the range.
+ */
+static void splitUTF8(const uint32_t lo, const uint32_t hi, vector<ByteRanges>& sequences) {
+    for (const uint32_t maxOfLength : {0x7Fu, 0x7FFu, 0xFFFFu}) {
+        if (lo <= maxOfLength && hi > maxOfLength) {
+            splitUTF8(lo, maxOfLength, sequences);
+            splitUTF8(maxOfLength + 1, hi, sequences);
+            return;
+        }
+    }
+    for (uint32_t i = 1; i < 4; ++i) {
+        const uint32_t mask = (1u << 6 * i) - 1;
+        if ((lo & ~mask) != (hi & ~mask)) {
+            if ((lo & mask) != 0) {
+                splitUTF8(lo, lo | mask, sequences);
+                splitUTF8((lo | mask) + 1, hi, sequences);
+                return;
+            }
+            if ((hi & mask) != mask) {
+                splitUTF8(lo, (hi & ~mask) - 1, sequences);
+                splitUTF8(hi & ~mask, hi, sequences);
+                return;
+            }
+        }
+    }
+    uint8_t loBytes[4], hiBytes[4];
+    const auto length = encodeUTF8(lo, loBytes);
+    encodeUTF8(hi, hiBytes);
+    ByteRanges sequence;
+    for (size_t i = 0; i < length; ++i) {
+        sequence.emplace_back(loBytes[i], hiBytes[i]);
+    }
+    sequences.push_back(std::move(sequence));
+}
+
+vector<ByteRanges> CharClass::utf8Sequences() const {
+    vector<ByteRanges> sequences;
+    for (const auto& [lo, hi] : intervals) {
+        if (lo < SURROGATE_BEGIN) {
+            splitUTF8(lo, min(hi, SURROGATE_BEGIN - 1), sequences);
+        }
+        if (hi > SURROGATE_END) {
+            splitUTF8(max(lo, SURROGATE_END + 1), hi, sequences);
+        }
+    }
+    return sequences;
+}
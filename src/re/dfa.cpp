@@ -1,7 +1,7 @@
 #include "re.h"
 #include <algorithm>
-#include <queue>
 #include <ranges>
+#include <span>
 
 using namespace std;
 
@@ -19,82 +19,285 @@ static string toAlphaCount(size_t n) {
     return s;
 }
 
-static shared_ptr<DFAState> getClosure(const vector<shared_ptr<NFAState>>& nodes) {
-    auto closure = make_shared<DFAState>();
-    vector<shared_ptr<NFAState>> stack;
-    unordered_set<size_t> visited;
-    vector<string> symbols;
-
-    for (const auto& node : nodes) {
-        stack.push_back(node);
-        closure->items.push_back(node);
-        visited.insert(node->id);
-        if (node->type == "accept") {
-            closure->type = "accept";
-        }
-    }
-
-    while (!stack.empty()) {
-        const auto top = stack.back();
-        stack.pop_back();
-
-        for (const auto& [label, target] : top->edges) {
-            if (label == RegularExpression::EPSILON) {
-                if (!visited.contains(target->id)) {
-                    stack.push_back(target);
-                    closure->items.push_back(target);
-                    visited.insert(target->id);
-                    if (target->type == "accept") {
-                        closure->type = "accept";
+size_t FlatDFA::size() const {
+    return accepting.size();
+}
+
+size_t FlatDFA::numSymbols() const {
+    return symbols.size();
+}
+
+uint32_t FlatDFA::next(const uint32_t state, const uint32_t symbol) const {
+    return transitions[static_cast<size_t>(state) * symbols.size() + symbol];
+}
+
+size_t NFAStateSetHash::operator()(const vector<uint32_t>& states) const {
+    size_t hash = states.size();
+    for (const auto state : states) {
+        hash ^= state + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+/**
+ * The ε-closures of the start state and the targets of symbol edges, which are the only closures
+ * needed by the subset construction, are computed once and stored in CSR form.
+ * The moves of a DFA state on all the symbols are computed in one pass over its NFA states,
+ * with one bitset per symbol to remove duplicates.
+ *
+ * @param items If not null, the sorted NFA states of each DFA state are stored in it.
+ */
+static FlatDFA subsetConstruction(const FlatNFA& nfa, vector<vector<uint32_t>>* items) {
+    FlatDFA dfa;
+    dfa.symbols = nfa.symbols;
+    dfa.byteClasses = nfa.byteClasses;
+    const size_t n = nfa.size();
+    if (n == 0) {
+        return dfa;
+    }
+    const size_t numSymbols = nfa.numSymbols();
+    const size_t numWords = (n + 63) / 64;
+
+    vector<uint32_t> closureIndex(n, FlatNFA::NONE);
+    vector<uint32_t> closureBegin = {0};
+    vector<uint32_t> closureStates;
+    {
+        vector<uint32_t> stamp(n, FlatNFA::NONE);
+        vector<uint32_t> stack;
+        auto computeClosure = [&](const uint32_t state) {
+            if (closureIndex[state] != FlatNFA::NONE) {
+                return;
+            }
+            const auto index = static_cast<uint32_t>(closureBegin.size() - 1);
+            closureIndex[state] = index;
+            stamp[state] = index;
+            stack.push_back(state);
+            while (!stack.empty()) {
+                const auto top = stack.back();
+                stack.pop_back();
+                closureStates.push_back(top);
+                for (auto i = nfa.epsilonBegin[top]; i < nfa.epsilonBegin[top + 1]; ++i) {
+                    if (const auto target = nfa.epsilonTargets[i]; stamp[target] != index) {
+                        stamp[target] = index;
+                        stack.push_back(target);
                     }
                 }
-            } else {
-                if (ranges::find(symbols, label) == symbols.end()) {
-                    symbols.push_back(label);
-                }
             }
+            closureBegin.push_back(static_cast<uint32_t>(closureStates.size()));
+        };
+        computeClosure(nfa.start);
+        for (const auto target : nfa.edgeTargets) {
+            computeClosure(target);
         }
     }
+    auto closureOf = [&](const uint32_t state) {
+        const auto index = closureIndex[state];
+        return span(closureStates.data() + closureBegin[index], closureBegin[index + 1] - closureBegin[index]);
+    };
+
+    unordered_map<vector<uint32_t>, uint32_t, NFAStateSetHash> stateIds;
+    vector<const vector<uint32_t>*> states;
+    auto addState = [&](vector<uint32_t>&& nfaStates) {
+        const auto [it, inserted] = stateIds.try_emplace(std::move(nfaStates), static_cast<uint32_t>(states.size()));
+        if (inserted) {
+            states.push_back(&it->first);
+            dfa.accepting.push_back(ranges::binary_search(it->first, nfa.accept));
+            dfa.transitions.resize(dfa.transitions.size() + numSymbols, FlatDFA::DEAD);
+        }
+        return it->second;
+    };
 
-    ranges::sort(closure->items, [](const auto& a, const auto& b) {
-        return a->id < b->id;
-    });
-    ranges::sort(symbols);
+    {
+        const auto closure = closureOf(nfa.start);
+        vector<uint32_t> first(closure.begin(), closure.end());
+        ranges::sort(first);
+        dfa.start = addState(std::move(first));
+    }
 
-    string key;
-    for (const auto& item : closure->items) {
-        if (!key.empty()) {
-            key += ",";
+    vector<uint64_t> bits(numSymbols * numWords, 0);
+    vector<vector<uint32_t>> moves(numSymbols);
+    vector<uint32_t> touched;
+    for (uint32_t current = 0; current < states.size(); ++current) {
+        for (const auto state : *states[current]) {
+            for (auto i = nfa.edgeBegin[state]; i < nfa.edgeBegin[state + 1]; ++i) {
+                const auto symbol = nfa.edgeSymbols[i];
+                uint64_t* const symbolBits = bits.data() + symbol * numWords;
+                if (moves[symbol].empty()) {
+                    touched.push_back(symbol);
+                }
+                for (const auto target : closureOf(nfa.edgeTargets[i])) {
+                    if (const uint64_t mask = 1ULL << (target & 63); !(symbolBits[target >> 6] & mask)) {
+                        symbolBits[target >> 6] |= mask;
+                        moves[symbol].push_back(target);
+                    }
+                }
+            }
         }
-        key += to_string(item->id);
+        ranges::sort(touched);
+        for (const auto symbol : touched) {
+            uint64_t* const symbolBits = bits.data() + symbol * numWords;
+            for (const auto target : moves[symbol]) {
+                symbolBits[target >> 6] = 0;
+            }
+            ranges::sort(moves[symbol]);
+            const auto next = addState(std::move(moves[symbol]));
+            moves[symbol] = {};
+            dfa.transitions[static_cast<size_t>(current) * numSymbols + symbol] = next;
+        }
+        touched.clear();
     }
-    closure->key = key;
-    closure->symbols = symbols;
 
-    return closure;
+    if (items) {
+        items->clear();
+        items->reserve(states.size());
+        for (const auto state : states) {
+            items->push_back(*state);
+        }
+    }
+    return dfa;
 }
 
-static shared_ptr<DFAState> getClosedMove(const shared_ptr<DFAState>& state, const string& symbol) {
-    vector<shared_ptr<NFAState>> nexts;
-
-    for (const auto& item : state->items) {
-        for (const auto& [label, target] : item->edges) {
-            if (label == symbol) {
-                bool found = false;
-                for (const auto& n : nexts) {
-                    if (n->id == target->id) {
-                        found = true;
-                        break;
-                    }
+FlatDFA RegularExpression::toFlatDFA(const FlatNFA& nfa) {
+    return subsetConstruction(nfa, nullptr);
+}
+
+FlatDFA RegularExpression::toFlatDFA(const FlatNFA& nfa, vector<vector<uint32_t>>& items) {
+    return subsetConstruction(nfa, &items);
+}
+
+/**
+ * The bytes are split into classes by the sets of positions accepting them, numbered in the order of their smallest bytes.
+ * The moves of a DFA state are computed in one pass over its positions with the classes each position accepts,
+ * and the end marker, numbered after the positions, follows the last positions, as in Aho-Sethi-Ullman.
+ */
+FlatDFA RegularExpression::toFlatDFA(const GlushkovNFA& nfa, const bool unanchored) {
+    FlatDFA dfa;
+    const auto n = static_cast<uint32_t>(nfa.size());
+    const uint32_t END = n;
+
+    // The distinct byte sets of the positions refine the partition of the bytes one by one,
+    // then the classes of each set are listed once for all the positions with the set.
+    unordered_map<bitset<256>, uint32_t> setIds;
+    vector<const bitset<256>*> sets;
+    vector<uint32_t> setOf(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        const auto [it, inserted] = setIds.try_emplace(nfa.positionBytes[i], static_cast<uint32_t>(sets.size()));
+        if (inserted) {
+            sets.push_back(&it->first);
+        }
+        setOf[i] = it->second;
+    }
+    dfa.byteClasses.assign(256, 0);
+    uint32_t numClasses = 1;
+    for (const auto* bytes : sets) {
+        vector<uint32_t> renumber(numClasses * 2, FlatNFA::NONE);
+        uint32_t next = 0;
+        for (uint32_t byte = 0; byte < 256; ++byte) {
+            auto& id = renumber[dfa.byteClasses[byte] * 2 + (*bytes)[byte]];
+            if (id == FlatNFA::NONE) {
+                id = next++;
+            }
+            dfa.byteClasses[byte] = id;
+        }
+        numClasses = next;
+    }
+    vector<vector<uint32_t>> classBytes(numClasses);
+    for (uint32_t byte = 0; byte < 256; ++byte) {
+        classBytes[dfa.byteClasses[byte]].push_back(byte);
+    }
+    for (const auto& bytes : classBytes) {
+        dfa.symbols.push_back(FlatNFA::byteClassLabel(bytes));
+    }
+    const size_t numSymbols = dfa.numSymbols();
+
+    vector<uint32_t> setClassBegin = {0};
+    vector<uint32_t> setClasses;
+    for (const auto* bytes : sets) {
+        for (uint32_t symbol = 0; symbol < numSymbols; ++symbol) {
+            if ((*bytes)[classBytes[symbol][0]]) {
+                setClasses.push_back(symbol);
+            }
+        }
+        setClassBegin.push_back(static_cast<uint32_t>(setClasses.size()));
+    }
+    vector<bool> isLast(n, false);
+    for (const auto position : nfa.last) {
+        isLast[position] = true;
+    }
+
+    vector<uint32_t> startSet = nfa.first;
+    if (nfa.nullable) {
+        startSet.push_back(END);
+    }
+    // Without an anchor, the start positions can be entered after any byte, so they are in every state,
+    // and the bytes no position accepts lead back to the start state.
+    const uint32_t missing = unanchored ? 0 : FlatDFA::DEAD;
+    unordered_map<vector<uint32_t>, uint32_t, NFAStateSetHash> stateIds;
+    vector<const vector<uint32_t>*> states;
+    auto addState = [&](vector<uint32_t>&& positions) {
+        const auto [it, inserted] = stateIds.try_emplace(std::move(positions), static_cast<uint32_t>(states.size()));
+        if (inserted) {
+            states.push_back(&it->first);
+            dfa.accepting.push_back(!it->first.empty() && it->first.back() == END);
+            dfa.transitions.resize(dfa.transitions.size() + numSymbols, missing);
+        }
+        return it->second;
+    };
+    dfa.start = addState(vector<uint32_t>(startSet));
+
+    const size_t numWords = (n + 64) / 64;
+    vector<uint64_t> bits(numSymbols * numWords, 0);
+    vector<vector<uint32_t>> moves(numSymbols);
+    vector<uint32_t> touched;
+    vector<bool> isTouched(numSymbols, false);
+    auto addMove = [&](const uint32_t symbol, const uint32_t target) {
+        if (const uint64_t mask = 1ULL << (target & 63); !(bits[symbol * numWords + (target >> 6)] & mask)) {
+            bits[symbol * numWords + (target >> 6)] |= mask;
+            moves[symbol].push_back(target);
+        }
+    };
+    for (uint32_t current = 0; current < states.size(); ++current) {
+        for (const auto position : *states[current]) {
+            if (position == END) {
+                continue;
+            }
+            const auto set = setOf[position];
+            for (auto k = setClassBegin[set]; k < setClassBegin[set + 1]; ++k) {
+                const auto symbol = setClasses[k];
+                if (!isTouched[symbol]) {
+                    isTouched[symbol] = true;
+                    touched.push_back(symbol);
+                }
+                for (auto i = nfa.followBegin[position]; i < nfa.followBegin[position + 1]; ++i) {
+                    addMove(symbol, nfa.followTargets[i]);
                 }
-                if (!found) {
-                    nexts.push_back(target);
+                if (isLast[position]) {
+                    addMove(symbol, END);
+                }
+            }
+        }
+        ranges::sort(touched);
+        for (const auto symbol : touched) {
+            isTouched[symbol] = false;
+            if (unanchored) {
+                for (const auto position : startSet) {
+                    addMove(symbol, position);
                 }
             }
+            for (const auto target : moves[symbol]) {
+                bits[symbol * numWords + (target >> 6)] = 0;
+            }
+            if (moves[symbol].empty()) {
+                continue;
+            }
+            ranges::sort(moves[symbol]);
+            const auto next = addState(std::move(moves[symbol]));
+            moves[symbol] = {};
+            dfa.transitions[static_cast<size_t>(current) * numSymbols + symbol] = next;
         }
+        touched.clear();
     }
-
-    return getClosure(nexts);
+    return dfa;
 }
 
 shared_ptr<DFAState> RegularExpression::toDFA(const shared_ptr<NFAState>& nfa) {
@@ -102,30 +305,42 @@ shared_ptr<DFAState> RegularExpression::toDFA(const shared_ptr<NFAState>& nfa) {
         return nullptr;
     }
 
-    auto first = getClosure({nfa});
-    unordered_map<string, shared_ptr<DFAState>> states;
-    queue<shared_ptr<DFAState>> q;
-    size_t count = 0;
+    vector<shared_ptr<NFAState>> nfaStates;
+    const auto flat = FlatNFA::fromNFA(nfa, &nfaStates);
+    vector<vector<uint32_t>> items;
+    const auto dfa = subsetConstruction(flat, &items);
 
-    first->id = toAlphaCount(count++);
-    states[first->key] = first;
-    q.push(first);
-
-    while (!q.empty()) {
-        auto top = q.front();
-        q.pop();
-
-        for (const auto& symbol : top->symbols) {
-            auto closure = getClosedMove(top, symbol);
-            if (!states.contains(closure->key)) {
-                closure->id = toAlphaCount(count++);
-                states[closure->key] = closure;
-                q.push(closure);
+    vector<shared_ptr<DFAState>> states(dfa.size());
+    for (size_t i = 0; i < dfa.size(); ++i) {
+        const auto state = make_shared<DFAState>();
+        state->id = toAlphaCount(i);
+        for (const auto item : items[i]) {
+            state->items.push_back(nfaStates[item]);
+            if (nfaStates[item]->type == "accept") {
+                state->type = "accept";
+            }
+        }
+        ranges::sort(state->items, [](const auto& a, const auto& b) {
+            return a->id < b->id;
+        });
+        for (const auto& item : state->items) {
+            if (!state->key.empty()) {
+                state->key += ",";
+            }
+            state->key += to_string(item->id);
+        }
+        states[i] = state;
+    }
+    for (uint32_t i = 0; i < dfa.size(); ++i) {
+        for (uint32_t symbol = 0; symbol < dfa.numSymbols(); ++symbol) {
+            if (const auto next = dfa.next(i, symbol); next != FlatDFA::DEAD) {
+                const auto& label = dfa.symbols[symbol];
+                states[i]->symbols.push_back(label);
+                states[i]->trans[label] = states[next];
+                states[i]->edges.emplace_back(label, states[next]);
             }
-            top->trans[symbol] = states[closure->key];
-            top->edges.emplace_back(symbol, states[closure->key]);
         }
     }
 
-    return first;
+    return states[dfa.start];
 }
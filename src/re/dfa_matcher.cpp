@@ -0,0 +1,200 @@
+#include "re_matcher.h"
+#include <map>
+#include <stdexcept>
+
+using namespace std;
+
+DenseDFA::DenseDFA() : table16(1, 0) {}
+
+/**
+ * The byte classes of the NFA are merged again if their columns in the DFA are identical,
+ * e.g. the bytes in `a|b|c` lead to different NFA states but to the same DFA state.
+ */
+DenseDFA::DenseDFA(const FlatDFA& dfa, const vector<uint32_t>* labels) {
+    if (dfa.size() == 0) {
+        table16.assign(1, 0);
+        return;
+    }
+    if (dfa.byteClasses.size() != 256) {
+        throw runtime_error("The DFA should be built from an NFA over bytes.");
+    }
+
+    const size_t n = dfa.size();
+    vector<uint32_t> index(n);
+    uint32_t next = 1;
+    for (uint32_t i = 0; i < n; ++i) {
+        if (!dfa.accepting[i]) {
+            index[i] = next++;
+        }
+    }
+    const uint32_t numRejecting = next;
+    for (uint32_t i = 0; i < n; ++i) {
+        if (dfa.accepting[i]) {
+            index[i] = next++;
+            if (labels) {
+                acceptLabels.push_back((*labels)[i]);
+            }
+        }
+    }
+
+    map<vector<uint32_t>, uint32_t> columns;
+    vector<uint32_t> classOfSymbol(dfa.numSymbols());
+    vector<uint32_t> representative;
+    for (uint32_t symbol = 0; symbol < dfa.numSymbols(); ++symbol) {
+        vector<uint32_t> column(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            column[i] = dfa.next(i, symbol);
+        }
+        const auto [it, inserted] = columns.try_emplace(std::move(column), static_cast<uint32_t>(representative.size()));
+        if (inserted) {
+            representative.push_back(symbol);
+        }
+        classOfSymbol[symbol] = it->second;
+    }
+    numClasses = representative.size();
+    for (size_t byte = 0; byte < 256; ++byte) {
+        classes[byte] = static_cast<uint8_t>(classOfSymbol[dfa.byteClasses[byte]]);
+    }
+
+    const size_t total = (n + 1) * numClasses;
+    vector<uint32_t> table(total, 0);
+    for (uint32_t i = 0; i < n; ++i) {
+        for (uint32_t c = 0; c < numClasses; ++c) {
+            if (const auto target = dfa.next(i, representative[c]); target != FlatDFA::DEAD) {
+                table[index[i] * numClasses + c] = index[target] * static_cast<uint32_t>(numClasses);
+            }
+        }
+    }
+    if (total <= numeric_limits<uint16_t>::max()) {
+        table16.assign(table.begin(), table.end());
+    } else {
+        table32 = std::move(table);
+    }
+    start = index[dfa.start] * static_cast<uint32_t>(numClasses);
+    acceptBegin = numRejecting * static_cast<uint32_t>(numClasses);
+}
+
+size_t DenseDFA::size() const {
+    return (table16.empty() ? table32.size() : table16.size()) / numClasses;
+}
+
+/**
+ * Run the function with the transition table of the actual entry type.
+ */
+template<typename Function>
+static auto withTable(const DenseDFA& dfa, Function&& function) {
+    return dfa.table16.empty() ? function(dfa.table32.data()) : function(dfa.table16.data());
+}
+
+bool DenseDFA::match(const string_view text) const {
+    return withTable(*this, [&](const auto* table) {
+        uint32_t state = start;
+        for (const char ch : text) {
+            state = table[state + classes[static_cast<uint8_t>(ch)]];
+            if (state == 0) {
+                return false;
+            }
+        }
+        return state >= acceptBegin;
+    });
+}
+
+size_t DenseDFA::longestPrefix(const string_view text) const {
+    return withTable(*this, [&](const auto* table) {
+        uint32_t state = start;
+        size_t last = state >= acceptBegin ? 0 : string_view::npos;
+        for (size_t i = 0; i < text.size(); ++i) {
+            state = table[state + classes[static_cast<uint8_t>(text[i])]];
+            if (state == 0) {
+                break;
+            }
+            if (state >= acceptBegin) {
+                last = i + 1;
+            }
+        }
+        return last;
+    });
+}
+
+pair<size_t, uint32_t> DenseDFA::longestLabelledPrefix(const string_view text) const {
+    return withTable(*this, [&](const auto* table) {
+        uint32_t state = start, lastState = 0;
+        size_t last = string_view::npos;
+        if (state >= acceptBegin) {
+            last = 0;
+            lastState = state;
+        }
+        for (size_t i = 0; i < text.size(); ++i) {
+            state = table[state + classes[static_cast<uint8_t>(text[i])]];
+            if (state == 0) {
+                break;
+            }
+            if (state >= acceptBegin) {
+                last = i + 1;
+                lastState = state;
+            }
+        }
+        if (last == string_view::npos) {
+            return pair<size_t, uint32_t>(last, 0);
+        }
+        return pair<size_t, uint32_t>(last, acceptLabels[(lastState - acceptBegin) / numClasses]);
+    });
+}
+
+size_t DenseDFA::leftmostAcceptReversed(const string_view text) const {
+    return withTable(*this, [&](const auto* table) {
+        uint32_t state = start;
+        size_t last = state >= acceptBegin ? text.size() : string_view::npos;
+        for (size_t i = text.size(); i-- > 0;) {
+            state = table[state + classes[static_cast<uint8_t>(text[i])]];
+            if (state == 0) {
+                break;
+            }
+            if (state >= acceptBegin) {
+                last = i;
+            }
+        }
+        return last;
+    });
+}
+
+/**
+ * The DFAs are built from the positions of the pattern, which skips the ε-NFA and its closures.
+ */
+DFAMatcher::DFAMatcher(const RegularExpression& regex) : _prefilter(regex.literals()) {
+    if (!regex.ast()) {
+        return;
+    }
+    _forward = DenseDFA(RegularExpression::toMinFlatDFA(RegularExpression::toFlatDFA(regex.toGlushkovNFA())));
+    _reverse = DenseDFA(RegularExpression::toMinFlatDFA(RegularExpression::toFlatDFA(regex.toGlushkovNFA(true), true)));
+}
+
+DFAMatcher::DFAMatcher(const string& pattern) : DFAMatcher(RegularExpression(pattern)) {}
+
+size_t DFAMatcher::numStates() const {
+    return _forward.size();
+}
+
+size_t DFAMatcher::numClasses() const {
+    return _forward.numClasses;
+}
+
+bool DFAMatcher::match(const string_view text) const {
+    return _forward.match(text);
+}
+
+size_t DFAMatcher::longestPrefix(const string_view text) const {
+    return _forward.longestPrefix(text);
+}
+
+optional<RegexMatch> DFAMatcher::find(const string_view text) const {
+    return _prefilter.find(text, [&](const string_view rest) -> optional<RegexMatch> {
+        const auto begin = _reverse.leftmostAcceptReversed(rest);
+        if (begin == string_view::npos) {
+            return nullopt;
+        }
+        return RegexMatch{begin, begin + _forward.longestPrefix(rest.substr(begin))};
+    }, [&](const string_view rest) {
+        return _forward.longestPrefix(rest);
+    });
+}
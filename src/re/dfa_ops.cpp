@@ -0,0 +1,268 @@
+#include "re.h"
+#include <numeric>
+#include <stdexcept>
+
+using namespace std;
+
+/**
+ * The symbols shared by two DFAs, with the symbol of each DFA for each of them,
+ * and the shortest text of each symbol for building counterexamples.
+ */
+struct JointSymbols {
+    vector<string> symbols;
+    vector<uint32_t> byteClasses;
+    vector<uint32_t> symbolOfA;
+    vector<uint32_t> symbolOfB;
+    vector<string> texts;
+};
+
+/**
+ * The bytes are split into classes by the pairs of their classes in the two DFAs, numbered in the order of their smallest bytes.
+ */
+static JointSymbols joinSymbols(const FlatDFA& a, const FlatDFA& b) {
+    JointSymbols joint;
+    if (a.byteClasses.size() == 256 && b.byteClasses.size() == 256) {
+        unordered_map<uint64_t, uint32_t> ids;
+        vector<vector<uint32_t>> classBytes;
+        joint.byteClasses.resize(256);
+        for (uint32_t byte = 0; byte < 256; ++byte) {
+            const uint64_t key = static_cast<uint64_t>(a.byteClasses[byte]) << 32 | b.byteClasses[byte];
+            const auto [it, inserted] = ids.try_emplace(key, static_cast<uint32_t>(classBytes.size()));
+            if (inserted) {
+                classBytes.emplace_back();
+                joint.symbolOfA.push_back(a.byteClasses[byte]);
+                joint.symbolOfB.push_back(b.byteClasses[byte]);
+                joint.texts.emplace_back(1, static_cast<char>(byte));
+            }
+            joint.byteClasses[byte] = it->second;
+            classBytes[it->second].push_back(byte);
+        }
+        for (const auto& bytes : classBytes) {
+            joint.symbols.push_back(FlatNFA::byteClassLabel(bytes));
+        }
+        return joint;
+    }
+    if (!a.byteClasses.empty() || !b.byteClasses.empty() || a.symbols != b.symbols) {
+        throw runtime_error("The DFAs should be built from NFAs over bytes or have the same symbols.");
+    }
+    joint.symbols = a.symbols;
+    joint.symbolOfA.resize(a.numSymbols());
+    iota(joint.symbolOfA.begin(), joint.symbolOfA.end(), 0);
+    joint.symbolOfB = joint.symbolOfA;
+    joint.texts = a.symbols;
+    return joint;
+}
+
+/**
+ * The states of a DFA with the dead state as an explicit sink numbered size(), so that the pairs are total.
+ */
+struct SinkDFA {
+    const FlatDFA& dfa;
+    uint32_t sink;
+
+    explicit SinkDFA(const FlatDFA& dfa) : dfa(dfa), sink(static_cast<uint32_t>(dfa.size())) {}
+
+    [[nodiscard]] uint32_t start() const {
+        return dfa.start == FlatDFA::DEAD ? sink : dfa.start;
+    }
+
+    [[nodiscard]] uint32_t next(const uint32_t state, const uint32_t symbol) const {
+        if (state == sink) {
+            return sink;
+        }
+        const auto target = dfa.next(state, symbol);
+        return target == FlatDFA::DEAD ? sink : target;
+    }
+
+    [[nodiscard]] bool accepting(const uint32_t state) const {
+        return state != sink && dfa.accepting[state];
+    }
+};
+
+/**
+ * A pair is dead if no string from it can be accepted, which is known without a search when a side is the sink,
+ * e.g. any pair with a sink for the intersection.
+ * @param accept Whether a pair is accepting by the acceptance of its sides, which should be false if both are rejecting.
+ */
+template<typename Accept>
+static FlatDFA product(const FlatDFA& a, const FlatDFA& b, Accept&& accept) {
+    const auto joint = joinSymbols(a, b);
+    const SinkDFA sinkA(a), sinkB(b);
+    const bool aliveWithoutA = accept(false, true);
+    const bool aliveWithoutB = accept(true, false);
+    auto isDead = [&](const uint32_t p, const uint32_t q) {
+        return (p == sinkA.sink && (q == sinkB.sink || !aliveWithoutA)) || (q == sinkB.sink && !aliveWithoutB);
+    };
+
+    FlatDFA dfa;
+    dfa.symbols = joint.symbols;
+    dfa.byteClasses = joint.byteClasses;
+    const size_t numSymbols = dfa.numSymbols();
+    unordered_map<uint64_t, uint32_t> stateIds;
+    vector<pair<uint32_t, uint32_t>> states;
+    auto addState = [&](const uint32_t p, const uint32_t q) {
+        if (isDead(p, q)) {
+            return FlatDFA::DEAD;
+        }
+        const auto [it, inserted] = stateIds.try_emplace(static_cast<uint64_t>(p) << 32 | q, static_cast<uint32_t>(states.size()));
+        if (inserted) {
+            states.emplace_back(p, q);
+            dfa.accepting.push_back(accept(sinkA.accepting(p), sinkB.accepting(q)));
+            dfa.transitions.resize(dfa.transitions.size() + numSymbols, FlatDFA::DEAD);
+        }
+        return it->second;
+    };
+    dfa.start = addState(sinkA.start(), sinkB.start());
+    for (uint32_t current = 0; current < states.size(); ++current) {
+        for (uint32_t symbol = 0; symbol < numSymbols; ++symbol) {
+            const auto [p, q] = states[current];
+            const auto target = addState(sinkA.next(p, joint.symbolOfA[symbol]), sinkB.next(q, joint.symbolOfB[symbol]));
+            dfa.transitions[static_cast<size_t>(current) * numSymbols + symbol] = target;
+        }
+    }
+    return dfa;
+}
+
+FlatDFA RegularExpression::intersectFlatDFA(const FlatDFA& a, const FlatDFA& b) {
+    return product(a, b, [](const bool acceptA, const bool acceptB) { return acceptA && acceptB; });
+}
+
+FlatDFA RegularExpression::unionFlatDFA(const FlatDFA& a, const FlatDFA& b) {
+    return product(a, b, [](const bool acceptA, const bool acceptB) { return acceptA || acceptB; });
+}
+
+FlatDFA RegularExpression::differenceFlatDFA(const FlatDFA& a, const FlatDFA& b) {
+    return product(a, b, [](const bool acceptA, const bool acceptB) { return acceptA && !acceptB; });
+}
+
+/**
+ * The dead state becomes an accepting sink, which is only added if it is reachable.
+ */
+FlatDFA RegularExpression::complementFlatDFA(const FlatDFA& dfa) {
+    FlatDFA result;
+    result.symbols = dfa.symbols;
+    result.byteClasses = dfa.byteClasses;
+    const SinkDFA sinkDFA(dfa);
+    const size_t numSymbols = dfa.numSymbols();
+    result.accepting.resize(dfa.size());
+    for (uint32_t i = 0; i < dfa.size(); ++i) {
+        result.accepting[i] = !dfa.accepting[i];
+    }
+    result.transitions = dfa.transitions;
+    result.start = sinkDFA.start();
+    bool hasSink = result.start == sinkDFA.sink;
+    for (auto& target : result.transitions) {
+        if (target == FlatDFA::DEAD) {
+            target = sinkDFA.sink;
+            hasSink = true;
+        }
+    }
+    if (hasSink) {
+        result.accepting.push_back(true);
+        result.transitions.resize(result.transitions.size() + numSymbols, sinkDFA.sink);
+    }
+    return result;
+}
+
+/**
+ * Rebuild the string of a pair from the symbols on the path of BFS parents.
+ */
+static string pathText(const vector<pair<uint32_t, uint32_t>>& parents, uint32_t index, const JointSymbols& joint) {
+    vector<uint32_t> symbols;
+    while (parents[index].first != FlatDFA::DEAD) {
+        symbols.push_back(parents[index].second);
+        index = parents[index].first;
+    }
+    string text;
+    for (auto it = symbols.rbegin(); it != symbols.rend(); ++it) {
+        text += joint.texts[*it];
+    }
+    return text;
+}
+
+/**
+ * The states of a are numbered first in the union-find, then the states of b. A pair is only visited
+ * if it merges two sets, so at most |a| + |b| + 1 pairs are visited, and the first pair with different acceptance
+ * gives the counterexample.
+ */
+bool RegularExpression::isEquivalentFlatDFA(const FlatDFA& a, const FlatDFA& b, string* counterexample) {
+    const auto joint = joinSymbols(a, b);
+    const SinkDFA sinkA(a), sinkB(b);
+    const uint32_t offset = sinkA.sink + 1;
+    vector<uint32_t> parent(static_cast<size_t>(offset) + sinkB.sink + 1);
+    iota(parent.begin(), parent.end(), 0);
+    auto find = [&](uint32_t x) {
+        while (parent[x] != x) {
+            x = parent[x] = parent[parent[x]];
+        }
+        return x;
+    };
+
+    vector<pair<uint32_t, uint32_t>> pairs;
+    vector<pair<uint32_t, uint32_t>> parents;
+    auto visit = [&](const uint32_t p, const uint32_t q, const uint32_t from, const uint32_t symbol) {
+        const auto rootP = find(p), rootQ = find(q + offset);
+        if (rootP == rootQ) {
+            return true;
+        }
+        parent[rootP] = rootQ;
+        pairs.emplace_back(p, q);
+        parents.emplace_back(from, symbol);
+        if (sinkA.accepting(p) != sinkB.accepting(q)) {
+            if (counterexample) {
+                *counterexample = pathText(parents, static_cast<uint32_t>(pairs.size() - 1), joint);
+            }
+            return false;
+        }
+        return true;
+    };
+    if (!visit(sinkA.start(), sinkB.start(), FlatDFA::DEAD, 0)) {
+        return false;
+    }
+    for (uint32_t current = 0; current < pairs.size(); ++current) {
+        for (uint32_t symbol = 0; symbol < joint.symbols.size(); ++symbol) {
+            const auto [p, q] = pairs[current];
+            if (!visit(sinkA.next(p, joint.symbolOfA[symbol]), sinkB.next(q, joint.symbolOfB[symbol]), current, symbol)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * The pairs whose side of a is the sink are skipped, as nothing is accepted by a from them.
+ */
+bool RegularExpression::isSubsetFlatDFA(const FlatDFA& a, const FlatDFA& b, string* counterexample) {
+    const auto joint = joinSymbols(a, b);
+    const SinkDFA sinkA(a), sinkB(b);
+    unordered_set<uint64_t> visited;
+    vector<pair<uint32_t, uint32_t>> pairs;
+    vector<pair<uint32_t, uint32_t>> parents;
+    auto visit = [&](const uint32_t p, const uint32_t q, const uint32_t from, const uint32_t symbol) {
+        if (p == sinkA.sink || !visited.insert(static_cast<uint64_t>(p) << 32 | q).second) {
+            return true;
+        }
+        pairs.emplace_back(p, q);
+        parents.emplace_back(from, symbol);
+        if (sinkA.accepting(p) && !sinkB.accepting(q)) {
+            if (counterexample) {
+                *counterexample = pathText(parents, static_cast<uint32_t>(pairs.size() - 1), joint);
+            }
+            return false;
+        }
+        return true;
+    };
+    if (!visit(sinkA.start(), sinkB.start(), FlatDFA::DEAD, 0)) {
+        return false;
+    }
+    for (uint32_t current = 0; current < pairs.size(); ++current) {
+        for (uint32_t symbol = 0; symbol < joint.symbols.size(); ++symbol) {
+            const auto [p, q] = pairs[current];
+            if (!visit(sinkA.next(p, joint.symbolOfA[symbol]), sinkB.next(q, joint.symbolOfB[symbol]), current, symbol)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,432 @@
+#include "re.h"
+#include <algorithm>
+#include <numeric>
+#include <ranges>
+
+using namespace std;
+
+size_t FlatNFA::size() const {
+    return edgeBegin.empty() ? 0 : edgeBegin.size() - 1;
+}
+
+size_t FlatNFA::numSymbols() const {
+    return symbols.size();
+}
+
+size_t FlatNFA::numEdges() const {
+    return edgeTargets.size();
+}
+
+size_t FlatNFA::numEpsilonEdges() const {
+    return epsilonTargets.size();
+}
+
+uint32_t FlatNFA::symbolId(const string& label) const {
+    if (!byteClasses.empty()) {
+        return label.size() == 1 ? byteClasses[static_cast<uint8_t>(label[0])] : NONE;
+    }
+    if (const auto it = ranges::lower_bound(symbols, label); it != symbols.end() && *it == label) {
+        return static_cast<uint32_t>(it - symbols.begin());
+    }
+    return NONE;
+}
+
+static string byteLabel(const uint32_t byte) {
+    if (byte > ' ' && byte < 0x7f) {
+        return string(1, static_cast<char>(byte));
+    }
+    constexpr char HEX[] = "0123456789abcdef";
+    return string("\\x") + HEX[byte >> 4] + HEX[byte & 15];
+}
+
+string FlatNFA::byteClassLabel(const vector<uint32_t>& bytes) {
+    string label;
+    for (size_t i = 0, j = 0; i < bytes.size(); i = j) {
+        for (j = i + 1; j < bytes.size() && bytes[j] == bytes[j - 1] + 1; ++j) {}
+        label += byteLabel(bytes[i]);
+        if (j - i > 1) {
+            label += "-" + byteLabel(bytes[j - 1]);
+        }
+    }
+    return bytes.size() > 1 ? "[" + label + "]" : label;
+}
+
+/**
+ * Build the CSR arrays from (from, symbol or NONE for ε, to). The order of edges of each state is kept.
+ */
+static void fillEdges(FlatNFA& nfa, const size_t n, const vector<tuple<uint32_t, uint32_t, uint32_t>>& edges) {
+    nfa.edgeBegin.assign(n + 1, 0);
+    nfa.epsilonBegin.assign(n + 1, 0);
+    for (const auto& [from, symbol, to] : edges) {
+        ++(symbol == FlatNFA::NONE ? nfa.epsilonBegin : nfa.edgeBegin)[from + 1];
+    }
+    for (size_t i = 0; i < n; ++i) {
+        nfa.edgeBegin[i + 1] += nfa.edgeBegin[i];
+        nfa.epsilonBegin[i + 1] += nfa.epsilonBegin[i];
+    }
+    nfa.edgeSymbols.resize(nfa.edgeBegin[n]);
+    nfa.edgeTargets.resize(nfa.edgeBegin[n]);
+    nfa.epsilonTargets.resize(nfa.epsilonBegin[n]);
+    vector<uint32_t> edgeNext(nfa.edgeBegin.begin(), nfa.edgeBegin.end() - 1);
+    vector<uint32_t> epsilonNext(nfa.epsilonBegin.begin(), nfa.epsilonBegin.end() - 1);
+    for (const auto& [from, symbol, to] : edges) {
+        if (symbol == FlatNFA::NONE) {
+            nfa.epsilonTargets[epsilonNext[from]++] = to;
+        } else {
+            nfa.edgeSymbols[edgeNext[from]] = symbol;
+            nfa.edgeTargets[edgeNext[from]++] = to;
+        }
+    }
+}
+
+FlatNFA FlatNFA::reversed() const {
+    FlatNFA result;
+    result.symbols = symbols;
+    result.byteClasses = byteClasses;
+    vector<tuple<uint32_t, uint32_t, uint32_t>> edges;
+    edges.reserve(numEdges() + numEpsilonEdges());
+    for (uint32_t i = 0; i < size(); ++i) {
+        for (auto j = edgeBegin[i]; j < edgeBegin[i + 1]; ++j) {
+            edges.emplace_back(edgeTargets[j], edgeSymbols[j], i);
+        }
+        for (auto j = epsilonBegin[i]; j < epsilonBegin[i + 1]; ++j) {
+            edges.emplace_back(epsilonTargets[j], NONE, i);
+        }
+    }
+    fillEdges(result, size(), edges);
+    result.start = accept;
+    result.accept = start;
+    return result;
+}
+
+FlatNFA FlatNFA::unanchored() const {
+    if (size() == 0) {
+        return *this;
+    }
+    FlatNFA result = *this;
+    const auto loop = static_cast<uint32_t>(size());
+    result.edgeBegin.push_back(result.edgeBegin.back() + static_cast<uint32_t>(numSymbols()));
+    result.epsilonBegin.push_back(result.epsilonBegin.back() + 1);
+    for (uint32_t symbol = 0; symbol < numSymbols(); ++symbol) {
+        result.edgeSymbols.push_back(symbol);
+        result.edgeTargets.push_back(loop);
+    }
+    result.epsilonTargets.push_back(start);
+    result.start = loop;
+    return result;
+}
+
+/**
+ * Edges collected in arbitrary order, with the symbols interned in the order of appearance.
+ * For NFAs over bytes, the symbol edges are collected as byte ranges and converted to byte classes at the end.
+ */
+struct FlatNFAEdges {
+    bool bytes = false;
+    vector<string> labels;
+    unordered_map<string, uint32_t> labelIndex;
+    vector<tuple<uint32_t, uint32_t, uint32_t>> edges;  // (from, symbol or NONE for ε, to)
+    vector<tuple<uint32_t, uint32_t, uint32_t, uint32_t>> byteRanges;  // (from, lo, hi, to)
+
+    void add(const uint32_t from, const string& label, const uint32_t to) {
+        if (label == RegularExpression::EPSILON) {
+            edges.emplace_back(from, FlatNFA::NONE, to);
+            return;
+        }
+        const auto [it, inserted] = labelIndex.try_emplace(label, static_cast<uint32_t>(labels.size()));
+        if (inserted) {
+            labels.push_back(label);
+        }
+        edges.emplace_back(from, it->second, to);
+    }
+
+    void addByteRange(const uint32_t from, const uint32_t lo, const uint32_t hi, const uint32_t to) {
+        byteRanges.emplace_back(from, lo, hi, to);
+    }
+
+    /**
+     * Split the bytes into classes at the boundaries of all the ranges, so that each range is a union of classes.
+     * The bytes that are not covered by any range are merged into a single class.
+     */
+    void buildByteClasses(FlatNFA& nfa) {
+        vector<bool> boundary(257, false);
+        vector<int> coverage(257, 0);
+        for (const auto& [from, lo, hi, to] : byteRanges) {
+            boundary[lo] = boundary[hi + 1] = true;
+            ++coverage[lo];
+            --coverage[hi + 1];
+        }
+        nfa.byteClasses.assign(256, FlatNFA::NONE);
+        vector<vector<uint32_t>> classBytes;
+        uint32_t unused = FlatNFA::NONE;
+        int covered = 0;
+        for (uint32_t byte = 0; byte < 256; ++byte) {
+            covered += coverage[byte];
+            if (covered == 0) {
+                if (unused == FlatNFA::NONE) {
+                    unused = static_cast<uint32_t>(classBytes.size());
+                    classBytes.emplace_back();
+                }
+                nfa.byteClasses[byte] = unused;
+            } else if (byte == 0 || boundary[byte] || nfa.byteClasses[byte - 1] == unused) {
+                nfa.byteClasses[byte] = static_cast<uint32_t>(classBytes.size());
+                classBytes.emplace_back();
+            } else {
+                nfa.byteClasses[byte] = nfa.byteClasses[byte - 1];
+            }
+            classBytes[nfa.byteClasses[byte]].push_back(byte);
+        }
+
+        for (const auto& bytesOfClass : classBytes) {
+            labels.push_back(FlatNFA::byteClassLabel(bytesOfClass));
+        }
+        for (const auto& [from, lo, hi, to] : byteRanges) {
+            for (uint32_t byte = lo; byte <= hi; ++byte) {
+                if (byte == lo || nfa.byteClasses[byte] != nfa.byteClasses[byte - 1]) {
+                    edges.emplace_back(from, nfa.byteClasses[byte], to);
+                }
+            }
+        }
+    }
+
+    /**
+     * Sort the symbol table and build the CSR arrays. The order of edges of each state is kept.
+     * The symbols of NFAs over bytes are byte classes, which are ordered by their smallest bytes instead.
+     */
+    void build(FlatNFA& nfa, const size_t n) {
+        if (bytes) {
+            buildByteClasses(nfa);
+        }
+        vector<uint32_t> order(labels.size());
+        iota(order.begin(), order.end(), 0);
+        if (!bytes) {
+            ranges::sort(order, [&](const uint32_t a, const uint32_t b) { return labels[a] < labels[b]; });
+        }
+        vector<uint32_t> remap(labels.size());
+        nfa.symbols.resize(labels.size());
+        for (uint32_t i = 0; i < order.size(); ++i) {
+            remap[order[i]] = i;
+            nfa.symbols[i] = std::move(labels[order[i]]);
+        }
+
+        for (auto& symbol : edges | views::elements<1>) {
+            if (symbol != FlatNFA::NONE) {
+                symbol = remap[symbol];
+            }
+        }
+        fillEdges(nfa, n, edges);
+    }
+};
+
+FlatNFA FlatNFA::fromNFA(const shared_ptr<NFAState>& nfa, vector<shared_ptr<NFAState>>* states) {
+    FlatNFA result;
+    if (!nfa) {
+        return result;
+    }
+
+    vector<shared_ptr<NFAState>> discovered = {nfa};
+    unordered_map<const NFAState*, uint32_t> index = {{nfa.get(), 0}};
+    for (size_t i = 0; i < discovered.size(); ++i) {
+        for (const auto& target : discovered[i]->edges | views::values) {
+            if (index.try_emplace(target.get(), static_cast<uint32_t>(discovered.size())).second) {
+                discovered.push_back(target);
+            }
+        }
+    }
+
+    const size_t n = discovered.size();
+    vector<bool> used(n, false);
+    bool keepIds = true;
+    for (const auto& state : discovered) {
+        if (state->id >= n || used[state->id]) {
+            keepIds = false;
+            break;
+        }
+        used[state->id] = true;
+    }
+    if (keepIds) {
+        vector<shared_ptr<NFAState>> ordered(n);
+        for (const auto& state : discovered) {
+            ordered[state->id] = state;
+            index[state.get()] = static_cast<uint32_t>(state->id);
+        }
+        discovered = std::move(ordered);
+    }
+
+    FlatNFAEdges edges;
+    for (uint32_t i = 0; i < n; ++i) {
+        for (const auto& [label, target] : discovered[i]->edges) {
+            edges.add(i, label, index.at(target.get()));
+        }
+        if (discovered[i]->type == "accept") {
+            result.accept = i;
+        }
+    }
+    edges.build(result, n);
+    result.start = index.at(nfa.get());
+
+    if (states) {
+        *states = std::move(discovered);
+    }
+    return result;
+}
+
+/**
+ * The same construction and numbering as generateGraph in nfa.cpp, on integer states.
+ */
+static uint32_t generateFlatGraph(const shared_ptr<RegexNode>& node, const uint32_t start, const uint32_t end,
+                                  vector<uint32_t>& ids, FlatNFAEdges& edges, uint32_t count) {
+    auto newState = [&] {
+        ids.push_back(FlatNFA::NONE);
+        return static_cast<uint32_t>(ids.size() - 1);
+    };
+
+    if (ids[start] == FlatNFA::NONE) {
+        ids[start] = count++;
+    }
+
+    switch (node->type) {
+        case RegexNode::Type::EMPTY:
+            edges.add(start, RegularExpression::EPSILON, end);
+            break;
+        case RegexNode::Type::TEXT:
+            if (edges.bytes) {
+                auto last = start;
+                for (size_t i = 0; i + 1 < node->text.size(); ++i) {
+                    const auto temp = newState();
+                    ids[temp] = count++;
+                    const auto byte = static_cast<uint8_t>(node->text[i]);
+                    edges.addByteRange(last, byte, byte, temp);
+                    last = temp;
+                }
+                const auto byte = static_cast<uint8_t>(node->text.back());
+                edges.addByteRange(last, byte, byte, end);
+            } else {
+                edges.add(start, node->text, end);
+            }
+            break;
+        case RegexNode::Type::CLASS:
+            if (edges.bytes) {
+                for (const auto& sequence : node->charClass.utf8Sequences()) {
+                    auto last = start;
+                    for (size_t i = 0; i + 1 < sequence.size(); ++i) {
+                        const auto temp = newState();
+                        ids[temp] = count++;
+                        edges.addByteRange(last, sequence[i].first, sequence[i].second, temp);
+                        last = temp;
+                    }
+                    edges.addByteRange(last, sequence.back().first, sequence.back().second, end);
+                }
+            } else {
+                edges.add(start, node->text, end);
+            }
+            break;
+        case RegexNode::Type::CAT: {
+            auto last = start;
+            for (size_t i = 0; i + 1 < node->parts.size(); ++i) {
+                const auto temp = newState();
+                count = generateFlatGraph(node->parts[i], last, temp, ids, edges, count);
+                last = temp;
+            }
+            count = generateFlatGraph(node->parts.back(), last, end, ids, edges, count);
+            break;
+        }
+        case RegexNode::Type::OR:
+            for (const auto& part : node->parts) {
+                const auto tempStart = newState();
+                const auto tempEnd = newState();
+                edges.add(tempEnd, RegularExpression::EPSILON, end);
+                edges.add(start, RegularExpression::EPSILON, tempStart);
+                count = generateFlatGraph(part, tempStart, tempEnd, ids, edges, count);
+            }
+            break;
+        case RegexNode::Type::STAR: {
+            const auto tempStart = newState();
+            const auto tempEnd = newState();
+            edges.add(tempEnd, RegularExpression::EPSILON, tempStart);
+            edges.add(tempEnd, RegularExpression::EPSILON, end);
+            edges.add(start, RegularExpression::EPSILON, tempStart);
+            edges.add(start, RegularExpression::EPSILON, end);
+            count = generateFlatGraph(node->sub, tempStart, tempEnd, ids, edges, count);
+            break;
+        }
+    }
+
+    if (ids[end] == FlatNFA::NONE) {
+        ids[end] = count++;
+    }
+
+    return count;
+}
+
+/**
+ * @param bytes Whether the symbols are byte classes instead of graphemes.
+ */
+static FlatNFA buildFlatNFA(const shared_ptr<RegexNode>& ast, const bool bytes) {
+    FlatNFA result;
+    if (!ast) {
+        return result;
+    }
+
+    // The edges are first collected on temporary states, which are renumbered by their ids afterward.
+    vector<uint32_t> ids = {FlatNFA::NONE, FlatNFA::NONE};
+    FlatNFAEdges edges;
+    edges.bytes = bytes;
+    const auto n = generateFlatGraph(ast, 0, 1, ids, edges, 0);
+    for (auto& [from, symbol, to] : edges.edges) {
+        from = ids[from];
+        to = ids[to];
+    }
+    for (auto& [from, lo, hi, to] : edges.byteRanges) {
+        from = ids[from];
+        to = ids[to];
+    }
+    edges.build(result, n);
+    result.start = ids[0];
+    result.accept = ids[1];
+    return result;
+}
+
+FlatNFA RegularExpression::toByteNFA(const vector<RegularExpression>& regexes, vector<uint32_t>& accepts) {
+    FlatNFA result;
+    accepts.clear();
+    // A new start state with ε-edges to the start states of the patterns, numbered before them.
+    vector<uint32_t> ids = {0};
+    FlatNFAEdges edges;
+    edges.bytes = true;
+    uint32_t n = 1;
+    vector<uint32_t> ends;
+    for (const auto& regex : regexes) {
+        if (!regex._ast) {
+            ends.push_back(FlatNFA::NONE);
+            continue;
+        }
+        const auto start = static_cast<uint32_t>(ids.size());
+        const auto end = start + 1;
+        ids.resize(ids.size() + 2, FlatNFA::NONE);
+        edges.add(0, EPSILON, start);
+        n = generateFlatGraph(regex._ast, start, end, ids, edges, n);
+        ends.push_back(end);
+    }
+    for (auto& [from, symbol, to] : edges.edges) {
+        from = ids[from];
+        to = ids[to];
+    }
+    for (auto& [from, lo, hi, to] : edges.byteRanges) {
+        from = ids[from];
+        to = ids[to];
+    }
+    edges.build(result, n);
+    result.start = 0;
+    for (const auto end : ends) {
+        accepts.push_back(end == FlatNFA::NONE ? FlatNFA::NONE : ids[end]);
+    }
+    return result;
+}
+
+FlatNFA RegularExpression::toFlatNFA() const {
+    return buildFlatNFA(_ast, false);
+}
+
+FlatNFA RegularExpression::toByteNFA() const {
+    return buildFlatNFA(_ast, true);
+}
@@ -0,0 +1,125 @@
+#include "re.h"
+#include <algorithm>
+
+using namespace std;
+
+size_t GlushkovNFA::size() const {
+    return positionBytes.size();
+}
+
+struct PositionSets {
+    vector<uint32_t> first;
+    vector<uint32_t> last;
+    bool nullable = true;
+};
+
+/**
+ * Concatenate the sets of two adjacent sub-patterns, the last positions of the left one are followed by
+ * the first positions of the right one.
+ */
+static void concatenate(PositionSets& left, PositionSets right, vector<vector<uint32_t>>& follow) {
+    for (const auto position : left.last) {
+        follow[position].insert(follow[position].end(), right.first.begin(), right.first.end());
+    }
+    if (left.nullable) {
+        left.first.insert(left.first.end(), right.first.begin(), right.first.end());
+    }
+    if (right.nullable) {
+        right.last.insert(right.last.end(), left.last.begin(), left.last.end());
+    }
+    left.last = std::move(right.last);
+    left.nullable = left.nullable && right.nullable;
+}
+
+static PositionSets buildPositions(const shared_ptr<RegexNode>& node, const bool reversed,
+                                   vector<bitset<256>>& positionBytes, vector<vector<uint32_t>>& follow) {
+    PositionSets result;
+    switch (node->type) {
+        case RegexNode::Type::EMPTY:
+            break;
+        case RegexNode::Type::TEXT:
+            for (size_t i = 0; i < node->text.size(); ++i) {
+                const auto position = static_cast<uint32_t>(positionBytes.size());
+                positionBytes.emplace_back();
+                positionBytes.back().set(static_cast<uint8_t>(node->text[reversed ? node->text.size() - 1 - i : i]));
+                follow.emplace_back();
+                if (i == 0) {
+                    result.first.push_back(position);
+                } else {
+                    follow[position - 1].push_back(position);
+                }
+                result.last = {position};
+            }
+            result.nullable = node->text.empty();
+            break;
+        case RegexNode::Type::CLASS:
+            result.nullable = false;
+            for (const auto& sequence : node->charClass.utf8Sequences()) {
+                for (size_t i = 0; i < sequence.size(); ++i) {
+                    const auto position = static_cast<uint32_t>(positionBytes.size());
+                    const auto& [lo, hi] = sequence[reversed ? sequence.size() - 1 - i : i];
+                    positionBytes.emplace_back();
+                    for (uint32_t byte = lo; byte <= hi; ++byte) {
+                        positionBytes.back().set(byte);
+                    }
+                    follow.emplace_back();
+                    if (i == 0) {
+                        result.first.push_back(position);
+                    } else {
+                        follow[position - 1].push_back(position);
+                    }
+                }
+                result.last.push_back(static_cast<uint32_t>(positionBytes.size() - 1));
+            }
+            break;
+        case RegexNode::Type::CAT:
+            for (size_t i = 0; i < node->parts.size(); ++i) {
+                const auto& part = node->parts[reversed ? node->parts.size() - 1 - i : i];
+                concatenate(result, buildPositions(part, reversed, positionBytes, follow), follow);
+            }
+            break;
+        case RegexNode::Type::OR:
+            result.nullable = false;
+            for (const auto& part : node->parts) {
+                auto sets = buildPositions(part, reversed, positionBytes, follow);
+                result.first.insert(result.first.end(), sets.first.begin(), sets.first.end());
+                result.last.insert(result.last.end(), sets.last.begin(), sets.last.end());
+                result.nullable = result.nullable || sets.nullable;
+            }
+            break;
+        case RegexNode::Type::STAR:
+            result = buildPositions(node->sub, reversed, positionBytes, follow);
+            for (const auto position : result.last) {
+                follow[position].insert(follow[position].end(), result.first.begin(), result.first.end());
+            }
+            result.nullable = true;
+            break;
+    }
+    return result;
+}
+
+/**
+ * The first, last and nullable sets are computed bottom-up, and the follow sets are filled in the same pass
+ * by concatenations and stars.
+ */
+GlushkovNFA RegularExpression::toGlushkovNFA(const bool reversed) const {
+    GlushkovNFA result;
+    if (!_ast) {
+        return result;
+    }
+    vector<vector<uint32_t>> follow;
+    auto sets = buildPositions(_ast, reversed, result.positionBytes, follow);
+    ranges::sort(sets.first);
+    ranges::sort(sets.last);
+    result.first = std::move(sets.first);
+    result.last = std::move(sets.last);
+    result.nullable = sets.nullable;
+    result.followBegin.assign(1, 0);
+    for (auto& targets : follow) {
+        ranges::sort(targets);
+        targets.erase(ranges::unique(targets).begin(), targets.end());
+        result.followTargets.insert(result.followTargets.end(), targets.begin(), targets.end());
+        result.followBegin.push_back(static_cast<uint32_t>(result.followTargets.size()));
+    }
+    return result;
+}
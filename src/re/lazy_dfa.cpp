@@ -0,0 +1,214 @@
+#include "re_matcher.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+/**
+ * The cache is considered thrashing after this number of flushes in one scan,
+ * if fewer than BYTES_PER_STATE bytes have been scanned per state built since the previous flush.
+ */
+static constexpr size_t MAX_FLUSHES_PER_SCAN = 3;
+static constexpr size_t BYTES_PER_STATE = 10;
+
+LazyDFA::LazyDFA(FlatNFA nfa, const size_t maxStates) : _nfa(std::move(nfa)), _maxStates(max<size_t>(maxStates, 2)) {
+    if (_nfa.size() == 0) {
+        return;
+    }
+    if (_nfa.byteClasses.size() != 256) {
+        throw runtime_error("The lazy DFA should be built from an NFA over bytes.");
+    }
+    _stamp.assign(_nfa.size(), 0);
+    _startSet = {_nfa.start};
+    closure(_startSet);
+}
+
+size_t LazyDFA::numCachedStates() const {
+    return _states.size();
+}
+
+size_t LazyDFA::numFlushes() const {
+    return _numFlushes;
+}
+
+size_t LazyDFA::numFallbacks() const {
+    return _numFallbacks;
+}
+
+/**
+ * Replace the states with their ε-closure. Only the states with symbol edges and the accept state are kept,
+ * since the other states never affect the moves, so that fewer distinct DFA states are created.
+ */
+void LazyDFA::closure(vector<uint32_t>& states) {
+    if (++_generation == 0) {
+        ranges::fill(_stamp, 0);
+        _generation = 1;
+    }
+    _stack.clear();
+    for (const auto state : states) {
+        if (_stamp[state] != _generation) {
+            _stamp[state] = _generation;
+            _stack.push_back(state);
+        }
+    }
+    states.clear();
+    while (!_stack.empty()) {
+        const auto top = _stack.back();
+        _stack.pop_back();
+        if (_nfa.edgeBegin[top] != _nfa.edgeBegin[top + 1] || top == _nfa.accept) {
+            states.push_back(top);
+        }
+        for (auto i = _nfa.epsilonBegin[top]; i < _nfa.epsilonBegin[top + 1]; ++i) {
+            if (const auto target = _nfa.epsilonTargets[i]; _stamp[target] != _generation) {
+                _stamp[target] = _generation;
+                _stack.push_back(target);
+            }
+        }
+    }
+    ranges::sort(states);
+}
+
+void LazyDFA::move(const vector<uint32_t>& states, const uint32_t symbol, vector<uint32_t>& result) {
+    result.clear();
+    for (const auto state : states) {
+        for (auto i = _nfa.edgeBegin[state]; i < _nfa.edgeBegin[state + 1]; ++i) {
+            if (_nfa.edgeSymbols[i] == symbol) {
+                result.push_back(_nfa.edgeTargets[i]);
+            }
+        }
+    }
+    closure(result);
+}
+
+bool LazyDFA::isAccepting(const vector<uint32_t>& states) const {
+    return ranges::binary_search(states, _nfa.accept);
+}
+
+uint32_t LazyDFA::addState(vector<uint32_t> states) {
+    const auto [it, inserted] = _stateIds.try_emplace(states, static_cast<uint32_t>(_states.size()));
+    if (inserted) {
+        _accepting.push_back(isAccepting(states));
+        _states.push_back(std::move(states));
+        _transitions.resize(_transitions.size() + _nfa.numSymbols(), UNKNOWN);
+    }
+    return it->second;
+}
+
+void LazyDFA::flush() {
+    ++_numFlushes;
+    _stateIds.clear();
+    _states.clear();
+    _accepting.clear();
+    _transitions.clear();
+    _start = FlatNFA::NONE;
+}
+
+size_t LazyDFA::longestAccepted(const string_view text, const bool backward) {
+    if (_nfa.size() == 0) {
+        return string_view::npos;
+    }
+    if (_start == FlatNFA::NONE) {
+        if (_states.size() >= _maxStates) {
+            flush();
+        }
+        _start = addState(_startSet);
+    }
+
+    const size_t n = text.size();
+    const size_t numSymbols = _nfa.numSymbols();
+    auto symbolAt = [&](const size_t i) {
+        return _nfa.byteClasses[static_cast<uint8_t>(backward ? text[n - 1 - i] : text[i])];
+    };
+
+    uint32_t state = _start;
+    size_t last = _accepting[state] ? 0 : string_view::npos;
+    size_t flushes = 0, lastFlush = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const auto symbol = symbolAt(i);
+        auto next = _transitions[state * numSymbols + symbol];
+        if (next == UNKNOWN) {
+            move(_states[state], symbol, _next);
+            if (_next.empty()) {
+                next = FlatNFA::NONE;
+            } else if (const auto it = _stateIds.find(_next); it != _stateIds.end()) {
+                next = it->second;
+            } else if (_states.size() < _maxStates) {
+                next = addState(_next);
+            } else {
+                if (++flushes >= MAX_FLUSHES_PER_SCAN && i - lastFlush < BYTES_PER_STATE * _maxStates) {
+                    // Simulate the NFA for the rest of the text without caching.
+                    ++_numFallbacks;
+                    vector<uint32_t> current = std::move(_next);
+                    for (size_t j = i; j < n && !current.empty(); ++j) {
+                        if (j > i) {
+                            move(current, symbolAt(j), _next);
+                            swap(current, _next);
+                        }
+                        if (!current.empty() && isAccepting(current)) {
+                            last = j + 1;
+                        }
+                    }
+                    return last;
+                }
+                lastFlush = i;
+                flush();
+                state = addState(_next);
+                if (_accepting[state]) {
+                    last = i + 1;
+                }
+                continue;
+            }
+            _transitions[state * numSymbols + symbol] = next;
+        }
+        if (next == FlatNFA::NONE) {
+            break;
+        }
+        state = next;
+        if (_accepting[state]) {
+            last = i + 1;
+        }
+    }
+    return last;
+}
+
+LazyDFAMatcher::LazyDFAMatcher(const RegularExpression& regex, const size_t maxStates) : _prefilter(regex.literals()) {
+    auto nfa = regex.toByteNFA();
+    _reverse = LazyDFA(nfa.reversed().unanchored(), maxStates);
+    _forward = LazyDFA(std::move(nfa), maxStates);
+}
+
+LazyDFAMatcher::LazyDFAMatcher(const string& pattern, const size_t maxStates) :
+    LazyDFAMatcher(RegularExpression(pattern), maxStates) {}
+
+bool LazyDFAMatcher::match(const string_view text) {
+    return _forward.longestAccepted(text) == text.size();
+}
+
+size_t LazyDFAMatcher::longestPrefix(const string_view text) {
+    return _forward.longestAccepted(text);
+}
+
+optional<RegexMatch> LazyDFAMatcher::find(const string_view text) {
+    return _prefilter.find(text, [&](const string_view rest) -> optional<RegexMatch> {
+        const auto length = _reverse.longestAccepted(rest, true);
+        if (length == string_view::npos) {
+            return nullopt;
+        }
+        const auto begin = rest.size() - length;
+        return RegexMatch{begin, begin + _forward.longestAccepted(rest.substr(begin))};
+    }, [&](const string_view rest) {
+        return _forward.longestAccepted(rest);
+    });
+}
+
+size_t LazyDFAMatcher::numCachedStates() const {
+    return _forward.numCachedStates() + _reverse.numCachedStates();
+}
+
+size_t LazyDFAMatcher::numFlushes() const {
+    return _forward.numFlushes() + _reverse.numFlushes();
+}
+
+size_t LazyDFAMatcher::numFallbacks() const {
+    return _forward.numFallbacks() + _reverse.numFallbacks();
+}
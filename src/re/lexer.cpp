@@ -0,0 +1,87 @@
+#include "lexer.h"
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * The label of a DFA state is 1 + the first rule whose accept state is in it, or 0 if it is rejecting.
+ */
+Lexer::Lexer(const vector<LexerRule>& rules) : _rules(rules) {
+    vector<RegularExpression> regexes;
+    for (const auto& rule : _rules) {
+        regexes.emplace_back(rule.pattern);
+        if (!regexes.back().ast()) {
+            _errorMessage = "Error: invalid pattern of " + rule.name + ": " + regexes.back().errorMessage();
+            return;
+        }
+    }
+
+    vector<uint32_t> accepts;
+    const auto nfa = RegularExpression::toByteNFA(regexes, accepts);
+    vector<uint32_t> ruleOf(nfa.size(), FlatNFA::NONE);
+    for (uint32_t rule = 0; rule < accepts.size(); ++rule) {
+        ruleOf[accepts[rule]] = rule;
+    }
+    vector<vector<uint32_t>> items;
+    auto dfa = RegularExpression::toFlatDFA(nfa, items);
+    vector<uint32_t> labels(dfa.size(), 0);
+    for (size_t i = 0; i < dfa.size(); ++i) {
+        uint32_t first = FlatNFA::NONE;
+        for (const auto item : items[i]) {
+            first = min(first, ruleOf[item]);
+        }
+        labels[i] = first == FlatNFA::NONE ? 0 : first + 1;
+        dfa.accepting[i] = labels[i] != 0;
+    }
+    if (labels[dfa.start] != 0) {
+        _errorMessage = "Error: " + _rules[labels[dfa.start] - 1].name + " matches the empty string.";
+        return;
+    }
+    const auto minDFA = RegularExpression::toMinFlatDFA(dfa, labels);
+    _dfa = DenseDFA(minDFA, &labels);
+}
+
+const string& Lexer::errorMessage() const {
+    return _errorMessage;
+}
+
+size_t Lexer::numRules() const {
+    return _rules.size();
+}
+
+const string& Lexer::ruleName(const size_t rule) const {
+    return _rules[rule].name;
+}
+
+size_t Lexer::numStates() const {
+    return _dfa.size();
+}
+
+LexerResult Lexer::tokenize(const string_view text) const {
+    LexerResult result;
+    if (!_errorMessage.empty()) {
+        return result;
+    }
+    for (size_t begin = 0; begin < text.size();) {
+        const auto [length, label] = _dfa.longestLabelledPrefix(text.substr(begin));
+        if (length == string_view::npos) {
+            result.errorPosition = begin;
+            return result;
+        }
+        if (const auto rule = label - 1; !_rules[rule].skip) {
+            result.tokens.push_back({rule, begin, begin + length});
+        }
+        begin += length;
+    }
+    result.accepted = true;
+    return result;
+}
+
+vector<string> Lexer::terminals(const vector<LexerToken>& tokens) const {
+    vector<string> result;
+    result.reserve(tokens.size());
+    for (const auto& token : tokens) {
+        result.push_back(_rules[token.rule].name);
+    }
+    return result;
+}
@@ -0,0 +1,91 @@
+#include "re_matcher.h"
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define PARSING_TOYS_X86_64
+#endif
+
+using namespace std;
+
+#ifdef PARSING_TOYS_X86_64
+
+/**
+ * Check the candidates of a block, whose bits are the offsets where both the first and the last bytes are equal.
+ */
+static size_t checkCandidates(const char* const block, const string_view literal, uint32_t bits) {
+    const size_t m = literal.size();
+    while (bits != 0) {
+        const auto offset = static_cast<size_t>(countr_zero(bits));
+        if (m <= 2 || memcmp(block + offset + 1, literal.data() + 1, m - 2) == 0) {
+            return offset;
+        }
+        bits &= bits - 1;
+    }
+    return string_view::npos;
+}
+
+/**
+ * The blocks of bytes are compared with the first and the last bytes of the literal at once,
+ * and only the positions where both are equal are compared in full, which skips most of the text
+ * even if the first byte is common.
+ */
+static size_t findLiteralSSE2(const string_view text, const string_view literal, size_t from) {
+    const size_t m = literal.size();
+    const auto firstByte = _mm_set1_epi8(literal[0]);
+    const auto lastByte = _mm_set1_epi8(literal[m - 1]);
+    for (; from + m - 1 + 16 <= text.size(); from += 16) {
+        const char* const block = text.data() + from;
+        const auto first = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block)), firstByte);
+        const auto last = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + m - 1)), lastByte);
+        const auto bits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(first, last)));
+        if (const auto offset = checkCandidates(block, literal, bits); offset != string_view::npos) {
+            return from + offset;
+        }
+    }
+    return text.find(literal, from);
+}
+
+#ifdef __GNUC__
+__attribute__((target("avx2")))
+static size_t findLiteralAVX2(const string_view text, const string_view literal, size_t from) {
+    const size_t m = literal.size();
+    const auto firstByte = _mm256_set1_epi8(literal[0]);
+    const auto lastByte = _mm256_set1_epi8(literal[m - 1]);
+    for (; from + m - 1 + 32 <= text.size(); from += 32) {
+        const char* const block = text.data() + from;
+        const auto first = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block)), firstByte);
+        const auto last = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + m - 1)), lastByte);
+        const auto bits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(first, last)));
+        if (const auto offset = checkCandidates(block, literal, bits); offset != string_view::npos) {
+            return from + offset;
+        }
+    }
+    return text.find(literal, from);
+}
+#endif
+
+#endif
+
+size_t findLiteral(const string_view text, const string_view literal, const size_t from) {
+    if (from > text.size()) {
+        return string_view::npos;
+    }
+    if (literal.empty()) {
+        return from;
+    }
+#ifdef PARSING_TOYS_X86_64
+    if (literal.size() > 1) {
+#ifdef __GNUC__
+        static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+        if (hasAVX2) {
+            return findLiteralAVX2(text, literal, from);
+        }
+#endif
+        return findLiteralSSE2(text, literal, from);
+    }
+#endif
+    // A single byte is searched with memchr, which is vectorized by the C library.
+    return text.find(literal, from);
+}
@@ -0,0 +1,67 @@
+#include "re.h"
+#include <algorithm>
+#include <ranges>
+
+using namespace std;
+
+static const string& longer(const string& a, const string& b) {
+    return b.size() > a.size() ? b : a;
+}
+
+static RegexLiterals concatenate(const RegexLiterals& left, const RegexLiterals& right) {
+    RegexLiterals result;
+    result.exact = left.exact && right.exact;
+    result.prefix = left.exact ? left.prefix + right.prefix : left.prefix;
+    result.suffix = right.exact ? left.suffix + right.suffix : right.suffix;
+    result.required = longer(longer(left.required, right.required), left.suffix + right.prefix);
+    result.required = longer(result.required, longer(result.prefix, result.suffix));
+    return result;
+}
+
+/**
+ * The prefix and the suffix of an exact pattern are both the whole string. A concatenation joins the suffix of
+ * the left part with the prefix of the right part, and an alternation keeps the common prefix and suffix of its parts.
+ */
+static RegexLiterals findLiterals(const shared_ptr<RegexNode>& node) {
+    RegexLiterals result;
+    switch (node->type) {
+        case RegexNode::Type::EMPTY:
+            result.exact = true;
+            break;
+        case RegexNode::Type::TEXT:
+            result.exact = true;
+            result.prefix = result.suffix = result.required = node->text;
+            break;
+        case RegexNode::Type::CAT:
+            result.exact = true;
+            for (const auto& part : node->parts) {
+                result = concatenate(result, findLiterals(part));
+            }
+            break;
+        case RegexNode::Type::OR:
+            for (size_t i = 0; i < node->parts.size(); ++i) {
+                const auto literals = findLiterals(node->parts[i]);
+                if (i == 0) {
+                    result = literals;
+                    continue;
+                }
+                result.exact = result.exact && literals.exact && result.prefix == literals.prefix;
+                result.prefix.erase(ranges::mismatch(result.prefix, literals.prefix).in1, result.prefix.end());
+                const auto suffixBegin = ranges::mismatch(result.suffix | views::reverse, literals.suffix | views::reverse).in1;
+                result.suffix.erase(result.suffix.begin(), suffixBegin.base());
+            }
+            result.required = longer(result.prefix, result.suffix);
+            break;
+        case RegexNode::Type::STAR:
+        case RegexNode::Type::CLASS:
+            break;
+    }
+    return result;
+}
+
+RegexLiterals RegularExpression::literals() const {
+    if (!_ast) {
+        return {};
+    }
+    return findLiterals(_ast);
+}
@@ -44,114 +44,184 @@ static HopcroftData getReverseEdges(const shared_ptr<DFAState>& start) {
     return data;
 }
 
-static vector<vector<string>> hopcroft(const HopcroftData& data) {
-    vector<string> ids;
-    for (const auto& id : data.idMap | views::keys) {
-        ids.push_back(id);
-    }
-    ranges::sort(ids);
+/**
+ * Hopcroft's partition refinement with the block/position arrays of Valmari and Lehtinen.
+ *
+ * The elements of each block are contiguous in `elements`, and the marked elements of a block are moved to
+ * the front of the block, so that marking and splitting take constant time per element.
+ * A missing transition goes to an extra sink state numbered n, which is labelled with sinkLabel.
+ *
+ * @param transitions The dense transition table of n states and k symbols, DEAD for missing transitions.
+ * @param labels The initial partition, the states with different labels are never merged.
+ * @return The block of each state, the sink state included.
+ */
+static vector<uint32_t> refinePartition(const size_t n, const size_t k, const vector<uint32_t>& transitions,
+                                        const vector<uint32_t>& labels, const uint32_t sinkLabel) {
+    const size_t numStates = n + 1;
+    const auto sink = static_cast<uint32_t>(n);
+    auto target = [&](const uint32_t state, const size_t symbol) {
+        if (state == sink) {
+            return sink;
+        }
+        const auto next = transitions[state * k + symbol];
+        return next == FlatDFA::DEAD ? sink : next;
+    };
 
-    vector<string> group1, group2;
-    for (const auto& id : ids) {
-        if (data.idMap.at(id)->type == "accept") {
-            group1.push_back(id);
-        } else {
-            group2.push_back(id);
+    // The predecessors of each (state, symbol) in CSR form.
+    vector<uint32_t> inverseBegin(numStates * k + 1, 0);
+    for (uint32_t state = 0; state < numStates; ++state) {
+        for (size_t symbol = 0; symbol < k; ++symbol) {
+            ++inverseBegin[target(state, symbol) * k + symbol + 1];
         }
     }
-
-    map<string, vector<string>> partitions;
-    deque<string> workQueue;
-    map<string, size_t> visited;
-
-    auto makeKey = [](const vector<string>& v) {
-        string key;
-        for (const auto& s : v) {
-            if (!key.empty()) {
-                key += ",";
+    for (size_t i = 0; i < numStates * k; ++i) {
+        inverseBegin[i + 1] += inverseBegin[i];
+    }
+    vector<uint32_t> inverse(numStates * k);
+    {
+        vector<uint32_t> next(inverseBegin.begin(), inverseBegin.end() - 1);
+        for (uint32_t state = 0; state < numStates; ++state) {
+            for (size_t symbol = 0; symbol < k; ++symbol) {
+                inverse[next[target(state, symbol) * k + symbol]++] = state;
             }
-            key += s;
         }
-        return key;
-    };
+    }
 
-    string key1 = makeKey(group1);
-    partitions[key1] = group1;
-    workQueue.push_back(key1);
-    visited[key1] = 0;
+    vector<uint32_t> elements(numStates), position(numStates), blockOf(numStates);
+    vector<uint32_t> blockBegin, blockEnd, blockMarked;
+    {
+        map<uint32_t, vector<uint32_t>> initial;
+        for (uint32_t state = 0; state < numStates; ++state) {
+            initial[state == sink ? sinkLabel : labels[state]].push_back(state);
+        }
+        uint32_t index = 0;
+        for (const auto& states : initial | views::values) {
+            const auto block = static_cast<uint32_t>(blockBegin.size());
+            blockBegin.push_back(index);
+            blockMarked.push_back(index);
+            for (const auto state : states) {
+                elements[index] = state;
+                position[state] = index++;
+                blockOf[state] = block;
+            }
+            blockEnd.push_back(index);
+        }
+    }
 
-    if (!group2.empty()) {
-        string key2 = makeKey(group2);
-        partitions[key2] = group2;
-        workQueue.push_back(key2);
+    // All the initial blocks but the largest one are splitters.
+    vector<pair<uint32_t, uint32_t>> workList;
+    vector<bool> inWorkList(numStates * k, false);
+    auto addSplitter = [&](const uint32_t block, const size_t symbol) {
+        inWorkList[block * k + symbol] = true;
+        workList.emplace_back(block, static_cast<uint32_t>(symbol));
+    };
+    uint32_t largest = 0;
+    for (uint32_t block = 1; block < blockBegin.size(); ++block) {
+        if (blockEnd[block] - blockBegin[block] > blockEnd[largest] - blockBegin[largest]) {
+            largest = block;
+        }
+    }
+    for (uint32_t block = 0; block < blockBegin.size(); ++block) {
+        if (block != largest) {
+            for (size_t symbol = 0; symbol < k; ++symbol) {
+                addSplitter(block, symbol);
+            }
+        }
     }
 
-    while (!workQueue.empty()) {
-        string topKey = workQueue.front();
-        workQueue.pop_front();
+    vector<uint32_t> predecessors, touched;
+    while (!workList.empty()) {
+        const auto [splitter, symbol] = workList.back();
+        workList.pop_back();
+        inWorkList[splitter * k + symbol] = false;
 
-        if (topKey.empty() || !partitions.contains(topKey)) {
-            continue;
+        predecessors.clear();
+        for (auto i = blockBegin[splitter]; i < blockEnd[splitter]; ++i) {
+            const auto offset = elements[i] * k + symbol;
+            predecessors.insert(predecessors.end(), inverse.begin() + inverseBegin[offset], inverse.begin() + inverseBegin[offset + 1]);
         }
-
-        vector<string> top;
-        size_t start = 0;
-        for (size_t i = 0; i <= topKey.size(); i++) {
-            if (i == topKey.size() || topKey[i] == ',') {
-                top.push_back(topKey.substr(start, i - start));
-                start = i + 1;
+        for (const auto state : predecessors) {
+            const auto block = blockOf[state];
+            const auto marked = blockMarked[block];
+            if (position[state] < marked) {
+                continue;
+            }
+            if (marked == blockBegin[block]) {
+                touched.push_back(block);
             }
+            const auto other = elements[marked];
+            swap(elements[position[state]], elements[marked]);
+            position[other] = position[state];
+            position[state] = marked;
+            ++blockMarked[block];
         }
 
-        for (const auto& symbol : data.symbols) {
-            set<string> revGroup;
-            for (const auto& id : top) {
-                if (auto it = data.revEdges.find(id); it != data.revEdges.end()) {
-                    if (auto it2 = it->second.find(symbol); it2 != it->second.end()) {
-                        for (const auto& from : it2->second) {
-                            revGroup.insert(from);
-                        }
-                    }
-                }
+        for (const auto block : touched) {
+            const auto marked = blockMarked[block];
+            blockMarked[block] = blockBegin[block];
+            if (marked == blockEnd[block]) {
+                continue;
             }
-
-            vector<string> keys;
-            for (const auto &k: partitions | views::keys) {
-                keys.push_back(k);
+            // The marked part becomes a new block.
+            const auto newBlock = static_cast<uint32_t>(blockBegin.size());
+            blockBegin.push_back(blockBegin[block]);
+            blockEnd.push_back(marked);
+            blockMarked.push_back(blockBegin[block]);
+            blockBegin[block] = blockMarked[block] = marked;
+            for (auto i = blockBegin[newBlock]; i < blockEnd[newBlock]; ++i) {
+                blockOf[elements[i]] = newBlock;
             }
-
-            for (const auto& key : keys) {
-                vector<string> g1, g2;
-                for (const auto& id : partitions[key]) {
-                    if (revGroup.contains(id)) {
-                        g1.push_back(id);
-                    } else {
-                        g2.push_back(id);
-                    }
+            const bool newIsSmaller = blockEnd[newBlock] - blockBegin[newBlock] <= blockEnd[block] - blockBegin[block];
+            for (size_t c = 0; c < k; ++c) {
+                if (inWorkList[block * k + c]) {
+                    addSplitter(newBlock, c);
+                } else {
+                    addSplitter(newIsSmaller ? newBlock : block, c);
                 }
+            }
+        }
+        touched.clear();
+    }
+    return blockOf;
+}
 
-                if (!g1.empty() && !g2.empty()) {
-                    partitions.erase(key);
-                    string newKey1 = makeKey(g1);
-                    string newKey2 = makeKey(g2);
-                    partitions[newKey1] = g1;
-                    partitions[newKey2] = g2;
-
-                    if (g1.size() <= g2.size()) {
-                        visited[newKey1] = workQueue.size();
-                        workQueue.push_back(newKey1);
-                    } else {
-                        visited[newKey2] = workQueue.size();
-                        workQueue.push_back(newKey2);
-                    }
-                }
+/**
+ * The partitions of the reachable states, with the ids in each partition sorted.
+ */
+static vector<vector<string>> hopcroft(const HopcroftData& data) {
+    vector<string> ids;
+    for (const auto& id : data.idMap | views::keys) {
+        ids.push_back(id);
+    }
+    ranges::sort(ids);
+    unordered_map<string, uint32_t> index;
+    for (uint32_t i = 0; i < ids.size(); ++i) {
+        index[ids[i]] = i;
+    }
+
+    const size_t n = ids.size(), k = data.symbols.size();
+    vector<uint32_t> transitions(n * k, FlatDFA::DEAD);
+    vector<uint32_t> labels(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        const auto& state = data.idMap.at(ids[i]);
+        labels[i] = state->type == "accept" ? 1 : 0;
+        for (size_t symbol = 0; symbol < k; ++symbol) {
+            if (const auto it = state->trans.find(data.symbols[symbol]); it != state->trans.end()) {
+                transitions[i * k + symbol] = index.at(it->second->id);
             }
         }
     }
 
+    // The missing transitions are kept distinguishable from the transitions to the states that can not accept.
+    const auto blockOf = refinePartition(n, k, transitions, labels, 2);
     vector<vector<string>> result;
-    for (const auto& v : partitions | views::values) {
-        result.push_back(v);
+    unordered_map<uint32_t, size_t> partitionIndex;
+    for (uint32_t i = 0; i < n; ++i) {
+        const auto [it, inserted] = partitionIndex.try_emplace(blockOf[i], result.size());
+        if (inserted) {
+            result.emplace_back();
+        }
+        result[it->second].push_back(ids[i]);
     }
     return result;
 }
@@ -241,3 +311,61 @@ shared_ptr<DFAState> RegularExpression::toMinDFA(const shared_ptr<DFAState>& dfa
     auto partitions = hopcroft(data);
     return buildMinDFA(dfa, partitions, data);
 }
+
+FlatDFA RegularExpression::toMinFlatDFA(const FlatDFA& dfa) {
+    vector<uint32_t> labels(dfa.size());
+    for (uint32_t i = 0; i < dfa.size(); ++i) {
+        labels[i] = dfa.accepting[i] ? 1 : 0;
+    }
+    return toMinFlatDFA(dfa, labels);
+}
+
+FlatDFA RegularExpression::toMinFlatDFA(const FlatDFA& dfa, vector<uint32_t>& labels) {
+    const size_t n = dfa.size(), k = dfa.numSymbols();
+    if (n == 0) {
+        return dfa;
+    }
+    const auto blockOf = refinePartition(n, k, dfa.transitions, labels, 0);
+    const auto deadBlock = blockOf[n];
+
+    FlatDFA result;
+    result.symbols = dfa.symbols;
+    result.byteClasses = dfa.byteClasses;
+    result.start = 0;
+    if (blockOf[dfa.start] == deadBlock) {
+        result.accepting.push_back(false);
+        result.transitions.assign(k, FlatDFA::DEAD);
+        labels = {0};
+        return result;
+    }
+
+    vector<uint32_t> representative(n + 1, FlatDFA::DEAD);
+    for (uint32_t i = 0; i < n; ++i) {
+        if (representative[blockOf[i]] == FlatDFA::DEAD) {
+            representative[blockOf[i]] = i;
+        }
+    }
+    vector<uint32_t> newId(n + 1, FlatDFA::DEAD);
+    vector<uint32_t> order = {blockOf[dfa.start]};
+    newId[blockOf[dfa.start]] = 0;
+    vector<uint32_t> newLabels;
+    for (size_t i = 0; i < order.size(); ++i) {
+        const auto state = representative[order[i]];
+        result.accepting.push_back(dfa.accepting[state]);
+        newLabels.push_back(labels[state]);
+        for (size_t symbol = 0; symbol < k; ++symbol) {
+            const auto next = dfa.transitions[state * k + symbol];
+            if (next == FlatDFA::DEAD || blockOf[next] == deadBlock) {
+                result.transitions.push_back(FlatDFA::DEAD);
+                continue;
+            }
+            if (newId[blockOf[next]] == FlatDFA::DEAD) {
+                newId[blockOf[next]] = static_cast<uint32_t>(order.size());
+                order.push_back(blockOf[next]);
+            }
+            result.transitions.push_back(newId[blockOf[next]]);
+        }
+    }
+    labels = std::move(newLabels);
+    return result;
+}
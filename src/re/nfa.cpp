@@ -1,5 +1,7 @@
 #include "re.h"
 #include "string_utils.h"
+#include <algorithm>
+#include <cctype>
 
 using namespace std;
 
@@ -12,7 +14,7 @@ RegularExpression::RegularExpression(const string& pattern) {
 bool RegularExpression::parse(const string& pattern) {
     _errorMessage.clear();
     const auto graphemes = segmentGraphemes(pattern);
-    _ast = parseSub(graphemes, 0, graphemes.size(), true);
+    _ast = parseGraphemes(graphemes);
     return _ast != nullptr;
 }
 
@@ -24,143 +26,501 @@ shared_ptr<RegexNode> RegularExpression::ast() const {
     return _ast;
 }
 
-shared_ptr<RegexNode> RegularExpression::parseSub(const vector<string>& graphemes, const size_t begin, const size_t end, const bool first) {
-    auto node = make_shared<RegexNode>();
-    node->begin = begin;
-    node->end = end;
+/**
+ * @return The index of the last grapheme of the escape or the class starting at i, or i if there is none.
+ *         An unterminated class ends at the end.
+ */
+static size_t skipEscapeOrClass(const vector<string>& graphemes, const size_t i, const size_t end) {
+    if (graphemes[i] == "\\") {
+        return min(i + 1, end - 1);
+    }
+    if (graphemes[i] == "[") {
+        for (size_t j = i + 1; j < end; ++j) {
+            if (graphemes[j] == "\\") {
+                ++j;
+            } else if (graphemes[j] == "]") {
+                return j;
+            }
+        }
+        return end - 1;
+    }
+    return i;
+}
 
-    if (begin == end) {
-        _errorMessage = "Error: empty input at " + to_string(begin) + ".";
-        return nullptr;
+static string joinGraphemes(const vector<string>& graphemes, const size_t begin, const size_t end) {
+    string result;
+    for (size_t i = begin; i < end; ++i) {
+        result += graphemes[i];
     }
+    return result;
+}
 
-    if (first) {
-        size_t last = begin;
-        int stack = 0;
-        vector<shared_ptr<RegexNode>> parts;
+static bool isSingle(const CharClass& charClass) {
+    return charClass.intervals.size() == 1 && charClass.intervals[0].first == charClass.intervals[0].second;
+}
 
-        for (size_t i = begin; i <= end; ++i) {
-            const string& ch = (i < end) ? graphemes[i] : "";
-            if (i == end || (ch == "|" && stack == 0)) {
-                if (last == begin && i == end) {
-                    return parseSub(graphemes, last, i, false);
-                }
-                auto sub = parseSub(graphemes, last, i, true);
-                if (!sub) {
-                    return nullptr;
-                }
-                parts.push_back(sub);
-                last = i + 1;
-            } else if (ch == "(") {
-                stack++;
-            } else if (ch == ")") {
-                stack--;
+/**
+ * Expand a counted repetition with copies of the node, x{2,4} is xx(x(x)?)?, and x{2,} is xxx*.
+ * @param high The maximum count, or RegularExpression::MAX_REPETITION + 1 for no maximum.
+ */
+static shared_ptr<RegexNode> repeat(const shared_ptr<RegexNode>& node, const size_t low, const size_t high, const size_t end) {
+    auto makeNode = [&](const RegexNode::Type type) {
+        auto result = make_shared<RegexNode>();
+        result->begin = node->begin;
+        result->end = end;
+        result->type = type;
+        return result;
+    };
+    shared_ptr<RegexNode> rest;
+    if (high > RegularExpression::MAX_REPETITION) {
+        rest = makeNode(RegexNode::Type::STAR);
+        rest->sub = node;
+    } else {
+        for (size_t i = low; i < high; ++i) {
+            auto part = node;
+            if (rest) {
+                part = makeNode(RegexNode::Type::CAT);
+                part->parts = {node, rest};
             }
+            rest = makeNode(RegexNode::Type::OR);
+            rest->parts = {part, makeNode(RegexNode::Type::EMPTY)};
         }
+    }
+    auto result = makeNode(RegexNode::Type::CAT);
+    result->parts.assign(low, node);
+    if (rest) {
+        result->parts.push_back(rest);
+    }
+    if (result->parts.empty()) {
+        return makeNode(RegexNode::Type::EMPTY);
+    }
+    if (result->parts.size() == 1) {
+        return result->parts[0];
+    }
+    return result;
+}
 
-        if (parts.size() == 1) {
-            return parts[0];
+/**
+ * Parse {m}, {m,} or {m,n} starting at graphemes[i], and move i to the closing brace.
+ */
+bool RegularExpression::parseRepetition(const vector<string>& graphemes, size_t& i, const size_t end, size_t& low, size_t& high) {
+    const size_t first = i;
+    auto parseCount = [&](size_t& count) {
+        const size_t begin = i;
+        count = 0;
+        while (i < end && graphemes[i].size() == 1 && isdigit(static_cast<uint8_t>(graphemes[i][0]))) {
+            count = min(count * 10 + static_cast<size_t>(graphemes[i][0] - '0'), MAX_REPETITION + 1);
+            ++i;
         }
-        node->type = RegexNode::Type::OR;
-        node->parts = parts;
+        return i > begin;
+    };
+    ++i;
+    bool valid = parseCount(low);
+    high = low;
+    if (valid && i < end && graphemes[i] == ",") {
+        ++i;
+        if (!parseCount(high)) {
+            high = MAX_REPETITION + 1;
+        } else if (high > MAX_REPETITION) {
+            valid = false;
+        }
+    }
+    if (!valid || i >= end || graphemes[i] != "}" || high < low || low > MAX_REPETITION) {
+        _errorMessage = "Error: invalid repetition at " + to_string(first) + ".";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Parse the escape starting at graphemes[i], and move i to its last grapheme.
+ * @return The code points of the escape, which are empty if the escaped grapheme has more than one code point.
+ */
+optional<CharClass> RegularExpression::parseEscape(const vector<string>& graphemes, size_t& i, const size_t end) {
+    if (i + 1 >= end) {
+        _errorMessage = "Error: unexpected \\ at " + to_string(i) + ".";
+        return nullopt;
+    }
+    const size_t first = i++;
+    CharClass result;
+    const string& ch = graphemes[i];
+    if (ch == "d" || ch == "D") {
+        result.add('0', '9');
+    } else if (ch == "w" || ch == "W") {
+        result.add('0', '9');
+        result.add('A', 'Z');
+        result.add('_', '_');
+        result.add('a', 'z');
+    } else if (ch == "s" || ch == "S") {
+        result.add('\t', '\r');
+        result.add(' ', ' ');
+    } else if (ch == "x") {
+        uint32_t value = 0;
+        for (size_t k = 0; k < 2; ++k) {
+            if (++i >= end || graphemes[i].size() != 1 || !isxdigit(static_cast<uint8_t>(graphemes[i][0]))) {
+                _errorMessage = "Error: invalid escape at " + to_string(first) + ".";
+                return nullopt;
+            }
+            const auto digit = static_cast<char>(tolower(static_cast<uint8_t>(graphemes[i][0])));
+            value = value * 16 + static_cast<uint32_t>(isdigit(static_cast<uint8_t>(digit)) ? digit - '0' : digit - 'a' + 10);
+        }
+        result.add(value, value);
     } else {
-        size_t i = begin;
-        vector<shared_ptr<RegexNode>> parts;
-
-        while (i < end) {
-            if (const string& ch = graphemes[i]; ch == "(") {
-                const size_t last = i + 1;
-                i++;
-                int stack = 1;
-                while (i < end && stack != 0) {
-                    if (const string& c = graphemes[i]; c == "(") {
-                        stack++;
-                    } else if (c == ")") {
-                        stack--;
-                    }
-                    i++;
-                }
-                if (stack != 0) {
-                    _errorMessage = "Error: missing right bracket for " + to_string(last) + ".";
-                    return nullptr;
-                }
-                i--;
-                auto sub = parseSub(graphemes, last, i, true);
-                if (!sub) {
-                    return nullptr;
-                }
-                sub->begin = last - 1;
-                sub->end = i + 1;
-                parts.push_back(sub);
-            } else if (ch == "*") {
-                if (parts.empty()) {
-                    _errorMessage = "Error: unexpected * at " + to_string(i) + ".";
-                    return nullptr;
-                }
-                auto tempNode = make_shared<RegexNode>();
-                tempNode->begin = parts.back()->begin;
-                tempNode->end = parts.back()->end + 1;
-                tempNode->type = RegexNode::Type::STAR;
-                tempNode->sub = parts.back();
-                parts.back() = tempNode;
-            } else if (ch == "+") {
-                if (parts.empty()) {
-                    _errorMessage = "Error: unexpected + at " + to_string(i) + ".";
-                    return nullptr;
-                }
-                auto virNode = make_shared<RegexNode>();
-                virNode->begin = parts.back()->begin;
-                virNode->end = parts.back()->end + 1;
-                virNode->type = RegexNode::Type::STAR;
-                virNode->sub = parts.back();
-
-                const auto tempNode = make_shared<RegexNode>();
-                tempNode->begin = parts.back()->begin;
-                tempNode->end = parts.back()->end + 1;
-                tempNode->type = RegexNode::Type::CAT;
-                tempNode->parts = {parts.back(), virNode};
-                parts.back() = tempNode;
-            } else if (ch == "?") {
-                if (parts.empty()) {
-                    _errorMessage = "Error: unexpected ? at " + to_string(i) + ".";
-                    return nullptr;
-                }
-                auto virNode = make_shared<RegexNode>();
-                virNode->begin = parts.back()->begin;
-                virNode->end = parts.back()->end + 1;
-                virNode->type = RegexNode::Type::EMPTY;
-
-                const auto tempNode = make_shared<RegexNode>();
-                tempNode->begin = parts.back()->begin;
-                tempNode->end = parts.back()->end + 1;
-                tempNode->type = RegexNode::Type::OR;
-                tempNode->parts = {parts.back(), virNode};
-                parts.back() = tempNode;
-            } else if (ch == EPSILON) {
-                auto tempNode = make_shared<RegexNode>();
-                tempNode->begin = i;
-                tempNode->end = i + 1;
-                tempNode->type = RegexNode::Type::EMPTY;
-                parts.push_back(tempNode);
-            } else {
-                auto tempNode = make_shared<RegexNode>();
-                tempNode->begin = i;
-                tempNode->end = i + 1;
-                tempNode->type = RegexNode::Type::TEXT;
-                tempNode->text = ch;
-                parts.push_back(tempNode);
+        static const unordered_map<string, uint32_t> CONTROLS = {
+            {"n", '\n'}, {"t", '\t'}, {"r", '\r'}, {"f", '\f'}, {"v", '\v'},
+        };
+        if (const auto it = CONTROLS.find(ch); it != CONTROLS.end()) {
+            result.add(it->second, it->second);
+        } else if (const auto codePoint = CharClass::fromUTF8(ch)) {
+            result.add(*codePoint, *codePoint);
+        }
+        return result;
+    }
+    if (isupper(static_cast<uint8_t>(ch[0]))) {
+        return result.negated();
+    }
+    return result;
+}
+
+/**
+ * Parse the class starting at graphemes[i] == "[", and move i to the closing bracket.
+ */
+shared_ptr<RegexNode> RegularExpression::parseClass(const vector<string>& graphemes, size_t& i, const size_t end) {
+    auto node = make_shared<RegexNode>();
+    node->type = RegexNode::Type::CLASS;
+    node->begin = i;
+    const size_t first = i++;
+    const bool negated = i < end && graphemes[i] == "^";
+    if (negated) {
+        ++i;
+    }
+    if (i < end && graphemes[i] == "]") {
+        _errorMessage = "Error: empty class at " + to_string(first) + ".";
+        return nullptr;
+    }
+    // Parse a character, or a class of an escape, and move i to the grapheme after it.
+    auto parseItem = [&](CharClass& item) {
+        if (graphemes[i] == "\\") {
+            const auto escaped = parseEscape(graphemes, i, end);
+            if (!escaped) {
+                return false;
             }
-            i++;
+            item = *escaped;
+        } else if (const auto codePoint = CharClass::fromUTF8(graphemes[i])) {
+            item.add(*codePoint, *codePoint);
+        }
+        if (item.intervals.empty()) {
+            _errorMessage = "Error: " + graphemes[i] + " at " + to_string(i) + " is not a single character.";
+            return false;
         }
+        ++i;
+        return true;
+    };
+    while (i < end && graphemes[i] != "]") {
+        const size_t begin = i;
+        CharClass lo;
+        if (!parseItem(lo)) {
+            return nullptr;
+        }
+        if (isSingle(lo) && i + 1 < end && graphemes[i] == "-" && graphemes[i + 1] != "]") {
+            ++i;
+            CharClass hi;
+            if (!parseItem(hi)) {
+                return nullptr;
+            }
+            if (!isSingle(hi) || hi.intervals[0].first < lo.intervals[0].first) {
+                _errorMessage = "Error: invalid range at " + to_string(begin) + ".";
+                return nullptr;
+            }
+            lo.intervals[0].second = hi.intervals[0].first;
+        }
+        node->charClass.add(lo);
+    }
+    if (i >= end) {
+        _errorMessage = "Error: missing right square bracket for " + to_string(first) + ".";
+        return nullptr;
+    }
+    node->charClass.normalize();
+    if (negated) {
+        node->charClass = node->charClass.negated();
+    }
+    node->end = i + 1;
+    node->text = joinGraphemes(graphemes, first, i + 1);
+    return node;
+}
+
+/**
+ * The number of the nodes and the depth of a node after the counted repetitions are expanded.
+ */
+struct RegexExpansion {
+    size_t size = 1;
+    size_t depth = 1;
+};
+
+/**
+ * A group being parsed, or the whole pattern, with its finished alternatives and the parts of the current alternative.
+ */
+struct RegexGroup {
+    size_t begin = 0;
+    size_t alternativeBegin = 0;
+    vector<shared_ptr<RegexNode>> alternatives;
+    vector<shared_ptr<RegexNode>> parts;
+    RegexExpansion alternativesExpansion = {0, 0};
+    vector<RegexExpansion> partExpansions;
+};
+
+/**
+ * @return The upper bounds of the size and the depth after a node is repeated by repeat().
+ */
+static RegexExpansion expandRepetition(const RegexExpansion& expansion, const size_t low, const size_t high) {
+    const size_t copies = high > RegularExpression::MAX_REPETITION ? low + 1 : high;
+    return {copies * (expansion.size + 3) + 1, expansion.depth + 2 * (copies - low) + 2};
+}
 
-        if (parts.size() == 1) {
-            return parts[0];
+/**
+ * Match the brackets with a stack, skipping the escapes and the classes.
+ * @return Whether each bracket has a matching one.
+ */
+static vector<bool> matchBrackets(const vector<string>& graphemes) {
+    const size_t n = graphemes.size();
+    vector<bool> matched(n, false);
+    vector<size_t> lefts;
+    for (size_t i = 0; i < n; ++i) {
+        if (const string& ch = graphemes[i]; ch == "(") {
+            lefts.push_back(i);
+        } else if (ch == ")") {
+            if (!lefts.empty()) {
+                matched[lefts.back()] = matched[i] = true;
+                lefts.pop_back();
+            }
+        } else {
+            i = skipEscapeOrClass(graphemes, i, n);
         }
-        node->type = RegexNode::Type::CAT;
-        node->parts = parts;
     }
+    return matched;
+}
 
-    return node;
+/**
+ * A single pass over the graphemes with an explicit stack of the open groups, so the time is linear in the length
+ * of the pattern and the nesting of the brackets does not use the call stack.
+ * A right bracket without a matching left bracket is a text.
+ * The copies of the counted repetitions share their nodes, so the sizes after the expansion are tracked
+ * through the groups, and the nested repetitions are rejected before the automata would be too large.
+ * The depth is also limited, since the passes from the syntax tree to the automata are recursive.
+ */
+shared_ptr<RegexNode> RegularExpression::parseGraphemes(const vector<string>& graphemes) {
+    const size_t n = graphemes.size();
+    const auto matched = matchBrackets(graphemes);
+
+    auto finishAlternative = [&](RegexGroup& group, const size_t end) {
+        if (group.parts.empty()) {
+            _errorMessage = "Error: empty input at " + to_string(group.alternativeBegin) + ".";
+            return false;
+        }
+        auto& [size, depth] = group.alternativesExpansion;
+        for (const auto& expansion : group.partExpansions) {
+            size += expansion.size;
+            depth = max(depth, expansion.depth + (group.parts.size() > 1));
+        }
+        size += group.parts.size() > 1;
+        group.partExpansions.clear();
+        if (group.parts.size() == 1) {
+            group.alternatives.push_back(group.parts[0]);
+        } else {
+            auto node = make_shared<RegexNode>();
+            node->type = RegexNode::Type::CAT;
+            node->begin = group.alternativeBegin;
+            node->end = end;
+            node->parts = std::move(group.parts);
+            group.alternatives.push_back(node);
+        }
+        group.parts.clear();
+        return true;
+    };
+    auto finishGroup = [&](RegexGroup& group, const size_t end) -> shared_ptr<RegexNode> {
+        if (!finishAlternative(group, end)) {
+            return nullptr;
+        }
+        if (group.alternatives.size() == 1) {
+            return group.alternatives[0];
+        }
+        ++group.alternativesExpansion.size;
+        ++group.alternativesExpansion.depth;
+        auto node = make_shared<RegexNode>();
+        node->type = RegexNode::Type::OR;
+        node->begin = group.begin;
+        node->end = end;
+        node->parts = std::move(group.alternatives);
+        return node;
+    };
+
+    vector<RegexGroup> groups(1);
+    for (size_t i = 0; i < n; ++i) {
+        const string& ch = graphemes[i];
+        if (ch == "(") {
+            if (!matched[i]) {
+                _errorMessage = "Error: missing right bracket for " + to_string(i + 1) + ".";
+                return nullptr;
+            }
+            groups.emplace_back();
+            groups.back().begin = groups.back().alternativeBegin = i + 1;
+            continue;
+        }
+        if (ch == ")" && matched[i]) {
+            auto sub = finishGroup(groups.back(), i);
+            if (!sub) {
+                return nullptr;
+            }
+            sub->begin = groups.back().begin - 1;
+            sub->end = i + 1;
+            const auto expansion = groups.back().alternativesExpansion;
+            groups.pop_back();
+            groups.back().parts.push_back(sub);
+            groups.back().partExpansions.push_back(expansion);
+            continue;
+        }
+        if (ch == "|") {
+            if (!finishAlternative(groups.back(), i)) {
+                return nullptr;
+            }
+            groups.back().alternativeBegin = i + 1;
+            continue;
+        }
+        auto& parts = groups.back().parts;
+        auto& partExpansions = groups.back().partExpansions;
+        if (ch == "*") {
+            if (parts.empty()) {
+                _errorMessage = "Error: unexpected * at " + to_string(i) + ".";
+                return nullptr;
+            }
+            auto tempNode = make_shared<RegexNode>();
+            tempNode->begin = parts.back()->begin;
+            tempNode->end = parts.back()->end + 1;
+            tempNode->type = RegexNode::Type::STAR;
+            tempNode->sub = parts.back();
+            parts.back() = tempNode;
+            partExpansions.back().size += 1;
+            partExpansions.back().depth += 1;
+        } else if (ch == "+") {
+            if (parts.empty()) {
+                _errorMessage = "Error: unexpected + at " + to_string(i) + ".";
+                return nullptr;
+            }
+            auto virNode = make_shared<RegexNode>();
+            virNode->begin = parts.back()->begin;
+            virNode->end = parts.back()->end + 1;
+            virNode->type = RegexNode::Type::STAR;
+            virNode->sub = parts.back();
+
+            const auto tempNode = make_shared<RegexNode>();
+            tempNode->begin = parts.back()->begin;
+            tempNode->end = parts.back()->end + 1;
+            tempNode->type = RegexNode::Type::CAT;
+            tempNode->parts = {parts.back(), virNode};
+            parts.back() = tempNode;
+            partExpansions.back().size = partExpansions.back().size * 2 + 2;
+            partExpansions.back().depth += 2;
+        } else if (ch == "?") {
+            if (parts.empty()) {
+                _errorMessage = "Error: unexpected ? at " + to_string(i) + ".";
+                return nullptr;
+            }
+            auto virNode = make_shared<RegexNode>();
+            virNode->begin = parts.back()->begin;
+            virNode->end = parts.back()->end + 1;
+            virNode->type = RegexNode::Type::EMPTY;
+
+            const auto tempNode = make_shared<RegexNode>();
+            tempNode->begin = parts.back()->begin;
+            tempNode->end = parts.back()->end + 1;
+            tempNode->type = RegexNode::Type::OR;
+            tempNode->parts = {parts.back(), virNode};
+            parts.back() = tempNode;
+            partExpansions.back().size += 2;
+            partExpansions.back().depth += 1;
+        } else if (ch == "{") {
+            if (parts.empty()) {
+                _errorMessage = "Error: unexpected { at " + to_string(i) + ".";
+                return nullptr;
+            }
+            const size_t first = i;
+            size_t low = 0, high = 0;
+            if (!parseRepetition(graphemes, i, n, low, high)) {
+                return nullptr;
+            }
+            partExpansions.back() = expandRepetition(partExpansions.back(), low, high);
+            if (partExpansions.back().size > MAX_EXPANDED_SIZE) {
+                _errorMessage = "Error: the repetition at " + to_string(first) + " expands to more than "
+                              + to_string(MAX_EXPANDED_SIZE) + " nodes.";
+                return nullptr;
+            }
+            parts.back() = repeat(parts.back(), low, high, i + 1);
+        } else if (ch == "[") {
+            auto tempNode = parseClass(graphemes, i, n);
+            if (!tempNode) {
+                return nullptr;
+            }
+            parts.push_back(tempNode);
+            partExpansions.emplace_back();
+        } else if (ch == ".") {
+            auto tempNode = make_shared<RegexNode>();
+            tempNode->begin = i;
+            tempNode->end = i + 1;
+            tempNode->type = RegexNode::Type::CLASS;
+            tempNode->text = ch;
+            tempNode->charClass.add('\n', '\n');
+            tempNode->charClass = tempNode->charClass.negated();
+            parts.push_back(tempNode);
+            partExpansions.emplace_back();
+        } else if (ch == "\\") {
+            const size_t first = i;
+            auto escaped = parseEscape(graphemes, i, n);
+            if (!escaped) {
+                return nullptr;
+            }
+            auto tempNode = make_shared<RegexNode>();
+            tempNode->begin = first;
+            tempNode->end = i + 1;
+            if (escaped->intervals.empty()) {
+                tempNode->type = RegexNode::Type::TEXT;
+                tempNode->text = graphemes[i];
+            } else if (isSingle(*escaped)) {
+                tempNode->type = RegexNode::Type::TEXT;
+                tempNode->text = CharClass::toUTF8(escaped->intervals[0].first);
+            } else {
+                tempNode->type = RegexNode::Type::CLASS;
+                tempNode->text = joinGraphemes(graphemes, first, i + 1);
+                tempNode->charClass = std::move(*escaped);
+            }
+            parts.push_back(tempNode);
+            partExpansions.emplace_back();
+        } else if (ch == EPSILON) {
+            auto tempNode = make_shared<RegexNode>();
+            tempNode->begin = i;
+            tempNode->end = i + 1;
+            tempNode->type = RegexNode::Type::EMPTY;
+            parts.push_back(tempNode);
+            partExpansions.emplace_back();
+        } else {
+            auto tempNode = make_shared<RegexNode>();
+            tempNode->begin = i;
+            tempNode->end = i + 1;
+            tempNode->type = RegexNode::Type::TEXT;
+            tempNode->text = ch;
+            parts.push_back(tempNode);
+            partExpansions.emplace_back();
+        }
+    }
+    auto ast = finishGroup(groups.back(), n);
+    if (ast && groups.back().alternativesExpansion.size > MAX_EXPANDED_SIZE) {
+        _errorMessage = "Error: the pattern expands to more than " + to_string(MAX_EXPANDED_SIZE) + " nodes.";
+        return nullptr;
+    }
+    if (ast && groups.back().alternativesExpansion.depth > MAX_DEPTH) {
+        _errorMessage = "Error: the pattern is nested deeper than " + to_string(MAX_DEPTH) + " levels.";
+        return nullptr;
+    }
+    return ast;
 }
 
 static size_t generateGraph(const shared_ptr<RegexNode>& node, const shared_ptr<NFAState>& start, const shared_ptr<NFAState>& end, size_t count) {
@@ -173,6 +533,7 @@ static size_t generateGraph(const shared_ptr<RegexNode>& node, const shared_ptr<
             start->edges.emplace_back(RegularExpression::EPSILON, end);
             break;
         case RegexNode::Type::TEXT:
+        case RegexNode::Type::CLASS:
             start->edges.emplace_back(node->text, end);
             break;
         case RegexNode::Type::CAT: {
@@ -0,0 +1,61 @@
+#include "re_matcher.h"
+
+using namespace std;
+
+RegexCache::RegexCache(const size_t capacity) : _capacity(max<size_t>(capacity, 1)) {}
+
+/**
+ * The entries are kept in the order of use, so the least recently used one is evicted from the back.
+ * If another thread has inserted the pattern while it was being compiled, its matcher is kept.
+ */
+shared_ptr<const DFAMatcher> RegexCache::get(const string& pattern) {
+    {
+        lock_guard lock(_mutex);
+        if (const auto it = _index.find(pattern); it != _index.end()) {
+            ++_numHits;
+            _entries.splice(_entries.begin(), _entries, it->second);
+            return it->second->second;
+        }
+        ++_numMisses;
+    }
+    auto matcher = make_shared<const DFAMatcher>(pattern);
+    lock_guard lock(_mutex);
+    if (const auto it = _index.find(pattern); it != _index.end()) {
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return it->second->second;
+    }
+    _entries.emplace_front(pattern, matcher);
+    _index.emplace(pattern, _entries.begin());
+    if (_entries.size() > _capacity) {
+        _index.erase(_entries.back().first);
+        _entries.pop_back();
+    }
+    return matcher;
+}
+
+size_t RegexCache::capacity() const {
+    return _capacity;
+}
+
+size_t RegexCache::size() const {
+    lock_guard lock(_mutex);
+    return _entries.size();
+}
+
+size_t RegexCache::numHits() const {
+    lock_guard lock(_mutex);
+    return _numHits;
+}
+
+size_t RegexCache::numMisses() const {
+    lock_guard lock(_mutex);
+    return _numMisses;
+}
+
+void RegexCache::clear() {
+    lock_guard lock(_mutex);
+    _entries.clear();
+    _index.clear();
+    _numHits = 0;
+    _numMisses = 0;
+}
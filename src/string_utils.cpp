@@ -1,11 +1,99 @@
 #include "string_utils.h"
 #include <grapheme_break.h>
 #include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PARSING_TOYS_X86_64
+#endif
 
 using namespace std;
 
+/**
+ * @return The position of the first byte that is not ASCII from a position, or the size of the string.
+ */
+static size_t skipASCII(const string_view s, size_t i) {
+#ifdef PARSING_TOYS_X86_64
+    for (; i + 16 <= s.size(); i += 16) {
+        const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.data() + i));
+        if (const auto bits = static_cast<uint32_t>(_mm_movemask_epi8(bytes)); bits != 0) {
+            return i + static_cast<size_t>(countr_zero(bits));
+        }
+    }
+#else
+    for (; i + 8 <= s.size(); i += 8) {
+        uint64_t word;
+        memcpy(&word, s.data() + i, 8);
+        if (const auto bits = word & 0x8080808080808080ULL; bits != 0) {
+            return i + static_cast<size_t>(countr_zero(bits) / 8);
+        }
+    }
+#endif
+    while (i < s.size() && static_cast<uint8_t>(s[i]) < 0x80) {
+        ++i;
+    }
+    return i;
+}
+
+static bool isASCIIControl(const char ch) {
+    return static_cast<uint8_t>(ch) < 0x20 || ch == 0x7F;
+}
+
+/**
+ * An ASCII character is a cluster by itself if it is followed by another ASCII character, except CR LF.
+ * The other characters are segmented in chunks with the ASCII characters next to them that are not controls,
+ * which may be extended by marks or follow a prepended character, and the controls always break.
+ */
+void segmentGraphemeViews(const string_view s, vector<string_view>& clusters) {
+    size_t i = 0;
+    while (i < s.size()) {
+        const size_t end = skipASCII(s, i);
+        size_t chunkBegin = end;
+        if (end < s.size() && end > i && !isASCIIControl(s[end - 1])) {
+            chunkBegin = end - 1;
+        }
+        while (i < chunkBegin) {
+            if (s[i] == '\r' && i + 1 < chunkBegin && s[i + 1] == '\n') {
+                clusters.push_back(s.substr(i, 2));
+                i += 2;
+            } else {
+                clusters.push_back(s.substr(i++, 1));
+            }
+        }
+        if (i == s.size()) {
+            break;
+        }
+        size_t chunkEnd = end;
+        while (true) {
+            while (chunkEnd < s.size() && static_cast<uint8_t>(s[chunkEnd]) >= 0x80) {
+                ++chunkEnd;
+            }
+            if (chunkEnd == s.size() || isASCIIControl(s[chunkEnd])) {
+                break;
+            }
+            if (++chunkEnd == s.size() || static_cast<uint8_t>(s[chunkEnd]) < 0x80) {
+                break;
+            }
+        }
+        for (const auto& cluster : grapheme_break::segmentGraphemeClusters(string(s.substr(i, chunkEnd - i)))) {
+            clusters.push_back(s.substr(i, cluster.size()));
+            i += cluster.size();
+        }
+    }
+}
+
+vector<string_view> segmentGraphemeViews(const string_view s) {
+    vector<string_view> clusters;
+    clusters.reserve(s.size());
+    segmentGraphemeViews(s, clusters);
+    return clusters;
+}
+
 vector<string> segmentGraphemes(const string& s) {
-    return grapheme_break::segmentGraphemeClusters(s);
+    const auto views = segmentGraphemeViews(s);
+    return {views.begin(), views.end()};
 }
 
 vector<string> stringSplit(const string& str, const char delimiter, const bool removeEmpty) {
@@ -85,5 +173,5 @@ string toSubscript(size_t number) {
 }
 
 size_t utf8Length(const string& s) {
-    return grapheme_break::segmentGraphemeClusters(s).size();
+    return segmentGraphemeViews(s).size();
 }
@@ -0,0 +1,127 @@
+#include "cfg.h"
+#include "automaton.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+
+using namespace std;
+
+static const string EXPRESSION_GRAMMAR = R"(
+E -> E + T | T
+T -> T * F | F
+F -> ( E ) | id
+)";
+
+static string temporaryDirectory(const string& name) {
+    const auto path = filesystem::temp_directory_path() / name;
+    filesystem::remove_all(path);
+    return path.string();
+}
+
+TEST(TestGrammarArtifactCache, Fingerprint) {
+    ContextFreeGrammar grammar, spaced, reordered, weighted;
+    EXPECT_TRUE(grammar.parse(EXPRESSION_GRAMMAR));
+    EXPECT_TRUE(spaced.parse("E->E + T|T\n\nT -> T * F | F\nF -> ( E )\n   | id\n"));
+    EXPECT_TRUE(reordered.parse("E -> T | E + T\nT -> T * F | F\nF -> ( E ) | id\n"));
+    EXPECT_TRUE(weighted.parse("E -> E + T | T\nT -> T * F | F\nF -> ( E ) | id [2]\n"));
+    EXPECT_EQ(grammar.fingerprint(), spaced.fingerprint());
+    EXPECT_NE(grammar.fingerprint(), reordered.fingerprint());
+    EXPECT_NE(grammar.fingerprint(), weighted.fingerprint());
+    EXPECT_NE(grammar.fingerprint(), ContextFreeGrammar().fingerprint());
+}
+
+TEST(TestGrammarArtifactCache, SameAsCompute) {
+    const auto directory = temporaryDirectory("parsing_toys_test_artifact_cache");
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse(EXPRESSION_GRAMMAR));
+    for (int run = 0; run < 2; ++run) {
+        GrammarArtifactCache cache(directory);
+        const auto firstAndFollowSet = grammar.computeFirstAndFollowSet();
+        const auto cached = cache.firstAndFollowSet(grammar);
+        EXPECT_EQ(firstAndFollowSet.ordering, cached.ordering);
+        EXPECT_EQ(firstAndFollowSet.first, cached.first);
+        EXPECT_EQ(firstAndFollowSet.follow, cached.follow);
+        for (const auto algorithm : {LRAlgorithm::LR0, LRAlgorithm::SLR1, LRAlgorithm::LR1, LRAlgorithm::LALR1}) {
+            auto copy = grammar;
+            unique_ptr<FiniteAutomaton> automaton;
+            ActionGotoTable table;
+            switch (algorithm) {
+                case LRAlgorithm::LR0:
+                    automaton = copy.computeLR0Automaton();
+                    table = copy.computeLR0ActionGotoTable(automaton);
+                    break;
+                case LRAlgorithm::SLR1:
+                    automaton = copy.computeSLR1Automaton();
+                    table = copy.computeSLR1ActionGotoTable(automaton);
+                    break;
+                case LRAlgorithm::LR1:
+                    automaton = copy.computeLR1Automaton();
+                    table = copy.computeLR1ActionGotoTable(automaton);
+                    break;
+                case LRAlgorithm::LALR1:
+                    automaton = copy.computeLALR1Automaton();
+                    table = copy.computeLALR1ActionGotoTable(automaton);
+                    break;
+            }
+            const auto actualTable = cache.actionGotoTable(grammar, algorithm);
+            EXPECT_EQ(table.toString(copy), actualTable.toString(copy));
+            const auto actual = cache.automaton(grammar, algorithm);
+            ASSERT_EQ(automaton->size(), actual->size());
+            for (size_t i = 0; i < automaton->size(); ++i) {
+                EXPECT_EQ(automaton->nodeAt(i).toString(), actual->nodeAt(i).toString());
+                EXPECT_EQ(automaton->nodeAt(i).accept, actual->nodeAt(i).accept);
+            }
+            EXPECT_EQ(automaton->edgesToString(), actual->edgesToString());
+        }
+        if (run == 0) {
+            // The tables load the automata on misses, which are hits when they are requested again.
+            EXPECT_EQ(9, cache.numMisses());
+            EXPECT_EQ(4, cache.numHits());
+        } else {
+            EXPECT_EQ(0, cache.numMisses());
+            EXPECT_EQ(9, cache.numHits());
+        }
+    }
+    filesystem::remove_all(directory);
+}
+
+TEST(TestGrammarArtifactCache, CorruptedArtifact) {
+    const auto directory = temporaryDirectory("parsing_toys_test_artifact_cache_corrupted");
+    ContextFreeGrammar grammar, other;
+    EXPECT_TRUE(grammar.parse(EXPRESSION_GRAMMAR));
+    EXPECT_TRUE(other.parse("S -> a S b | ε\n"));
+    GrammarArtifactCache cache(directory);
+    const auto expected = cache.actionGotoTable(grammar, LRAlgorithm::SLR1).toString(grammar);
+    const auto path = cache.pathOf(grammar, "slr1-table");
+    ASSERT_TRUE(filesystem::exists(path));
+    {
+        ifstream file(path, ios::binary);
+        string magic, version;
+        getline(file, magic);
+        getline(file, version);
+        EXPECT_EQ("parsing-toys artifact", magic);
+        EXPECT_EQ(to_string(GrammarArtifactCache::FORMAT_VERSION), version);
+    }
+
+    // Truncated
+    const auto size = filesystem::file_size(path);
+    filesystem::resize_file(path, size - 3);
+    EXPECT_EQ(expected, cache.actionGotoTable(grammar, LRAlgorithm::SLR1).toString(grammar));
+    EXPECT_EQ(size, filesystem::file_size(path));
+
+    // Written for another grammar with the same path
+    (void)cache.actionGotoTable(other, LRAlgorithm::SLR1);
+    filesystem::copy_file(cache.pathOf(other, "slr1-table"), path, filesystem::copy_options::overwrite_existing);
+    const auto numMisses = cache.numMisses();
+    EXPECT_EQ(expected, cache.actionGotoTable(grammar, LRAlgorithm::SLR1).toString(grammar));
+    EXPECT_EQ(numMisses + 1, cache.numMisses());
+
+    // Garbage after the header
+    {
+        ofstream file(path, ios::binary | ios::app);
+        file << "999999999999\n";
+    }
+    EXPECT_EQ(expected, cache.actionGotoTable(grammar, LRAlgorithm::SLR1).toString(grammar));
+    EXPECT_EQ(numMisses + 2, cache.numMisses());
+    filesystem::remove_all(directory);
+}
@@ -1,5 +1,6 @@
 #include "cfg.h"
 #include <gtest/gtest.h>
+#include <algorithm>
 
 using namespace std;
 
@@ -211,3 +212,92 @@ TEST(TestContextFreeGrammarCNF, TerminalCollisionMultiple) {
     const auto result = grammar.toString();
     EXPECT_TRUE(result.find("T_a_2") != string::npos);
 }
+
+TEST(TestContextFreeGrammarCNF, ConvertProductionOfFourSymbols) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> A B C D\nA -> a\nB -> b\nC -> c\nD -> d"));
+    grammar.toChomskyNormalForm();
+    EXPECT_TRUE(grammar.isChomskyNormalForm());
+    const auto expected = R"(   S -> A S'
+  S' -> B S'_1
+S'_1 -> C D
+   A -> a
+   B -> b
+   C -> c
+   D -> d
+)";
+    EXPECT_EQ(expected, grammar.toString());
+    EXPECT_TRUE(grammar.cykParse("a b c d").accepted);
+}
+
+TEST(TestContextFreeGrammarCNF, CompileKeepsOriginal) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> a S b | ε"));
+    const auto original = grammar.toString();
+    const auto compiled = grammar.compileChomskyNormalForm();
+    EXPECT_EQ(original, grammar.toString());
+    EXPECT_TRUE(compiled.grammar.isChomskyNormalForm());
+    ContextFreeGrammar converted = grammar;
+    converted.toChomskyNormalForm();
+    EXPECT_EQ(converted.toString(), compiled.grammar.toString());
+    EXPECT_EQ("S'", compiled.newStart);
+    EXPECT_EQ("a", compiled.terminalWrappers.at("T_a"));
+}
+
+TEST(TestContextFreeGrammarCNF, RestoreArithmeticExpression) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("E -> E + T | T\nT -> T * F | F\nF -> ( E ) | id"));
+    const auto compiled = grammar.compileChomskyNormalForm();
+    for (const auto& input : {"id", "id + id * ( id )", "( ( id ) ) * id + id"}) {
+        const auto result = compiled.cykParse(input);
+        ASSERT_TRUE(result.accepted) << input;
+        EXPECT_EQ(grammar.earleyParse(input).parseTree->toString(), result.parseTree->toString()) << input;
+    }
+    EXPECT_FALSE(compiled.cykParse("id +").accepted);
+    EXPECT_EQ(nullptr, compiled.cykParse("id +").parseTree);
+}
+
+TEST(TestContextFreeGrammarCNF, RestoreNullableAndUnitProductions) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse(R"(
+S -> A x B C
+A -> a | ε
+B -> D
+D -> b | A A
+C -> c C | ε
+)"));
+    const auto compiled = grammar.compileChomskyNormalForm();
+    const auto expected = R"(S
+  A
+    ε
+  x
+  B
+    D
+      A
+        ε
+      A
+        ε
+  C
+    c
+    C
+      ε
+)";
+    EXPECT_EQ(expected, compiled.cykParse("x c").parseTree->toString());
+    const auto result = compiled.cykParse("a x b c c");
+    EXPECT_EQ(grammar.earleyParse("a x b c c").parseTree->toString(), result.parseTree->toString());
+}
+
+TEST(TestContextFreeGrammarCNF, RestoreEmptyString) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> A S | A\nA -> a | ε"));
+    const auto compiled = grammar.compileChomskyNormalForm();
+    const auto expected = R"(S
+  A
+    ε
+)";
+    EXPECT_EQ(expected, compiled.cykParse("").parseTree->toString());
+    const auto result = compiled.cykParse("a a");
+    ASSERT_TRUE(result.accepted);
+    EXPECT_EQ("S", result.parseTree->label);
+    EXPECT_EQ(2, ranges::count_if(result.parseTree->toString(), [](const char c) { return c == 'a'; }));
+}
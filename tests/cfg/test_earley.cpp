@@ -0,0 +1,206 @@
+#include "cfg.h"
+#include <gtest/gtest.h>
+
+using namespace std;
+
+TEST(TestEarley, EmptyGrammar) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse(""));
+    const auto result = grammar.earleyParse("a");
+    EXPECT_FALSE(result.accepted);
+    EXPECT_EQ(nullptr, result.parseTree);
+}
+
+TEST(TestEarley, EmptyString) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> A B\nA -> a | ε\nB -> b | ε"));
+    const auto result = grammar.earleyParse("");
+    EXPECT_TRUE(result.accepted);
+    EXPECT_EQ(0, result.size());
+    const auto expected = R"(S
+  A
+    ε
+  B
+    ε
+)";
+    EXPECT_EQ(expected, result.parseTree->toString());
+}
+
+TEST(TestEarley, EmptyStringNotAccepted) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> a"));
+    const auto result = grammar.earleyParse("");
+    EXPECT_FALSE(result.accepted);
+}
+
+TEST(TestEarley, UnknownToken) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> a S | a"));
+    EXPECT_FALSE(grammar.earleyParse("a b a").accepted);
+    EXPECT_FALSE(grammar.earleyParse("S").accepted);
+}
+
+TEST(TestEarley, ItemSets) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> A B\nA -> a\nB -> b"));
+    const auto result = grammar.earleyParse("a b");
+    EXPECT_TRUE(result.accepted);
+    EXPECT_EQ(2, result.size());
+    EXPECT_EQ((vector<string>{"S' -> · S, 0", "S -> · A B, 0", "A -> · a, 0"}), result.getSet(0));
+    EXPECT_EQ((vector<string>{"A -> a ·, 0", "S -> A · B, 0", "B -> · b, 1"}), result.getSet(1));
+    // S -> A B · is on the deterministic reduction path and is skipped.
+    EXPECT_EQ((vector<string>{"B -> b ·, 1", "S' -> S ·, 0"}), result.getSet(2));
+    EXPECT_TRUE(result.getSet(3).empty());
+    EXPECT_EQ(8, result.numItems());
+}
+
+TEST(TestEarley, ArithmeticExpression) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("E -> E + T | T\nT -> T * F | F\nF -> ( E ) | id"));
+    const auto result = grammar.earleyParse("id + id * ( id )");
+    EXPECT_TRUE(result.accepted);
+    const auto expected = R"(E
+  E
+    T
+      F
+        id
+  +
+  T
+    T
+      F
+        id
+    *
+    F
+      (
+      E
+        T
+          F
+            id
+      )
+)";
+    EXPECT_EQ(expected, result.parseTree->toString());
+    EXPECT_FALSE(grammar.earleyParse("id + + id").accepted);
+    EXPECT_FALSE(grammar.earleyParse("id +").accepted);
+}
+
+TEST(TestEarley, NullableNonTerminals) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse(R"(
+S -> A A A x
+A -> B | ε
+B -> A
+)"));
+    const auto result = grammar.earleyParse("x");
+    EXPECT_TRUE(result.accepted);
+    const auto expected = R"(S
+  A
+    ε
+  A
+    ε
+  A
+    ε
+  x
+)";
+    EXPECT_EQ(expected, result.parseTree->toString());
+}
+
+TEST(TestEarley, NullableCompletedLater) {
+    // The classic case where the completion of an empty non-terminal happens before the item waiting for it.
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse(R"(
+S -> E
+E -> A E b | a
+A -> ε
+)"));
+    EXPECT_TRUE(grammar.earleyParse("a").accepted);
+    EXPECT_TRUE(grammar.earleyParse("a b b").accepted);
+    EXPECT_FALSE(grammar.earleyParse("b a").accepted);
+}
+
+TEST(TestEarley, CyclicUnitProductions) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse(R"(
+S -> A
+A -> B | a
+B -> A | b
+)"));
+    const auto result = grammar.earleyParse("b");
+    EXPECT_TRUE(result.accepted);
+    const auto expected = R"(S
+  A
+    B
+      b
+)";
+    EXPECT_EQ(expected, result.parseTree->toString());
+}
+
+TEST(TestEarley, AmbiguousGrammar) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("E -> E + E | id"));
+    const auto result = grammar.earleyParse("id + id + id");
+    EXPECT_TRUE(result.accepted);
+    EXPECT_EQ(10, result.parseTree->size());
+}
+
+TEST(TestEarley, RightRecursionLeoItems) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> a S | a"));
+    const auto result = grammar.earleyParse("a a a");
+    EXPECT_TRUE(result.accepted);
+    const auto expected = R"(S
+  a
+  S
+    a
+    S
+      a
+)";
+    EXPECT_EQ(expected, result.parseTree->toString());
+
+    string input;
+    constexpr size_t n = 2000;
+    for (size_t i = 0; i < n; ++i) {
+        input += "a ";
+    }
+    const auto longResult = grammar.earleyParse(input);
+    EXPECT_TRUE(longResult.accepted);
+    EXPECT_EQ(2 * n, longResult.parseTree->size());
+    // Without the deterministic reduction paths, each set would contain all the completed items of S.
+    for (size_t i = 0; i <= n; ++i) {
+        EXPECT_LE(longResult.sets[i].size(), 6);
+    }
+}
+
+TEST(TestEarley, RightRecursionThroughOtherNonTerminals) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse(R"(
+L -> x R
+R -> , L | ε
+)"));
+    const auto result = grammar.earleyParse("x , x , x");
+    EXPECT_TRUE(result.accepted);
+    const auto expected = R"(L
+  x
+  R
+    ,
+    L
+      x
+      R
+        ,
+        L
+          x
+          R
+            ε
+)";
+    EXPECT_EQ(expected, result.parseTree->toString());
+    EXPECT_FALSE(grammar.earleyParse("x , , x").accepted);
+}
+
+TEST(TestEarley, SameAsCYK) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> ( S ) | S S | ε"));
+    ContextFreeGrammar cnf = grammar;
+    cnf.toChomskyNormalForm();
+    for (const auto& input : {"", "( )", "( ( ) )", "( ) ( )", "( ( )", ") (", "( ( ) ( ) ) ( )"}) {
+        EXPECT_EQ(cnf.cykParse(input).accepted, grammar.earleyParse(input).accepted) << input;
+    }
+}
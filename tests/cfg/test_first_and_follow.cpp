@@ -263,3 +263,17 @@ TEST(TestContextFreeGrammarFirstAndFollow, SpecialCase13) {
     EXPECT_EQ(vector<string>({"a", "b", ContextFreeGrammar::EOF_SYMBOL}), result.getFollowSet("A"));
     EXPECT_EQ(vector<string>({"a", ContextFreeGrammar::EOF_SYMBOL}), result.getFollowSet("B"));
 }
+
+TEST(TestContextFreeGrammarFirstAndFollow, Update) {
+    ContextFreeGrammar previous, grammar;
+    EXPECT_TRUE(previous.parse("S -> A B A\nA -> a | ε\nB -> b | ε\nC -> c\n"));
+    EXPECT_TRUE(grammar.parse("S -> A B A\nA -> a | ε\nB -> b\n"));
+    EXPECT_EQ(unordered_set<Symbol>({"B", "C"}), grammar.changedHeads(previous));
+    const auto result = grammar.updateFirstAndFollowSet(previous, previous.computeFirstAndFollowSet());
+    const auto expected = grammar.computeFirstAndFollowSet();
+    EXPECT_EQ(expected.ordering, result.ordering);
+    EXPECT_EQ(expected.first, result.first);
+    EXPECT_EQ(expected.follow, result.follow);
+    EXPECT_EQ(vector<string>({"a", "b"}), result.getFirstSet("S"));
+    EXPECT_EQ(vector<string>({"b", ContextFreeGrammar::EOF_SYMBOL}), result.getFollowSet("A"));
+}
@@ -0,0 +1,123 @@
+#include "cfg.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace std;
+
+static void expectSameAsParse(const IncrementalGrammar& incremental, const bool success) {
+    ContextFreeGrammar grammar;
+    ASSERT_EQ(grammar.parse(incremental.text()), success) << incremental.text();
+    if (!success) {
+        EXPECT_EQ(grammar.errorMessage(), incremental.errorMessage()) << incremental.text();
+        return;
+    }
+    EXPECT_EQ(grammar.toString(), incremental.grammar().toString()) << incremental.text();
+    EXPECT_EQ(grammar.orderedNonTerminals(), incremental.grammar().orderedNonTerminals()) << incremental.text();
+    auto expected = grammar.terminals(), actual = incremental.grammar().terminals();
+    ranges::sort(expected);
+    ranges::sort(actual);
+    EXPECT_EQ(expected, actual) << incremental.text();
+}
+
+TEST(TestIncrementalGrammar, Blocks) {
+    IncrementalGrammar incremental;
+    EXPECT_TRUE(incremental.parse("\nS -> a\nA -> b | c\n  | d\nB -> e f C -> g\n"));
+    EXPECT_EQ(3, incremental.numBlocks());
+    expectSameAsParse(incremental, true);
+}
+
+TEST(TestIncrementalGrammar, Edits) {
+    IncrementalGrammar incremental;
+    EXPECT_TRUE(incremental.parse("S -> A B\nA -> a | ε\nB -> b [0.5] | A\n"));
+    const vector<tuple<string, string, bool>> edits = {
+        {"a | ε", "a | ε | S", true},
+        {"B -> b", "C -> b", true},
+        {"C -> b", "C b", true},
+        {"S -> A B\n", "", true},
+        {"C b [0.5]", "C ->", false},
+        {"C ->", "C -> c [0.5]", true},
+        {"A -> a", "B -> d [0.3]\nA -> a", true},
+        {"\n", "\r\n", true},
+        {"B -> d [0.3]", "B -> d [-1]", false},
+        {"B -> d [-1]", "B -> b [0.2] | d", true},
+    };
+    for (const auto& [from, to, success] : edits) {
+        const auto offset = incremental.text().find(from);
+        ASSERT_NE(string::npos, offset) << from;
+        EXPECT_EQ(success, incremental.edit(offset, from.size(), to)) << incremental.text();
+        expectSameAsParse(incremental, success);
+    }
+    EXPECT_TRUE(incremental.grammar().hasWeights());
+    EXPECT_EQ(0.2, incremental.grammar().weightOf("B", {"b"}));
+}
+
+TEST(TestIncrementalGrammar, OutOfRange) {
+    IncrementalGrammar incremental;
+    EXPECT_TRUE(incremental.parse("S -> a"));
+    EXPECT_FALSE(incremental.edit(5, 2, ""));
+    EXPECT_EQ("The range [5, 7) is out of the text with 6 bytes.", incremental.errorMessage());
+    EXPECT_EQ("S -> a\n", incremental.grammar().toString());
+}
+
+/**
+ * Insert and delete random pieces of grammars, and compare with parsing the whole text after each edit.
+ */
+TEST(TestIncrementalGrammar, SameAsParse) {
+    const vector<string> pieces = {"S", "A", "B", "a", "b", " ", " ", "->", "->", "|", "\n", "\n", "\r\n", "ε", "[0.5]", "你"};
+    mt19937 rng(42);
+    IncrementalGrammar incremental;
+    EXPECT_TRUE(incremental.parse("S -> A B\nA -> a\nB -> b\n"));
+    for (int step = 0; step < 3000; ++step) {
+        const auto& text = incremental.text();
+        size_t offset = uniform_int_distribution<size_t>(0, text.size())(rng);
+        while (offset < text.size() && (static_cast<uint8_t>(text[offset]) & 0xC0) == 0x80) {
+            ++offset;
+        }
+        size_t length = 0;
+        string replacement;
+        if (text.size() > 80 || rng() % 3 == 0) {
+            length = min(text.size() - offset, uniform_int_distribution<size_t>(0, 6)(rng));
+            while (offset + length < text.size() && (static_cast<uint8_t>(text[offset + length]) & 0xC0) == 0x80) {
+                ++length;
+            }
+        }
+        for (size_t i = rng() % 3; i > 0; --i) {
+            replacement += pieces[rng() % pieces.size()];
+        }
+        const bool success = incremental.edit(offset, length, replacement);
+        expectSameAsParse(incremental, success);
+        if (HasFailure()) {
+            break;
+        }
+    }
+}
+
+TEST(TestIncrementalGrammar, ParseFile) {
+    const auto path = filesystem::temp_directory_path() / "parsing_toys_test_grammar.txt";
+    {
+        ofstream file(path, ios::binary);
+        file << "S -> A 你\r\nA -> a [0.5]\n   | ε\n";
+    }
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parseFile(path.string()));
+    EXPECT_EQ("S -> A 你\nA -> a [0.5]\n   | ε\n", grammar.toString());
+
+    IncrementalGrammar incremental;
+    EXPECT_TRUE(incremental.parseFile(path.string()));
+    EXPECT_EQ(grammar.toString(), incremental.grammar().toString());
+    EXPECT_EQ(2, incremental.numBlocks());
+
+    ofstream(path, ios::binary | ios::trunc).close();
+    ContextFreeGrammar empty;
+    EXPECT_TRUE(empty.parseFile(path.string()));
+    EXPECT_EQ("", empty.toString());
+    filesystem::remove(path);
+
+    EXPECT_FALSE(grammar.parseFile(path.string()));
+    EXPECT_EQ("Can not open the file '" + path.string() + "'.", grammar.errorMessage());
+    EXPECT_FALSE(incremental.parseFile(path.string()));
+    EXPECT_EQ("Can not open the file '" + path.string() + "'.", incremental.errorMessage());
+}
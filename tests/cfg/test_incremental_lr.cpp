@@ -0,0 +1,154 @@
+#include "cfg.h"
+#include "automaton.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <algorithm>
+
+using namespace std;
+
+using Type = IncrementalLRAutomaton::Type;
+
+static void expectSameAsCompute(const IncrementalLRAutomaton& incremental, ContextFreeGrammar grammar, const Type type, const string& text) {
+    const auto firstAndFollowSet = grammar.computeFirstAndFollowSet();
+    EXPECT_EQ(firstAndFollowSet.ordering, incremental.firstAndFollowSet().ordering) << text;
+    EXPECT_EQ(firstAndFollowSet.first, incremental.firstAndFollowSet().first) << text;
+    EXPECT_EQ(firstAndFollowSet.follow, incremental.firstAndFollowSet().follow) << text;
+
+    unique_ptr<FiniteAutomaton> automaton;
+    ActionGotoTable table;
+    switch (type) {
+        case Type::LR0:
+            automaton = grammar.computeLR0Automaton();
+            table = grammar.computeLR0ActionGotoTable(automaton);
+            break;
+        case Type::SLR1:
+            automaton = grammar.computeSLR1Automaton();
+            table = grammar.computeSLR1ActionGotoTable(automaton);
+            break;
+        case Type::LR1:
+            automaton = grammar.computeLR1Automaton();
+            table = grammar.computeLR1ActionGotoTable(automaton);
+            break;
+        case Type::LALR1:
+            automaton = grammar.computeLALR1Automaton();
+            table = grammar.computeLALR1ActionGotoTable(automaton);
+            break;
+    }
+    const auto& actual = incremental.automaton();
+    ASSERT_EQ(automaton->size(), actual->size()) << text;
+    for (size_t i = 0; i < automaton->size(); ++i) {
+        EXPECT_EQ(automaton->nodeAt(i).toString(), actual->nodeAt(i).toString()) << text;
+        EXPECT_EQ(automaton->nodeAt(i).accept, actual->nodeAt(i).accept) << text;
+    }
+    EXPECT_EQ(automaton->edgesToString(), actual->edgesToString()) << text;
+    EXPECT_EQ(automaton->toSVG(), actual->toSVG()) << text;
+    EXPECT_EQ(table.toString(grammar), incremental.actionGotoTable().toString(grammar)) << text;
+}
+
+TEST(TestIncrementalLRAutomaton, Empty) {
+    IncrementalLRAutomaton incremental(Type::LALR1);
+    EXPECT_THROW(incremental.update(ContextFreeGrammar()), runtime_error);
+}
+
+TEST(TestIncrementalLRAutomaton, ReuseStates) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse(R"(
+E -> E + T | T
+T -> T * F | F
+F -> ( E ) | id
+)"));
+    IncrementalLRAutomaton incremental(Type::LALR1);
+    incremental.update(grammar);
+    EXPECT_EQ(0, incremental.numReusedStates());
+    EXPECT_EQ(0, incremental.numReusedRows());
+    const auto numStates = incremental.automaton()->size();
+
+    incremental.update(grammar);
+    EXPECT_LT(0, incremental.numReusedStates());
+    EXPECT_EQ(numStates, incremental.numReusedRows());
+
+    EXPECT_TRUE(grammar.parse(R"(
+E -> E + T | T
+T -> T * F | F
+F -> ( E ) | id | num
+)"));
+    incremental.update(grammar);
+    expectSameAsCompute(incremental, grammar, Type::LALR1, "num");
+    EXPECT_LT(0, incremental.numReusedStates());
+    EXPECT_LT(0, incremental.numReusedRows());
+    EXPECT_GT(incremental.automaton()->size(), incremental.numReusedRows());
+}
+
+TEST(TestIncrementalLRAutomaton, ChangeStartSymbol) {
+    ContextFreeGrammar grammar;
+    IncrementalLRAutomaton incremental(Type::SLR1);
+    for (const auto& text : {"S -> A b\nA -> a\n", "A -> a\nS -> A b\n", "S' -> A\nA -> a | S'\n", "S -> S' b\nS' -> a\n"}) {
+        EXPECT_TRUE(grammar.parse(text));
+        incremental.update(grammar);
+        expectSameAsCompute(incremental, grammar, Type::SLR1, text);
+    }
+}
+
+/**
+ * Change the productions of random heads, remove heads and reorder them, and compare with computing from scratch.
+ * The states are reached again in later steps with their kernel items in different orders.
+ */
+static void expectSameAsComputeAfterEdits(const Type type, const unsigned seed, const int numSteps) {
+    const vector<string> heads = {"S", "A", "B", "C", "D"};
+    const vector<string> symbols = {"S", "A", "B", "C", "D", "a", "b", "c"};
+    mt19937 rng(seed);
+    auto randomProductions = [&] {
+        string line;
+        for (size_t i = rng() % 3 + 1; i > 0; --i) {
+            line += line.empty() ? "" : " |";
+            const size_t length = rng() % 4;
+            for (size_t j = 0; j < length; ++j) {
+                line += " " + symbols[rng() % symbols.size()];
+            }
+            if (length == 0) {
+                line += " ε";
+            }
+        }
+        return line;
+    };
+    vector<pair<string, string>> rules = {{"S", " A B"}, {"A", " a | ε"}, {"B", " b A"}};
+    IncrementalLRAutomaton incremental(type);
+    for (int step = 0; step < numSteps; ++step) {
+        string text;
+        for (const auto& [head, line] : rules) {
+            text += head + " ->" + line + "\n";
+        }
+        ContextFreeGrammar grammar;
+        ASSERT_TRUE(grammar.parse(text)) << text;
+        incremental.update(grammar);
+        expectSameAsCompute(incremental, grammar, type, text);
+        if (::testing::Test::HasFailure()) {
+            return;
+        }
+        if (const auto choice = rng() % 10; choice < 6) {
+            rules[rng() % rules.size()].second = randomProductions();
+        } else if (choice < 8 && rules.size() < heads.size()) {
+            for (const auto& head : heads) {
+                if (ranges::none_of(rules, [&](const auto& rule) { return rule.first == head; })) {
+                    rules.emplace_back(head, randomProductions());
+                    break;
+                }
+            }
+        } else if (choice < 9 && rules.size() > 1) {
+            rules.erase(rules.begin() + static_cast<ptrdiff_t>(rng() % (rules.size() - 1) + 1));
+        } else {
+            swap(rules[rng() % rules.size()], rules[rng() % rules.size()]);
+        }
+    }
+}
+
+TEST(TestIncrementalLRAutomaton, SameAsCompute) {
+    for (const auto type : {Type::LR0, Type::SLR1, Type::LR1, Type::LALR1}) {
+        for (const unsigned seed : {42u, 7u, 2024u}) {
+            expectSameAsComputeAfterEdits(type, seed, 500);
+            if (HasFailure()) {
+                return;
+            }
+        }
+    }
+}
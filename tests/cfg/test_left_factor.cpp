@@ -199,3 +199,38 @@ TEST(TestContextFreeGrammarLeftFactoring, SingleSuffixAfterFactoring) {
     const auto result = grammar.toString();
     EXPECT_TRUE(result.find("a b c") != string::npos);
 }
+
+TEST(TestContextFreeGrammarLeftFactoring, Weights) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("T -> a b [0.4] | a c [0.6]"));
+    grammar.leftFactoring();
+    const auto expected = R"( T -> a T' [1]
+T' -> b [0.4]
+    | c [0.6]
+)";
+    EXPECT_EQ(expected, grammar.toString());
+    EXPECT_EQ(1.0, grammar.weightOf("T", {"a", "b"}));
+    EXPECT_EQ(1.0, grammar.weightOf("T", {"a", "c"}));
+}
+
+TEST(TestContextFreeGrammarLeftFactoring, WeightsOfExpansions) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> a b [0.5] | A [0.5]\nA -> a c [0.2] | d [0.8]"));
+    grammar.leftFactoring(true);
+    EXPECT_NEAR(0.6, grammar.weightOf("S", {"a", "S'"}), 1e-9);
+    EXPECT_NEAR(0.5 / 0.6, grammar.weightOf("S'", {"b"}), 1e-9);
+    EXPECT_NEAR(0.1 / 0.6, grammar.weightOf("S'", {"c"}), 1e-9);
+}
+
+TEST(TestContextFreeGrammarLeftFactoring, UnweightedProductionsOfWeightedGrammar) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> T [0.5] | b [0.5]\nT -> a b | a c"));
+    grammar.leftFactoring();
+    const auto expected = R"( S -> T [0.5]
+    | b [0.5]
+ T -> a T'
+T' -> b
+    | c
+)";
+    EXPECT_EQ(expected, grammar.toString());
+}
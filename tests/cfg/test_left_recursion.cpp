@@ -179,3 +179,50 @@ D -> a
 )";
     EXPECT_EQ(expected, grammar.toString());
 }
+
+TEST(TestContextFreeGrammarLeftRecursionElimination, EveryHeadEliminated) {
+    // The primed symbols are inserted after their heads, which should not skip the last heads.
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("A -> A a | b\nB -> B c | d\nC -> C e | f\n"));
+    EXPECT_TRUE(grammar.leftRecursionElimination());
+    const auto expected = R"( A -> b A'
+A' -> a A'
+    | ε
+ B -> d B'
+B' -> c B'
+    | ε
+ C -> f C'
+C' -> e C'
+    | ε
+)";
+    EXPECT_EQ(expected, grammar.toString());
+}
+
+TEST(TestContextFreeGrammarLeftRecursionElimination, Weights) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("E -> E + T [0.3] | T [0.7]\nT -> a\n"));
+    EXPECT_TRUE(grammar.leftRecursionElimination());
+    const auto expected = R"( E -> T E' [0.7]
+E' -> + T E' [0.3]
+    | ε
+ T -> a
+)";
+    EXPECT_EQ(expected, grammar.toString());
+    // The weights of the replaced productions are not kept.
+    EXPECT_EQ(1.0, grammar.weightOf("E", {"E", "+", "T"}));
+    EXPECT_EQ(1.0, grammar.weightOf("E", {"T"}));
+}
+
+TEST(TestContextFreeGrammarLeftRecursionElimination, WeightsOfSubstitutions) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> A a [0.4] | b [0.6]\nA -> S c [0.5] | d [0.5]\n"));
+    EXPECT_TRUE(grammar.leftRecursionElimination());
+    const auto expected = R"( S -> A a [0.4]
+    | b [0.6]
+ A -> b c A' [0.3]
+    | d A' [0.5]
+A' -> a c A' [0.2]
+    | ε
+)";
+    EXPECT_EQ(expected, grammar.toString());
+}
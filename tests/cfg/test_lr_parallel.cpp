@@ -0,0 +1,101 @@
+#include "cfg.h"
+#include "automaton.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace std;
+
+static unique_ptr<FiniteAutomaton> computeSequentially(ContextFreeGrammar grammar, const LRAlgorithm algorithm) {
+    switch (algorithm) {
+        case LRAlgorithm::LR0:
+            return grammar.computeLR0Automaton();
+        case LRAlgorithm::SLR1:
+            return grammar.computeSLR1Automaton();
+        case LRAlgorithm::LR1:
+            return grammar.computeLR1Automaton();
+        case LRAlgorithm::LALR1:
+            return grammar.computeLALR1Automaton();
+    }
+    return nullptr;
+}
+
+static ActionGotoTable computeTableSequentially(const ContextFreeGrammar& grammar, const LRAlgorithm algorithm, const unique_ptr<FiniteAutomaton>& automaton) {
+    switch (algorithm) {
+        case LRAlgorithm::LR0:
+            return grammar.computeLR0ActionGotoTable(automaton);
+        case LRAlgorithm::SLR1:
+            return grammar.computeSLR1ActionGotoTable(automaton);
+        case LRAlgorithm::LR1:
+            return grammar.computeLR1ActionGotoTable(automaton);
+        case LRAlgorithm::LALR1:
+            return grammar.computeLALR1ActionGotoTable(automaton);
+    }
+    return {};
+}
+
+static void expectSameAsSequential(const ContextFreeGrammar& grammar, const string& text) {
+    for (const auto algorithm : {LRAlgorithm::LR0, LRAlgorithm::SLR1, LRAlgorithm::LR1, LRAlgorithm::LALR1}) {
+        const auto expected = computeSequentially(grammar, algorithm);
+        const auto expectedTable = computeTableSequentially(grammar, algorithm, expected);
+        for (const size_t numThreads : {0, 2, 4, 8}) {
+            auto copy = grammar;
+            const auto actual = copy.computeLRAutomaton(algorithm, numThreads);
+            ASSERT_EQ(expected->size(), actual->size()) << text;
+            for (size_t i = 0; i < expected->size(); ++i) {
+                EXPECT_EQ(expected->nodeAt(i).label, actual->nodeAt(i).label) << text;
+                EXPECT_EQ(expected->nodeAt(i).toString(), actual->nodeAt(i).toString()) << text;
+                EXPECT_EQ(expected->nodeAt(i).accept, actual->nodeAt(i).accept) << text;
+            }
+            EXPECT_EQ(expected->edgesToString(), actual->edgesToString()) << text;
+            const auto actualTable = grammar.computeActionGotoTable(algorithm, actual, numThreads);
+            EXPECT_EQ(expectedTable.toString(grammar), actualTable.toString(grammar)) << text;
+            EXPECT_EQ(expectedTable.hasConflict(), actualTable.hasConflict()) << text;
+        }
+    }
+}
+
+TEST(TestLRParallel, Empty) {
+    ContextFreeGrammar grammar;
+    EXPECT_THROW(grammar.computeLRAutomaton(LRAlgorithm::LR0, 4), runtime_error);
+    EXPECT_THROW(grammar.computeLRAutomaton(LRAlgorithm::LALR1, 4), runtime_error);
+}
+
+TEST(TestLRParallel, Expression) {
+    ContextFreeGrammar grammar;
+    const string text = R"(
+E -> E + T | E - T | T
+T -> T * F | T / F | F
+F -> ( E ) | - F | id | num
+)";
+    EXPECT_TRUE(grammar.parse(text));
+    expectSameAsSequential(grammar, text);
+}
+
+TEST(TestLRParallel, Random) {
+    const vector<string> heads = {"S", "A", "B", "C", "D"};
+    const vector<string> symbols = {"S", "A", "B", "C", "D", "a", "b", "c", "d"};
+    mt19937 rng(42);
+    for (int step = 0; step < 30; ++step) {
+        string text;
+        for (const auto& head : heads) {
+            text += head + " ->";
+            for (size_t i = rng() % 3 + 1; i > 0; --i) {
+                text += text.back() == '>' ? "" : " |";
+                const size_t length = rng() % 5;
+                for (size_t j = 0; j < length; ++j) {
+                    text += " " + symbols[rng() % symbols.size()];
+                }
+                if (length == 0) {
+                    text += " ε";
+                }
+            }
+            text += "\n";
+        }
+        ContextFreeGrammar grammar;
+        ASSERT_TRUE(grammar.parse(text)) << text;
+        expectSameAsSequential(grammar, text);
+        if (HasFailure()) {
+            return;
+        }
+    }
+}
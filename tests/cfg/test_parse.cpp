@@ -119,6 +119,48 @@ TEST(TestContextFreeGrammarParse, Deduplicate4) {
     EXPECT_EQ("S -> a\nA -> b\n", grammar.toString());
 }
 
+TEST(TestContextFreeGrammarParse, Weights) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> A B [0.75] | a [0.25]\nA -> a\nB -> b [1e-2] | [2]"));
+    EXPECT_TRUE(grammar.hasWeights());
+    EXPECT_EQ(0.75, grammar.weightOf("S", {"A", "B"}));
+    EXPECT_EQ(0.25, grammar.weightOf("S", {"a"}));
+    EXPECT_EQ(1.0, grammar.weightOf("A", {"a"}));
+    EXPECT_EQ(0.01, grammar.weightOf("B", {"b"}));
+    // A weight alone is treated as a symbol.
+    EXPECT_EQ(1.0, grammar.weightOf("B", {"[2]"}));
+    EXPECT_EQ("S -> A B [0.75]\n   | a [0.25]\nA -> a\nB -> b [0.01]\n   | [2]\n", grammar.toString());
+}
+
+TEST(TestContextFreeGrammarParse, WeightsInTheMiddle) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> [ S ] | [0.5] S"));
+    EXPECT_FALSE(grammar.hasWeights());
+    EXPECT_EQ("S -> [ S ]\n   | [0.5] S\n", grammar.toString());
+}
+
+TEST(TestContextFreeGrammarParse, NegativeWeight) {
+    ContextFreeGrammar grammar;
+    EXPECT_FALSE(grammar.parse("S -> a [-0.5]"));
+    EXPECT_EQ("Line 1 Column 8: The weight of a production should be non-negative.", grammar.errorMessage());
+}
+
+TEST(TestContextFreeGrammarParse, OutOfRangeWeight) {
+    ContextFreeGrammar grammar;
+    EXPECT_FALSE(grammar.parse("S -> a [0.5]\n   | b [1e400]"));
+    EXPECT_EQ("Line 2 Column 8: The weight of a production is out of range.", grammar.errorMessage());
+}
+
+TEST(TestContextFreeGrammarParse, BracketsNotNumbers) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> a [x] | b [nan] | c [1abc] | d [+1]"));
+    EXPECT_TRUE(grammar.hasWeights());
+    EXPECT_EQ(1.0, grammar.weightOf("S", {"a", "[x]"}));
+    EXPECT_EQ(1.0, grammar.weightOf("S", {"b", "[nan]"}));
+    EXPECT_EQ(1.0, grammar.weightOf("S", {"c", "[1abc]"}));
+    EXPECT_EQ("S -> a [x]\n   | b [nan]\n   | c [1abc]\n   | d [1]\n", grammar.toString());
+}
+
 TEST(TestContextFreeGrammarParse, SpecialCase1) {
     ContextFreeGrammar grammar;
     EXPECT_TRUE(grammar.parse("S -> S S + | S S * | a"));
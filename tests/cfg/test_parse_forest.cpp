@@ -0,0 +1,207 @@
+#include "cfg.h"
+#include "parse_forest.h"
+#include <gtest/gtest.h>
+#include <unordered_set>
+
+using namespace std;
+
+static string repeatTokens(const string& token, const string& separator, const size_t n) {
+    string result;
+    for (size_t i = 0; i < n; ++i) {
+        if (i > 0) {
+            result += " " + separator + " ";
+        }
+        result += token;
+    }
+    return result;
+}
+
+TEST(TestParseForest, SharedNodes) {
+    ParseForest forest;
+    const auto a = forest.addNode(ParseForestNode::Type::SYMBOL, "A", 0, 1);
+    const auto b = forest.addNode(ParseForestNode::Type::SYMBOL, "A", 0, 1);
+    const auto c = forest.addNode(ParseForestNode::Type::TERMINAL, "A", 0, 1);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(2, forest.size());
+    EXPECT_EQ(a, forest.findNode(ParseForestNode::Type::SYMBOL, "A", 0, 1));
+    EXPECT_EQ(ParseForest::NONE, forest.findNode(ParseForestNode::Type::SYMBOL, "A", 0, 2));
+    EXPECT_EQ(forest.addPackedNode(a, {c}), forest.addPackedNode(a, {c}));
+    EXPECT_EQ(1, forest.numPackedNodes());
+}
+
+TEST(TestParseForest, EmptyForest) {
+    const ParseForest forest;
+    EXPECT_EQ(0, forest.countDerivations());
+    EXPECT_FALSE(forest.isAmbiguous());
+    EXPECT_TRUE(forest.firstTrees(3).empty());
+    EXPECT_TRUE(forest.bestTrees(3).empty());
+    EXPECT_EQ("", forest.toString());
+}
+
+TEST(TestParseForest, CYKAmbiguousExpression) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("E -> E + E | id"));
+    grammar.toChomskyNormalForm();
+    const auto result = grammar.cykParse("id + id + id", true);
+    ASSERT_NE(nullptr, result.forest);
+    const auto& forest = *result.forest;
+    EXPECT_TRUE(forest.isAmbiguous());
+    EXPECT_EQ(2, forest.countDerivations());
+    const auto trees = forest.firstTrees(5);
+    ASSERT_EQ(2, trees.size());
+    EXPECT_NE(trees[0]->toString(), trees[1]->toString());
+    EXPECT_EQ(result.parseTree->toString(), trees[0]->toString());
+}
+
+TEST(TestParseForest, CYKWithoutForest) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> a"));
+    EXPECT_EQ(nullptr, grammar.cykParse("a").forest);
+}
+
+TEST(TestParseForest, CYKEmptyString) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> ε"));
+    const auto result = grammar.cykParse("", true);
+    EXPECT_EQ(1, result.forest->countDerivations());
+    EXPECT_EQ("S\n  ε\n", result.forest->firstTrees(1)[0]->toString());
+}
+
+TEST(TestParseForest, CYKRejected) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> A B\nA -> a\nB -> b"));
+    const auto result = grammar.cykParse("b a", true);
+    EXPECT_FALSE(result.accepted);
+    EXPECT_EQ(ParseForest::NONE, result.forest->root());
+    EXPECT_EQ(0, result.forest->countDerivations());
+}
+
+TEST(TestParseForest, CatalanNumbers) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("E -> E + E | id"));
+    ContextFreeGrammar cnf = grammar;
+    cnf.toChomskyNormalForm();
+    const vector<size_t> catalan = {1, 1, 2, 5, 14, 42, 132, 429, 1430, 4862};
+    for (size_t n = 1; n <= catalan.size(); ++n) {
+        const auto input = repeatTokens("id", "+", n);
+        EXPECT_EQ(catalan[n - 1], cnf.cykParse(input, true).forest->countDerivations());
+        EXPECT_EQ(catalan[n - 1], grammar.earleyParse(input, true).forest->countDerivations());
+    }
+    // Catalan(29) trees are counted without enumerating them.
+    EXPECT_EQ(1002242216651368ULL, grammar.earleyParse(repeatTokens("id", "+", 30), true).forest->countDerivations());
+}
+
+TEST(TestParseForest, StreamAllTrees) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("E -> E + E | E * E | id"));
+    const auto result = grammar.earleyParse("id + id * id - id", true);
+    EXPECT_FALSE(result.accepted);
+
+    const auto accepted = grammar.earleyParse("id + id * id + id", true);
+    const auto& forest = *accepted.forest;
+    EXPECT_EQ(5, forest.countDerivations());
+    auto stream = forest.trees();
+    unordered_set<string> trees;
+    while (const auto tree = stream.next()) {
+        EXPECT_EQ(14, tree->size());
+        EXPECT_EQ("E", tree->label);
+        trees.insert(tree->toString());
+    }
+    EXPECT_EQ(5, trees.size());
+    EXPECT_EQ(nullptr, stream.next());
+}
+
+TEST(TestParseForest, StreamLazily) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("E -> E + E | id"));
+    const auto result = grammar.earleyParse(repeatTokens("id", "+", 30), true);
+    auto stream = result.forest->trees();
+    unordered_set<string> trees;
+    for (size_t i = 0; i < 100; ++i) {
+        const auto tree = stream.next();
+        ASSERT_NE(nullptr, tree);
+        trees.insert(tree->toString());
+    }
+    EXPECT_EQ(100, trees.size());
+}
+
+TEST(TestParseForest, EarleyForestToString) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> A B | a B\nA -> a\nB -> b"));
+    const auto result = grammar.earleyParse("a b", true);
+    const auto expected = R"(S[0,2]
+  S -> a · B[0,1] B[1,2]
+  S -> A · B[0,1] B[1,2]
+S -> a · B[0,1]
+  a[0,1]
+B[1,2]
+  b[1,2]
+S -> A · B[0,1]
+  A[0,1]
+A[0,1]
+  a[0,1]
+)";
+    EXPECT_EQ(expected, result.forest->toString());
+    EXPECT_EQ(2, result.forest->countDerivations());
+    const auto trees = result.forest->firstTrees(2);
+    ASSERT_EQ(2, trees.size());
+    EXPECT_EQ("S\n  a\n  B\n    b\n", trees[0]->toString());
+    EXPECT_EQ("S\n  A\n    a\n  B\n    b\n", trees[1]->toString());
+}
+
+TEST(TestParseForest, NullableDerivations) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> A A x\nA -> B | ε\nB -> ε"));
+    const auto result = grammar.earleyParse("x", true);
+    EXPECT_TRUE(result.accepted);
+    EXPECT_EQ(4, result.forest->countDerivations());
+    EXPECT_EQ(4, result.forest->firstTrees(10).size());
+}
+
+TEST(TestParseForest, CyclicDerivations) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> A | a\nA -> S | b"));
+    const auto result = grammar.earleyParse("a", true);
+    EXPECT_TRUE(result.accepted);
+    EXPECT_EQ(ParseForest::NONE, result.forest->countDerivations());
+    const auto trees = result.forest->firstTrees(10);
+    ASSERT_EQ(1, trees.size());
+    EXPECT_EQ("S\n  a\n", trees[0]->toString());
+    const auto best = result.forest->bestTrees(10);
+    ASSERT_EQ(1, best.size());
+    EXPECT_EQ("S\n  a\n", best[0]->toString());
+}
+
+TEST(TestParseForest, BestTrees) {
+    // S -> X Y with 3 alternatives for X and 2 alternatives for Y.
+    ParseForest forest;
+    const auto s = forest.addNode(ParseForestNode::Type::SYMBOL, "S", 0, 2);
+    const auto x = forest.addNode(ParseForestNode::Type::SYMBOL, "X", 0, 1);
+    const auto y = forest.addNode(ParseForestNode::Type::SYMBOL, "Y", 1, 2);
+    const auto a = forest.addNode(ParseForestNode::Type::TERMINAL, "a", 0, 1);
+    const auto b = forest.addNode(ParseForestNode::Type::TERMINAL, "b", 0, 1);
+    const auto c = forest.addNode(ParseForestNode::Type::TERMINAL, "c", 0, 1);
+    const auto d = forest.addNode(ParseForestNode::Type::TERMINAL, "d", 1, 2);
+    const auto e = forest.addNode(ParseForestNode::Type::TERMINAL, "e", 1, 2);
+    forest.addPackedNode(s, {x, y}, -1.0);
+    forest.addPackedNode(x, {a}, -3.0);
+    forest.addPackedNode(x, {b}, -1.0);
+    forest.addPackedNode(x, {c}, -2.0);
+    forest.addPackedNode(y, {d}, -0.5);
+    forest.addPackedNode(y, {e}, -4.0);
+    forest.setRoot(s);
+    EXPECT_EQ(6, forest.countDerivations());
+
+    auto leaves = [](const shared_ptr<ParseTreeNode>& tree) {
+        return tree->children[0]->children[0]->label + tree->children[1]->children[0]->label;
+    };
+    const auto best = forest.bestTrees(4);
+    ASSERT_EQ(4, best.size());
+    EXPECT_EQ("bd", leaves(best[0]));
+    EXPECT_EQ("cd", leaves(best[1]));
+    EXPECT_EQ("ad", leaves(best[2]));
+    EXPECT_EQ("be", leaves(best[3]));
+    EXPECT_EQ(6, forest.bestTrees(10).size());
+    EXPECT_TRUE(forest.bestTrees(0).empty());
+}
@@ -173,3 +173,28 @@ TEST(TestContextFreeGrammarTokenize, UTF8) {
     EXPECT_EQ(ContextFreeGrammarToken({ContextFreeGrammarToken::Type::ALTERNATION, "｜", 1, 4}), tokens[3]);
     EXPECT_EQ(ContextFreeGrammarToken({ContextFreeGrammarToken::Type::SYMBOL, "玩", 1, 5}), tokens[4]);
 }
+
+TEST(TestContextFreeGrammarTokenize, Views) {
+    const string s = "S → a你 ϵ\r\n  ｜ b->c";
+    const auto tokens = ContextFreeGrammar::tokenizeViews(s);
+    ASSERT_EQ(8, tokens.size());
+    EXPECT_EQ("S", tokens[0].symbol);
+    EXPECT_EQ(s.data(), tokens[0].symbol.data());
+    EXPECT_EQ(ContextFreeGrammarToken::Type::PRODUCTION, tokens[1].type);
+    EXPECT_EQ("a你", tokens[2].symbol);
+    EXPECT_EQ(s.data() + 6, tokens[2].symbol.data());
+    EXPECT_EQ(8, tokens[3].column);
+    EXPECT_EQ(ContextFreeGrammar::EMPTY_SYMBOL.data(), tokens[3].symbol.data());
+    EXPECT_EQ(ContextFreeGrammarToken::Type::ALTERNATION, tokens[4].type);
+    EXPECT_EQ(2, tokens[4].line);
+    EXPECT_EQ(3, tokens[4].column);
+    EXPECT_EQ("b", tokens[5].symbol);
+    EXPECT_EQ("->", tokens[6].symbol);
+    EXPECT_EQ(8, tokens[7].column);
+
+    const auto copies = ContextFreeGrammar::tokenize(s);
+    ASSERT_EQ(tokens.size(), copies.size());
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        EXPECT_EQ(ContextFreeGrammarToken({tokens[i].type, string(tokens[i].symbol), tokens[i].line, tokens[i].column}), copies[i]);
+    }
+}
@@ -0,0 +1,147 @@
+#include "cfg.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+TEST(TestWeightedCYK, EmptyString) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> ε [0.5] | a [0.5]"));
+    const auto result = grammar.weightedCYKParse("");
+    EXPECT_TRUE(result.accepted);
+    EXPECT_DOUBLE_EQ(log(0.5), result.logProbability);
+    EXPECT_EQ("S\n  ε\n", result.parseTree->toString());
+    EXPECT_FALSE(grammar.weightedCYKParse("a a").accepted);
+}
+
+TEST(TestWeightedCYK, Rejected) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> A B\nA -> a\nB -> b"));
+    const auto result = grammar.weightedCYKParse("b a");
+    EXPECT_FALSE(result.accepted);
+    EXPECT_EQ(nullptr, result.parseTree);
+    EXPECT_EQ(-numeric_limits<double>::infinity(), result.logProbability);
+    EXPECT_EQ(-numeric_limits<double>::infinity(), result.getViterbi(0, 1, "S"));
+}
+
+TEST(TestWeightedCYK, UnweightedGrammar) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> A B\nA -> a\nB -> b"));
+    const auto result = grammar.weightedCYKParse("a b");
+    EXPECT_TRUE(result.accepted);
+    EXPECT_EQ(0.0, result.logProbability);
+    EXPECT_EQ(0.0, result.getInside(0, 0, "A"));
+    EXPECT_EQ(grammar.cykParse("a b").parseTree->toString(), result.parseTree->toString());
+}
+
+TEST(TestWeightedCYK, PrepositionalPhraseAttachment) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse(R"(
+S -> NP VP [1.0]
+VP -> V NP [0.7] | VP PP [0.3]
+NP -> NP PP [0.4] | she [0.1] | stars [0.18] | telescopes [0.32]
+PP -> P NP [1.0]
+V -> saw [1.0]
+P -> with [1.0]
+)"));
+    const auto result = grammar.weightedCYKParse("she saw stars with telescopes");
+    EXPECT_TRUE(result.accepted);
+    // VP -> V NP with NP -> NP PP: 0.1 * 0.7 * 0.4 * 0.18 * 0.32, and VP -> VP PP: 0.1 * 0.3 * 0.7 * 0.18 * 0.32.
+    const double attachToNoun = 0.1 * 0.7 * 0.4 * 0.18 * 0.32;
+    const double attachToVerb = 0.1 * 0.3 * 0.7 * 0.18 * 0.32;
+    EXPECT_NEAR(log(attachToNoun), result.logProbability, 1e-9);
+    EXPECT_NEAR(log(attachToNoun + attachToVerb), result.insideLogProbability, 1e-9);
+    const auto expected = R"(S
+  NP
+    she
+  VP
+    V
+      saw
+    NP
+      NP
+        stars
+      PP
+        P
+          with
+        NP
+          telescopes
+)";
+    EXPECT_EQ(expected, result.parseTree->toString());
+    EXPECT_NEAR(log(0.18 * 0.32 * 0.4), result.getViterbi(2, 4, "NP"), 1e-9);
+    EXPECT_EQ(-numeric_limits<double>::infinity(), result.getInside(2, 4, "VP"));
+}
+
+TEST(TestWeightedCYK, WeightsPreservedByCNF) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> a S b [0.25] | a b [0.75]"));
+    grammar.toChomskyNormalForm();
+    EXPECT_TRUE(grammar.isChomskyNormalForm());
+    const auto expected = R"(  S' -> T_a S'_1 [0.25]
+      | T_a T_b [0.75]
+S'_1 -> S T_b
+   S -> T_a S'_1 [0.25]
+      | T_a T_b [0.75]
+ T_a -> a
+ T_b -> b
+)";
+    EXPECT_EQ(expected, grammar.toString());
+    const auto result = grammar.weightedCYKParse("a a a b b b");
+    EXPECT_TRUE(result.accepted);
+    EXPECT_NEAR(log(0.25 * 0.25 * 0.75), result.logProbability, 1e-9);
+}
+
+TEST(TestWeightedCYK, UnitProductionWeightsMultipliedByCNF) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> A [0.5]\nA -> a [0.4]"));
+    grammar.toChomskyNormalForm();
+    EXPECT_TRUE(grammar.isChomskyNormalForm());
+    EXPECT_NEAR(0.2, grammar.weightOf("S", {"a"}), 1e-9);
+    EXPECT_NEAR(log(0.2), grammar.weightedCYKParse("a").logProbability, 1e-9);
+}
+
+TEST(TestWeightedCYK, EpsilonWeightsMultipliedByCNF) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> a B [0.5]\nB -> b [0.1] | ε [0.9]"));
+    grammar.toChomskyNormalForm();
+    EXPECT_TRUE(grammar.isChomskyNormalForm());
+    EXPECT_NEAR(log(0.45), grammar.weightedCYKParse("a").logProbability, 1e-9);
+    EXPECT_NEAR(log(0.05), grammar.weightedCYKParse("a b").logProbability, 1e-9);
+}
+
+TEST(TestWeightedCYK, DuplicateWeightsSummedByCNF) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> A [0.5] | B [0.5]\nA -> a [1.0]\nB -> a [0.6] | b [0.4]"));
+    grammar.toChomskyNormalForm();
+    EXPECT_TRUE(grammar.isChomskyNormalForm());
+    const auto result = grammar.weightedCYKParse("a");
+    EXPECT_NEAR(log(0.8), result.logProbability, 1e-9);
+    EXPECT_NEAR(log(0.8), result.insideLogProbability, 1e-9);
+    EXPECT_NEAR(log(0.2), grammar.weightedCYKParse("b").logProbability, 1e-9);
+}
+
+TEST(TestWeightedCYK, ProbabilitiesPreservedByCNF) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> A B [1.0]\nA -> a [0.5] | ε [0.5]\nB -> b [0.2] | ε [0.8]\n"));
+    grammar.toChomskyNormalForm();
+    EXPECT_TRUE(grammar.isChomskyNormalForm());
+    EXPECT_NEAR(log(0.4), grammar.weightedCYKParse("").logProbability, 1e-9);
+    EXPECT_NEAR(log(0.4), grammar.weightedCYKParse("a").logProbability, 1e-9);
+    EXPECT_NEAR(log(0.1), grammar.weightedCYKParse("b").logProbability, 1e-9);
+    EXPECT_NEAR(log(0.1), grammar.weightedCYKParse("a b").logProbability, 1e-9);
+}
+
+TEST(TestWeightedCYK, RecursiveEpsilonWeightsByCNF) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> a A [1.0]\nA -> A A [0.25] | ε [0.75]"));
+    grammar.toChomskyNormalForm();
+    // The probability that A derives ε is the least solution of e = 0.25 e^2 + 0.75, which is 1.
+    EXPECT_NEAR(log(1.0), grammar.weightedCYKParse("a").logProbability, 1e-6);
+}
+
+TEST(TestWeightedCYK, ZeroWeight) {
+    ContextFreeGrammar grammar;
+    EXPECT_TRUE(grammar.parse("S -> A A [0]\nA -> a"));
+    EXPECT_FALSE(grammar.weightedCYKParse("a a").accepted);
+    EXPECT_TRUE(grammar.cykParse("a a").accepted);
+}
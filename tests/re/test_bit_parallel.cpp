@@ -0,0 +1,121 @@
+#include "re_matcher.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace std;
+
+TEST(TestGlushkovNFA, Positions) {
+    const RegularExpression regex("a(b|c)*d?");
+    const auto nfa = regex.toGlushkovNFA();
+    ASSERT_EQ(4, nfa.size());
+    EXPECT_TRUE(nfa.positionBytes[2]['c']);
+    EXPECT_EQ(1, nfa.positionBytes[2].count());
+    EXPECT_EQ(vector<uint32_t>({0}), nfa.first);
+    EXPECT_EQ(vector<uint32_t>({0, 1, 2, 3}), nfa.last);
+    EXPECT_FALSE(nfa.nullable);
+    EXPECT_EQ(vector<uint32_t>({0, 3, 6, 9, 9}), nfa.followBegin);
+    EXPECT_EQ(vector<uint32_t>({1, 2, 3, 1, 2, 3, 1, 2, 3}), nfa.followTargets);
+}
+
+TEST(TestGlushkovNFA, Reversed) {
+    const RegularExpression regex("ab*(cd)?");
+    const auto nfa = regex.toGlushkovNFA(true);
+    ASSERT_EQ(4, nfa.size());
+    EXPECT_TRUE(nfa.positionBytes[0]['d']);
+    EXPECT_TRUE(nfa.positionBytes[3]['a']);
+    EXPECT_EQ(vector<uint32_t>({0, 2, 3}), nfa.first);
+    EXPECT_EQ(vector<uint32_t>({3}), nfa.last);
+}
+
+TEST(TestGlushkovNFA, Nullable) {
+    EXPECT_TRUE(RegularExpression("a*(b|ε)").toGlushkovNFA().nullable);
+    EXPECT_FALSE(RegularExpression("a*b").toGlushkovNFA().nullable);
+    EXPECT_EQ(0, RegularExpression("a|").toGlushkovNFA().size());
+}
+
+TEST(TestBitParallelNFA, Shifts) {
+    const BitParallelNFA text(RegularExpression("abcd").toGlushkovNFA());
+    EXPECT_EQ(vector<int32_t>({1}), text.shifts);
+    EXPECT_TRUE(text.chunks.empty());
+
+    string pattern = "(a|b)*";
+    for (size_t i = 0; i < 100; ++i) {
+        pattern += "(a|b)";
+    }
+    const BitParallelNFA wide(RegularExpression(pattern).toGlushkovNFA());
+    EXPECT_EQ(4, wide.words);
+    EXPECT_EQ(vector<int32_t>({2, 1, 3, 0, -1}), wide.shifts);
+    EXPECT_TRUE(wide.chunks.empty());
+
+    // Too many distances for shifts.
+    const BitParallelNFA loop(RegularExpression("(a|b|c|d|e|f|g|h|i)*x").toGlushkovNFA());
+    EXPECT_TRUE(loop.shifts.empty());
+    EXPECT_EQ(vector<uint32_t>({0, 1}), loop.chunks);
+}
+
+TEST(TestBitParallelMatcher, Match) {
+    const BitParallelMatcher matcher("(a|b)*abb");
+    EXPECT_EQ("", matcher.errorMessage());
+    EXPECT_EQ(5, matcher.numPositions());
+    EXPECT_TRUE(matcher.match("abb"));
+    EXPECT_TRUE(matcher.match("babaabb"));
+    EXPECT_FALSE(matcher.match(""));
+    EXPECT_FALSE(matcher.match("abba"));
+    EXPECT_EQ(4, matcher.longestPrefix("babbab"));
+    EXPECT_EQ((RegexMatch{1, 4}), matcher.find("cabbbc"));
+    EXPECT_FALSE(matcher.find("abab").has_value());
+}
+
+TEST(TestBitParallelMatcher, Invalid) {
+    const BitParallelMatcher matcher("a|");
+    EXPECT_NE("", matcher.errorMessage());
+    EXPECT_FALSE(matcher.match(""));
+    EXPECT_FALSE(matcher.find("a").has_value());
+}
+
+TEST(TestBitParallelMatcher, TooManyPositions) {
+    const BitParallelMatcher matcher(string(257, 'a'));
+    EXPECT_EQ("Error: the pattern has 257 byte positions, more than 256.", matcher.errorMessage());
+    EXPECT_FALSE(matcher.match(string(257, 'a')));
+}
+
+TEST(TestBitParallelMatcher, UTF8) {
+    const BitParallelMatcher matcher("(你|我)好+");
+    const string text = "大家好，我好好学习";
+    const auto found = matcher.find(text);
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ("我好好", text.substr(found->begin, found->end - found->begin));
+}
+
+TEST(TestBitParallelMatcher, SameAsLazyDFAMatcher) {
+    mt19937 rng(42);
+    // Patterns crossing the boundaries of the words.
+    string wide = "(ab|b)*";
+    for (size_t i = 0; i < 30; ++i) {
+        wide += "(a|bb)";
+    }
+    string wider = "c*";
+    for (size_t i = 0; i < 100; ++i) {
+        wider += i % 7 == 0 ? "(ab)*" : "(a|b)";
+    }
+    string tables = "(a|b|c|d|e|f|g|h|i)*";
+    for (size_t i = 0; i < 30; ++i) {
+        tables += "(a|bc)";
+    }
+    for (const auto& pattern : {string("a"), string("ab|b"), string("(a|b)*a"), string("a(ba)*b?"),
+                                string("bb*a|a"), string("(a|ε)(b|ε)*"), wide, wider, tables}) {
+        LazyDFAMatcher expected(pattern);
+        const BitParallelMatcher matcher(pattern);
+        ASSERT_EQ("", matcher.errorMessage());
+        for (size_t t = 0; t < 200; ++t) {
+            string text;
+            const auto length = rng() % 120;
+            for (size_t i = 0; i < length; ++i) {
+                text += "abc"[rng() % (t % 10 == 0 ? 3 : 2)];
+            }
+            EXPECT_EQ(expected.match(text), matcher.match(text)) << pattern << " " << text;
+            EXPECT_EQ(expected.longestPrefix(text), matcher.longestPrefix(text)) << pattern << " " << text;
+            EXPECT_EQ(expected.find(text), matcher.find(text)) << pattern << " " << text;
+        }
+    }
+}
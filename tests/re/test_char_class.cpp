@@ -0,0 +1,88 @@
+#include "re.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace std;
+
+TEST(TestCharClass, Normalize) {
+    CharClass charClass;
+    charClass.add('x', 'z');
+    charClass.add('a', 'c');
+    charClass.add('b', 'f');
+    charClass.add('g', 'g');
+    charClass.normalize();
+    EXPECT_EQ((vector<pair<uint32_t, uint32_t>>{{'a', 'g'}, {'x', 'z'}}), charClass.intervals);
+    EXPECT_TRUE(charClass.contains('a'));
+    EXPECT_TRUE(charClass.contains('g'));
+    EXPECT_FALSE(charClass.contains('h'));
+    EXPECT_FALSE(charClass.contains('`'));
+    EXPECT_TRUE(charClass.contains('z'));
+}
+
+TEST(TestCharClass, Negated) {
+    CharClass charClass;
+    charClass.add(0, 9);
+    charClass.add('a', 'z');
+    const auto negated = charClass.negated();
+    EXPECT_EQ((vector<pair<uint32_t, uint32_t>>{{10, 'a' - 1}, {'z' + 1, CharClass::MAX_CODE_POINT}}), negated.intervals);
+    EXPECT_TRUE(negated.negated().intervals == charClass.intervals);
+    EXPECT_EQ((vector<pair<uint32_t, uint32_t>>{{0, CharClass::MAX_CODE_POINT}}), CharClass().negated().intervals);
+}
+
+TEST(TestCharClass, UTF8) {
+    EXPECT_EQ("a", CharClass::toUTF8('a'));
+    EXPECT_EQ("é", CharClass::toUTF8(0xE9));
+    EXPECT_EQ("你", CharClass::toUTF8(0x4F60));
+    EXPECT_EQ("😀", CharClass::toUTF8(0x1F600));
+    EXPECT_EQ(0x1F600, CharClass::fromUTF8("😀"));
+    EXPECT_EQ(0x4F60, CharClass::fromUTF8("你"));
+    EXPECT_FALSE(CharClass::fromUTF8("ab").has_value());
+    EXPECT_FALSE(CharClass::fromUTF8("").has_value());
+}
+
+TEST(TestCharClass, UTF8Sequences) {
+    CharClass ascii;
+    ascii.add('a', 'z');
+    EXPECT_EQ((vector<vector<pair<uint8_t, uint8_t>>>{{{'a', 'z'}}}), ascii.utf8Sequences());
+    CharClass twoBytes;
+    twoBytes.add(0x80, 0x7FF);
+    EXPECT_EQ((vector<vector<pair<uint8_t, uint8_t>>>{{{0xC2, 0xDF}, {0x80, 0xBF}}}), twoBytes.utf8Sequences());
+    EXPECT_EQ(9, CharClass().negated().utf8Sequences().size());
+}
+
+/**
+ * The sequences should match exactly the encodings of the code points in the class.
+ */
+TEST(TestCharClass, UTF8SequencesRandom) {
+    mt19937 rng(42);
+    for (size_t t = 0; t < 50; ++t) {
+        CharClass charClass;
+        for (size_t k = 0; k < 3; ++k) {
+            const uint32_t lo = rng() % (t % 2 ? 0x800 : CharClass::MAX_CODE_POINT);
+            charClass.add(lo, min<uint32_t>(lo + rng() % 0x20000, CharClass::MAX_CODE_POINT));
+        }
+        charClass.normalize();
+        const auto sequences = charClass.utf8Sequences();
+        for (size_t k = 0; k < 1000; ++k) {
+            uint32_t codePoint = rng() % (CharClass::MAX_CODE_POINT + 1);
+            if (k % 2) {
+                const auto& [lo, hi] = charClass.intervals[rng() % charClass.intervals.size()];
+                codePoint = lo + rng() % (hi - lo + 1);
+            }
+            if (codePoint >= 0xD800 && codePoint <= 0xDFFF) {
+                continue;
+            }
+            const auto bytes = CharClass::toUTF8(codePoint);
+            size_t numMatches = 0;
+            for (const auto& sequence : sequences) {
+                bool matched = sequence.size() == bytes.size();
+                for (size_t i = 0; matched && i < bytes.size(); ++i) {
+                    const auto byte = static_cast<uint8_t>(bytes[i]);
+                    matched = sequence[i].first <= byte && byte <= sequence[i].second;
+                }
+                numMatches += matched;
+            }
+            EXPECT_EQ(charClass.contains(codePoint) ? 1 : 0, numMatches) << codePoint;
+        }
+    }
+}
@@ -0,0 +1,194 @@
+#include "re_matcher.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace std;
+
+TEST(TestByteNFA, MultiByteGraphemes) {
+    const RegularExpression re("你|a");
+    const auto nfa = re.toByteNFA();
+    EXPECT_EQ(256, nfa.byteClasses.size());
+    EXPECT_EQ(8, nfa.size());
+    EXPECT_EQ(4, nfa.numEdges());
+    EXPECT_EQ(nfa.byteClasses['b'], nfa.byteClasses['c']);
+    EXPECT_NE(nfa.byteClasses['a'], nfa.byteClasses['b']);
+    EXPECT_EQ("a", nfa.symbols[nfa.symbolId("a")]);
+    EXPECT_EQ("\\xe4", nfa.symbols[nfa.byteClasses[0xe4]]);
+    EXPECT_EQ(FlatNFA::NONE, nfa.symbolId("ab"));
+}
+
+TEST(TestByteNFA, Reversed) {
+    const RegularExpression re("ab");
+    const auto nfa = re.toByteNFA();
+    const auto reversed = nfa.reversed();
+    EXPECT_EQ(nfa.start, reversed.accept);
+    EXPECT_EQ(nfa.accept, reversed.start);
+    const auto dfa = RegularExpression::toFlatDFA(reversed);
+    auto state = dfa.next(dfa.start, nfa.symbolId("b"));
+    ASSERT_NE(FlatDFA::DEAD, state);
+    state = dfa.next(state, nfa.symbolId("a"));
+    ASSERT_NE(FlatDFA::DEAD, state);
+    EXPECT_TRUE(dfa.accepting[state]);
+}
+
+TEST(TestDFAMatcher, Match) {
+    const DFAMatcher matcher("(a|b)*abb");
+    EXPECT_TRUE(matcher.match("abb"));
+    EXPECT_TRUE(matcher.match("babaabb"));
+    EXPECT_FALSE(matcher.match(""));
+    EXPECT_FALSE(matcher.match("abba"));
+    EXPECT_FALSE(matcher.match("abc"));
+    EXPECT_EQ(3, matcher.numClasses());
+    EXPECT_EQ(2, DFAMatcher("(a|b|c)*").numClasses());
+    EXPECT_EQ(2, DFAMatcher("(a|b|c)*").numStates());
+}
+
+TEST(TestDFAMatcher, Epsilon) {
+    const DFAMatcher matcher("ε");
+    EXPECT_TRUE(matcher.match(""));
+    EXPECT_FALSE(matcher.match("a"));
+    EXPECT_EQ(0, matcher.longestPrefix("abc"));
+    EXPECT_EQ((RegexMatch{0, 0}), matcher.find("abc"));
+}
+
+TEST(TestDFAMatcher, Invalid) {
+    const DFAMatcher matcher("(a");
+    EXPECT_FALSE(matcher.match(""));
+    EXPECT_FALSE(matcher.match("a"));
+    EXPECT_EQ(string_view::npos, matcher.longestPrefix("a"));
+    EXPECT_FALSE(matcher.find("a").has_value());
+    EXPECT_FALSE(DFAMatcher().match(""));
+}
+
+TEST(TestDFAMatcher, DeepNesting) {
+    string pattern;
+    for (int i = 0; i < 30000; ++i) {
+        pattern += "(a|";
+    }
+    pattern += "a" + string(30000, ')');
+    const DFAMatcher matcher(pattern);
+    EXPECT_FALSE(matcher.match("a"));
+}
+
+TEST(TestDFAMatcher, LongestPrefix) {
+    const DFAMatcher matcher("a(bc)*");
+    EXPECT_EQ(5, matcher.longestPrefix("abcbcb"));
+    EXPECT_EQ(1, matcher.longestPrefix("ab"));
+    EXPECT_EQ(string_view::npos, matcher.longestPrefix("bc"));
+    EXPECT_EQ(string_view::npos, matcher.longestPrefix(""));
+}
+
+TEST(TestDFAMatcher, Find) {
+    const DFAMatcher matcher("abcd|c");
+    EXPECT_EQ((RegexMatch{0, 4}), matcher.find("abcd"));
+    EXPECT_EQ((RegexMatch{2, 3}), matcher.find("abce"));
+    EXPECT_FALSE(matcher.find("abe").has_value());
+    EXPECT_EQ((RegexMatch{3, 7}), DFAMatcher("a+b").find("xyzaaab ab"));
+    EXPECT_EQ((RegexMatch{0, 0}), DFAMatcher("a*").find("bbb"));
+}
+
+TEST(TestDFAMatcher, UTF8) {
+    const DFAMatcher matcher("(你|我)好+");
+    EXPECT_TRUE(matcher.match("你好好"));
+    EXPECT_FALSE(matcher.match("他好"));
+    const string text = "大家好，我好好学习";
+    const auto found = matcher.find(text);
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ("我好好", text.substr(found->begin, found->end - found->begin));
+}
+
+TEST(TestDFAMatcher, LargeTable) {
+    string pattern = "(a|b)*a";
+    for (size_t i = 0; i < 14; ++i) {
+        pattern += "(a|b)";
+    }
+    const DFAMatcher matcher(pattern);
+    EXPECT_GT(matcher.numStates() * matcher.numClasses(), 65536);
+    const string text = string(9, 'b') + "a" + string(14, 'b');
+    EXPECT_TRUE(matcher.match(text));
+    EXPECT_TRUE(matcher.match(text.substr(9)));
+    EXPECT_FALSE(matcher.match(text.substr(10)));
+    EXPECT_FALSE(matcher.match(text + "b"));
+    EXPECT_EQ((RegexMatch{0, 24}), matcher.find(text + "b"));
+    EXPECT_FALSE(matcher.find(text.substr(10)).has_value());
+}
+
+/**
+ * Compare find() with trying all the spans in the order of leftmost-longest.
+ */
+TEST(TestDFAMatcher, FindRandom) {
+    mt19937 rng(42);
+    const string alphabet = "ab";
+    for (const auto& pattern : {"a", "ab|b", "(a|b)*a", "a(ba)*b?", "bb*a|a"}) {
+        const DFAMatcher matcher(pattern);
+        for (size_t t = 0; t < 100; ++t) {
+            string text;
+            const auto length = rng() % 10;
+            for (size_t i = 0; i < length; ++i) {
+                text += alphabet[rng() % alphabet.size()];
+            }
+            optional<RegexMatch> expected;
+            for (size_t begin = 0; begin <= text.size() && !expected; ++begin) {
+                for (size_t end = text.size() + 1; end-- > begin;) {
+                    if (matcher.match(string_view(text).substr(begin, end - begin))) {
+                        expected = RegexMatch{begin, end};
+                        break;
+                    }
+                }
+            }
+            EXPECT_EQ(expected, matcher.find(text)) << pattern << " " << text;
+        }
+    }
+}
+
+TEST(TestDFAMatcher, Classes) {
+    const DFAMatcher identifier("[A-Za-z_]\\w*");
+    EXPECT_TRUE(identifier.match("_foo42"));
+    EXPECT_FALSE(identifier.match("42foo"));
+    EXPECT_EQ((RegexMatch{3, 8}), identifier.find("42 foo_1+2"));
+    EXPECT_EQ(3, identifier.numClasses());
+
+    const DFAMatcher negated("[^a-c]+");
+    EXPECT_TRUE(negated.match("xyz你好"));
+    EXPECT_FALSE(negated.match("xbz"));
+    EXPECT_FALSE(negated.match("\xed\xa0\x80"));
+
+    const DFAMatcher dot("a.c");
+    EXPECT_TRUE(dot.match("abc"));
+    EXPECT_TRUE(dot.match("a你c"));
+    EXPECT_TRUE(dot.match("a😀c"));
+    EXPECT_FALSE(dot.match("a\nc"));
+    EXPECT_FALSE(dot.match("a\xff" "c"));
+    EXPECT_FALSE(dot.match("abbc"));
+
+    const DFAMatcher unicode("[α-ω]+");
+    EXPECT_TRUE(unicode.match("λ"));
+    EXPECT_EQ((RegexMatch{1, 7}), unicode.find("aαβγb"));
+}
+
+TEST(TestDFAMatcher, Repetition) {
+    const DFAMatcher matcher("\\d{3}-\\d{2,4}(x{2,})?");
+    EXPECT_TRUE(matcher.match("123-45"));
+    EXPECT_TRUE(matcher.match("123-4567"));
+    EXPECT_TRUE(matcher.match("123-4567xxx"));
+    EXPECT_FALSE(matcher.match("123-4"));
+    EXPECT_FALSE(matcher.match("123-45678"));
+    EXPECT_FALSE(matcher.match("123-4567x"));
+    EXPECT_FALSE(matcher.match("12-45"));
+}
+
+/**
+ * A class is a single edge, so the NFA does not grow with the size of the class.
+ */
+TEST(TestDFAMatcher, ClassSize) {
+    string alternatives = "(";
+    for (char ch = 'a'; ch <= 'z'; ++ch) {
+        alternatives += ch;
+        alternatives += ch == 'z' ? ")" : "|";
+    }
+    const auto expanded = RegularExpression(alternatives + "+").toByteNFA();
+    const auto compact = RegularExpression("[a-z]+").toByteNFA();
+    EXPECT_EQ(2, compact.numEdges());
+    EXPECT_GT(expanded.size(), 10 * compact.size());
+    EXPECT_EQ("[a-z]", RegularExpression("[a-z]").toFlatNFA().symbols[0]);
+}
@@ -0,0 +1,133 @@
+#include "re.h"
+#include <gtest/gtest.h>
+
+using namespace std;
+
+static FlatDFA byteDFA(const string& pattern) {
+    return RegularExpression::toFlatDFA(RegularExpression(pattern).toGlushkovNFA());
+}
+
+static bool acceptsBytes(const FlatDFA& dfa, const string& text) {
+    auto state = dfa.start;
+    for (const char ch : text) {
+        if (state == FlatDFA::DEAD) {
+            return false;
+        }
+        state = dfa.next(state, dfa.byteClasses[static_cast<uint8_t>(ch)]);
+    }
+    return state != FlatDFA::DEAD && dfa.accepting[state];
+}
+
+TEST(TestDFAOps, Intersection) {
+    const auto dfa = RegularExpression::intersectFlatDFA(byteDFA("(a|b)*abb"), byteDFA("a*b*"));
+    EXPECT_TRUE(acceptsBytes(dfa, "abb"));
+    EXPECT_TRUE(acceptsBytes(dfa, "aaabb"));
+    EXPECT_FALSE(acceptsBytes(dfa, "babb"));
+    EXPECT_FALSE(acceptsBytes(dfa, "abbb"));
+    EXPECT_EQ(256, dfa.byteClasses.size());
+
+    const auto empty = RegularExpression::toMinFlatDFA(RegularExpression::intersectFlatDFA(byteDFA("a+"), byteDFA("b+")));
+    EXPECT_EQ(1, empty.size());
+    EXPECT_FALSE(empty.accepting[0]);
+}
+
+TEST(TestDFAOps, UnionAndDifference) {
+    const auto a = byteDFA("[a-m]+"), b = byteDFA("[h-z]+");
+    const auto unionDFA = RegularExpression::unionFlatDFA(a, b);
+    const auto difference = RegularExpression::differenceFlatDFA(a, b);
+    EXPECT_EQ(4, unionDFA.numSymbols());
+    for (const auto& [text, inUnion, inDifference] : vector<tuple<string, bool, bool>>{
+             {"abc", true, true}, {"xyz", true, false}, {"hij", true, false}, {"az", false, false}, {"", false, false}}) {
+        EXPECT_EQ(inUnion, acceptsBytes(unionDFA, text)) << text;
+        EXPECT_EQ(inDifference, acceptsBytes(difference, text)) << text;
+    }
+}
+
+TEST(TestDFAOps, Complement) {
+    const auto dfa = RegularExpression::complementFlatDFA(byteDFA("ab*"));
+    EXPECT_TRUE(acceptsBytes(dfa, ""));
+    EXPECT_FALSE(acceptsBytes(dfa, "a"));
+    EXPECT_FALSE(acceptsBytes(dfa, "abbb"));
+    EXPECT_TRUE(acceptsBytes(dfa, "ba"));
+    EXPECT_TRUE(acceptsBytes(dfa, "abba"));
+    EXPECT_TRUE(acceptsBytes(dfa, "\xff"));
+
+    const auto all = RegularExpression::complementFlatDFA(FlatDFA());
+    EXPECT_EQ(1, all.size());
+    EXPECT_TRUE(all.accepting[0]);
+}
+
+TEST(TestDFAOps, Equivalence) {
+    string counterexample = "x";
+    EXPECT_TRUE(RegularExpression::isEquivalentFlatDFA(byteDFA("(a|b)*"), byteDFA("(a*b*)*"), &counterexample));
+    EXPECT_EQ("x", counterexample);
+    EXPECT_TRUE(RegularExpression::isEquivalentFlatDFA(byteDFA("[0-9]{2}"), byteDFA("\\d\\d")));
+    EXPECT_FALSE(RegularExpression::isEquivalentFlatDFA(byteDFA("a*"), byteDFA("a+"), &counterexample));
+    EXPECT_EQ("", counterexample);
+    EXPECT_FALSE(RegularExpression::isEquivalentFlatDFA(byteDFA("(a|b)*abb"), byteDFA("(a|b)*bb"), &counterexample));
+    EXPECT_EQ("bb", counterexample);
+    EXPECT_FALSE(RegularExpression::isEquivalentFlatDFA(byteDFA("你|好"), byteDFA("[你-好]"), &counterexample));
+    EXPECT_NE(acceptsBytes(byteDFA("你|好"), counterexample), acceptsBytes(byteDFA("[你-好]"), counterexample));
+}
+
+TEST(TestDFAOps, Inclusion) {
+    string counterexample;
+    EXPECT_TRUE(RegularExpression::isSubsetFlatDFA(byteDFA("ab+"), byteDFA("a*b*"), &counterexample));
+    EXPECT_FALSE(RegularExpression::isSubsetFlatDFA(byteDFA("a*b*"), byteDFA("ab+"), &counterexample));
+    EXPECT_EQ("", counterexample);
+    EXPECT_FALSE(RegularExpression::isSubsetFlatDFA(byteDFA("a(b|c)+"), byteDFA("ab+"), &counterexample));
+    EXPECT_EQ("ac", counterexample);
+    const auto empty = RegularExpression::intersectFlatDFA(byteDFA("a+"), byteDFA("b+"));
+    EXPECT_TRUE(RegularExpression::isSubsetFlatDFA(empty, byteDFA("c")));
+    EXPECT_FALSE(RegularExpression::isSubsetFlatDFA(byteDFA("c"), empty, &counterexample));
+    EXPECT_EQ("c", counterexample);
+}
+
+TEST(TestDFAOps, SameSymbols) {
+    const RegularExpression re("(a|b)*abb");
+    const auto nfa = re.toFlatNFA();
+    const auto dfa = RegularExpression::toFlatDFA(nfa);
+    const auto minDFA = RegularExpression::toMinFlatDFA(dfa);
+    EXPECT_TRUE(RegularExpression::isEquivalentFlatDFA(dfa, minDFA));
+    EXPECT_THROW((void)RegularExpression::isEquivalentFlatDFA(dfa, byteDFA("(a|b)*abb")), runtime_error);
+}
+
+/**
+ * Compare the operations with the matches of the operands on all the texts up to a length.
+ */
+TEST(TestDFAOps, SameAsBruteForce) {
+    const vector<string> patterns = {"a*", "(ab)*", "a(a|b)*", "(a|b)*b", "b?a?b?", "(a|b)*a(a|b)", "ε", "[ab]{2,3}", "(aa|b)*"};
+    vector<string> texts = {""};
+    for (size_t i = 0; i < texts.size() && texts[i].size() < 6; ++i) {
+        texts.push_back(texts[i] + "a");
+        texts.push_back(texts[i] + "b");
+    }
+    for (const auto& patternA : patterns) {
+        for (const auto& patternB : patterns) {
+            const auto a = byteDFA(patternA), b = byteDFA(patternB);
+            const auto intersection = RegularExpression::intersectFlatDFA(a, b);
+            const auto unionDFA = RegularExpression::unionFlatDFA(a, b);
+            const auto difference = RegularExpression::differenceFlatDFA(a, b);
+            const auto complement = RegularExpression::complementFlatDFA(a);
+            bool equivalent = true, subset = true;
+            for (const auto& text : texts) {
+                const bool inA = acceptsBytes(a, text), inB = acceptsBytes(b, text);
+                EXPECT_EQ(inA && inB, acceptsBytes(intersection, text)) << patternA << " " << patternB << " " << text;
+                EXPECT_EQ(inA || inB, acceptsBytes(unionDFA, text)) << patternA << " " << patternB << " " << text;
+                EXPECT_EQ(inA && !inB, acceptsBytes(difference, text)) << patternA << " " << patternB << " " << text;
+                EXPECT_EQ(!inA, acceptsBytes(complement, text)) << patternA << " " << text;
+                equivalent = equivalent && inA == inB;
+                subset = subset && (!inA || inB);
+            }
+            string counterexample;
+            EXPECT_EQ(equivalent, RegularExpression::isEquivalentFlatDFA(a, b, &counterexample)) << patternA << " " << patternB;
+            if (!equivalent) {
+                EXPECT_NE(acceptsBytes(a, counterexample), acceptsBytes(b, counterexample)) << patternA << " " << patternB;
+            }
+            EXPECT_EQ(subset, RegularExpression::isSubsetFlatDFA(a, b, &counterexample)) << patternA << " " << patternB;
+            if (!subset) {
+                EXPECT_TRUE(acceptsBytes(a, counterexample) && !acceptsBytes(b, counterexample)) << patternA << " " << patternB;
+            }
+        }
+    }
+}
@@ -0,0 +1,138 @@
+#include "re.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace std;
+
+static bool accepts(const FlatDFA& dfa, const FlatNFA& nfa, const vector<string>& input) {
+    auto state = dfa.start;
+    for (const auto& symbol : input) {
+        const auto id = nfa.symbolId(symbol);
+        if (id == FlatNFA::NONE) {
+            return false;
+        }
+        state = dfa.next(state, id);
+        if (state == FlatDFA::DEAD) {
+            return false;
+        }
+    }
+    return dfa.accepting[state];
+}
+
+TEST(TestFlatDFA, Empty) {
+    const auto dfa = RegularExpression::toFlatDFA(FlatNFA());
+    EXPECT_EQ(0, dfa.size());
+    EXPECT_EQ(FlatDFA::DEAD, dfa.start);
+
+    const RegularExpression re("ε");
+    const auto epsilon = RegularExpression::toFlatDFA(re.toFlatNFA());
+    EXPECT_EQ(1, epsilon.size());
+    EXPECT_EQ(0, epsilon.numSymbols());
+    EXPECT_TRUE(epsilon.accepting[epsilon.start]);
+}
+
+TEST(TestFlatDFA, Accepts) {
+    const RegularExpression re("(a|b)*abb");
+    const auto nfa = re.toFlatNFA();
+    const auto dfa = RegularExpression::toFlatDFA(nfa);
+    EXPECT_EQ(5, dfa.size());
+    EXPECT_TRUE(accepts(dfa, nfa, {"a", "b", "b"}));
+    EXPECT_TRUE(accepts(dfa, nfa, {"b", "a", "b", "a", "b", "b"}));
+    EXPECT_FALSE(accepts(dfa, nfa, {"a", "b"}));
+    EXPECT_FALSE(accepts(dfa, nfa, {"a", "b", "b", "a"}));
+    EXPECT_FALSE(accepts(dfa, nfa, {"c"}));
+}
+
+TEST(TestFlatDFA, SameAsDFA) {
+    for (const auto& pattern : {"a", "(a|b)*abb", "(a|a)*", "a+b?c", "((a|bc)*|d)+e", "(a|b)*a(a|b)(a|b)", "你好(世界|ε)*"}) {
+        const RegularExpression re(pattern);
+        const auto graph = RegularExpression::toDFAGraph(RegularExpression::toDFA(re.toNFA()));
+        const auto dfa = RegularExpression::toFlatDFA(re.toFlatNFA());
+        ASSERT_EQ(graph.size(), dfa.size()) << pattern;
+        EXPECT_EQ(0, dfa.start);
+        size_t numEdges = 0;
+        for (uint32_t i = 0; i < dfa.size(); ++i) {
+            EXPECT_EQ(graph.states[i]->type == "accept", dfa.accepting[i]) << pattern;
+            for (uint32_t symbol = 0; symbol < dfa.numSymbols(); ++symbol) {
+                const auto next = dfa.next(i, symbol);
+                const auto it = graph.states[i]->trans.find(dfa.symbols[symbol]);
+                if (next == FlatDFA::DEAD) {
+                    EXPECT_EQ(graph.states[i]->trans.end(), it) << pattern;
+                } else {
+                    ++numEdges;
+                    ASSERT_NE(graph.states[i]->trans.end(), it) << pattern;
+                    EXPECT_EQ(graph.states[next], it->second) << pattern;
+                }
+            }
+        }
+        EXPECT_EQ(graph.numEdges(), numEdges) << pattern;
+    }
+}
+
+TEST(TestFlatDFA, ManyAlternatives) {
+    string pattern;
+    for (size_t i = 0; i < 300; ++i) {
+        if (!pattern.empty()) {
+            pattern += "|";
+        }
+        pattern += "k" + to_string(i) + "x";
+    }
+    const RegularExpression re(pattern);
+    const auto nfa = re.toFlatNFA();
+    const auto dfa = RegularExpression::toFlatDFA(nfa);
+    EXPECT_TRUE(accepts(dfa, nfa, {"k", "2", "9", "9", "x"}));
+    EXPECT_TRUE(accepts(dfa, nfa, {"k", "0", "x"}));
+    EXPECT_FALSE(accepts(dfa, nfa, {"k", "3", "0", "0", "x"}));
+    EXPECT_FALSE(accepts(dfa, nfa, {"k", "1", "2"}));
+}
+
+static bool acceptsBytes(const FlatDFA& dfa, const string& text) {
+    auto state = dfa.start;
+    for (const char ch : text) {
+        state = dfa.next(state, dfa.byteClasses[static_cast<uint8_t>(ch)]);
+        if (state == FlatDFA::DEAD) {
+            return false;
+        }
+    }
+    return dfa.accepting[state];
+}
+
+TEST(TestFlatDFA, FollowPos) {
+    const auto dfa = RegularExpression::toFlatDFA(RegularExpression("(a|b)*abb").toGlushkovNFA());
+    EXPECT_EQ(4, dfa.size());
+    EXPECT_EQ(3, dfa.numSymbols());
+    EXPECT_EQ(256, dfa.byteClasses.size());
+    EXPECT_EQ("a", dfa.symbols[dfa.byteClasses['a']]);
+    EXPECT_EQ(dfa.byteClasses['c'], dfa.byteClasses[0xff]);
+    EXPECT_TRUE(acceptsBytes(dfa, "babb"));
+    EXPECT_FALSE(acceptsBytes(dfa, "abba"));
+
+    const auto epsilon = RegularExpression::toFlatDFA(RegularExpression("ε").toGlushkovNFA());
+    EXPECT_EQ(1, epsilon.size());
+    EXPECT_EQ(1, epsilon.numSymbols());
+    EXPECT_TRUE(epsilon.accepting[epsilon.start]);
+    EXPECT_FALSE(acceptsBytes(epsilon, "a"));
+}
+
+TEST(TestFlatDFA, FollowPosSameAsSubset) {
+    mt19937 rng(42);
+    const string alphabet = "abc你";
+    for (const auto& pattern : {"a", "(a|b)*abb", "(a|a)*", "a+b?c", "((a|bc)*|d)+e", "(a|b)*a(a|b)(a|b)", "你(好|ε)*", "ε|a*", "[a-b]c.|[^ab]{2}", "\\w+[你-好]?"}) {
+        const RegularExpression re(pattern);
+        const auto nfa = re.toByteNFA();
+        for (const bool unanchored : {false, true}) {
+            const auto subset = RegularExpression::toFlatDFA(unanchored ? nfa.reversed().unanchored() : nfa);
+            const auto direct = RegularExpression::toFlatDFA(re.toGlushkovNFA(unanchored), unanchored);
+            EXPECT_LE(direct.size(), subset.size()) << pattern;
+            EXPECT_EQ(RegularExpression::toMinFlatDFA(subset).size(), RegularExpression::toMinFlatDFA(direct).size()) << pattern;
+            for (size_t t = 0; t < 100; ++t) {
+                string text;
+                const auto length = rng() % 8;
+                for (size_t i = 0; i < length; ++i) {
+                    text += alphabet[rng() % alphabet.size()];
+                }
+                EXPECT_EQ(acceptsBytes(subset, text), acceptsBytes(direct, text)) << pattern << " " << text;
+            }
+        }
+    }
+}
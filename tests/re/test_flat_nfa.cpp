@@ -0,0 +1,115 @@
+#include "re.h"
+#include <gtest/gtest.h>
+#include <set>
+
+using namespace std;
+
+/**
+ * Collect the edges of both representations as (from id, label, to id) to compare them.
+ */
+static multiset<tuple<size_t, string, size_t>> collectEdges(const FlatNFA& nfa) {
+    multiset<tuple<size_t, string, size_t>> edges;
+    for (size_t i = 0; i < nfa.size(); ++i) {
+        for (auto j = nfa.edgeBegin[i]; j < nfa.edgeBegin[i + 1]; ++j) {
+            edges.emplace(i, nfa.symbols[nfa.edgeSymbols[j]], nfa.edgeTargets[j]);
+        }
+        for (auto j = nfa.epsilonBegin[i]; j < nfa.epsilonBegin[i + 1]; ++j) {
+            edges.emplace(i, RegularExpression::EPSILON, nfa.epsilonTargets[j]);
+        }
+    }
+    return edges;
+}
+
+static multiset<tuple<size_t, string, size_t>> collectEdges(const NFAGraph& graph) {
+    multiset<tuple<size_t, string, size_t>> edges;
+    for (const auto& [u, v, label] : graph.edges) {
+        edges.emplace(graph.states[u]->id, label, graph.states[v]->id);
+    }
+    return edges;
+}
+
+TEST(TestFlatNFA, Empty) {
+    const RegularExpression re("ε");
+    const auto nfa = re.toFlatNFA();
+    EXPECT_EQ(2, nfa.size());
+    EXPECT_EQ(0, nfa.numSymbols());
+    EXPECT_EQ(0, nfa.numEdges());
+    EXPECT_EQ(1, nfa.numEpsilonEdges());
+    EXPECT_EQ(0, nfa.start);
+    EXPECT_EQ(1, nfa.accept);
+    EXPECT_EQ(1, nfa.epsilonTargets[0]);
+}
+
+TEST(TestFlatNFA, Invalid) {
+    const RegularExpression re("(a");
+    const auto nfa = re.toFlatNFA();
+    EXPECT_EQ(0, nfa.size());
+    EXPECT_EQ(FlatNFA::NONE, nfa.start);
+    EXPECT_EQ(0, FlatNFA::fromNFA(nullptr).size());
+}
+
+TEST(TestFlatNFA, SymbolTable) {
+    const RegularExpression re("c(b|a)*ab");
+    const auto nfa = re.toFlatNFA();
+    EXPECT_EQ((vector<string>{"a", "b", "c"}), nfa.symbols);
+    EXPECT_EQ(0, nfa.symbolId("a"));
+    EXPECT_EQ(2, nfa.symbolId("c"));
+    EXPECT_EQ(FlatNFA::NONE, nfa.symbolId("d"));
+    EXPECT_EQ(FlatNFA::NONE, nfa.symbolId(RegularExpression::EPSILON));
+    EXPECT_EQ(nfa.edgeSymbols[nfa.edgeBegin[nfa.start]], nfa.symbolId("c"));
+}
+
+TEST(TestFlatNFA, SameAsNFA) {
+    for (const auto& pattern : {"a", "ab", "a|b", "a*", "(a|b)*abb", "a+b?c", "((a|bc)*|d)+e", "你好(世界|ε)*"}) {
+        const RegularExpression re(pattern);
+        const auto nfa = re.toNFA();
+        const auto flat = re.toFlatNFA();
+        const auto graph = RegularExpression::toNFAGraph(nfa);
+        ASSERT_EQ(graph.size(), flat.size()) << pattern;
+        EXPECT_EQ(graph.numEdges(), flat.numEdges() + flat.numEpsilonEdges()) << pattern;
+        EXPECT_EQ(collectEdges(graph), collectEdges(flat)) << pattern;
+        EXPECT_EQ(nfa->id, flat.start) << pattern;
+        for (const auto& state : graph.states) {
+            if (state->type == "accept") {
+                EXPECT_EQ(state->id, flat.accept) << pattern;
+            }
+        }
+
+        vector<shared_ptr<NFAState>> states;
+        const auto converted = FlatNFA::fromNFA(nfa, &states);
+        EXPECT_EQ(flat.symbols, converted.symbols) << pattern;
+        EXPECT_EQ(flat.edgeBegin, converted.edgeBegin) << pattern;
+        EXPECT_EQ(flat.edgeSymbols, converted.edgeSymbols) << pattern;
+        EXPECT_EQ(flat.edgeTargets, converted.edgeTargets) << pattern;
+        EXPECT_EQ(flat.epsilonBegin, converted.epsilonBegin) << pattern;
+        EXPECT_EQ(flat.epsilonTargets, converted.epsilonTargets) << pattern;
+        EXPECT_EQ(flat.accept, converted.accept) << pattern;
+        ASSERT_EQ(flat.size(), states.size()) << pattern;
+        for (size_t i = 0; i < states.size(); ++i) {
+            EXPECT_EQ(i, states[i]->id) << pattern;
+        }
+    }
+}
+
+TEST(TestFlatNFA, FromNFAWithoutIds) {
+    const auto start = make_shared<NFAState>();
+    const auto middle = make_shared<NFAState>();
+    const auto accept = make_shared<NFAState>();
+    start->type = "start";
+    accept->type = "accept";
+    start->id = middle->id = accept->id = 7;
+    start->edges.emplace_back("x", middle);
+    middle->edges.emplace_back(RegularExpression::EPSILON, accept);
+    middle->edges.emplace_back("y", start);
+
+    vector<shared_ptr<NFAState>> states;
+    const auto nfa = FlatNFA::fromNFA(start, &states);
+    ASSERT_EQ(3, nfa.size());
+    EXPECT_EQ(0, nfa.start);
+    EXPECT_EQ(2, nfa.accept);
+    EXPECT_EQ(middle, states[1]);
+    EXPECT_EQ((vector<uint32_t>{0, 1, 2, 2}), nfa.edgeBegin);
+    EXPECT_EQ((vector<uint32_t>{1, 0}), nfa.edgeTargets);
+    EXPECT_EQ((vector<uint32_t>{0, 0, 1, 1}), nfa.epsilonBegin);
+    EXPECT_EQ((vector<uint32_t>{2}), nfa.epsilonTargets);
+}
@@ -0,0 +1,88 @@
+#include "re_matcher.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace std;
+
+static string randomText(const size_t n, const string& alphabet, const unsigned seed) {
+    mt19937 rng(seed);
+    string text;
+    for (size_t i = 0; i < n; ++i) {
+        text += alphabet[rng() % alphabet.size()];
+    }
+    return text;
+}
+
+TEST(TestLazyDFA, Match) {
+    LazyDFAMatcher matcher("(a|b)*abb");
+    EXPECT_TRUE(matcher.match("abb"));
+    EXPECT_TRUE(matcher.match("babaabb"));
+    EXPECT_FALSE(matcher.match(""));
+    EXPECT_FALSE(matcher.match("abba"));
+    EXPECT_EQ(4, matcher.longestPrefix("babbab"));
+    EXPECT_EQ((RegexMatch{1, 4}), matcher.find("cabbbc"));
+    EXPECT_FALSE(matcher.find("abab").has_value());
+    EXPECT_GT(matcher.numCachedStates(), 0);
+    EXPECT_EQ(0, matcher.numFlushes());
+}
+
+TEST(TestLazyDFA, Invalid) {
+    LazyDFAMatcher matcher("a|");
+    EXPECT_FALSE(matcher.match(""));
+    EXPECT_EQ(string_view::npos, matcher.longestPrefix("a"));
+    EXPECT_FALSE(matcher.find("a").has_value());
+}
+
+TEST(TestLazyDFA, SameAsDFAMatcher) {
+    for (const auto& pattern : {"a", "ab|b", "(a|b)*a", "a(ba)*b?", "bb*a|a", "(a|b)*a(a|b)(a|b)(a|b)"}) {
+        const DFAMatcher expected(pattern);
+        // A tiny cache to force flushes and fallbacks.
+        LazyDFAMatcher matcher(pattern, 3);
+        for (unsigned seed = 0; seed < 50; ++seed) {
+            const auto text = randomText(seed % 20, "abc", seed);
+            EXPECT_EQ(expected.match(text), matcher.match(text)) << pattern << " " << text;
+            EXPECT_EQ(expected.longestPrefix(text), matcher.longestPrefix(text)) << pattern << " " << text;
+            EXPECT_EQ(expected.find(text), matcher.find(text)) << pattern << " " << text;
+        }
+    }
+}
+
+TEST(TestLazyDFA, ExponentialPattern) {
+    // The full DFA has 2^25 states.
+    constexpr size_t n = 25;
+    string pattern = "(a|b)*a";
+    for (size_t i = 1; i < n; ++i) {
+        pattern += "(a|b)";
+    }
+    LazyDFAMatcher matcher(pattern, 256);
+    const auto text = randomText(100000, "ab", 7);
+    EXPECT_EQ(text[text.size() - n] == 'a', matcher.match(text));
+    EXPECT_LE(matcher.numCachedStates(), 512);
+    EXPECT_GT(matcher.numFlushes() + matcher.numFallbacks(), 0);
+
+    const auto found = matcher.find(text);
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ(0, found->begin);
+    EXPECT_EQ(text.rfind('a', text.size() - n) + n, found->end);
+}
+
+TEST(TestLazyDFA, FlushWithoutFallback) {
+    // A new state is only needed when the letter changes, so the scan continues in the rebuilt cache.
+    LazyDFAMatcher matcher("v*w*x*y*z*", 3);
+    string text;
+    for (const char ch : string("vwxyz")) {
+        text += string(100, ch);
+    }
+    EXPECT_TRUE(matcher.match(text));
+    EXPECT_GT(matcher.numFlushes(), 0);
+    EXPECT_EQ(0, matcher.numFallbacks());
+    EXPECT_FALSE(matcher.match(text + "v"));
+}
+
+TEST(TestLazyDFA, UTF8) {
+    LazyDFAMatcher matcher("(你|我)好+");
+    const string text = "大家好，我好好学习";
+    const auto found = matcher.find(text);
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ("我好好", text.substr(found->begin, found->end - found->begin));
+}
@@ -0,0 +1,119 @@
+#include "lexer.h"
+#include "cfg.h"
+#include "automaton.h"
+#include <gtest/gtest.h>
+
+using namespace std;
+
+static string anyOf(const string& chars) {
+    string pattern = "(";
+    for (const char ch : chars) {
+        if (pattern.size() > 1) {
+            pattern += "|";
+        }
+        pattern += ch;
+    }
+    return pattern + ")";
+}
+
+static const string LETTERS = anyOf("abcdefghijklmnopqrstuvwxyz");
+static const string DIGITS = anyOf("0123456789");
+
+static Lexer identifierLexer() {
+    return Lexer({
+        {"if", "if"},
+        {"id", LETTERS + "(" + LETTERS + "|" + DIGITS + ")*"},
+        {"num", DIGITS + "+"},
+        {"=", "="},
+        {"==", "=="},
+        {"ws", "( |\n)+", true},
+    });
+}
+
+TEST(TestLexer, LongestMatchAndPriority) {
+    const auto lexer = identifierLexer();
+    ASSERT_EQ("", lexer.errorMessage());
+    EXPECT_EQ(6, lexer.numRules());
+    EXPECT_EQ("num", lexer.ruleName(2));
+
+    const auto result = lexer.tokenize("if iff==x1 = 42\nif");
+    ASSERT_TRUE(result.accepted);
+    const vector<LexerToken> expected = {
+        {0, 0, 2}, {1, 3, 6}, {4, 6, 8}, {1, 8, 10}, {3, 11, 12}, {2, 13, 15}, {0, 16, 18},
+    };
+    EXPECT_EQ(expected, result.tokens);
+    EXPECT_EQ(vector<string>({"if", "id", "==", "id", "=", "num", "if"}), lexer.terminals(result.tokens));
+}
+
+TEST(TestLexer, LaterRuleLosesTies) {
+    const Lexer lexer({
+        {"id", LETTERS + "+"},
+        {"if", "if"},
+    });
+    const auto result = lexer.tokenize("if");
+    ASSERT_TRUE(result.accepted);
+    EXPECT_EQ(vector<string>({"id"}), lexer.terminals(result.tokens));
+}
+
+TEST(TestLexer, RulesNotMerged) {
+    // Without the labels, the accepting states and then the states after 'a' and 'c' would be merged,
+    // which leaves 3 states and the dead state.
+    const Lexer lexer({
+        {"x", "ab"},
+        {"y", "cb"},
+    });
+    EXPECT_EQ(6, lexer.numStates());
+    const auto result = lexer.tokenize("abcbab");
+    ASSERT_TRUE(result.accepted);
+    EXPECT_EQ(vector<string>({"x", "y", "x"}), lexer.terminals(result.tokens));
+}
+
+TEST(TestLexer, ErrorPosition) {
+    const auto lexer = identifierLexer();
+    const auto result = lexer.tokenize("x = 1 ? 2");
+    EXPECT_FALSE(result.accepted);
+    EXPECT_EQ(6, result.errorPosition);
+    EXPECT_EQ(3, result.tokens.size());
+}
+
+TEST(TestLexer, InvalidRules) {
+    const Lexer invalid({{"a", "a"}, {"b", "(b"}});
+    EXPECT_EQ("Error: invalid pattern of b: Error: missing right bracket for 1.", invalid.errorMessage());
+    EXPECT_FALSE(invalid.tokenize("a").accepted);
+
+    const Lexer empty({{"a", "a"}, {"b", "b*"}});
+    EXPECT_EQ("Error: b matches the empty string.", empty.errorMessage());
+}
+
+TEST(TestLexer, UTF8) {
+    const Lexer lexer({{"hello", "你好"}, {"world", "世界"}, {"ws", " +", true}});
+    const auto result = lexer.tokenize("你好 世界你好");
+    ASSERT_TRUE(result.accepted);
+    EXPECT_EQ(vector<string>({"hello", "world", "hello"}), lexer.terminals(result.tokens));
+    EXPECT_EQ(7, result.tokens[1].begin);
+}
+
+TEST(TestLexer, FeedParsers) {
+    const Lexer lexer({
+        {"id", LETTERS + "+"},
+        {",", ","},
+        {"ws", " +", true},
+    });
+    const auto result = lexer.tokenize("foo, bar ,baz");
+    ASSERT_TRUE(result.accepted);
+    const auto terminals = lexer.terminals(result.tokens);
+
+    ContextFreeGrammar grammar;
+    grammar.parse(R"(
+L -> id R
+R -> , id R | ε
+)");
+    auto lrTable = grammar.computeSLR1ActionGotoTable(grammar.computeSLR1Automaton());
+    const auto lrSteps = lrTable.parse(terminals);
+    EXPECT_EQ("accept", lrSteps.actions.back());
+
+    auto llTable = grammar.computeLL1Table();
+    const auto llSteps = llTable.parse(terminals);
+    EXPECT_EQ("accept", llSteps.actions.back());
+    EXPECT_EQ(llTable.parse("id , id , id").toString(), llSteps.toString());
+}
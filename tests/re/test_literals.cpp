@@ -0,0 +1,154 @@
+#include "re_matcher.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace std;
+
+TEST(TestRegexLiterals, Text) {
+    const auto literals = RegularExpression("abc").literals();
+    EXPECT_TRUE(literals.exact);
+    EXPECT_EQ("abc", literals.prefix);
+    EXPECT_EQ("abc", literals.suffix);
+    EXPECT_EQ("abc", literals.required);
+    EXPECT_EQ("你好", RegularExpression("你好").literals().prefix);
+}
+
+TEST(TestRegexLiterals, Concatenation) {
+    auto literals = RegularExpression("ab(c|d)*efg").literals();
+    EXPECT_FALSE(literals.exact);
+    EXPECT_EQ("ab", literals.prefix);
+    EXPECT_EQ("efg", literals.suffix);
+    EXPECT_EQ("efg", literals.required);
+    literals = RegularExpression("a*(bc(d|e)fghi)c*").literals();
+    EXPECT_EQ("", literals.prefix);
+    EXPECT_EQ("", literals.suffix);
+    EXPECT_EQ("fghi", literals.required);
+}
+
+TEST(TestRegexLiterals, Alternation) {
+    auto literals = RegularExpression("abcx|abdx").literals();
+    EXPECT_FALSE(literals.exact);
+    EXPECT_EQ("ab", literals.prefix);
+    EXPECT_EQ("x", literals.suffix);
+    EXPECT_EQ("ab", literals.required);
+    literals = RegularExpression("(foo|bar)baz").literals();
+    EXPECT_EQ("", literals.prefix);
+    EXPECT_EQ("baz", literals.suffix);
+    EXPECT_EQ("baz", literals.required);
+    literals = RegularExpression("ab|ab").literals();
+    EXPECT_TRUE(literals.exact);
+    EXPECT_EQ("ab", literals.prefix);
+    literals = RegularExpression("a|ε").literals();
+    EXPECT_FALSE(literals.exact);
+    EXPECT_EQ("", literals.required);
+}
+
+TEST(TestRegexLiterals, Empty) {
+    auto literals = RegularExpression("ε").literals();
+    EXPECT_TRUE(literals.exact);
+    EXPECT_EQ("", literals.required);
+    literals = RegularExpression("(a").literals();
+    EXPECT_FALSE(literals.exact);
+    EXPECT_EQ("", literals.required);
+}
+
+TEST(TestFindLiteral, Simple) {
+    EXPECT_EQ(0, findLiteral("abc", ""));
+    EXPECT_EQ(2, findLiteral("abc", "", 2));
+    EXPECT_EQ(string_view::npos, findLiteral("abc", "", 4));
+    EXPECT_EQ(string_view::npos, findLiteral("abc", "abcd"));
+    EXPECT_EQ(1, findLiteral("abc", "bc"));
+    const string text = string(100, 'a') + "abab" + string(100, 'b') + "ab";
+    EXPECT_EQ(101, findLiteral(text, "bab"));
+    EXPECT_EQ(99, findLiteral(text, "aab"));
+    EXPECT_EQ(202, findLiteral(text, "bbab"));
+    EXPECT_EQ(string_view::npos, findLiteral(text, "abba"));
+}
+
+TEST(TestFindLiteral, SameAsFind) {
+    mt19937 rng(42);
+    for (size_t t = 0; t < 2000; ++t) {
+        const string alphabet = t % 2 ? "ab" : "abcd";
+        string text, literal;
+        const auto length = rng() % 100;
+        for (size_t i = 0; i < length; ++i) {
+            text += alphabet[rng() % alphabet.size()];
+        }
+        const auto literalLength = 1 + rng() % 6;
+        for (size_t i = 0; i < literalLength; ++i) {
+            literal += alphabet[rng() % alphabet.size()];
+        }
+        const auto from = rng() % (length + 2);
+        EXPECT_EQ(string_view(text).find(literal, from), findLiteral(text, literal, from)) << text << " " << literal;
+    }
+}
+
+TEST(TestLiteralPrefilter, SkipWithoutRequired) {
+    const LiteralPrefilter prefilter(RegularExpression("a*bcd").literals());
+    size_t numFinds = 0;
+    auto find = [&](string_view) -> optional<RegexMatch> {
+        ++numFinds;
+        return nullopt;
+    };
+    auto longestPrefix = [](string_view) { return string_view::npos; };
+    EXPECT_FALSE(prefilter.find("aaaabcaaaa", find, longestPrefix).has_value());
+    EXPECT_EQ(0, numFinds);
+    EXPECT_FALSE(prefilter.find("aaaabcdaaa", find, longestPrefix).has_value());
+    EXPECT_EQ(1, numFinds);
+}
+
+TEST(TestLiteralPrefilter, Candidates) {
+    const LiteralPrefilter prefilter(RegularExpression("ab*c").literals());
+    size_t numFinds = 0, numPrefixes = 0;
+    auto find = [&](const string_view text) -> optional<RegexMatch> {
+        ++numFinds;
+        if (const auto begin = text.find("ac"); begin != string_view::npos) {
+            return RegexMatch{begin, begin + 2};
+        }
+        return nullopt;
+    };
+    auto longestPrefix = [&](const string_view text) {
+        ++numPrefixes;
+        return text.starts_with("ac") ? 2 : string_view::npos;
+    };
+    EXPECT_EQ((RegexMatch{3, 5}), prefilter.find("xxaacx", find, longestPrefix));
+    EXPECT_EQ(0, numFinds);
+    EXPECT_EQ(2, numPrefixes);
+    const string text = string(20, 'a') + "c";
+    EXPECT_EQ((RegexMatch{19, 21}), prefilter.find(text, find, longestPrefix));
+    EXPECT_EQ(1, numFinds);
+    EXPECT_EQ(2 + LiteralPrefilter::MAX_CANDIDATES, numPrefixes);
+}
+
+/**
+ * Compare find() of the matchers with trying all the spans in the order of leftmost-longest,
+ * with patterns that have literals and texts with many candidates.
+ */
+TEST(TestLiteralPrefilter, SameAsBruteForce) {
+    mt19937 rng(42);
+    const string alphabet = "abc";
+    for (const auto& pattern : {"ab(a|b)*b", "a(c|a)*b", "ba|ca", "(a|b)cc*", "c(a|b)*c", "aa*ab|ac"}) {
+        const DFAMatcher dfaMatcher(pattern);
+        LazyDFAMatcher lazyMatcher(pattern);
+        const BitParallelMatcher bitParallelMatcher(pattern);
+        for (size_t t = 0; t < 100; ++t) {
+            string text;
+            const auto length = rng() % 40;
+            for (size_t i = 0; i < length; ++i) {
+                text += alphabet[rng() % (t % 2 ? 2 : 3)];
+            }
+            optional<RegexMatch> expected;
+            for (size_t begin = 0; begin <= text.size() && !expected; ++begin) {
+                for (size_t end = text.size() + 1; end-- > begin;) {
+                    if (dfaMatcher.match(string_view(text).substr(begin, end - begin))) {
+                        expected = RegexMatch{begin, end};
+                        break;
+                    }
+                }
+            }
+            EXPECT_EQ(expected, dfaMatcher.find(text)) << pattern << " " << text;
+            EXPECT_EQ(expected, lazyMatcher.find(text)) << pattern << " " << text;
+            EXPECT_EQ(expected, bitParallelMatcher.find(text)) << pattern << " " << text;
+        }
+    }
+}
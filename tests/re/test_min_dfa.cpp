@@ -485,3 +485,68 @@ TEST(TestMinDFA, DragonBookExample) {
 
     EXPECT_LT(minStates.size(), dfaStates.size());
 }
+
+static bool acceptsFlat(const FlatDFA& dfa, const FlatNFA& nfa, const string& input) {
+    auto state = dfa.start;
+    for (const char ch : input) {
+        const auto symbol = nfa.symbolId(string(1, ch));
+        if (symbol == FlatNFA::NONE || (state = dfa.next(state, symbol)) == FlatDFA::DEAD) {
+            return false;
+        }
+    }
+    return dfa.accepting[state];
+}
+
+TEST(TestMinFlatDFA, SameSizeAsMinDFA) {
+    for (const auto& pattern : {"ε", "a", "(a|b)*", "(a|b)+", "(a|b)*abb", "a(b|c)*", "((a|bc)*|d)+e", "(a|b)*a(a|b)(a|b)"}) {
+        const RegularExpression re(pattern);
+        const auto minDfa = RegularExpression::toMinDFA(RegularExpression::toDFA(re.toNFA()));
+        const auto nfa = re.toFlatNFA();
+        const auto dfa = RegularExpression::toFlatDFA(nfa);
+        const auto minFlat = RegularExpression::toMinFlatDFA(dfa);
+        EXPECT_EQ(RegularExpression::toDFAGraph(minDfa).size(), minFlat.size()) << pattern;
+        EXPECT_EQ(0, minFlat.start);
+        for (const auto& input : {"", "a", "b", "ab", "abb", "aabb", "bcbce", "de", "aab", "abab", "baaa"}) {
+            EXPECT_EQ(acceptsFlat(dfa, nfa, input), acceptsFlat(minFlat, nfa, input)) << pattern << " " << input;
+        }
+    }
+}
+
+TEST(TestMinFlatDFA, Exponential) {
+    // The reversed pattern a(a|b)^n(a|b)* has a DFA of n + 2 states, which is the minimized DFA of the reversed NFA.
+    string pattern = "(a|b)*a";
+    for (size_t i = 0; i < 10; ++i) {
+        pattern += "(a|b)";
+    }
+    const RegularExpression re(pattern);
+    const auto nfa = re.toFlatNFA();
+    const auto dfa = RegularExpression::toFlatDFA(nfa);
+    EXPECT_EQ(2048, RegularExpression::toMinFlatDFA(dfa).size());
+    EXPECT_EQ(12, RegularExpression::toMinFlatDFA(RegularExpression::toFlatDFA(nfa.reversed())).size());
+}
+
+TEST(TestMinFlatDFA, EmptyLanguage) {
+    FlatDFA dfa;
+    dfa.symbols = {"a"};
+    dfa.transitions = {1, 1};
+    dfa.accepting = {false, false};
+    dfa.start = 0;
+    const auto minDfa = RegularExpression::toMinFlatDFA(dfa);
+    ASSERT_EQ(1, minDfa.size());
+    EXPECT_FALSE(minDfa.accepting[0]);
+    EXPECT_EQ(FlatDFA::DEAD, minDfa.next(0, 0));
+    EXPECT_EQ(0, RegularExpression::toMinFlatDFA(FlatDFA()).size());
+}
+
+TEST(TestMinFlatDFA, RemoveDeadStates) {
+    // 0 -a-> 1 (accept), 0 -b-> 2 -a-> 2, where 2 can never accept.
+    FlatDFA dfa;
+    dfa.symbols = {"a", "b"};
+    dfa.transitions = {1, 2, FlatDFA::DEAD, FlatDFA::DEAD, 2, FlatDFA::DEAD};
+    dfa.accepting = {false, true, false};
+    dfa.start = 0;
+    const auto minDfa = RegularExpression::toMinFlatDFA(dfa);
+    ASSERT_EQ(2, minDfa.size());
+    EXPECT_EQ(1, minDfa.next(0, 0));
+    EXPECT_EQ(FlatDFA::DEAD, minDfa.next(0, 1));
+}
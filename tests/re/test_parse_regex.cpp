@@ -305,3 +305,231 @@ TEST(TestRegexParse, ErrorEmptyInsideBrackets) {
     EXPECT_FALSE(re.parse("a(|)b"));
     EXPECT_EQ(re.errorMessage(), "Error: empty input at 2.");
 }
+
+TEST(TestRegexParse, Class) {
+    const RegularExpression re("x[a-c_\\d]");
+    const auto ast = re.ast();
+    ASSERT_NE(ast, nullptr);
+    ASSERT_EQ(ast->parts.size(), 2);
+    const auto& node = ast->parts[1];
+    EXPECT_EQ(node->type, RegexNode::Type::CLASS);
+    EXPECT_EQ(node->text, "[a-c_\\d]");
+    EXPECT_EQ(node->begin, 1);
+    EXPECT_EQ(node->end, 9);
+    EXPECT_EQ((vector<pair<uint32_t, uint32_t>>{{'0', '9'}, {'_', '_'}, {'a', 'c'}}), node->charClass.intervals);
+}
+
+TEST(TestRegexParse, ClassLiterals) {
+    auto ast = RegularExpression("[-a-]").ast();
+    ASSERT_NE(ast, nullptr);
+    EXPECT_EQ((vector<pair<uint32_t, uint32_t>>{{'-', '-'}, {'a', 'a'}}), ast->charClass.intervals);
+    ast = RegularExpression("[(|)*\\]]").ast();
+    ASSERT_NE(ast, nullptr);
+    EXPECT_EQ((vector<pair<uint32_t, uint32_t>>{{'(', '*'}, {']', ']'}, {'|', '|'}}), ast->charClass.intervals);
+    ast = RegularExpression("[你-好]").ast();
+    ASSERT_NE(ast, nullptr);
+    EXPECT_EQ((vector<pair<uint32_t, uint32_t>>{{0x4F60, 0x597D}}), ast->charClass.intervals);
+}
+
+TEST(TestRegexParse, NegatedClass) {
+    const auto ast = RegularExpression("[^b-y]").ast();
+    ASSERT_NE(ast, nullptr);
+    EXPECT_EQ((vector<pair<uint32_t, uint32_t>>{{0, 'a'}, {'z', CharClass::MAX_CODE_POINT}}), ast->charClass.intervals);
+    const auto dot = RegularExpression(".").ast();
+    ASSERT_NE(dot, nullptr);
+    EXPECT_EQ(dot->type, RegexNode::Type::CLASS);
+    EXPECT_FALSE(dot->charClass.contains('\n'));
+    EXPECT_TRUE(dot->charClass.contains('a'));
+}
+
+TEST(TestRegexParse, Escapes) {
+    auto ast = RegularExpression("\\.\\n\\x41\\(\\ε").ast();
+    ASSERT_NE(ast, nullptr);
+    ASSERT_EQ(ast->parts.size(), 5);
+    EXPECT_EQ(ast->parts[0]->type, RegexNode::Type::TEXT);
+    EXPECT_EQ(ast->parts[0]->text, ".");
+    EXPECT_EQ(ast->parts[0]->begin, 0);
+    EXPECT_EQ(ast->parts[0]->end, 2);
+    EXPECT_EQ(ast->parts[1]->text, "\n");
+    EXPECT_EQ(ast->parts[2]->text, "A");
+    EXPECT_EQ(ast->parts[2]->begin, 4);
+    EXPECT_EQ(ast->parts[2]->end, 8);
+    EXPECT_EQ(ast->parts[3]->text, "(");
+    EXPECT_EQ(ast->parts[4]->type, RegexNode::Type::TEXT);
+    EXPECT_EQ(ast->parts[4]->text, "ε");
+    ast = RegularExpression("\\W").ast();
+    ASSERT_NE(ast, nullptr);
+    EXPECT_EQ(ast->type, RegexNode::Type::CLASS);
+    EXPECT_EQ(ast->text, "\\W");
+    EXPECT_FALSE(ast->charClass.contains('_'));
+    EXPECT_TRUE(ast->charClass.contains('-'));
+}
+
+TEST(TestRegexParse, Repetition) {
+    auto ast = RegularExpression("a{2,4}").ast();
+    ASSERT_NE(ast, nullptr);
+    EXPECT_EQ(ast->type, RegexNode::Type::CAT);
+    EXPECT_EQ(ast->begin, 0);
+    EXPECT_EQ(ast->end, 6);
+    ASSERT_EQ(ast->parts.size(), 3);
+    EXPECT_EQ(ast->parts[0]->type, RegexNode::Type::TEXT);
+    EXPECT_EQ(ast->parts[1]->type, RegexNode::Type::TEXT);
+    EXPECT_EQ(ast->parts[2]->type, RegexNode::Type::OR);
+    EXPECT_EQ(ast->parts[2]->parts[0]->type, RegexNode::Type::CAT);
+    EXPECT_EQ(ast->parts[2]->parts[1]->type, RegexNode::Type::EMPTY);
+
+    ast = RegularExpression("(ab){2,}").ast();
+    ASSERT_NE(ast, nullptr);
+    ASSERT_EQ(ast->parts.size(), 3);
+    EXPECT_EQ(ast->parts[2]->type, RegexNode::Type::STAR);
+    EXPECT_EQ(ast->parts[2]->end, 8);
+
+    ast = RegularExpression("a{1}").ast();
+    ASSERT_NE(ast, nullptr);
+    EXPECT_EQ(ast->type, RegexNode::Type::TEXT);
+    ast = RegularExpression("a{0}").ast();
+    ASSERT_NE(ast, nullptr);
+    EXPECT_EQ(ast->type, RegexNode::Type::EMPTY);
+}
+
+TEST(TestRegexParse, ErrorClasses) {
+    RegularExpression re;
+    EXPECT_FALSE(re.parse("a[bc"));
+    EXPECT_EQ(re.errorMessage(), "Error: missing right square bracket for 1.");
+    EXPECT_FALSE(re.parse("[]"));
+    EXPECT_EQ(re.errorMessage(), "Error: empty class at 0.");
+    EXPECT_FALSE(re.parse("[z-a]"));
+    EXPECT_EQ(re.errorMessage(), "Error: invalid range at 1.");
+    EXPECT_FALSE(re.parse("[a-\\d]"));
+    EXPECT_EQ(re.errorMessage(), "Error: invalid range at 1.");
+    EXPECT_FALSE(re.parse("(a|[)]"));
+    EXPECT_EQ(re.errorMessage(), "Error: missing right bracket for 1.");
+    EXPECT_FALSE(re.parse("ab\\"));
+    EXPECT_EQ(re.errorMessage(), "Error: unexpected \\ at 2.");
+    EXPECT_FALSE(re.parse("\\x4g"));
+    EXPECT_EQ(re.errorMessage(), "Error: invalid escape at 0.");
+}
+
+TEST(TestRegexParse, ErrorRepetitions) {
+    RegularExpression re;
+    EXPECT_FALSE(re.parse("{2}"));
+    EXPECT_EQ(re.errorMessage(), "Error: unexpected { at 0.");
+    EXPECT_FALSE(re.parse("a{3,2}"));
+    EXPECT_EQ(re.errorMessage(), "Error: invalid repetition at 1.");
+    EXPECT_FALSE(re.parse("a{,2}"));
+    EXPECT_EQ(re.errorMessage(), "Error: invalid repetition at 1.");
+    EXPECT_FALSE(re.parse("a{2"));
+    EXPECT_EQ(re.errorMessage(), "Error: invalid repetition at 1.");
+    EXPECT_FALSE(re.parse("a{1001}"));
+    EXPECT_EQ(re.errorMessage(), "Error: invalid repetition at 1.");
+    EXPECT_TRUE(re.parse("a{1000}"));
+}
+
+TEST(TestRegexParse, ErrorNestedRepetitions) {
+    RegularExpression re;
+    EXPECT_FALSE(re.parse("((a{1000}){1000}){1000}"));
+    EXPECT_EQ(re.errorMessage(), "Error: the repetition at 10 expands to more than 1000000 nodes.");
+    EXPECT_FALSE(re.parse("(((a{10}){10}){10}){1000}"));
+    EXPECT_EQ(re.errorMessage(), "Error: the repetition at 19 expands to more than 1000000 nodes.");
+    EXPECT_TRUE(re.parse("((a{10}){10}){10}"));
+    EXPECT_TRUE(re.parse("(a{1000}){100}"));
+
+    string pattern;
+    for (int i = 0; i < 300; ++i) {
+        pattern += "(a{1000})";
+    }
+    EXPECT_FALSE(re.parse(pattern));
+    EXPECT_EQ(re.errorMessage(), "Error: the pattern expands to more than 1000000 nodes.");
+}
+
+TEST(TestRegexParse, ErrorDeepNesting) {
+    auto nested = [](const size_t depth) {
+        string pattern;
+        for (size_t i = 0; i < depth; ++i) {
+            pattern += "(a|";
+        }
+        pattern += "a";
+        for (size_t i = 0; i < depth; ++i) {
+            pattern += ")";
+        }
+        return pattern;
+    };
+    RegularExpression re;
+    EXPECT_FALSE(re.parse(nested(30000)));
+    EXPECT_EQ(re.errorMessage(), "Error: the pattern is nested deeper than 5000 levels.");
+    EXPECT_FALSE(re.parse("a" + string(5000, '*')));
+    EXPECT_EQ(re.errorMessage(), "Error: the pattern is nested deeper than 5000 levels.");
+    EXPECT_FALSE(re.parse("(a{0,1000}){0,1000}"));
+    EXPECT_TRUE(re.parse("a" + string(4999, '*')));
+    EXPECT_TRUE(re.parse("a{0,1000}"));
+
+    EXPECT_TRUE(re.parse(nested(4999)));
+    const auto flatNFA = re.toFlatNFA();
+    EXPECT_EQ(4999 * 4 + 2, flatNFA.size());
+    EXPECT_EQ(flatNFA.size(), RegularExpression::toNFAGraph(re.toNFA()).size());
+    EXPECT_EQ(flatNFA.size(), re.toByteNFA().size());
+    EXPECT_EQ(5000, re.toGlushkovNFA().positionBytes.size());
+    EXPECT_EQ("a", re.literals().required);
+}
+
+TEST(TestRegexParse, Spans) {
+    const RegularExpression re("x(ab|c*)+");
+    const auto ast = re.ast();
+    ASSERT_NE(ast, nullptr);
+    EXPECT_EQ(ast->type, RegexNode::Type::CAT);
+    EXPECT_EQ(ast->begin, 0);
+    EXPECT_EQ(ast->end, 9);
+    ASSERT_EQ(ast->parts.size(), 2);
+    const auto plus = ast->parts[1];
+    EXPECT_EQ(plus->begin, 1);
+    EXPECT_EQ(plus->end, 9);
+    const auto group = plus->parts[0];
+    EXPECT_EQ(group->type, RegexNode::Type::OR);
+    EXPECT_EQ(group->begin, 1);
+    EXPECT_EQ(group->end, 8);
+    ASSERT_EQ(group->parts.size(), 2);
+    EXPECT_EQ(group->parts[0]->begin, 2);
+    EXPECT_EQ(group->parts[0]->end, 4);
+    EXPECT_EQ(group->parts[1]->type, RegexNode::Type::STAR);
+    EXPECT_EQ(group->parts[1]->begin, 5);
+    EXPECT_EQ(group->parts[1]->end, 7);
+}
+
+TEST(TestRegexParse, UnmatchedRightBracket) {
+    const RegularExpression re("a)|b");
+    const auto ast = re.ast();
+    ASSERT_NE(ast, nullptr);
+    EXPECT_EQ(ast->type, RegexNode::Type::OR);
+    ASSERT_EQ(ast->parts.size(), 2);
+    EXPECT_EQ(ast->parts[0]->type, RegexNode::Type::CAT);
+    EXPECT_EQ(ast->parts[0]->parts[1]->text, ")");
+    EXPECT_EQ(ast->parts[1]->text, "b");
+}
+
+TEST(TestRegexParse, DeepNesting) {
+    constexpr size_t depth = 100000;
+    RegularExpression re(string(depth, '(') + "a" + string(depth, ')'));
+    auto ast = re.ast();
+    ASSERT_NE(ast, nullptr);
+    EXPECT_EQ(ast->type, RegexNode::Type::TEXT);
+    EXPECT_EQ(ast->begin, 0);
+    EXPECT_EQ(ast->end, 2 * depth + 1);
+
+    string pattern;
+    for (size_t i = 0; i < 1000; ++i) {
+        pattern += "a|(";
+    }
+    pattern += "b" + string(1000, ')');
+    ASSERT_TRUE(re.parse(pattern));
+    ast = re.ast();
+    for (size_t i = 0; i < 1000; ++i) {
+        ASSERT_EQ(ast->type, RegexNode::Type::OR);
+        EXPECT_EQ(ast->begin, i == 0 ? 0 : 3 * i - 1);
+        EXPECT_EQ(ast->end, i == 0 ? pattern.size() : pattern.size() - i + 1);
+        ast = ast->parts[1];
+    }
+    EXPECT_EQ(ast->text, "b");
+
+    EXPECT_FALSE(re.parse(string(depth, '(') + "a" + string(depth - 1, ')')));
+    EXPECT_EQ(re.errorMessage(), "Error: missing right bracket for 1.");
+}
@@ -0,0 +1,67 @@
+#include "re_matcher.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace std;
+
+TEST(TestRegexCache, HitAndMiss) {
+    RegexCache cache;
+    const auto matcher = cache.get("(a|b)*abb");
+    EXPECT_TRUE(matcher->match("babb"));
+    EXPECT_EQ(matcher, cache.get("(a|b)*abb"));
+    EXPECT_NE(matcher, cache.get("(a|b)*ab"));
+    EXPECT_EQ(2, cache.size());
+    EXPECT_EQ(1, cache.numHits());
+    EXPECT_EQ(2, cache.numMisses());
+    cache.clear();
+    EXPECT_EQ(0, cache.size());
+    EXPECT_EQ(0, cache.numHits());
+}
+
+TEST(TestRegexCache, Invalid) {
+    RegexCache cache;
+    const auto matcher = cache.get("(a");
+    EXPECT_FALSE(matcher->match("a"));
+    EXPECT_FALSE(matcher->find("(a").has_value());
+    EXPECT_EQ(matcher, cache.get("(a"));
+}
+
+TEST(TestRegexCache, EvictLeastRecentlyUsed) {
+    RegexCache cache(2);
+    const auto a = cache.get("a");
+    const auto b = cache.get("b");
+    EXPECT_EQ(a, cache.get("a"));
+    const auto c = cache.get("c");
+    EXPECT_EQ(2, cache.size());
+    EXPECT_EQ(a, cache.get("a"));
+    EXPECT_EQ(c, cache.get("c"));
+    EXPECT_NE(b, cache.get("b"));
+    EXPECT_TRUE(b->match("b"));
+    EXPECT_EQ(3, cache.numHits());
+    EXPECT_EQ(4, cache.numMisses());
+}
+
+TEST(TestRegexCache, Threads) {
+    RegexCache cache(4);
+    const vector<string> patterns = {"a+", "b*c", "(ab|cd)*", "[0-9]{2}", "x|y|z", "ε"};
+    vector<thread> threads;
+    vector<size_t> numMatches(4, 0);
+    for (size_t t = 0; t < numMatches.size(); ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t i = 0; i < 200; ++i) {
+                const auto& pattern = patterns[(i * (t + 1)) % patterns.size()];
+                if (cache.get(pattern)->match(i % 2 ? "ab" : "aa")) {
+                    ++numMatches[t];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(800, cache.numHits() + cache.numMisses());
+    EXPECT_LE(cache.size(), 4);
+    for (const auto count : numMatches) {
+        EXPECT_GT(count, 0);
+    }
+}
@@ -1,5 +1,7 @@
 #include "string_utils.h"
+#include <grapheme_break.h>
 #include <gtest/gtest.h>
+#include <random>
 
 using namespace std;
 
@@ -13,4 +15,35 @@ TEST(TestStringUtils, ToSubscripts) {
     EXPECT_EQ(string("₀"), toSubscript(0));
     EXPECT_EQ(string("₄₂"), toSubscript(42));
     EXPECT_EQ(string("₁₃₅₆₇₈₉"), toSubscript(1356789));
-}
\ No newline at end of file
+}
+TEST(TestStringUtils, SegmentGraphemeViews) {
+    const string s = "ab\r\nc你好\n";
+    const auto views = segmentGraphemeViews(s);
+    EXPECT_EQ((vector<string_view>{"a", "b", "\r\n", "c", "你", "好", "\n"}), views);
+    EXPECT_EQ(s.data(), views[0].data());
+    EXPECT_EQ(s.data() + 8, views[5].data());
+    EXPECT_TRUE(segmentGraphemeViews("").empty());
+    const string ascii(100, 'x');
+    EXPECT_EQ(100, segmentGraphemeViews(ascii).size());
+}
+
+/**
+ * The fast path for ASCII should not change the clusters next to the other characters,
+ * e.g. the combining marks, the prepended characters, the emoji sequences and CR LF.
+ */
+TEST(TestStringUtils, SegmentGraphemeViewsSameAsLibrary) {
+    const vector<string> parts = {"a", "b", " ", "\r", "\n", "\r\n", "\t", "e\xcc\x81", "\xcc\x81", "你", "→",
+                                  "\xe2\x80\x8d", "\xf0\x9f\x91\xa8", "\xf0\x9f\x87\xa8", "\xd8\x80", "\xe0\xa4\x95\xe0\xa5\x8d"};
+    mt19937 rng(42);
+    for (size_t t = 0; t < 1000; ++t) {
+        string s;
+        const auto length = rng() % 40;
+        for (size_t i = 0; i < length; ++i) {
+            s += parts[rng() % (t % 2 ? 5 : parts.size())];
+        }
+        const auto expected = grapheme_break::segmentGraphemeClusters(s);
+        const auto views = segmentGraphemeViews(s);
+        EXPECT_EQ(expected, vector<string>(views.begin(), views.end())) << s;
+        EXPECT_EQ(expected, segmentGraphemes(s)) << s;
+    }
+}
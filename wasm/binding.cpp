@@ -33,7 +33,7 @@ EMSCRIPTEN_BINDINGS(ParsingToysWASM) {
         .function("computeLL1Table", &ContextFreeGrammar::computeLL1Table)
         .function("isChomskyNormalForm", &ContextFreeGrammar::isChomskyNormalForm)
         .function("toChomskyNormalForm", &ContextFreeGrammar::toChomskyNormalForm)
-        .function("cykParse", &ContextFreeGrammar::cykParse)
+        .function("cykParse", optional_override([](const ContextFreeGrammar& self, const string& s) { return self.cykParse(s); }))
     ;
     class_<FirstAndFollowSet>("FirstAndFollowSet")
         .constructor<>()
@@ -62,7 +62,7 @@ EMSCRIPTEN_BINDINGS(ParsingToysWASM) {
         .function("hasConflict", optional_override([](const ActionGotoTable& self) { return self.hasConflict(); }))
         .function("hasConflictAt", optional_override([](const ActionGotoTable& self, size_t index, const string& symbol) { return self.hasConflict(index, symbol); }))
         .function("getCell", optional_override([](const ActionGotoTable& self, size_t index, const string& symbol, const string& separator) { return self.toString(index, symbol, separator); }))
-        .function("parse", &ActionGotoTable::parse)
+        .function("parse", select_overload<LRParsingSteps(const string&)>(&ActionGotoTable::parse))
         .function("getParseTree", optional_override([](const ActionGotoTable& self) { return self.parseTree; }))
     ;
     class_<ParseTreeNode>("ParseTreeNode")
@@ -85,7 +85,7 @@ EMSCRIPTEN_BINDINGS(ParsingToysWASM) {
         .function("hasConflict", optional_override([](const MTable& self) { return self.hasConflict(); }))
         .function("hasConflictAt", optional_override([](const MTable& self, const string& nt, const string& t) { return self.hasConflict(nt, t); }))
         .function("getCell", optional_override([](const MTable& self, const string& nt, const string& t, const string& sep) { return self.getCell(nt, t, sep); }))
-        .function("parse", &MTable::parse)
+        .function("parse", select_overload<LLParsingSteps(const string&)>(&MTable::parse))
         .function("getParseTree", optional_override([](const MTable& self) { return self.parseTree; }))
     ;
     class_<CYKTable>("CYKTable")